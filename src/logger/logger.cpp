@@ -2,12 +2,14 @@
 
 void Logger::print(const char* level, const char* component, const char* message) {
     if (!initialized) return;
+    lock();
     serial->print("[");
     serial->print(level);
     serial->print("] ");
     serial->print(component);
     serial->print(": ");
     serial->println(message);
+    unlock();
 }
 
 void Logger::error(const char* component, const char* message) {
@@ -42,18 +44,24 @@ void Logger::failure(const char* component, const char* message) {
 
 void Logger::header(const char* title) {
     if (!initialized) return;
+    lock();
     serial->println("==========================================");
     serial->print("| ");
     serial->println(title);
     serial->println("==========================================");
+    unlock();
 }
 
 void Logger::footer() {
     if (!initialized) return;
+    lock();
     serial->println("==========================================");
+    unlock();
 }
 
 void Logger::println(const char* message) {
     if (!initialized) return;
+    lock();
     serial->println(message);
+    unlock();
 }
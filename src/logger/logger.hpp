@@ -2,6 +2,9 @@
 #include <Arduino.h>
 #include <HWCDC.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
 /**
  * Simple logging system for ESP32-S3 Touch AMOLED project
  * Provides consistent formatting and log levels
@@ -10,6 +13,10 @@ class Logger {
 private:
     HWCDC* serial = nullptr;
     bool initialized = false;
+    SemaphoreHandle_t mutex = nullptr;   // Keeps lines whole when several tasks log (parallel init)
+    
+    void lock() { if (mutex) xSemaphoreTake(mutex, portMAX_DELAY); }
+    void unlock() { if (mutex) xSemaphoreGive(mutex); }
     
 public:
     enum Level {
@@ -23,9 +30,13 @@ public:
 
     void setSerial(HWCDC* serial) {
         this->serial = serial;
+        if (!mutex) mutex = xSemaphoreCreateMutex();
         this->initialized = (serial != nullptr);
     }
 
+    // A USB host is attached (light sleep drops the USB link)
+    bool isConnected() const { return serial && *serial; }
+
     // Generic print to generalize messages
     void print(const char* level, const char* component, const char* message);
     
@@ -2,12 +2,14 @@
 #include "system/system_manager.hpp"
 #include "config.h"
 #include "logger/logger.hpp"
+#include "system/boot/boot_profiler.hpp"
 
 HWCDC USBSerial;
 Logger logger = Logger();
 SystemManager *system_manager = nullptr;
 
 void setup() {
+    BOOT_STAGE("USB serial");
     // Initialize USB Serial
     USBSerial.begin(115200);
     while (!USBSerial) {
@@ -22,7 +24,8 @@ void setup() {
     logger.info("MAIN", "System starting...");
     logger.info("MAIN", "Version: 1.0.0");
 
-    // Initialize system
+    // Initialize system (LittleFS mounts while the members are constructed)
+    BOOT_STAGE("SystemManager members");
     system_manager = new SystemManager(&logger);
 
     if (!system_manager->isInitialized()) {
@@ -34,6 +37,9 @@ void setup() {
     }
     
     logger.header("System setup complete");
+
+    // Build the boot_profile environment for a per-stage init breakdown
+    BOOT_DONE(&logger);
 }
 
 void loop() {
@@ -0,0 +1,118 @@
+#include "actigraphy.hpp"
+
+// Cole-Kripke weights for epochs n-4 .. n+2 (1-minute epochs)
+static const uint16_t CK_WEIGHTS[7] = {106, 54, 58, 76, 230, 74, 67};
+
+Actigraphy::Actigraphy(float sample_rate_hz) {
+    epoch_samples = (uint32_t)(EPOCH_S * sample_rate_hz + 0.5f);
+    reset();
+}
+
+void Actigraphy::reset() {
+    sample_count = 0;
+    deviation_sum = 0;
+    peak_deviation = 0;
+    history_count = 0;
+    scored_pending = false;
+    epochs = 0;
+    sleep_epochs = 0;
+    wake_epochs = 0;
+    onset_epoch = 0;
+    onset_found = false;
+    sleep_run = 0;
+    waso_epochs = 0;
+    awakenings = 0;
+    last_stage = STAGE_UNKNOWN;
+}
+
+bool Actigraphy::update(const ImuSample& s) {
+    // | |a|² − g² | / 2g ≈ | |a| − g | in counts, no sqrt
+    static constexpr uint32_t G_SQ = (uint32_t)ImuSample::ACCEL_COUNTS_PER_G * ImuSample::ACCEL_COUNTS_PER_G;
+    uint32_t m2 = magnitudeSquared(s);
+    uint32_t deviation = (m2 > G_SQ ? m2 - G_SQ : G_SQ - m2) / (2 * ImuSample::ACCEL_COUNTS_PER_G);
+
+    if (deviation > (uint32_t)DEAD_BAND) deviation_sum += deviation - DEAD_BAND;
+    if (deviation > peak_deviation) peak_deviation = deviation > 0xFFFF ? 0xFFFF : deviation;
+
+    if (++sample_count < epoch_samples) return false;
+
+    Epoch epoch;
+    uint32_t counts = deviation_sum >> COUNT_SHIFT;
+    epoch.counts = counts >= GAP_COUNTS ? GAP_COUNTS - 1 : counts;
+    uint32_t peak = peak_deviation >> 6;  // 1/64 g
+    epoch.peak = peak > 0xFF ? 0xFF : peak;
+    epoch.stage = STAGE_UNKNOWN;
+
+    sample_count = 0;
+    deviation_sum = 0;
+    peak_deviation = 0;
+    closeEpoch(epoch);
+    return true;
+}
+
+void Actigraphy::addGapEpoch() {
+    Epoch epoch = {GAP_COUNTS, 0xFF, STAGE_UNKNOWN};
+    closeEpoch(epoch);
+}
+
+void Actigraphy::closeEpoch(const Epoch& epoch) {
+    if (history_count == HISTORY) {
+        for (uint8_t i = 1; i < HISTORY; i++) history[i - 1] = history[i];
+        history_count--;
+    }
+    history[history_count++] = epoch;
+    if (history_count > LOOKAHEAD) score();
+}
+
+void Actigraphy::score() {
+    // Target is LOOKAHEAD epochs back from the newest; missing past epochs count as zero
+    uint8_t target = history_count - 1 - LOOKAHEAD;
+    uint32_t weighted = 0;
+    for (int8_t k = -4; k <= 2; k++) {
+        int16_t i = target + k;
+        if (i < 0) continue;
+        uint16_t counts = history[i].counts;
+        if (counts > COUNT_CAP) counts = COUNT_CAP;
+        weighted += CK_WEIGHTS[k + 4] * (uint32_t)counts;
+    }
+
+    Epoch& e = history[target];
+    e.stage = (e.counts == GAP_COUNTS || weighted >= WAKE_THRESHOLD) ? STAGE_WAKE : STAGE_SLEEP;
+
+    // Incremental night summary
+    uint32_t index = epochs++;
+    if (e.stage == STAGE_SLEEP) {
+        sleep_epochs++;
+        sleep_run++;
+        if (!onset_found && sleep_run >= ONSET_EPOCHS) {
+            onset_found = true;
+            onset_epoch = index + 1 - sleep_run;
+        }
+    } else {
+        wake_epochs++;
+        sleep_run = 0;
+        if (onset_found) {
+            waso_epochs++;
+            if (last_stage == STAGE_SLEEP) awakenings++;
+        }
+    }
+    last_stage = e.stage;
+
+    scored = e;
+    scored_pending = true;
+}
+
+bool Actigraphy::popScored(Epoch& epoch) {
+    if (!scored_pending) return false;
+    scored_pending = false;
+    epoch = scored;
+    return true;
+}
+
+const char* Actigraphy::stageName(uint8_t stage) {
+    switch (stage) {
+        case STAGE_WAKE:  return "wake";
+        case STAGE_SLEEP: return "sleep";
+        default:          return "unknown";
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <stdint.h>
+#include "../imu/imu_sample.hpp"
+
+/**
+ * Actigraphy: per-minute activity counts from the accelerometer and incremental
+ * sleep/wake scoring (Cole-Kripke, 1-minute epochs).
+ * Each epoch's score needs two epochs of look-ahead, so stages come out
+ * LOOKAHEAD epochs behind the samples. Fixed memory, no allocation.
+ */
+class Actigraphy {
+public:
+    enum Stage : uint8_t {
+        STAGE_UNKNOWN = 0,
+        STAGE_WAKE,
+        STAGE_SLEEP
+    };
+
+    // Compact per-epoch summary — what gets stored (4 bytes per minute)
+    struct Epoch {
+        uint16_t counts;    // Activity counts (saturating)
+        uint8_t peak;       // Largest per-sample deviation from 1g, in 1/64 g
+        uint8_t stage;      // Stage
+    };
+
+    static constexpr uint32_t EPOCH_S = 60;
+    static constexpr uint8_t LOOKAHEAD = 2;
+    static constexpr uint16_t GAP_COUNTS = 0xFFFF;   // Epoch with no samples (device was awake / in use)
+
+private:
+    static constexpr int16_t DEAD_BAND = accelCounts(0.02f);  // Sensor noise and breathing
+    static constexpr uint8_t COUNT_SHIFT = 9;                  // Sum of deviations → counts (~120/min fidgeting awake)
+    static constexpr uint16_t COUNT_CAP = 300;                 // Cole-Kripke clips counts per epoch
+    // Weighted sum ≥ this → wake. Plays the role of Cole-Kripke's scale factor P for
+    // this sensor's counts; tuned on synthetic nights, recalibrate against sleep diaries.
+    static constexpr uint32_t WAKE_THRESHOLD = 20000;
+    static constexpr uint8_t ONSET_EPOCHS = 10;                // Sleep must last this long to mark onset
+
+    uint32_t epoch_samples;
+    uint32_t sample_count = 0;
+    uint32_t deviation_sum = 0;
+    uint16_t peak_deviation = 0;
+
+    // Counts for epochs n-6 .. n (oldest first); epoch n-2 is scored when epoch n closes
+    static constexpr uint8_t HISTORY = 7;
+    Epoch history[HISTORY];
+    uint8_t history_count = 0;
+
+    bool scored_pending = false;
+    Epoch scored;
+
+    // Night summary
+    uint32_t epochs = 0;
+    uint32_t sleep_epochs = 0;
+    uint32_t wake_epochs = 0;
+    uint32_t onset_epoch = 0;       // Index of the first epoch of the first long sleep bout
+    bool onset_found = false;
+    uint32_t sleep_run = 0;
+    uint32_t waso_epochs = 0;       // Wake after onset
+    uint32_t awakenings = 0;
+    uint8_t last_stage = STAGE_UNKNOWN;
+
+    void closeEpoch(const Epoch& epoch);
+    void score();
+
+public:
+    explicit Actigraphy(float sample_rate_hz = 21.0f);
+
+    // Feed one accelerometer sample (raw counts). Returns true if it closed an epoch.
+    bool update(const ImuSample& sample);
+    // Insert one epoch with no data (e.g. the watch was in use) — scored as wake
+    void addGapEpoch();
+    void reset();
+
+    // Newest scored epoch, available once per closed epoch after the look-ahead fills —
+    // collect it after every update() that returns true and every addGapEpoch()
+    bool popScored(Epoch& epoch);
+
+    uint32_t getEpochs() const { return epochs; }
+    uint32_t getSleepMinutes() const { return sleep_epochs * EPOCH_S / 60; }
+    uint32_t getWakeMinutes() const { return wake_epochs * EPOCH_S / 60; }
+    uint32_t getWasoMinutes() const { return waso_epochs * EPOCH_S / 60; }
+    uint32_t getAwakenings() const { return awakenings; }
+    bool hasOnset() const { return onset_found; }
+    uint32_t getOnsetMinutes() const { return onset_epoch * EPOCH_S / 60; }  // From start of recording
+    uint8_t getLastStage() const { return last_stage; }
+    static const char* stageName(uint8_t stage);
+};
@@ -0,0 +1,68 @@
+#include "activity_classifier.hpp"
+
+#include <math.h>
+
+ActivityClassifier::ActivityClassifier(float sample_rate_hz) {
+    window_samples = (uint32_t)(WINDOW_S * sample_rate_hz);
+}
+
+void ActivityClassifier::reset() {
+    count = 0;
+    sum = sum_sq = 0.0f;
+    window_steps = 0;
+    activity = candidate = ACTIVITY_UNKNOWN;
+    candidate_windows = 0;
+    last_stddev = 0.0f;
+}
+
+bool ActivityClassifier::update(uint32_t magnitude_sq, float cadence_spm, bool step) {
+    // Deviation from 1 g keeps the running sums small and well conditioned
+    float magnitude = magnitudeDeviationG(magnitude_sq);
+    sum += magnitude;
+    sum_sq += magnitude * magnitude;
+    if (step) window_steps++;
+    if (++count < window_samples) return false;
+
+    float mean = sum / count;
+    float variance = sum_sq / count - mean * mean;
+    last_stddev = variance > 0.0f ? sqrtf(variance) : 0.0f;
+    Activity result = classify(last_stddev, cadence_spm, window_steps);
+
+    count = 0;
+    sum = sum_sq = 0.0f;
+    window_steps = 0;
+
+    // Hysteresis: a new class must hold for CONFIRM_WINDOWS windows
+    if (result == candidate) {
+        if (candidate_windows < CONFIRM_WINDOWS) candidate_windows++;
+    } else {
+        candidate = result;
+        candidate_windows = 1;
+    }
+    if (candidate_windows >= CONFIRM_WINDOWS && candidate != activity) {
+        activity = candidate;
+        return true;
+    }
+    return false;
+}
+
+ActivityClassifier::Activity ActivityClassifier::classify(float stddev, float cadence_spm, uint16_t steps) const {
+    if (stddev < STILL_STDDEV_G && steps == 0) return ACTIVITY_STILL;
+    if (steps > 0 && cadence_spm > 0.0f) {
+        if (cadence_spm >= RUN_CADENCE_SPM || stddev >= RUN_STDDEV_G) return ACTIVITY_RUN;
+        return ACTIVITY_WALK;
+    }
+    // Sustained low-level vibration without a step rhythm: car, bus, train
+    if (stddev < MOVING_STDDEV_G) return ACTIVITY_TRANSPORT;
+    return ACTIVITY_UNKNOWN;
+}
+
+const char* ActivityClassifier::name(Activity activity) {
+    switch (activity) {
+        case ACTIVITY_STILL:     return "Still";
+        case ACTIVITY_WALK:      return "Walk";
+        case ACTIVITY_RUN:       return "Run";
+        case ACTIVITY_TRANSPORT: return "Transport";
+        default:                 return "Unknown";
+    }
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+#include "../imu/imu_sample.hpp"
+
+/**
+ * Windowed activity classifier (still / walk / run / transport).
+ * Accumulates |a| statistics incrementally over ~2 s windows and combines them
+ * with the pedometer cadence. Fixed memory, no allocation — call update() once per sample.
+ */
+class ActivityClassifier {
+public:
+    enum Activity : uint8_t {
+        ACTIVITY_UNKNOWN = 0,
+        ACTIVITY_STILL,
+        ACTIVITY_WALK,
+        ACTIVITY_RUN,
+        ACTIVITY_TRANSPORT
+    };
+
+private:
+    static constexpr float WINDOW_S = 2.0f;
+    static constexpr float STILL_STDDEV_G = 0.02f;    // Below: resting / on a table
+    static constexpr float MOVING_STDDEV_G = 0.25f;   // Above without steps: arm waving, not transport
+    static constexpr float RUN_CADENCE_SPM = 140.0f;
+    static constexpr float RUN_STDDEV_G = 0.60f;
+    static constexpr uint8_t CONFIRM_WINDOWS = 2;     // Same result required before switching
+
+    uint32_t window_samples;
+    uint32_t count = 0;
+    float sum = 0.0f;
+    float sum_sq = 0.0f;
+    uint16_t window_steps = 0;
+
+    Activity activity = ACTIVITY_UNKNOWN;
+    Activity candidate = ACTIVITY_UNKNOWN;
+    uint8_t candidate_windows = 0;
+    float last_stddev = 0.0f;
+
+    Activity classify(float stddev, float cadence_spm, uint16_t steps) const;
+
+public:
+    explicit ActivityClassifier(float sample_rate_hz = 112.1f);
+
+    // Feed one accelerometer sample as |a|² in raw counts² (magnitudeSquared()) with the
+    // pedometer state for this sample. Returns true when the reported activity changes.
+    bool update(uint32_t magnitude_sq, float cadence_spm, bool step);
+    void reset();
+
+    Activity getActivity() const { return activity; }
+    float getStdDev() const { return last_stddev; }
+    static const char* name(Activity activity);
+};
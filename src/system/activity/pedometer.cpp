@@ -0,0 +1,111 @@
+#include "pedometer.hpp"
+
+#include <math.h>
+
+Pedometer::Pedometer(float sample_rate_hz) : sample_rate_hz(sample_rate_hz) {
+    min_step_samples = (uint32_t)(MIN_STEP_S * sample_rate_hz);
+    max_step_samples = (uint32_t)(MAX_STEP_S * sample_rate_hz);
+
+    // RBJ band-pass, centre 2 Hz, Q 0.5 → passes roughly 0.8..4.8 Hz (slow walk to sprint)
+    const float f0 = 2.0f;
+    const float q = 0.5f;
+    float w0 = 2.0f * (float)M_PI * f0 / sample_rate_hz;
+    float alpha = sinf(w0) / (2.0f * q);
+    float a0 = 1.0f + alpha;
+    b0 = alpha / a0;
+    b2 = -alpha / a0;
+    a1 = -2.0f * cosf(w0) / a0;
+    a2 = (1.0f - alpha) / a0;
+}
+
+void Pedometer::reset() {
+    x1 = x2 = y1 = y2 = 0.0f;
+    signal = 0.0f;
+    rising = false;
+    peak_average = 0.0f;
+    threshold = MIN_THRESHOLD_G;
+    sample_index = 0;
+    last_step_index = 0;
+    have_last_step = false;
+    interval_average = 0.0f;
+    pending_steps = 0;
+    regular = false;
+    steps = 0;
+}
+
+bool Pedometer::update(uint32_t magnitude_sq) {
+    // Offset from 1g is fine — the band-pass removes DC anyway
+    float magnitude = magnitudeDeviationG(magnitude_sq);
+
+    // Band-pass (b1 = 0): removes gravity and high-frequency jitter
+    float y = b0 * magnitude + b2 * x2 - a1 * y1 - a2 * y2;
+    x2 = x1; x1 = magnitude;
+    y2 = y1; y1 = y;
+    sample_index++;
+
+    // Peak = previous sample, once the filtered signal stops rising
+    bool step = false;
+    if (rising && y < signal) {
+        step = acceptPeak(signal);
+    }
+    rising = y > signal;
+    signal = y;
+
+    // Adaptive threshold: half the typical peak, decaying (~9 s at 112 Hz) when peaks stop
+    peak_average *= 0.999f;
+    threshold = 0.5f * peak_average;
+    if (threshold < MIN_THRESHOLD_G) threshold = MIN_THRESHOLD_G;
+
+    // Stopped walking
+    if (have_last_step && sample_index - last_step_index > max_step_samples) {
+        regular = false;
+        pending_steps = 0;
+        have_last_step = false;
+    }
+
+    return step;
+}
+
+bool Pedometer::acceptPeak(float height) {
+    if (height < threshold) return false;
+
+    uint32_t peak_index = sample_index - 1;
+    uint32_t interval = peak_index - last_step_index;
+
+    // Bounce within one step — ignore
+    if (have_last_step && interval < min_step_samples) return false;
+
+    peak_average = (peak_average == 0.0f) ? height : 0.8f * peak_average + 0.2f * height;
+
+    bool in_rhythm = have_last_step && interval <= max_step_samples;
+    last_step_index = peak_index;
+    have_last_step = true;
+
+    if (!in_rhythm) {
+        // First step of a new sequence
+        pending_steps = 1;
+        regular = false;
+        return false;
+    }
+
+    interval_average = (interval_average == 0.0f) ? interval : 0.7f * interval_average + 0.3f * interval;
+
+    if (regular) {
+        steps++;
+        return true;
+    }
+
+    // Only credit steps once a regular sequence is established (rejects isolated bumps)
+    if (++pending_steps >= REGULATION_STEPS) {
+        regular = true;
+        steps += pending_steps;
+        pending_steps = 0;
+        return true;
+    }
+    return false;
+}
+
+float Pedometer::getCadence() const {
+    if (!regular || interval_average <= 0.0f) return 0.0f;
+    return 60.0f * sample_rate_hz / interval_average;
+}
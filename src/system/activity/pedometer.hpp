@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include "../imu/imu_sample.hpp"
+
+/**
+ * Streaming step counter for the accelerometer sample stream.
+ * Band-pass filters |a|² (linearised, no sqrt) around walking/running frequencies, detects peaks
+ * against an adaptive threshold and only counts once a regular cadence is seen.
+ * Fixed memory, no allocation — call update() once per sample.
+ */
+class Pedometer {
+private:
+    static constexpr float MIN_THRESHOLD_G = 0.05f;   // Floor for the adaptive peak threshold
+    static constexpr float MIN_STEP_S = 0.25f;        // Fastest cadence: 240 steps/min
+    static constexpr float MAX_STEP_S = 2.0f;         // Slowest cadence: 30 steps/min
+    static constexpr uint8_t REGULATION_STEPS = 4;    // Consecutive regular steps before counting
+
+    float sample_rate_hz;
+    uint32_t min_step_samples;
+    uint32_t max_step_samples;
+
+    // Band-pass biquad (RBJ, ~0.7..5 Hz) — coefficients normalised by a0
+    float b0 = 0.0f, b2 = 0.0f, a1 = 0.0f, a2 = 0.0f;
+    float x1 = 0.0f, x2 = 0.0f, y1 = 0.0f, y2 = 0.0f;
+
+    float signal = 0.0f;          // Last filtered sample
+    bool rising = false;
+    float peak_average = 0.0f;    // EMA of accepted peak heights
+    float threshold = MIN_THRESHOLD_G;
+
+    uint32_t sample_index = 0;
+    uint32_t last_step_index = 0;
+    bool have_last_step = false;
+    float interval_average = 0.0f;  // EMA of step interval in samples
+    uint8_t pending_steps = 0;      // Steps seen while not yet regular
+    bool regular = false;
+
+    uint32_t steps = 0;
+
+    bool acceptPeak(float height);
+
+public:
+    explicit Pedometer(float sample_rate_hz = 112.1f);
+
+    // Feed one accelerometer sample as |a|² in raw counts² (magnitudeSquared()).
+    // Returns true if this sample completed a counted step.
+    bool update(uint32_t magnitude_sq);
+    void reset();
+
+    uint32_t getSteps() const { return steps; }
+    float getCadence() const;               // Steps per minute, 0 when not walking
+    float getSignal() const { return signal; }
+    float getThreshold() const { return threshold; }
+    bool isWalking() const { return regular; }
+};
@@ -0,0 +1,150 @@
+#include "sleep_tracker.hpp"
+
+// Scored epochs not yet on flash. RTC slow memory keeps them across deep sleep
+// and soft resets, so a crash loses at most the in-progress epoch.
+// A short append leaves part of epochs[0] on flash: the retry resumes at that byte.
+struct PendingEpochs {
+    uint32_t magic;
+    uint16_t count;
+    uint8_t partial;
+    Actigraphy::Epoch epochs[SleepTracker::PENDING_CAPACITY];
+};
+RTC_DATA_ATTR static PendingEpochs pending;
+
+bool SleepTracker::start(const RTC::DateTime& now) {
+    if (!fs.isInitialized()) return false;
+
+    // Recovered tail from before a reset belongs to the previous log
+    if (pending.magic == MAGIC && pending.count > 0 && pending.count <= PENDING_CAPACITY &&
+        pending.partial < sizeof(Actigraphy::Epoch)) {
+        flush();
+    }
+    pending.magic = MAGIC;
+    pending.count = 0;
+    pending.partial = 0;
+
+    if (fs.exists(SLEEP_LOG_FILE)) {
+        fs.remove(SLEEP_LOG_PREV_FILE);
+        fs.rename(SLEEP_LOG_FILE, SLEEP_LOG_PREV_FILE);
+    }
+
+    FileHeader header;
+    header.magic = MAGIC;
+    header.version = 1;
+    header.epoch_s = Actigraphy::EPOCH_S;
+    header.year = now.year;
+    header.month = now.month;
+    header.day = now.day;
+    header.hour = now.hour;
+    header.minute = now.minute;
+    if (!fs.writeFile(SLEEP_LOG_FILE, (const uint8_t*)&header, sizeof(header))) return false;
+
+    actigraphy.reset();
+    flash_writes = 1;
+    bytes_written = sizeof(header);
+    drains = 0;
+    samples = 0;
+    lost_epochs = 0;
+    active = true;
+    if (logger) logger->info("SLEEP", "Sleep tracking started");
+    return true;
+}
+
+void SleepTracker::stop() {
+    if (!active) return;
+    if (armed) disarm();
+    flush();
+    active = false;
+    logSummary();
+}
+
+bool SleepTracker::arm() {
+    if (!active || armed) return armed;
+
+    // Minutes spent awake with the watch in use are gaps in the sample stream
+    if (disarm_time != 0) {
+        uint32_t gap = (millis() - disarm_time) / (Actigraphy::EPOCH_S * 1000);
+        for (uint32_t i = 0; i < gap; i++) {
+            actigraphy.addGapEpoch();
+            collectScored();
+        }
+        disarm_time = 0;
+    }
+
+    if (!imu.enableFifoBatching(FIFO_WATERMARK)) return false;
+    armed = true;
+    return true;
+}
+
+void SleepTracker::disarm() {
+    if (!armed) return;
+    service();  // Keep whatever the FIFO still holds
+    imu.disableFifoBatching();
+    armed = false;
+    disarm_time = millis();
+}
+
+void SleepTracker::service() {
+    if (!armed) return;
+
+    uint16_t got;
+    while ((got = imu.readFifo(fifo_buffer, FIFO_CHUNK)) > 0) {
+        samples += got;
+        for (uint16_t i = 0; i < got; i++) {
+            if (actigraphy.update(fifo_buffer[i])) collectScored();
+        }
+        if (got < FIFO_CHUNK) break;
+    }
+    drains++;
+
+    if (pending.count >= FLUSH_EPOCHS) flush();
+}
+
+void SleepTracker::collectScored() {
+    Actigraphy::Epoch epoch;
+    if (!actigraphy.popScored(epoch)) return;
+    // Flash keeps failing: the buffer stays full and the newest epoch goes
+    if (pending.count >= PENDING_CAPACITY && !flush()) {
+        lost_epochs++;
+        return;
+    }
+    pending.epochs[pending.count++] = epoch;
+}
+
+bool SleepTracker::flush() {
+    if (pending.count == 0) return true;
+    const uint8_t* data = (const uint8_t*)pending.epochs + pending.partial;
+    size_t len = pending.count * sizeof(Actigraphy::Epoch) - pending.partial;
+    size_t written = 0;
+    bool ok = fs.appendFile(SLEEP_LOG_FILE, data, len, &written);
+    if (written > 0) {
+        flash_writes++;
+        bytes_written += written;
+    }
+    if (ok) {
+        pending.count = 0;
+        pending.partial = 0;
+        return true;
+    }
+
+    // Keep only what did not reach the file, so the retry neither repeats nor skips bytes
+    size_t done = pending.partial + written;
+    uint16_t whole = done / sizeof(Actigraphy::Epoch);
+    pending.count -= whole;
+    pending.partial = done % sizeof(Actigraphy::Epoch);
+    memmove(pending.epochs, pending.epochs + whole, pending.count * sizeof(Actigraphy::Epoch));
+    if (logger) logger->failure("SLEEP", (String("Log append failed, ") + String(pending.count) + " epochs pending").c_str());
+    return false;
+}
+
+void SleepTracker::logSummary() {
+    if (!logger) return;
+    const Actigraphy& a = actigraphy;
+    logger->info("SLEEP", (String("Epochs: ") + String(a.getEpochs()) + ", now " + Actigraphy::stageName(a.getLastStage()) +
+                           ", sleep " + String(a.getSleepMinutes()) + "min, wake " + String(a.getWakeMinutes()) + "min").c_str());
+    logger->info("SLEEP", (String("Onset: ") + (a.hasOnset() ? String(a.getOnsetMinutes()) + "min" : String("-")) + ", WASO " +
+                           String(a.getWasoMinutes()) + "min, awakenings " + String(a.getAwakenings())).c_str());
+    logger->info("SLEEP", (String("Storage: ") + String(BYTES_PER_HOUR) + " B/hour, " + String(bytes_written) + " B in " + String(flash_writes) +
+                           " flash writes, " + String(drains) + " FIFO drains, " + String(samples) + " samples, " +
+                           String(lost_epochs) + " epochs lost").c_str());
+}
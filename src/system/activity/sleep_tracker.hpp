@@ -0,0 +1,85 @@
+#pragma once
+#include <Arduino.h>
+#include "../../logger/logger.hpp"
+#include "../imu/imu.hpp"
+#include "../rtc/rtc.hpp"
+#include "../storage/fs_manager.hpp"
+#include "actigraphy.hpp"
+
+#define SLEEP_LOG_FILE          "/sleep.bin"
+#define SLEEP_LOG_PREV_FILE     "/sleep_prev.bin"
+
+/**
+ * Overnight sleep tracking.
+ * The IMU batches 21Hz low-power accel samples in its FIFO and wakes the CPU
+ * only at the watermark. Each drain feeds Actigraphy; scored epochs wait in
+ * RTC slow memory and are appended to LittleFS every FLUSH_EPOCHS minutes.
+ *
+ * Log file: FileHeader followed by one Actigraphy::Epoch (4 bytes) per minute.
+ * The previous night is kept as SLEEP_LOG_PREV_FILE.
+ */
+class SleepTracker {
+public:
+    struct FileHeader {
+        uint32_t magic;
+        uint8_t version;
+        uint8_t epoch_s;
+        uint16_t year;
+        uint8_t month;
+        uint8_t day;
+        uint8_t hour;
+        uint8_t minute;
+    };
+
+    static constexpr uint32_t MAGIC = 0x31504C53;  // "SLP1"
+    static constexpr uint8_t FIFO_WATERMARK = 96;  // ~4.6s of samples per CPU wake
+    static constexpr uint8_t FLUSH_EPOCHS = 10;    // At most one flash write per 10 minutes
+    static constexpr uint8_t PENDING_CAPACITY = 32;
+    static constexpr uint32_t BYTES_PER_HOUR = 3600 / Actigraphy::EPOCH_S * sizeof(Actigraphy::Epoch);
+
+private:
+    static constexpr uint8_t FIFO_CHUNK = 32;
+
+    Logger* logger = nullptr;
+    IMU& imu;
+    FSManager& fs;
+    Actigraphy actigraphy;
+
+    bool active = false;
+    bool armed = false;
+    unsigned long disarm_time = 0;
+    ImuSample fifo_buffer[FIFO_CHUNK];
+
+    uint32_t flash_writes = 0;
+    uint32_t bytes_written = 0;
+    uint32_t drains = 0;
+    uint32_t samples = 0;
+    uint32_t lost_epochs = 0;    // Scored with the buffer full and flash failing
+
+    void collectScored();
+    bool flush();
+
+public:
+    SleepTracker(Logger* logger, IMU& imu, FSManager& fs) : logger(logger), imu(imu), fs(fs), actigraphy(ImuRatePolicy::LOW_HZ) {}
+
+    // New night: rotates the log, writes the header, resets scoring
+    bool start(const RTC::DateTime& now);
+    void stop();  // Flushes and logs the night summary
+    bool isActive() const { return active; }
+
+    // IMU into FIFO batching before light sleep / back to normal on a user wake.
+    // Time spent disarmed is recorded as wake epochs.
+    bool arm();
+    void disarm();
+    bool isArmed() const { return armed; }
+
+    // Drain the FIFO, score closed epochs, flush when due — call on every watermark wake
+    void service();
+
+    const Actigraphy& getActigraphy() const { return actigraphy; }
+    uint32_t getFlashWrites() const { return flash_writes; }
+    uint32_t getBytesWritten() const { return bytes_written; }
+    uint32_t getDrains() const { return drains; }
+    uint32_t getLostEpochs() const { return lost_epochs; }
+    void logSummary();
+};
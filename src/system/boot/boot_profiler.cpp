@@ -0,0 +1,119 @@
+#include "boot_profiler.hpp"
+
+#ifdef BOOT_PROFILE
+#include "esp_timer.h"
+#include "../i2c/i2c_bus.hpp"
+
+BootProfiler::Entry BootProfiler::entries[BootProfiler::MAX_ENTRIES];
+uint8_t BootProfiler::count = 0;
+int8_t BootProfiler::stack[BootProfiler::MAX_DEPTH];
+uint8_t BootProfiler::depth = 0;
+I2CBus* BootProfiler::bus = nullptr;
+uint32_t BootProfiler::done_us = 0;
+TaskHandle_t BootProfiler::owner = nullptr;
+volatile uint32_t BootProfiler::delay_total_us = 0;
+
+// Linked in place of delay() with -Wl,--wrap=delay
+extern "C" void __real_delay(uint32_t ms);
+extern "C" void __wrap_delay(uint32_t ms) {
+    uint32_t start = (uint32_t)esp_timer_get_time();
+    __real_delay(ms);
+    if (!BootProfiler::isDone()) BootProfiler::delay_total_us += (uint32_t)esp_timer_get_time() - start;
+}
+
+uint32_t BootProfiler::i2cBusyUs() {
+    return bus ? bus->getTotalBusyUs() : 0;
+}
+
+void BootProfiler::stage(const char* name) {
+    if (!owner) owner = xTaskGetCurrentTaskHandle();
+    if (xTaskGetCurrentTaskHandle() != owner) return;
+    while (depth > 0) close(stack[depth - 1]);
+    open(name);
+}
+
+int8_t BootProfiler::open(const char* name) {
+    if (done_us != 0 || count >= MAX_ENTRIES || depth >= MAX_DEPTH) return -1;
+    if (xTaskGetCurrentTaskHandle() != owner) return -1;
+
+    Entry& e = entries[count];
+    e.name = name;
+    e.depth = depth;
+    e.start_us = (uint32_t)esp_timer_get_time();
+    // Running totals at open — close() turns them into deltas
+    e.duration_us = 0;
+    e.delay_us = delay_total_us;
+    e.i2c_us = i2cBusyUs();
+    stack[depth++] = count;
+    return count++;
+}
+
+void BootProfiler::close(int8_t index) {
+    if (index < 0 || depth == 0 || xTaskGetCurrentTaskHandle() != owner) return;
+
+    // Close anything opened inside this entry that is still open
+    while (depth > 0) {
+        int8_t top = stack[--depth];
+        Entry& e = entries[top];
+        e.duration_us = (uint32_t)esp_timer_get_time() - e.start_us;
+        e.delay_us = delay_total_us - e.delay_us;
+        e.i2c_us = i2cBusyUs() - e.i2c_us;
+        if (top == index) break;
+    }
+}
+
+void BootProfiler::done(Logger* logger) {
+    if (done_us != 0 || xTaskGetCurrentTaskHandle() != owner) return;
+    while (depth > 0) close(stack[depth - 1]);
+    done_us = (uint32_t)esp_timer_get_time();
+    log(logger);
+}
+
+void BootProfiler::log(Logger* logger) {
+    if (!logger || count == 0) return;
+
+    // Top-level stages by duration, each followed by its sub-steps in order
+    uint8_t order[MAX_ENTRIES];
+    uint8_t stages = 0;
+    uint32_t staged_us = 0, delay_us = 0, i2c_us = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].depth != 0) continue;
+        order[stages++] = i;
+        staged_us += entries[i].duration_us;
+        delay_us += entries[i].delay_us;
+        i2c_us += entries[i].i2c_us;
+    }
+    for (uint8_t i = 1; i < stages; i++) {
+        uint8_t v = order[i];
+        int8_t j = i - 1;
+        while (j >= 0 && entries[order[j]].duration_us < entries[v].duration_us) {
+            order[j + 1] = order[j];
+            j--;
+        }
+        order[j + 1] = v;
+    }
+
+    uint32_t total = done_us ? done_us : (uint32_t)esp_timer_get_time();
+    logger->header("BOOT PROFILE");
+    logger->info("BOOT", (String("App start to setup done: ") + String(total / 1000.0f, 1) + "ms, stages " + String(staged_us / 1000.0f, 1) +
+                          "ms (" + String(delay_us / 1000.0f, 1) + "ms in delay, " + String(i2c_us / 1000.0f, 1) + "ms on I2C)").c_str());
+
+    for (uint8_t s = 0; s < stages; s++) {
+        uint8_t i = order[s];
+        uint8_t end = i + 1;
+        while (end < count && entries[end].depth > 0) end++;
+
+        for (uint8_t k = i; k < end; k++) {
+            const Entry& e = entries[k];
+            String line;
+            for (uint8_t d = 0; d < e.depth; d++) line += "  ";
+            line += String(e.name) + ": " + String(e.duration_us / 1000.0f, 1) + "ms";
+            if (e.depth == 0 && staged_us > 0) line += " (" + String(e.duration_us * 100.0f / staged_us, 1) + "%)";
+            line += ", delay " + String(e.delay_us / 1000.0f, 1) + "ms, I2C " + String(e.i2c_us / 1000.0f, 1) + "ms";
+            logger->info("BOOT", line.c_str());
+        }
+    }
+    logger->footer();
+}
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+#include <Arduino.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../../logger/logger.hpp"
+
+class I2CBus;
+
+/**
+ * Boot-time profiler — compiled in only with -DBOOT_PROFILE.
+ *
+ *   BOOT_STAGE("IMU");        // Ends the previous top-level stage, starts this one
+ *   { BOOT_STEP("NTP"); ... } // Nested sub-step, ends at scope exit
+ *   BOOT_DONE(logger);        // Ends the last stage and logs the sorted breakdown
+ *
+ * Only the task that opened the first stage records; markers hit on other
+ * tasks (init graph helper, I2C worker) are ignored.
+ * Each entry records wall time, time spent in delay() and time the shared I2C
+ * bus was busy. delay() is only attributed when linked with -Wl,--wrap=delay
+ * (see the boot_profile environment in platformio.ini).
+ * Without BOOT_PROFILE the macros expand to nothing.
+ */
+#ifdef BOOT_PROFILE
+
+class BootProfiler {
+public:
+    static constexpr uint8_t MAX_ENTRIES = 40;
+    static constexpr uint8_t MAX_DEPTH = 4;
+
+    struct Entry {
+        const char* name;
+        uint8_t depth;
+        uint32_t start_us;       // Since app start
+        uint32_t duration_us;
+        uint32_t delay_us;
+        uint32_t i2c_us;
+    };
+
+    class Step {
+    private:
+        int8_t index;
+    public:
+        Step(const char* name) : index(BootProfiler::open(name)) {}
+        ~Step() { BootProfiler::close(index); }
+    };
+
+private:
+    static Entry entries[MAX_ENTRIES];
+    static uint8_t count;
+    static int8_t stack[MAX_DEPTH];
+    static uint8_t depth;
+    static I2CBus* bus;
+    static uint32_t done_us;
+    static TaskHandle_t owner;
+
+    static uint32_t i2cBusyUs();
+
+public:
+    static volatile uint32_t delay_total_us;  // Accumulated by the delay() wrapper
+
+    static void attachBus(I2CBus& bus) { BootProfiler::bus = &bus; }
+
+    static void stage(const char* name);
+    static int8_t open(const char* name);
+    static void close(int8_t index);
+    static void done(Logger* logger);
+
+    // Kept after boot for inspection at runtime
+    static bool isDone() { return done_us != 0; }
+    static uint32_t getTotalUs() { return done_us; }
+    static uint8_t getCount() { return count; }
+    static const Entry& getEntry(uint8_t i) { return entries[i]; }
+    static void log(Logger* logger);
+};
+
+#define BOOT_CONCAT_(a, b) a##b
+#define BOOT_CONCAT(a, b) BOOT_CONCAT_(a, b)
+#define BOOT_STAGE(name) BootProfiler::stage(name)
+#define BOOT_STEP(name) BootProfiler::Step BOOT_CONCAT(boot_step_, __LINE__)(name)
+#define BOOT_DONE(logger) BootProfiler::done(logger)
+
+#else
+
+#define BOOT_STAGE(name) do {} while (0)
+#define BOOT_STEP(name) do {} while (0)
+#define BOOT_DONE(logger) do {} while (0)
+
+#endif
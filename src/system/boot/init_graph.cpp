@@ -0,0 +1,271 @@
+#include "init_graph.hpp"
+
+int8_t InitGraph::add(const char* name, InitFn fn, void* ctx, std::initializer_list<int8_t> deps, uint8_t resources, bool required) {
+    if (count >= MAX_NODES) {
+        if (logger) logger->error("INIT", (String("Graph full, dropping ") + name).c_str());
+        return -1;
+    }
+
+    Node& node = nodes[count];
+    node.name = name;
+    node.fn = fn;
+    node.ctx = ctx;
+    node.deps = 0;
+    for (int8_t dep : deps) {
+        // Only earlier nodes — keeps the graph acyclic and declaration order runnable
+        if (dep >= 0 && dep < count) node.deps |= 1UL << dep;
+    }
+    node.resources = resources;
+    node.required = required;
+    node.model_ms = 0;
+    node.model_bus_ms = 0;
+    node.state = PENDING;
+    node.core = 0;
+    node.start_us = 0;
+    node.end_us = 0;
+    return count++;
+}
+
+void InitGraph::setModel(int8_t index, uint16_t ms, uint16_t bus_ms) {
+    if (index < 0 || index >= count) return;
+    nodes[index].model_ms = ms;
+    nodes[index].model_bus_ms = bus_ms < ms ? bus_ms : ms;
+}
+
+void InitGraph::reset() {
+    for (uint8_t i = 0; i < count; i++) {
+        nodes[i].state = PENDING;
+        nodes[i].start_us = 0;
+        nodes[i].end_us = 0;
+    }
+    running = 0;
+    finished = 0;
+    busy_resources = 0;
+    wall_us = 0;
+}
+
+void InitGraph::computeRanks() {
+    // Nodes only depend on earlier ones, so one reverse pass sees every successor first
+    for (int8_t i = count - 1; i >= 0; i--) {
+        uint32_t longest = 0;
+        for (uint8_t j = i + 1; j < count; j++) {
+            if ((nodes[j].deps & (1UL << i)) && rank_ms[j] > longest) longest = rank_ms[j];
+        }
+        rank_ms[i] = nodes[i].model_ms + longest;
+    }
+}
+
+bool InitGraph::run(Mode mode, uint8_t workers) {
+    if (count == 0) return true;
+    if (!mutex) mutex = xSemaphoreCreateMutex();
+    if (!helper_done) helper_done = xSemaphoreCreateBinary();
+    if (mode == SIMULATE && !sim_bus) sim_bus = xSemaphoreCreateMutex();
+    if (!mutex || !helper_done || (mode == SIMULATE && !sim_bus)) {
+        if (logger) logger->failure("INIT", "Failed to create graph semaphores");
+        return false;
+    }
+
+    reset();
+    computeRanks();
+    this->mode = mode;
+    worker_count = workers > 1 ? 2 : 1;
+    this->workers[0] = xTaskGetCurrentTaskHandle();
+    this->workers[1] = nullptr;
+    start_us = micros();
+
+    if (worker_count > 1) {
+        BaseType_t other = xPortGetCoreID() ^ 1;
+        if (xTaskCreatePinnedToCore(helperEntry, "init_graph", WORKER_STACK, this, 1, &this->workers[1], other) != pdPASS) {
+            if (logger) logger->warn("INIT", "No helper task, initializing on one core");
+            this->workers[1] = nullptr;
+            worker_count = 1;
+        }
+    }
+
+    work(0);
+    if (worker_count > 1) xSemaphoreTake(helper_done, portMAX_DELAY);
+    wall_us = micros() - start_us;
+
+    for (uint8_t i = 0; i < count; i++) {
+        if (nodes[i].required && nodes[i].state != DONE) return false;
+    }
+    return true;
+}
+
+void InitGraph::helperEntry(void* arg) {
+    InitGraph* graph = static_cast<InitGraph*>(arg);
+    graph->work(1);
+    xSemaphoreGive(graph->helper_done);
+    vTaskDelete(nullptr);
+}
+
+void InitGraph::work(uint8_t worker) {
+    while (true) {
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        int8_t index = claimNext();
+        if (index < 0 && running == 0 && finished < count) {
+            // Nothing runnable and nothing in flight: skip what's left rather than hang
+            for (uint8_t i = 0; i < count; i++) {
+                if (nodes[i].state == PENDING) nodes[i].state = SKIPPED;
+            }
+            finished = count;
+        }
+        bool all_done = finished >= count;
+        if (all_done || index >= 0) {
+            // Let the other worker look for work too. Notify under the mutex:
+            // it can't exit (and be deleted) until we release it.
+            for (uint8_t w = 0; w < worker_count; w++) {
+                if (w != worker && workers[w]) xTaskNotifyGive(workers[w]);
+            }
+        }
+        xSemaphoreGive(mutex);
+
+        if (all_done) return;
+        if (index < 0) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        Node& node = nodes[index];
+        node.core = xPortGetCoreID();
+        node.start_us = micros() - start_us;
+        bool ok = execute(node);
+        node.end_us = micros() - start_us;
+
+        xSemaphoreTake(mutex, portMAX_DELAY);
+        finish(index, ok);
+        for (uint8_t w = 0; w < worker_count; w++) {
+            if (w != worker && workers[w]) xTaskNotifyGive(workers[w]);
+        }
+        xSemaphoreGive(mutex);
+    }
+}
+
+// Under the mutex. Skips nodes whose dependencies failed, then claims the ready node
+// with the longest estimated path to the end (declaration order with one worker).
+int8_t InitGraph::claimNext() {
+    int8_t best = -1;
+    for (uint8_t i = 0; i < count; i++) {
+        Node& node = nodes[i];
+        if (node.state != PENDING) continue;
+
+        bool ready = true;
+        bool blocked = false;
+        for (uint8_t d = 0; d < i; d++) {
+            if (!(node.deps & (1UL << d))) continue;
+            State s = nodes[d].state;
+            if (s == FAILED || s == SKIPPED) blocked = true;
+            else if (s != DONE) ready = false;
+        }
+        if (blocked) {
+            // Earlier nodes are settled first, so a skip cascades within this pass
+            node.state = SKIPPED;
+            finished++;
+            if (logger) logger->warn("INIT", (String("Skipping ") + node.name + " (dependency failed)").c_str());
+            continue;
+        }
+        if (!ready || (node.resources & busy_resources)) continue;
+
+        if (best < 0) {
+            best = i;
+            if (worker_count == 1) break;
+        } else if (rank_ms[i] > rank_ms[best]) {
+            best = i;
+        }
+    }
+
+    if (best >= 0) {
+        nodes[best].state = RUNNING;
+        busy_resources |= nodes[best].resources;
+        running++;
+    }
+    return best;
+}
+
+void InitGraph::finish(int8_t index, bool ok) {
+    Node& node = nodes[index];
+    node.state = ok ? DONE : FAILED;
+    busy_resources &= ~node.resources;
+    running--;
+    finished++;
+}
+
+bool InitGraph::execute(Node& node) {
+    if (mode == REAL) return node.fn ? node.fn(node.ctx) : true;
+
+    // Modelled: the bus share serialises across workers, the rest overlaps
+    if (node.model_bus_ms > 0) {
+        xSemaphoreTake(sim_bus, portMAX_DELAY);
+        vTaskDelay(pdMS_TO_TICKS(node.model_bus_ms));
+        xSemaphoreGive(sim_bus);
+    }
+    if (node.model_ms > node.model_bus_ms) vTaskDelay(pdMS_TO_TICKS(node.model_ms - node.model_bus_ms));
+    return true;
+}
+
+uint32_t InitGraph::getSerialUs() const {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        if (nodes[i].state == DONE || nodes[i].state == FAILED) total += nodes[i].end_us - nodes[i].start_us;
+    }
+    return total;
+}
+
+uint32_t InitGraph::criticalPath(uint8_t* path, uint8_t& length) const {
+    uint32_t chain_us[MAX_NODES];
+    int8_t previous[MAX_NODES];
+    int8_t last = -1;
+
+    for (uint8_t i = 0; i < count; i++) {
+        const Node& node = nodes[i];
+        bool ran = node.state == DONE || node.state == FAILED;
+        chain_us[i] = ran ? node.end_us - node.start_us : 0;
+        previous[i] = -1;
+
+        uint32_t longest = 0;
+        for (uint8_t d = 0; d < i; d++) {
+            if ((node.deps & (1UL << d)) && chain_us[d] > longest) {
+                longest = chain_us[d];
+                previous[i] = d;
+            }
+        }
+        chain_us[i] += longest;
+        if (last < 0 || chain_us[i] > chain_us[last]) last = i;
+    }
+
+    length = 0;
+    if (last < 0) return 0;
+    for (int8_t i = last; i >= 0; i = previous[i]) path[length++] = i;
+    return chain_us[last];
+}
+
+void InitGraph::log(const char* title) {
+    if (!logger) return;
+    static const char* const STATE_NAMES[] = {"pending", "running", "ok", "FAILED", "skipped"};
+
+    logger->header(title);
+    for (uint8_t i = 0; i < count; i++) {
+        const Node& node = nodes[i];
+        String line = String(node.name) + ": " + STATE_NAMES[node.state];
+        if (node.state == DONE || node.state == FAILED) {
+            line += ", " + String((node.end_us - node.start_us) / 1000.0f, 1) + "ms at " + String(node.start_us / 1000.0f, 1) +
+                    "ms on core " + String(node.core);
+        }
+        logger->info("INIT", line.c_str());
+    }
+
+    uint32_t serial_us = getSerialUs();
+    logger->info("INIT", (String("Wall ") + String(wall_us / 1000.0f, 1) + "ms for " + String(serial_us / 1000.0f, 1) +
+                          "ms of init work on " + String(worker_count) + (worker_count > 1 ? " cores" : " core")).c_str());
+
+    uint8_t path[MAX_NODES];
+    uint8_t length = 0;
+    uint32_t critical_us = criticalPath(path, length);
+    String line = String("Critical path ") + String(critical_us / 1000.0f, 1) + "ms: ";
+    for (int8_t i = length - 1; i >= 0; i--) {
+        line += nodes[path[i]].name;
+        if (i > 0) line += " -> ";
+    }
+    logger->info("INIT", line.c_str());
+    logger->footer();
+}
@@ -0,0 +1,115 @@
+#pragma once
+#include <Arduino.h>
+#include <initializer_list>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "../../logger/logger.hpp"
+
+/**
+ * Peripheral bring-up as a dependency graph.
+ *
+ * Each node names the nodes it needs (PMU rails, a shared I2S port, ...) and the
+ * hardware it must own exclusively while it runs. run() executes the graph on two
+ * workers — the calling task and a helper pinned to the other core — always
+ * picking the ready node with the longest estimated remaining path. I2C access
+ * needs no declaration: every driver already serialises through the bus lock,
+ * so only the delays and non-I2C work overlap.
+ *
+ * A failed node skips everything that depends on it; run() returns false if a
+ * required node failed or was skipped. log() prints per-node timing and the
+ * measured critical path.
+ *
+ * SIMULATE replaces every init function with its modelled time (holding a
+ * stand-in bus lock for the modelled I2C share) so a schedule can be compared
+ * against a sequential run without touching the hardware (test/test_init_graph).
+ */
+class InitGraph {
+public:
+    static constexpr uint8_t MAX_NODES = 24;
+    static constexpr uint32_t WORKER_STACK = 8192;   // WiFi, SD mount and display init run here
+
+    typedef bool (*InitFn)(void* ctx);
+
+    // Peripherals a node must own exclusively while running (display QSPI and SD HSPI are separate hosts)
+    enum Resource : uint8_t {
+        RES_NONE = 0,
+        RES_I2S  = 1 << 0,   // Speaker and mic share I2S port 0
+    };
+
+    enum Mode : uint8_t {
+        REAL = 0,
+        SIMULATE
+    };
+
+    enum State : uint8_t {
+        PENDING = 0,
+        RUNNING,
+        DONE,
+        FAILED,
+        SKIPPED
+    };
+
+    struct Node {
+        const char* name;
+        InitFn fn;
+        void* ctx;
+        uint32_t deps;            // Bitmask of node indices
+        uint8_t resources;
+        bool required;
+        uint16_t model_ms;        // Estimated duration — scheduling priority and SIMULATE
+        uint16_t model_bus_ms;    // Share of model_ms spent holding the I2C bus
+        State state;
+        uint8_t core;             // Core it ran on
+        uint32_t start_us;        // Relative to run() start
+        uint32_t end_us;
+    };
+
+private:
+    Logger* logger = nullptr;
+    Node nodes[MAX_NODES];
+    uint8_t count = 0;
+    uint32_t rank_ms[MAX_NODES];     // Estimated longest path from a node to the end
+
+    // Shared between the workers while run() is active
+    SemaphoreHandle_t mutex = nullptr;
+    SemaphoreHandle_t helper_done = nullptr;
+    SemaphoreHandle_t sim_bus = nullptr;
+    TaskHandle_t workers[2] = {nullptr, nullptr};
+    uint8_t running = 0;
+    uint8_t finished = 0;
+    uint8_t busy_resources = 0;
+    uint8_t worker_count = 0;
+    Mode mode = REAL;
+    uint32_t start_us = 0;
+    uint32_t wall_us = 0;
+
+    static void helperEntry(void* arg);
+    void work(uint8_t worker);
+    int8_t claimNext();
+    void finish(int8_t index, bool ok);
+    void computeRanks();
+    bool execute(Node& node);
+
+public:
+    InitGraph(Logger* logger) : logger(logger) {}
+
+    // Dependencies must already be added, so declaration order is a valid sequential order.
+    // Returns the node index, or -1 if the graph is full.
+    int8_t add(const char* name, InitFn fn, void* ctx, std::initializer_list<int8_t> deps = {},
+               uint8_t resources = RES_NONE, bool required = true);
+    void setModel(int8_t index, uint16_t ms, uint16_t bus_ms = 0);
+
+    // workers = 1 runs the nodes one at a time in declaration order
+    bool run(Mode mode = REAL, uint8_t workers = 2);
+    void reset();
+
+    uint8_t getCount() const { return count; }
+    const Node& getNode(uint8_t index) const { return nodes[index]; }
+    uint32_t getWallUs() const { return wall_us; }
+    uint32_t getSerialUs() const;       // Sum of node durations
+    // Longest dependency chain by measured duration, written end-first into path
+    uint32_t criticalPath(uint8_t* path, uint8_t& length) const;
+    void log(const char* title);
+};
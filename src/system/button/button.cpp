@@ -0,0 +1,108 @@
+#include "button.hpp"
+
+namespace {
+
+// Time left until deadline, 0 once it has passed
+uint32_t remaining(uint32_t deadline, uint32_t now) {
+    int32_t left = (int32_t)(deadline - now);
+    return left > 0 ? (uint32_t)left : 0;
+}
+
+}  // namespace
+
+bool Button::begin() {
+    pinMode(pin, active_low ? INPUT_PULLUP : INPUT_PULLDOWN);
+
+    // Held at boot: take it as the resting level rather than a press
+    raw = stable = digitalRead(pin) == (active_low ? LOW : HIGH);
+    raw_since = millis();
+
+    attachInterruptArg(digitalPinToInterrupt(pin), Button::isrArg, this, CHANGE);
+    if (logger) logger->success("BUTTON", (String("Button on GPIO") + String(pin) + " ready").c_str());
+    return true;
+}
+
+void IRAM_ATTR Button::isrArg(void* arg) {
+    Button* self = static_cast<Button*>(arg);
+    if (self) {
+        self->edges++;
+        if (self->irq_hook) self->irq_hook(self->irq_hook_ctx);
+    }
+}
+
+void Button::emit(EventType type, uint32_t time_ms, uint32_t held_ms) {
+    if (!callback) return;
+    Event event = {type, time_ms, held_ms};
+    callback(event, callback_ctx);
+}
+
+uint32_t Button::service(uint32_t now) {
+    return update(now, digitalRead(pin) == (active_low ? LOW : HIGH));
+}
+
+void Button::swallowPress(uint32_t now) {
+    swallow = true;
+    swallow_time = now;
+}
+
+uint32_t Button::update(uint32_t now, bool pressed) {
+    // The waking press was over before we looked (or never stuck) — don't eat the next one
+    if (swallow && !stable && !raw && now - swallow_time > DEBOUNCE_MS) swallow = false;
+
+    if (pressed != raw) {
+        raw = pressed;
+        raw_since = now;
+    }
+
+    // Gesture deadlines are judged at the last edge, so a late call still sees the real timing.
+    // Both run before the debounce below so events come out in edge order.
+    uint32_t held_until = raw ? now : raw_since;
+    if (stable && !long_fired && !swallow && held_until - press_time >= LONG_PRESS_MS) {
+        long_fired = true;
+        clicks = 0;
+        emit(LONG_PRESS, press_time + LONG_PRESS_MS, LONG_PRESS_MS);
+    }
+
+    uint32_t quiet_until = raw ? raw_since : now;
+    if (clicks == 1 && !stable && quiet_until - release_time >= MULTI_CLICK_MS) {
+        clicks = 0;
+        emit(CLICK, release_time);
+    }
+
+    // Debounce: a level counts once it has held, stamped with the edge that started it
+    if (raw != stable && now - raw_since >= DEBOUNCE_MS) {
+        stable = raw;
+        if (stable) {
+            press_time = raw_since;
+            long_fired = false;
+            emit(PRESS, press_time);
+        } else {
+            release_time = raw_since;
+            emit(RELEASE, release_time, release_time - press_time);
+            if (swallow || long_fired) {
+                swallow = false;
+                clicks = 0;
+            } else if (++clicks >= 2) {
+                clicks = 0;
+                emit(DOUBLE_CLICK, release_time);
+            }
+        }
+    }
+
+    uint32_t wait = NO_DEADLINE;
+    if (raw != stable) wait = min(wait, remaining(raw_since + DEBOUNCE_MS, now));
+    if (stable && raw && !long_fired && !swallow) wait = min(wait, remaining(press_time + LONG_PRESS_MS, now));
+    if (clicks == 1 && !stable && !raw) wait = min(wait, remaining(release_time + MULTI_CLICK_MS, now));
+    return wait;
+}
+
+const char* Button::eventName(EventType type) {
+    switch (type) {
+        case PRESS:        return "press";
+        case RELEASE:      return "release";
+        case CLICK:        return "click";
+        case DOUBLE_CLICK: return "double click";
+        case LONG_PRESS:   return "long press";
+    }
+    return "?";
+}
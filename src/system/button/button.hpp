@@ -1,16 +1,90 @@
 #pragma once
 #include <Arduino.h>
+#include "../../logger/logger.hpp"
 
-// Simple button function with debounce
-inline bool buttonPressed(uint8_t pin) {
-    static unsigned long lastPress[40] = {0};
-    static bool lastState[40] = {HIGH};
-    bool currentState = digitalRead(pin);
-    if (currentState == LOW && lastState[pin] == HIGH && (millis() - lastPress[pin]) > 100) {
-        lastPress[pin] = millis();
-        lastState[pin] = currentState;
-        return true;
-    }
-    lastState[pin] = currentState;
-    return false;
-}
\ No newline at end of file
+/**
+ * Interrupt-driven push button.
+ *
+ * The pin ISR only counts the edge and calls the IRQ hook (e.g. to wake the
+ * main loop). service() then reads the level and runs a debounce and gesture
+ * state machine. It returns how long until it needs to run again: at the end
+ * of the debounce window, the long-press threshold or the multi-click gap.
+ * Nothing in here waits.
+ *
+ *   PRESS ─┬─ RELEASE ── (gap) ── CLICK
+ *          │      └── PRESS ── RELEASE ── DOUBLE_CLICK
+ *          └─ LONG_PRESS (still held) ── RELEASE
+ *
+ * A level counts once it has held for DEBOUNCE_MS. Events are stamped with
+ * the edge that stuck, not the time they were recognised.
+ */
+class Button {
+public:
+    static constexpr uint32_t DEBOUNCE_MS = 25;
+    static constexpr uint32_t LONG_PRESS_MS = 1000;
+    static constexpr uint32_t MULTI_CLICK_MS = 300;    // Max release-to-press gap within a double click
+    static constexpr uint32_t NO_DEADLINE = 0xFFFFFFFF;
+
+    enum EventType : uint8_t {
+        PRESS = 0,
+        RELEASE,
+        CLICK,
+        DOUBLE_CLICK,
+        LONG_PRESS
+    };
+
+    struct Event {
+        EventType type;
+        uint32_t time_ms;        // millis() of the edge (CLICK: its release)
+        uint32_t held_ms;        // RELEASE and LONG_PRESS: how long it was down
+    };
+
+    typedef void (*EventCallback)(const Event& event, void* ctx);
+    typedef void (*IrqHook)(void* ctx);   // Must be IRAM-safe
+
+private:
+    Logger* logger = nullptr;
+    uint8_t pin;
+    bool active_low;
+    volatile uint32_t edges = 0;
+    IrqHook irq_hook = nullptr;
+    void* irq_hook_ctx = nullptr;
+    EventCallback callback = nullptr;
+    void* callback_ctx = nullptr;
+
+    // Debounce
+    bool raw = false;            // Last level seen
+    uint32_t raw_since = 0;
+    bool stable = false;         // Debounced level
+
+    // Gestures
+    uint32_t press_time = 0;
+    uint32_t release_time = 0;
+    uint8_t clicks = 0;          // Releases in the current click sequence
+    bool long_fired = false;
+    bool swallow = false;        // This press woke the system — no click or long press
+    uint32_t swallow_time = 0;
+
+    static void IRAM_ATTR isrArg(void* arg);
+    void emit(EventType type, uint32_t time_ms, uint32_t held_ms = 0);
+
+public:
+    Button(Logger* logger, uint8_t pin, bool active_low = true) : logger(logger), pin(pin), active_low(active_low) {}
+
+    bool begin();
+    void setIrqHook(IrqHook hook, void* ctx) { irq_hook_ctx = ctx; irq_hook = hook; }
+    void replayIrq() { isrArg(this); }   // An edge missed while the pin was a sleep wake source
+    void setCallback(EventCallback callback, void* ctx) { this->callback = callback; callback_ctx = ctx; }
+
+    // Reads the pin and advances. Returns ms until it must run again, NO_DEADLINE = next edge only.
+    uint32_t service(uint32_t now);
+    // The state machine on its own — service() without the pin
+    uint32_t update(uint32_t now, bool pressed);
+
+    // Call when a press woke the system: it still reports PRESS/RELEASE, nothing else
+    void swallowPress(uint32_t now);
+
+    bool isPressed() const { return stable; }
+    uint32_t getEdgeCount() const { return edges; }
+    static const char* eventName(EventType type);
+};
@@ -0,0 +1,254 @@
+#include "i2c_bus.hpp"
+
+bool I2CBus::begin(int sda, int scl, uint32_t hz) {
+    if (!mutex) mutex = xSemaphoreCreateRecursiveMutex();
+    if (!mutex) {
+        if (logger) logger->failure("I2C", "Failed to create bus mutex");
+        return false;
+    }
+
+    default_hz = hz;
+    current_hz = hz;
+    if (!wire.begin(sda, scl, hz)) {
+        if (logger) logger->failure("I2C", "Failed to start bus");
+        return false;
+    }
+    initialized = true;
+    return true;
+}
+
+void I2CBus::scan() {
+    if (!logger) return;
+    Lock lock(*this);
+    for (uint8_t addr = 1; addr < 127; ++addr) {
+        wire.beginTransmission(addr);
+        if (wire.endTransmission() == 0) {
+            char buf[32];
+            snprintf(buf, sizeof(buf), "Found device at 0x%02X", addr);
+            logger->debug("I2C", buf);
+        }
+    }
+}
+
+void I2CBus::lock(uint32_t hz) {
+    if (mutex) xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+    if (lock_depth++ == 0) lock_start_us = micros();
+
+    if (hz == 0) hz = default_hz;
+    if (hz != current_hz) {
+        wire.setClock(hz);
+        current_hz = hz;
+    }
+}
+
+void I2CBus::unlock() {
+    if (lock_depth > 0 && --lock_depth == 0) total_busy_us += micros() - lock_start_us;
+    if (mutex) xSemaphoreGiveRecursive(mutex);
+}
+
+bool I2CBus::write(uint8_t addr, uint8_t reg, const uint8_t* data, size_t len, uint32_t hz) {
+    if (!initialized) return false;
+    Lock lock(*this, hz);
+    uint32_t start = micros();
+
+    wire.beginTransmission(addr);
+    wire.write(reg);
+    if (len > 0) wire.write(data, len);
+    last_error = wire.endTransmission();
+    record(addr, reg, len, true, start);
+    return last_error == ERROR_NONE;
+}
+
+bool I2CBus::read(uint8_t addr, uint8_t reg, uint8_t* buffer, size_t len, uint32_t hz, uint32_t gap_us) {
+    if (!initialized) return false;
+    Lock lock(*this, hz);
+    uint32_t start = micros();
+
+    wire.beginTransmission(addr);
+    wire.write(reg);
+    last_error = wire.endTransmission(false);
+    if (last_error == ERROR_NONE) {
+        if (gap_us > 0) delayMicroseconds(gap_us);
+        if (wire.requestFrom(addr, len) != len) {
+            last_error = ERROR_SHORT_READ;
+        } else {
+            for (size_t i = 0; i < len; i++) {
+                buffer[i] = wire.read();
+            }
+        }
+    }
+    record(addr, reg, len, false, start);
+    return last_error == ERROR_NONE;
+}
+
+bool I2CBus::probe(uint8_t addr, uint32_t hz) {
+    if (!initialized) return false;
+    Lock lock(*this, hz);
+
+    wire.beginTransmission(addr);
+    last_error = wire.endTransmission();
+    return last_error == ERROR_NONE;
+}
+
+void I2CBus::record(uint8_t addr, uint8_t reg, size_t len, bool write, uint32_t start_us) {
+    if (!tracing) return;
+    uint32_t duration = micros() - start_us;
+    TraceEntry& e = trace[trace_head];
+    e.time_us = start_us;
+    e.duration_us = duration > 0xFFFF ? 0xFFFF : duration;
+    e.addr = addr;
+    e.reg = reg;
+    e.len = len > 0xFF ? 0xFF : len;
+    e.write = write;
+    e.error = last_error;
+    trace_head = (trace_head + 1) % TRACE_DEPTH;
+    if (trace_count < TRACE_DEPTH) trace_count++;
+}
+
+void I2CBus::addDevice(I2CDevice* device) {
+    Lock lock(*this);
+    for (uint8_t i = 0; i < device_count; i++) {
+        if (devices[i] == device) return;
+    }
+    if (device_count < MAX_DEVICES) devices[device_count++] = device;
+}
+
+uint32_t I2CBus::logSummary(uint32_t window_ms) {
+    if (!logger || window_ms == 0) return 0;
+
+    uint32_t busy_us = 0, nacks = 0, errors = 0, retries = 0, worst_us = 0;
+    const char* worst = "-";
+    for (uint8_t i = 0; i < device_count; i++) {
+        const I2CDevice::Stats& s = devices[i]->getStats();
+        busy_us += s.busy_us;
+        nacks += s.nacks;
+        errors += s.errors;
+        retries += s.retries;
+        if (s.max_us > worst_us) {
+            worst_us = s.max_us;
+            worst = devices[i]->getName();
+        }
+    }
+
+    String line = String("Bus ") + String(busy_us / (window_ms * 10.0f), 1) + "% busy";
+    if (busy_us > 0) {
+        line += " (";
+        bool first = true;
+        for (uint8_t i = 0; i < device_count; i++) {
+            const I2CDevice::Stats& s = devices[i]->getStats();
+            if (s.busy_us == 0) continue;
+            line += String(first ? "" : " ") + devices[i]->getName() + " " + String(s.busy_us * 100 / busy_us) + "%";
+            first = false;
+        }
+        line += ")";
+    }
+    line += ", " + String(nacks) + " NACK, " + String(errors) + " err, " + String(retries) + " retries, worst " + String(worst_us) + "us " + worst;
+    logger->info("I2C", line.c_str());
+    return nacks + errors;
+}
+
+void I2CBus::logStats() {
+    if (!logger) return;
+    for (uint8_t i = 0; i < device_count; i++) {
+        const I2CDevice::Stats& s = devices[i]->getStats();
+        char addr[8];
+        snprintf(addr, sizeof(addr), "0x%02X", devices[i]->getAddress());
+        logger->info("I2C", (String(devices[i]->getName()) + " @" + addr + ": " + String(s.transactions) + " transactions, " + String(s.bytes) + " B, " +
+                             String(s.busy_us) + "us, " + String(s.nacks) + " NACK, " + String(s.errors) + " err, " + String(s.retries) + " retries, max " +
+                             String(s.max_us) + "us").c_str());
+    }
+}
+
+void I2CBus::resetStats() {
+    Lock lock(*this);
+    for (uint8_t i = 0; i < device_count; i++) devices[i]->resetStats();
+}
+
+void I2CBus::dumpTrace() {
+    if (!logger) return;
+
+    // Copy under the lock, log outside it
+    TraceEntry copy[TRACE_DEPTH];
+    uint8_t count, head;
+    {
+        Lock lock(*this);
+        count = trace_count;
+        head = trace_head;
+        memcpy(copy, trace, sizeof(trace));
+    }
+
+    logger->info("I2C_TRACE", (String("Last ") + String(count) + " transactions:").c_str());
+    for (uint8_t n = 0; n < count; n++) {
+        const TraceEntry& e = copy[(head + TRACE_DEPTH - count + n) % TRACE_DEPTH];
+        char buf[80];
+        snprintf(buf, sizeof(buf), "%10lu %s 0x%02X reg 0x%02X len %3u %5uus%s", (unsigned long)e.time_us, e.write ? "W" : "R", e.addr, e.reg, e.len,
+                 e.duration_us, e.error ? (e.error == ERROR_ADDR_NACK ? " ADDR NACK" : e.error == ERROR_DATA_NACK ? " DATA NACK" : " ERROR") : "");
+        logger->info("I2C_TRACE", buf);
+    }
+}
+
+void I2CDevice::account(bool ok, size_t len, uint32_t call_us, uint32_t locked_us) {
+    uint32_t now = micros();
+    stats.transactions++;
+    stats.busy_us += now - locked_us;
+    if (now - call_us > stats.max_us) stats.max_us = now - call_us;
+    if (ok) {
+        stats.bytes += len;
+        return;
+    }
+    uint8_t error = bus->getLastError();
+    if (error == I2CBus::ERROR_ADDR_NACK || error == I2CBus::ERROR_DATA_NACK) stats.nacks++;
+    else stats.errors++;
+}
+
+bool I2CDevice::writeRegs(uint8_t reg, const uint8_t* data, size_t len) {
+    if (!bus) return false;
+    uint32_t call = micros();
+    I2CBus::Lock lock(*bus, hz);
+    uint32_t locked = micros();
+    bool ok = bus->write(addr, reg, data, len, hz);
+    account(ok, len, call, locked);
+    return ok;
+}
+
+bool I2CDevice::readRegs(uint8_t reg, uint8_t* buffer, size_t len, uint32_t gap_us) {
+    if (!bus) return false;
+    uint32_t call = micros();
+    I2CBus::Lock lock(*bus, hz);
+    uint32_t locked = micros();
+    bool ok = bus->read(addr, reg, buffer, len, hz, gap_us);
+    account(ok, len, call, locked);
+    return ok;
+}
+
+bool I2CDevice::probe() {
+    if (!bus) return false;
+    uint32_t call = micros();
+    I2CBus::Lock lock(*bus, hz);
+    uint32_t locked = micros();
+    bool ok = bus->probe(addr, hz);
+    account(ok, 0, call, locked);
+    return ok;
+}
+
+void I2CDevice::lock() {
+    if (!bus) return;
+    uint32_t call = micros();
+    bus->lock(hz);
+    if (lock_depth++ == 0) {
+        lock_start = micros();
+        lock_transactions = stats.transactions;
+        uint32_t waited = lock_start - call;
+        if (waited > stats.max_us) stats.max_us = waited;
+    }
+}
+
+void I2CDevice::unlock() {
+    if (!bus || lock_depth == 0) return;
+    if (--lock_depth == 0 && stats.transactions == lock_transactions) {
+        // Raw TwoWire/HAL access: count the whole session
+        stats.transactions++;
+        stats.busy_us += micros() - lock_start;
+    }
+    bus->unlock();
+}
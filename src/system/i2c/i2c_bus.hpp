@@ -0,0 +1,186 @@
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "../../logger/logger.hpp"
+
+// Per-device bus clocks. Every part on the shared bus is rated for 400kHz fast mode;
+// the codecs stay at standard mode since they are only touched during setup.
+#define I2C_STANDARD_HZ     100000
+#define I2C_FAST_HZ         400000
+#define I2C_FAST_PLUS_HZ    1000000
+
+class I2CDevice;
+
+/**
+ * Owner of the shared I2C bus.
+ * Every transaction runs under a recursive mutex, so drivers can hold the bus
+ * across a multi-step sequence (read-modify-write, CTRL9 handshakes) while the
+ * register helpers below still lock on their own. The clock is switched to the
+ * device's rate when the bus is taken, and left there until someone needs another.
+ *
+ * Attached I2CDevices are listed for the usage summary. An optional ring buffer
+ * records the most recent raw transactions.
+ */
+class I2CBus {
+public:
+    static constexpr uint8_t MAX_DEVICES = 12;
+    static constexpr uint8_t TRACE_DEPTH = 64;
+
+    // Wire endTransmission() codes, plus short reads
+    enum Error : uint8_t {
+        ERROR_NONE = 0,
+        ERROR_TOO_LONG = 1,
+        ERROR_ADDR_NACK = 2,
+        ERROR_DATA_NACK = 3,
+        ERROR_OTHER = 4,
+        ERROR_TIMEOUT = 5,
+        ERROR_SHORT_READ = 6,
+    };
+
+    struct TraceEntry {
+        uint32_t time_us;
+        uint16_t duration_us;
+        uint8_t addr;
+        uint8_t reg;
+        uint8_t len;
+        uint8_t write : 1;
+        uint8_t error : 7;
+    };
+
+private:
+    Logger* logger = nullptr;
+    TwoWire& wire;
+    SemaphoreHandle_t mutex = nullptr;
+    uint32_t default_hz = I2C_STANDARD_HZ;
+    uint32_t current_hz = 0;
+    bool initialized = false;
+    uint8_t last_error = ERROR_NONE;
+    uint8_t lock_depth = 0;
+    uint32_t lock_start_us = 0;
+    uint32_t total_busy_us = 0;    // Lifetime time held by anyone, never reset
+
+    I2CDevice* devices[MAX_DEVICES] = {nullptr};
+    uint8_t device_count = 0;
+
+    bool tracing = false;
+    TraceEntry trace[TRACE_DEPTH];
+    uint8_t trace_head = 0;
+    uint8_t trace_count = 0;
+
+    void record(uint8_t addr, uint8_t reg, size_t len, bool write, uint32_t start_us);
+
+public:
+    I2CBus(Logger* logger, TwoWire& wire = Wire) : logger(logger), wire(wire) {}
+
+    bool begin(int sda, int scl, uint32_t hz = I2C_STANDARD_HZ);
+    bool isInitialized() const { return initialized; }
+    void scan();
+
+    // Take the bus at the given clock (0 = bus default). Nests.
+    void lock(uint32_t hz = 0);
+    void unlock();
+
+    class Lock {
+    private:
+        I2CBus& bus;
+    public:
+        Lock(I2CBus& bus, uint32_t hz = 0) : bus(bus) { bus.lock(hz); }
+        ~Lock() { bus.unlock(); }
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+
+    // Single locked transactions: register address followed by data
+    bool write(uint8_t addr, uint8_t reg, const uint8_t* data, size_t len, uint32_t hz = 0);
+    bool read(uint8_t addr, uint8_t reg, uint8_t* buffer, size_t len, uint32_t hz = 0, uint32_t gap_us = 0);
+    bool probe(uint8_t addr, uint32_t hz = 0);
+    uint8_t getLastError() const { return last_error; }  // Of the last transaction — read under the lock
+
+    // Raw access for libraries that drive TwoWire themselves — only while holding the lock
+    TwoWire& getWire() { return wire; }
+    uint32_t getClock() const { return current_hz; }
+    uint32_t getTotalBusyUs() const { return total_busy_us; }
+
+    // Devices listed in the usage summary (I2CDevice::attach() adds itself)
+    void addDevice(I2CDevice* device);
+
+    // One line: bus occupancy and share per device since the last resetStats().
+    // Returns NACKs + errors in that window.
+    uint32_t logSummary(uint32_t window_ms);
+    void logStats();    // One line per device
+    void resetStats();
+
+    // Ring buffer of recent transactions
+    void setTracing(bool enabled) { tracing = enabled; }
+    bool isTracing() const { return tracing; }
+    void dumpTrace();
+};
+
+/**
+ * Handle a driver keeps for its chip: name, address and clock on a shared I2CBus.
+ * Counts every transaction it makes for the bus summary.
+ */
+class I2CDevice {
+public:
+    struct Stats {
+        uint32_t transactions = 0;
+        uint32_t bytes = 0;         // Payload, excluding address and register bytes
+        uint32_t busy_us = 0;       // Time holding the bus
+        uint32_t nacks = 0;
+        uint32_t errors = 0;        // Other failures (timeouts, short reads)
+        uint32_t retries = 0;       // Reported by the driver
+        uint32_t max_us = 0;        // Worst call latency, including waiting for the bus
+    };
+
+private:
+    const char* name;
+    I2CBus* bus = nullptr;
+    uint8_t addr;
+    uint32_t hz;
+    Stats stats;
+    uint32_t lock_start = 0;
+    uint32_t lock_transactions = 0;
+    uint8_t lock_depth = 0;
+
+    void account(bool ok, size_t len, uint32_t call_us, uint32_t locked_us);
+
+public:
+    I2CDevice(const char* name, uint8_t addr, uint32_t hz = I2C_FAST_HZ) : name(name), addr(addr), hz(hz) {}
+
+    void attach(I2CBus& bus) { this->bus = &bus; bus.addDevice(this); }
+    bool isAttached() const { return bus != nullptr; }
+    I2CBus* getBus() { return bus; }
+    const char* getName() const { return name; }
+    uint8_t getAddress() const { return addr; }
+    void setAddress(uint8_t addr) { this->addr = addr; }
+    uint32_t getClock() const { return hz; }
+
+    bool writeReg(uint8_t reg, uint8_t value) { return writeRegs(reg, &value, 1); }
+    bool writeRegs(uint8_t reg, const uint8_t* data, size_t len);
+    bool readReg(uint8_t reg, uint8_t* value) { return readRegs(reg, value, 1); }
+    bool readRegs(uint8_t reg, uint8_t* buffer, size_t len, uint32_t gap_us = 0);
+    bool probe();
+
+    // Hold the bus at this device's clock across several transactions.
+    // For drivers that go around the helpers (XPowersLib, es8311.c), each outermost
+    // lock/unlock pair counts as one transaction.
+    void lock();
+    void unlock();
+
+    class Lock {
+    private:
+        I2CDevice& device;
+    public:
+        Lock(I2CDevice& device) : device(device) { device.lock(); }
+        ~Lock() { device.unlock(); }
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
+
+    void noteRetry() { stats.retries++; }
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = Stats(); }
+};
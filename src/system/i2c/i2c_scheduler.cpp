@@ -0,0 +1,190 @@
+#include "i2c_scheduler.hpp"
+
+constexpr uint32_t I2CScheduler::DEFAULT_DEADLINE_US[I2CScheduler::PRIORITY_COUNT];
+
+bool I2CScheduler::begin(UBaseType_t task_priority, BaseType_t core) {
+    if (task) return true;
+    if (!bus.isInitialized()) return false;
+
+    if (xTaskCreatePinnedToCore(taskEntry, "i2c_sched", TASK_STACK, this, task_priority, &task, core) != pdPASS) {
+        task = nullptr;
+        if (logger) logger->failure("I2C", "Failed to start transfer scheduler");
+        return false;
+    }
+    return true;
+}
+
+void I2CScheduler::taskEntry(void* arg) {
+    static_cast<I2CScheduler*>(arg)->run();
+}
+
+bool I2CScheduler::submit(const Transfer& transfer) {
+    if (!task || !transfer.device || transfer.priority >= PRIORITY_COUNT) return false;
+    Priority p = transfer.priority;
+    uint32_t now = micros();
+
+    // Before it's visible to the worker, which releases it on completion
+    if (power) power->acquire(power_lock);
+    portENTER_CRITICAL(&mux);
+    stats[p].submitted++;
+    if (count[p] >= QUEUE_DEPTH) {
+        stats[p].rejected++;
+        portEXIT_CRITICAL(&mux);
+        if (power) power->release(power_lock);
+        return false;
+    }
+    Pending& slot = queue[p][count[p]++];
+    slot.transfer = transfer;
+    slot.transfer.submit_us = now;
+    slot.deadline = now + (transfer.deadline_us ? transfer.deadline_us : DEFAULT_DEADLINE_US[p]);
+    portEXIT_CRITICAL(&mux);
+
+    xTaskNotifyGive(task);
+    return true;
+}
+
+bool I2CScheduler::read(I2CDevice& device, uint8_t reg, uint8_t* buffer, size_t len, Priority priority,
+                        Callback callback, void* ctx, uint32_t deadline_us) {
+    Transfer t;
+    t.device = &device;
+    t.reg = reg;
+    t.data = buffer;
+    t.len = len;
+    t.priority = priority;
+    t.deadline_us = deadline_us;
+    t.callback = callback;
+    t.ctx = ctx;
+    return submit(t);
+}
+
+bool I2CScheduler::write(I2CDevice& device, uint8_t reg, uint8_t value, Priority priority,
+                         Callback callback, void* ctx, uint32_t deadline_us) {
+    Transfer t;
+    t.device = &device;
+    t.reg = reg;
+    t.len = 1;
+    t.value = value;
+    t.write = true;
+    t.priority = priority;
+    t.deadline_us = deadline_us;
+    t.callback = callback;
+    t.ctx = ctx;
+    return submit(t);
+}
+
+// Highest priority first, earliest deadline within a level. Expired background
+// transfers are considered alongside normal ones.
+bool I2CScheduler::next(Pending& out) {
+    uint32_t now = micros();
+    int best_p = -1, best_i = -1;
+
+    portENTER_CRITICAL(&mux);
+    for (int level = 0; level < PRIORITY_COUNT && best_p < 0; level++) {
+        for (int p = level; p < PRIORITY_COUNT; p++) {
+            // Only the normal level also looks at aged background entries
+            if (p != level && !(level == PRIORITY_NORMAL && p == PRIORITY_BACKGROUND)) continue;
+            for (int i = 0; i < count[p]; i++) {
+                const Pending& c = queue[p][i];
+                if (p != level && (int32_t)(now - c.deadline) < 0) continue;
+                if (best_p < 0 || (int32_t)(c.deadline - queue[best_p][best_i].deadline) < 0) {
+                    best_p = p;
+                    best_i = i;
+                }
+            }
+        }
+    }
+    if (best_p >= 0) {
+        out = queue[best_p][best_i];
+        queue[best_p][best_i] = queue[best_p][--count[best_p]];
+    }
+    portEXIT_CRITICAL(&mux);
+    return best_p >= 0;
+}
+
+void I2CScheduler::run() {
+    Pending pending;
+    for (;;) {
+        if (!next(pending)) {
+            ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+            continue;
+        }
+
+        Transfer& t = pending.transfer;
+        if (t.drop_late && (int32_t)(micros() - pending.deadline) > 0) {
+            complete(pending, false, true);
+            continue;
+        }
+
+        bool ok;
+        if (t.write) {
+            ok = t.data ? t.device->writeRegs(t.reg, t.data, t.len) : t.device->writeReg(t.reg, t.value);
+        } else {
+            ok = t.device->readRegs(t.reg, t.data, t.len);
+        }
+        complete(pending, ok, false);
+    }
+}
+
+uint8_t I2CScheduler::bucketFor(uint32_t us) {
+    uint8_t bucket = 0;
+    uint32_t v = us >> 6;
+    while (v && bucket < HISTOGRAM_BUCKETS - 1) {
+        v >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void I2CScheduler::complete(Pending& pending, bool ok, bool dropped) {
+    Transfer& t = pending.transfer;
+    t.done_us = micros();
+    uint32_t latency = t.done_us - t.submit_us;
+
+    portENTER_CRITICAL(&mux);
+    Stats& s = stats[t.priority];
+    if (dropped) s.dropped++;
+    else if (ok) s.completed++;
+    else s.failed++;
+    if ((int32_t)(t.done_us - pending.deadline) > 0) s.late++;
+    if (latency > s.max_us) s.max_us = latency;
+    s.histogram[bucketFor(latency)]++;
+    portEXIT_CRITICAL(&mux);
+    if (power) power->release(power_lock);
+
+    if (t.callback) t.callback(t, ok, t.ctx);
+}
+
+void I2CScheduler::resetStats() {
+    portENTER_CRITICAL(&mux);
+    for (uint8_t p = 0; p < PRIORITY_COUNT; p++) stats[p] = Stats();
+    portEXIT_CRITICAL(&mux);
+}
+
+const char* I2CScheduler::priorityName(Priority priority) {
+    switch (priority) {
+        case PRIORITY_REALTIME: return "realtime";
+        case PRIORITY_NORMAL: return "normal";
+        case PRIORITY_BACKGROUND: return "background";
+        default: return "?";
+    }
+}
+
+void I2CScheduler::logStats() {
+    if (!logger) return;
+    for (uint8_t p = 0; p < PRIORITY_COUNT; p++) {
+        Stats s;
+        portENTER_CRITICAL(&mux);
+        s = stats[p];
+        portEXIT_CRITICAL(&mux);
+        if (s.submitted == 0) continue;
+
+        logger->info("I2C_SCHED", (String(priorityName((Priority)p)) + ": " + String(s.completed) + " ok, " + String(s.failed) + " failed, " +
+                                   String(s.late) + " late, " + String(s.dropped) + " dropped, " + String(s.rejected) + " rejected, max " +
+                                   String(s.max_us) + "us").c_str());
+        String line = "  latency";
+        for (uint8_t b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            line += (b == HISTOGRAM_BUCKETS - 1 ? String(" >=") : String(" <")) + String(64u << (b == HISTOGRAM_BUCKETS - 1 ? b - 1 : b)) + "us:" + String(s.histogram[b]);
+        }
+        logger->info("I2C_SCHED", line.c_str());
+    }
+}
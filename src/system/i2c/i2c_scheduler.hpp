@@ -0,0 +1,111 @@
+#pragma once
+#include <Arduino.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "../../logger/logger.hpp"
+#include "i2c_bus.hpp"
+#include "../power/power_manager.hpp"
+
+/**
+ * Asynchronous transfers on the shared I2CBus.
+ * Drivers submit register reads/writes with a priority, optional deadline and
+ * completion callback; a worker task executes them one at a time. Higher
+ * priorities always go first and each level is served earliest-deadline-first,
+ * so a realtime transfer waits for at most the one transfer already on the wire.
+ * Background transfers that outlive their deadline compete at normal priority
+ * so they can't starve.
+ *
+ * Callbacks run in the worker task. Buffers must stay valid until the callback.
+ * submit() is for task context only.
+ */
+class I2CScheduler {
+public:
+    enum Priority : uint8_t {
+        PRIORITY_REALTIME = 0,    // Touch, IMU samples
+        PRIORITY_NORMAL,          // RTC polls, PMU telemetry
+        PRIORITY_BACKGROUND,      // Codec configuration, diagnostics
+        PRIORITY_COUNT
+    };
+
+    struct Transfer;
+    typedef void (*Callback)(const Transfer& transfer, bool ok, void* ctx);
+
+    struct Transfer {
+        I2CDevice* device = nullptr;
+        uint8_t reg = 0;
+        uint8_t* data = nullptr;      // nullptr + len 1 on a write: uses value
+        size_t len = 0;
+        uint8_t value = 0;
+        bool write = false;
+        Priority priority = PRIORITY_NORMAL;
+        uint32_t deadline_us = 0;     // Relative to submit, 0 = priority default
+        bool drop_late = false;       // Fail instead of running once the deadline has passed
+        Callback callback = nullptr;
+        void* ctx = nullptr;
+
+        // Filled in by the scheduler
+        uint32_t submit_us = 0;
+        uint32_t done_us = 0;
+    };
+
+    static constexpr uint8_t QUEUE_DEPTH = 16;       // Per priority
+    static constexpr uint8_t HISTOGRAM_BUCKETS = 10;  // <64us, doubling, up to >=16ms
+
+    struct Stats {
+        uint32_t submitted = 0;
+        uint32_t completed = 0;
+        uint32_t failed = 0;
+        uint32_t late = 0;        // Finished after the deadline
+        uint32_t dropped = 0;     // drop_late and the deadline passed before start
+        uint32_t rejected = 0;    // Queue full
+        uint32_t max_us = 0;
+        uint32_t histogram[HISTOGRAM_BUCKETS] = {0};
+    };
+
+private:
+    static constexpr uint32_t DEFAULT_DEADLINE_US[PRIORITY_COUNT] = {2000, 20000, 200000};
+    static constexpr uint32_t TASK_STACK = 3072;
+
+    struct Pending {
+        Transfer transfer;
+        uint32_t deadline;        // Absolute, micros()
+    };
+
+    Logger* logger = nullptr;
+    I2CBus& bus;
+    TaskHandle_t task = nullptr;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+
+    Pending queue[PRIORITY_COUNT][QUEUE_DEPTH];
+    uint8_t count[PRIORITY_COUNT] = {0};
+    Stats stats[PRIORITY_COUNT];
+    PowerManager* power = nullptr;   // Lock held per queued transfer — no light sleep mid-transaction
+    int8_t power_lock = -1;
+
+    static void taskEntry(void* arg);
+    void run();
+    bool next(Pending& out);
+    void complete(Pending& pending, bool ok, bool dropped);
+    static uint8_t bucketFor(uint32_t us);
+
+public:
+    I2CScheduler(Logger* logger, I2CBus& bus) : logger(logger), bus(bus) {}
+
+    bool begin(UBaseType_t task_priority = 5, BaseType_t core = 0);
+    bool isRunning() const { return task != nullptr; }
+    void setPowerLock(PowerManager& power, int8_t lock) { this->power = &power; power_lock = lock; }
+
+    // Queue a transfer — false if the bus isn't up or this priority's queue is full
+    bool submit(const Transfer& transfer);
+    bool read(I2CDevice& device, uint8_t reg, uint8_t* buffer, size_t len, Priority priority,
+              Callback callback = nullptr, void* ctx = nullptr, uint32_t deadline_us = 0);
+    bool write(I2CDevice& device, uint8_t reg, uint8_t value, Priority priority,
+               Callback callback = nullptr, void* ctx = nullptr, uint32_t deadline_us = 0);
+    uint8_t queued(Priority priority) const { return count[priority]; }
+
+    const Stats& getStats(Priority priority) const { return stats[priority]; }
+    void resetStats();
+    void logStats();
+    static const char* priorityName(Priority priority);
+};
@@ -0,0 +1,94 @@
+#include "reg_sequence.hpp"
+
+bool RegSequence::run(I2CDevice& device, const RegStep* steps, size_t count, bool auto_increment, Result& result, RegShadow* shadow) {
+    result = Result();
+    I2CBus* bus = device.getBus();
+    if (!bus) {
+        result.failed_step = 0;
+        return false;
+    }
+
+    uint32_t start = micros();
+    uint32_t waited_us = 0;
+    size_t i = 0;
+
+    while (i < count && result.ok()) {
+        // Everything up to the next wait runs under one bus lock
+        {
+            I2CBus::Lock lock(*bus, device.getClock());
+            while (i < count && steps[i].op != RegStep::OP_WAIT) {
+                const RegStep& step = steps[i];
+
+                if (step.op == RegStep::OP_VERIFY) {
+                    uint8_t value = 0;
+                    if (!device.readReg(step.reg, &value) || (value & step.mask) != (step.value & step.mask)) {
+                        result.failed_step = i;
+                        break;
+                    }
+                    result.verified++;
+                    i++;
+                    continue;
+                }
+
+                // Merge a run of writes to consecutive registers into one burst
+                uint8_t burst[MAX_BURST];
+                size_t len = 0;
+                size_t first = i;
+                do {
+                    burst[len++] = steps[i].value;
+                    i++;
+                } while (auto_increment && len < MAX_BURST && i < count &&
+                         (steps[i].op == RegStep::OP_WRITE || steps[i].op == RegStep::OP_COMMAND) &&
+                         steps[i].reg == (uint8_t)(step.reg + len));
+
+                bool ok = len == 1 ? device.writeReg(step.reg, burst[0]) : device.writeRegs(step.reg, burst, len);
+                result.transactions++;
+                if (!ok) {
+                    result.failed_step = first;
+                    break;
+                }
+                result.writes += len;
+                if (shadow) {
+                    for (size_t k = first; k < i; k++) shadow->note(steps[k].reg, steps[k].value);
+                }
+
+#ifdef REG_SEQUENCE_VERIFY
+                // Debug builds: read back every config register just written
+                for (size_t k = first; k < i; k++) {
+                    if (steps[k].op != RegStep::OP_WRITE) continue;
+                    uint8_t value = 0;
+                    if (!device.readReg(steps[k].reg, &value) || value != steps[k].value) {
+                        result.failed_step = k;
+                        break;
+                    }
+                    result.verified++;
+                }
+                if (!result.ok()) break;
+#endif
+            }
+        }
+
+        // Waits happen with the bus released
+        if (i < count && result.ok() && steps[i].op == RegStep::OP_WAIT) {
+            if (steps[i].value > 0) {
+                uint32_t t0 = micros();
+                delay(steps[i].value);
+                waited_us += micros() - t0;
+            }
+            i++;
+        }
+    }
+
+    result.elapsed_us = micros() - start;
+    result.bus_us = result.elapsed_us - waited_us;
+    return result.ok();
+}
+
+void RegSequence::log(Logger* logger, const char* tag, const char* name, const Result& result) {
+    if (!logger) return;
+    String line = String(name) + ": " + String(result.writes) + " writes in " + String(result.transactions) + " transactions, " +
+                  String(result.elapsed_us / 1000.0f, 1) + "ms (" + String(result.bus_us / 1000.0f, 1) + "ms on the bus)";
+    if (result.verified > 0) line += ", " + String(result.verified) + " verified";
+    if (result.ok()) logger->debug(tag, line.c_str());
+    else logger->failure(tag, (line + ", failed at step " + String(result.failed_step)).c_str());
+}
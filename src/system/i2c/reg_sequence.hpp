@@ -0,0 +1,66 @@
+#pragma once
+#include <Arduino.h>
+
+#include "../../logger/logger.hpp"
+#include "i2c_bus.hpp"
+#include "reg_shadow.hpp"
+
+/**
+ * One step of a register initialization table.
+ * Build tables with the constexpr helpers:
+ *
+ *   static const RegStep INIT[] = {
+ *       RegStep::command(REG_RESET, 0xB0), RegStep::wait(10),
+ *       RegStep::write(REG_CTRL2, 0x26), RegStep::write(REG_CTRL3, 0x66),
+ *   };
+ */
+struct RegStep {
+    enum Op : uint8_t {
+        OP_WRITE,       // Config register — read back when REG_SEQUENCE_VERIFY is defined
+        OP_COMMAND,     // Self-clearing / write-only register, never read back
+        OP_WAIT,        // Delay in ms (0 = only end the current burst)
+        OP_VERIFY,      // Always read back and compare under mask
+    };
+
+    uint8_t op;
+    uint8_t reg;
+    uint8_t value;
+    uint8_t mask;
+
+    static constexpr RegStep write(uint8_t reg, uint8_t value) { return RegStep{OP_WRITE, reg, value, 0xFF}; }
+    static constexpr RegStep command(uint8_t reg, uint8_t value) { return RegStep{OP_COMMAND, reg, value, 0xFF}; }
+    static constexpr RegStep wait(uint8_t ms) { return RegStep{OP_WAIT, 0, ms, 0}; }
+    static constexpr RegStep boundary() { return RegStep{OP_WAIT, 0, 0, 0}; }
+    static constexpr RegStep verify(uint8_t reg, uint8_t value, uint8_t mask = 0xFF) { return RegStep{OP_VERIFY, reg, value, mask}; }
+};
+
+/**
+ * Executes RegStep tables on an I2CDevice.
+ * Consecutive writes to consecutive registers are merged into one auto-increment
+ * burst when the device supports it. The bus is held between waits and released
+ * during them. Pass the device's RegShadow, if it has one, to keep it coherent.
+ */
+class RegSequence {
+public:
+    static constexpr size_t MAX_BURST = 16;
+
+    struct Result {
+        uint16_t writes = 0;        // Register values written
+        uint16_t transactions = 0;  // I2C write transactions used for them
+        uint16_t verified = 0;
+        int16_t failed_step = -1;   // Index of the first failing step
+        uint32_t elapsed_us = 0;    // Including waits
+        uint32_t bus_us = 0;        // Excluding waits
+        bool ok() const { return failed_step < 0; }
+    };
+
+    static bool run(I2CDevice& device, const RegStep* steps, size_t count, bool auto_increment, Result& result, RegShadow* shadow = nullptr);
+
+    template <size_t N>
+    static bool run(I2CDevice& device, const RegStep (&steps)[N], bool auto_increment, Result& result, RegShadow* shadow = nullptr) {
+        return run(device, steps, N, auto_increment, result, shadow);
+    }
+
+    // "<name>: 12 writes in 5 transactions, 61.2ms (1.1ms on the bus)"
+    static void log(Logger* logger, const char* tag, const char* name, const Result& result);
+};
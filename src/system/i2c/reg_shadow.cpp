@@ -0,0 +1,83 @@
+#include "reg_shadow.hpp"
+
+void RegShadow::setCached(uint8_t from, uint8_t to, uint8_t flag_mask) {
+    for (uint16_t reg = from; reg <= to; reg++) {
+        if (reg < first || reg - first >= count) continue;
+        cached |= 1u << (reg - first);
+        flags[reg - first] = flag_mask;
+    }
+}
+
+bool RegShadow::read(uint8_t reg, uint8_t* value) {
+    if (!isCached(reg)) return device.readReg(reg, value);
+
+    uint8_t i = reg - first;
+    if (valid & (1u << i)) {
+        *value = values[i];
+        stats.hits++;
+        return true;
+    }
+
+    stats.misses++;
+    uint8_t raw = 0;
+    if (!device.readReg(reg, &raw)) return false;
+    values[i] = raw & ~flags[i];
+    valid |= 1u << i;
+    *value = raw;
+    return true;
+}
+
+bool RegShadow::write(uint8_t reg, uint8_t value) {
+    if (!isCached(reg)) return device.writeReg(reg, value);
+
+    uint8_t i = reg - first;
+    uint8_t stored = value & ~flags[i];
+    if ((valid & (1u << i)) && values[i] == stored && (value & flags[i]) == flags[i]) {
+        stats.skipped++;
+        return true;
+    }
+
+    stats.writes++;
+    if (!device.writeReg(reg, value)) {
+        valid &= ~(1u << i);
+        return false;
+    }
+    values[i] = stored;
+    valid |= 1u << i;
+    return true;
+}
+
+bool RegShadow::update(uint8_t reg, uint8_t mask, uint8_t bits, uint8_t clear_flags) {
+    uint8_t value = 0;
+    if (!read(reg, &value)) return false;
+    if (isCached(reg)) {
+        uint8_t f = flags[reg - first];
+        value = (value & ~f) | (f & ~clear_flags);
+    }
+    value = (value & ~mask) | (bits & mask);
+    return write(reg, value);
+}
+
+bool RegShadow::sync() {
+    for (uint8_t i = 0; i < count; i++) {
+        uint32_t bit = 1u << i;
+        if (!(cached & valid & bit)) continue;
+        stats.writes++;
+        if (!device.writeReg(first + i, values[i] | flags[i])) return false;
+    }
+    return true;
+}
+
+bool RegShadow::refresh() {
+    uint8_t raw[MAX_REGS];
+    if (!device.readRegs(first, raw, count)) {
+        valid = 0;
+        return false;
+    }
+    stats.misses++;
+    for (uint8_t i = 0; i < count; i++) {
+        values[i] = raw[i] & ~flags[i];
+    }
+    valid = cached;
+    return true;
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <Arduino.h>
+
+#include "i2c_bus.hpp"
+
+/**
+ * RAM copy of a device's write-mostly configuration registers.
+ * Covers a contiguous register window of up to MAX_REGS. Registers marked cached
+ * are read from RAM once known and writes of an unchanged value are skipped;
+ * everything else in the window passes straight through to the device.
+ *
+ * Flag bits (hardware-set, write-0-to-clear) in a cached register are never
+ * stored: writes send them as 1 so they are left alone unless explicitly cleared.
+ *
+ * invalidate() after a device reset or power loss; sync() to push the cached
+ * values back after the device lost them.
+ */
+class RegShadow {
+public:
+    static constexpr uint8_t MAX_REGS = 32;
+
+    struct Stats {
+        uint32_t hits = 0;       // Reads served from RAM
+        uint32_t misses = 0;     // Reads that went to the device
+        uint32_t skipped = 0;    // Writes dropped as unchanged
+        uint32_t writes = 0;     // Writes sent to the device
+    };
+
+private:
+    I2CDevice& device;
+    uint8_t first;
+    uint8_t count;
+    uint8_t values[MAX_REGS] = {0};
+    uint8_t flags[MAX_REGS] = {0};
+    uint32_t cached = 0;
+    uint32_t valid = 0;
+    Stats stats;
+
+    bool isCached(uint8_t reg) const { return reg >= first && reg - first < count && (cached & (1u << (reg - first))); }
+
+public:
+    RegShadow(I2CDevice& device, uint8_t first, uint8_t count) : device(device), first(first), count(count > MAX_REGS ? MAX_REGS : count) {}
+
+    // Mark [from, to] as cached; flag_mask = hardware-owned bits within them
+    void setCached(uint8_t from, uint8_t to, uint8_t flag_mask = 0);
+
+    bool read(uint8_t reg, uint8_t* value);
+    bool write(uint8_t reg, uint8_t value);
+    // Read-modify-write of the bits in mask; clear_flags = flag bits to write as 0
+    bool update(uint8_t reg, uint8_t mask, uint8_t bits, uint8_t clear_flags = 0);
+
+    // Record a value written by another path (burst, RegSequence)
+    void note(uint8_t reg, uint8_t value) {
+        if (!isCached(reg)) return;
+        values[reg - first] = value & ~flags[reg - first];
+        valid |= 1u << (reg - first);
+    }
+
+    void invalidate() { valid = 0; }
+    bool sync();      // Rewrite every known cached value
+    bool refresh();   // Re-read the cached window from the device in one burst
+
+    const Stats& getStats() const { return stats; }
+    void resetStats() { stats = Stats(); }
+};
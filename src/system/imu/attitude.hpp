@@ -0,0 +1,47 @@
+#pragma once
+#include <math.h>
+
+// Minimal quaternion math for the AttitudeEngine path (device-computed dQ),
+// plus software gyro integration to check it against.
+struct Quaternion {
+    float w = 1.0f;
+    float x = 0.0f;
+    float y = 0.0f;
+    float z = 0.0f;
+
+    // Hamilton product: this ⊗ q (apply q in the body frame)
+    Quaternion operator*(const Quaternion& q) const {
+        Quaternion r;
+        r.w = w * q.w - x * q.x - y * q.y - z * q.z;
+        r.x = w * q.x + x * q.w + y * q.z - z * q.y;
+        r.y = w * q.y - x * q.z + y * q.w + z * q.x;
+        r.z = w * q.z + x * q.y - y * q.x + z * q.w;
+        return r;
+    }
+
+    void normalize() {
+        float n = sqrtf(w * w + x * x + y * y + z * z);
+        if (n <= 0.0f) { w = 1.0f; x = y = z = 0.0f; return; }
+        float inv = 1.0f / n;
+        w *= inv; x *= inv; y *= inv; z *= inv;
+    }
+
+    // Small-angle rotation from body rates (dps) over dt seconds
+    static Quaternion fromGyro(float gx_dps, float gy_dps, float gz_dps, float dt) {
+        const float half = 0.5f * dt * (float)M_PI / 180.0f;
+        Quaternion r;
+        r.x = gx_dps * half;
+        r.y = gy_dps * half;
+        r.z = gz_dps * half;
+        r.w = 1.0f;
+        r.normalize();
+        return r;
+    }
+
+    // Rotation angle (degrees) between two orientations
+    static float angleBetween(const Quaternion& a, const Quaternion& b) {
+        float dot = fabsf(a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z);
+        if (dot > 1.0f) dot = 1.0f;
+        return 2.0f * acosf(dot) * 180.0f / (float)M_PI;
+    }
+};
@@ -0,0 +1,89 @@
+#include "gesture_classifier.hpp"
+#include "gesture_model_data.hpp"
+
+const GestureClassifier::Model& GestureClassifier::defaultModel() {
+    return GESTURE_MODEL;
+}
+
+void GestureClassifier::reset() {
+    head = 0;
+    count = 0;
+    last_class = CLASS_NONE;
+    streak = 0;
+    fired = false;
+    have_event = false;
+    last_event_time = 0;
+}
+
+int8_t GestureClassifier::windowMax(const int8_t* values) {
+    int8_t m = values[0];
+    for (uint8_t i = 1; i < WINDOW; i++) {
+        if (values[i] > m) m = values[i];
+    }
+    return m;
+}
+
+void GestureClassifier::computeFeatures(int8_t out[FEATURES]) const {
+    uint8_t cur = (head + WINDOW - 1) % WINDOW;
+    uint8_t old = head;
+
+    out[0] = ax[cur];
+    out[1] = ay[cur];
+    out[2] = az[cur];
+    out[3] = ax[old];
+    out[4] = ay[old];
+    out[5] = az[old];
+    out[6] = windowMax(gx);
+    out[7] = windowMax(gy);
+    out[8] = windowMax(gz);
+    out[9] = clamp8(ax[cur] - ax[old]);
+    out[10] = clamp8(ay[cur] - ay[old]);
+    out[11] = clamp8(az[cur] - az[old]);
+}
+
+uint8_t GestureClassifier::classify(const int8_t features[FEATURES]) const {
+    const Node* nodes = model->nodes;
+    uint16_t i = 0;
+    // Depth-bounded walk; the node-count guard protects against a malformed table
+    for (uint16_t steps = 0; steps < model->node_count; steps++) {
+        const Node& n = nodes[i];
+        if (n.feature < 0) return (uint8_t)n.threshold;
+        i = features[n.feature] <= n.threshold ? n.left : n.right;
+        if (i >= model->node_count) break;
+    }
+    return CLASS_NONE;
+}
+
+uint8_t GestureClassifier::update(const ImuSample& s, uint32_t now_ms) {
+    ax[head] = quantAccel(s.ax);
+    ay[head] = quantAccel(s.ay);
+    az[head] = quantAccel(s.az);
+    gx[head] = quantGyro(s.gx);
+    gy[head] = quantGyro(s.gy);
+    gz[head] = quantGyro(s.gz);
+    head = (head + 1) % WINDOW;
+    if (count < WINDOW) {
+        count++;
+        if (count < WINDOW) return WristGesture::NONE;
+    }
+
+    int8_t features[FEATURES];
+    computeFeatures(features);
+    uint8_t cls = classify(features);
+
+    if (cls == last_class) {
+        if (streak < 255) streak++;
+    } else {
+        last_class = cls;
+        streak = 1;
+        fired = false;
+    }
+
+    if (cls == CLASS_NONE || fired || streak < CONFIRM_POLLS) return WristGesture::NONE;
+    if (have_event && now_ms - last_event_time < COOLDOWN_MS) return WristGesture::NONE;
+
+    fired = true;
+    have_event = true;
+    last_event_time = now_ms;
+    return cls == CLASS_RAISE ? WristGesture::RAISE : WristGesture::LOWER;
+}
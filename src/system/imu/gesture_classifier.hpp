@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include "imu_sample.hpp"
+#include "wrist_gesture.hpp"
+
+/**
+ * Wrist gesture classifier: int8 decision tree over a sliding window of
+ * 50ms-polled samples. Drop-in alternative to WristGesture — same update()
+ * contract and Event bits. The model tables are generated by
+ * tools/gesture_train.py from recorded traces (gesture_model_data.hpp) and
+ * live in flash; any Model with matching WINDOW/FEATURES can be plugged in.
+ */
+class GestureClassifier {
+public:
+    static constexpr uint8_t WINDOW = 16;          // Polls per window (~800ms)
+    static constexpr uint8_t FEATURES = 12;
+    static constexpr uint8_t CONFIRM_POLLS = 2;    // Consecutive windows of a class before it fires
+    static constexpr uint32_t COOLDOWN_MS = 1000;  // Same as WristGesture
+
+    enum Class : uint8_t { CLASS_NONE = 0, CLASS_RAISE = 1, CLASS_LOWER = 2 };
+
+    // {feature, threshold, left, right}; feature < 0 is a leaf with the class in threshold
+    struct Node {
+        int8_t feature;
+        int8_t threshold;
+        uint8_t left;
+        uint8_t right;
+    };
+
+    struct Model {
+        const Node* nodes;
+        uint16_t node_count;
+    };
+
+    // Quantization shared with the training script
+    static int8_t quantAccel(int16_t counts) { return clamp8(counts >> 6); }          // 1/64 g
+    static int8_t quantGyro(int16_t counts) { return clamp8((counts < 0 ? -(int32_t)counts : counts) >> 6); }  // 2 dps, magnitude
+
+    static const Model& defaultModel();  // Generated tables in gesture_model_data.hpp
+
+    GestureClassifier() : model(&defaultModel()) {}
+    explicit GestureClassifier(const Model& model) : model(&model) {}
+
+    // Feed one polled sample; returns WristGesture::Event bits
+    uint8_t update(const ImuSample& sample, uint32_t now_ms);
+    void reset();
+
+    void setModel(const Model& m) { model = &m; reset(); }
+    uint8_t getLastClass() const { return last_class; }
+
+    void computeFeatures(int8_t out[FEATURES]) const;
+    uint8_t classify(const int8_t features[FEATURES]) const;
+
+private:
+    const Model* model;
+
+    // Struct-of-arrays ring buffer: each axis is contiguous so the window
+    // reductions are straight int8 loops the compiler can unroll
+    int8_t ax[WINDOW], ay[WINDOW], az[WINDOW];
+    int8_t gx[WINDOW], gy[WINDOW], gz[WINDOW];
+    uint8_t head = 0;    // Next write position == oldest sample once full
+    uint8_t count = 0;
+
+    uint8_t last_class = CLASS_NONE;
+    uint8_t streak = 0;
+    bool fired = false;              // Current streak already produced an event
+    bool have_event = false;
+    uint32_t last_event_time = 0;
+
+    static int8_t clamp8(int32_t v) { return v < -127 ? -127 : v > 127 ? 127 : (int8_t)v; }
+    static int8_t windowMax(const int8_t* values);
+};
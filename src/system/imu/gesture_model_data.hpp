@@ -0,0 +1,49 @@
+#pragma once
+// Generated by tools/gesture_train.py - do not edit by hand.
+// Source: synthetic 30 min
+#include "gesture_classifier.hpp"
+
+static_assert(GestureClassifier::WINDOW == 16, "gesture model trained for a different window");
+static_assert(GestureClassifier::FEATURES == 12, "gesture model trained for a different feature set");
+
+// {feature, threshold, left, right} - feature < 0 marks a leaf whose threshold is the class
+static const GestureClassifier::Node GESTURE_MODEL_NODES[] = {
+    {  9,   -9,   1,  12},  // 0: dax <= -9
+    {  4,   -7,   2,  11},  // 1: ay0 <= -7
+    {  3,   18,   3,   4},  // 2: ax0 <= 18
+    { -1,    0,   0,   0},  // 3: leaf: none
+    {  0,   17,   5,  10},  // 4: ax <= 17
+    {  4,  -37,   6,   7},  // 5: ay0 <= -37
+    { -1,    0,   0,   0},  // 6: leaf: none
+    {  8,   80,   8,   9},  // 7: gzmax <= 80
+    { -1,    2,   0,   0},  // 8: leaf: lower
+    { -1,    0,   0,   0},  // 9: leaf: none
+    { -1,    0,   0,   0},  // 10: leaf: none
+    { -1,    0,   0,   0},  // 11: leaf: none
+    {  9,   10,  13,  24},  // 12: dax <= 10
+    { 10,  -24,  14,  19},  // 13: day <= -24
+    {  6,   57,  15,  18},  // 14: gxmax <= 57
+    {  1,  -20,  16,  17},  // 15: ay <= -20
+    { -1,    1,   0,   0},  // 16: leaf: raise
+    { -1,    0,   0,   0},  // 17: leaf: none
+    { -1,    0,   0,   0},  // 18: leaf: none
+    { 10,   24,  20,  21},  // 19: day <= 24
+    { -1,    0,   0,   0},  // 20: leaf: none
+    {  6,   61,  22,  23},  // 21: gxmax <= 61
+    { -1,    2,   0,   0},  // 22: leaf: lower
+    { -1,    0,   0,   0},  // 23: leaf: none
+    {  1,   -8,  25,  32},  // 24: ay <= -8
+    {  1,  -28,  26,  27},  // 25: ay <= -28
+    { -1,    0,   0,   0},  // 26: leaf: none
+    {  3,   17,  28,  31},  // 27: ax0 <= 17
+    {  0,   20,  29,  30},  // 28: ax <= 20
+    { -1,    0,   0,   0},  // 29: leaf: none
+    { -1,    1,   0,   0},  // 30: leaf: raise
+    { -1,    0,   0,   0},  // 31: leaf: none
+    { -1,    0,   0,   0},  // 32: leaf: none
+};
+
+static const GestureClassifier::Model GESTURE_MODEL = {
+    GESTURE_MODEL_NODES,
+    sizeof(GESTURE_MODEL_NODES) / sizeof(GESTURE_MODEL_NODES[0]),
+};
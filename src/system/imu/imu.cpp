@@ -2,14 +2,45 @@
 
 volatile bool     IMU::motion_detected = false;
 volatile uint32_t IMU::isr_count       = 0;
+volatile uint32_t IMU::last_isr_us     = 0;
+IMU::IrqHook      IMU::irq_hook        = nullptr;
+void*             IMU::irq_hook_ctx    = nullptr;
 
 void IRAM_ATTR IMU::motionISR() {
     motion_detected = true;
     isr_count++;
+    last_isr_us = micros();
+    if (irq_hook) irq_hook(irq_hook_ctx);
 }
 
-bool IMU::setBus(TwoWire &bus) {
-    i2c = &bus;
+// CTRL1 turns on address auto-increment, so it gets its own transaction;
+// CTRL2/CTRL3 then go out as one burst
+const RegStep IMU::INIT_SEQUENCE[] = {
+    RegStep::command(REG_RESET, 0xB0),
+    RegStep::wait(10),
+    // CTRL1: [6] = address auto increment, [3:2] = INT pins push-pull, active high
+    RegStep::write(REG_CTRL1, 0x4C),
+    RegStep::boundary(),
+    // CTRL2: aAFS 010 = ±8g, aODR 0110 = 112.1Hz
+    // CTRL3: gGFS 110 = ±1024dps, gODR 0110 = 112.1Hz
+    RegStep::write(REG_CTRL2, 0x26),
+    RegStep::write(REG_CTRL3, 0x66),
+    // CTRL7: [7] = syncSmpl off so DRDY pulses INT1, [1] = gEN, [0] = aEN
+    RegStep::write(REG_CTRL7, 0x03),
+    RegStep::wait(50),  // Gyro start-up
+};
+
+const RegStep IMU::ACTIVE_SEQUENCE[] = {
+    RegStep::write(REG_CTRL2, 0x26),
+    RegStep::write(REG_CTRL3, 0x66),
+    RegStep::write(REG_CTRL7, 0x03),
+    RegStep::wait(50),  // Gyro start-up
+};
+
+bool IMU::setBus(I2CBus &bus) {
+    if (!mutex) mutex = xSemaphoreCreateRecursiveMutex();
+    Lock lock(*this);
+    i2c.attach(bus);
     interrupt_pin = IMU_INT1;
 
     // Read chip ID
@@ -25,49 +56,27 @@ bool IMU::setBus(TwoWire &bus) {
     }
     if (logger != nullptr) logger->info("IMU", (String("Chip ID: 0x") + String(whoami, HEX)).c_str());
 
-    // Software reset
-    writeRegister(REG_RESET, 0xB0);
-    delay(10);
-    
-    // Configure CTRL1: Set serial interface, address auto increment, and INT pins
-    // Bit 6: address auto increment (1)
-    // Bit 3-2: INT pin config (11 = push-pull, active high)
-    if (!writeRegister(REG_CTRL1, 0x4C)) {
-        if (logger != nullptr) logger->failure("IMU", "Failed to configure CTRL1");
-        return false;
-    }
-    
-    // Configure accelerometer: ±8g range, 112Hz ODR
-    // CTRL2: bits[6:4] = aAFS (010 = ±8g), bits[3:0] = aODR (0110 = 112.1Hz)
-    if (!writeRegister(REG_CTRL2, 0x26)) {
-        if (logger != nullptr) logger->failure("IMU", "Failed to configure accelerometer");
-        return false;
-    }
-    
-    // Configure gyroscope: ±1024dps range, 112Hz ODR
-    // CTRL3: bits[6:4] = gGFS (110 = ±1024dps), bits[3:0] = gODR (0110 = 112.1Hz)
-    if (!writeRegister(REG_CTRL3, 0x66)) {
-        if (logger != nullptr) logger->failure("IMU", "Failed to configure gyroscope");
-        return false;
-    }
-    
-    // Enable accelerometer and gyroscope — syncSmpl disabled so DRDY routes to INT1
-    // CTRL7: [7] = syncSmpl (0 = pulse on INT1), [1] = gEN, [0] = aEN
-    if (!writeRegister(REG_CTRL7, 0x03)) {  // 0x03 = gyro + accel, no syncSmpl
-        if (logger != nullptr) logger->failure("IMU", "Failed to enable sensors");
-        return false;
+    // Revision keys the cached calibration
+    if (readRegister(REG_REVISION_ID, &revision_id)) {
+        if (logger != nullptr) logger->info("IMU", (String("Revision: 0x") + String(revision_id, HEX)).c_str());
     }
 
-    delay(50);
+    // Software reset, interface and sensor configuration
+    ctrl_shadow.setCached(REG_CTRL1, REG_CTRL8);
+    ctrl_shadow.invalidate();
+    RegSequence::Result result;
+    bool configured = RegSequence::run(i2c, INIT_SEQUENCE, true, result, &ctrl_shadow);
+    RegSequence::log(logger, "IMU", "QMI8658 init", result);
+    if (!configured) return false;
 
     // Setup INT1 (GPIO21) for data-ready interrupt — INT2 is only on test point TP15
     interrupt_pin = IMU_INT1;
     pinMode(interrupt_pin, INPUT);
     attachInterrupt(digitalPinToInterrupt(interrupt_pin), motionISR, RISING);
 
-    // Read back CTRL7 for verification
+    // Read back CTRL7 from the device (not the shadow) for verification
     uint8_t ctrl7_read = 0;
-    if (readRegister(REG_CTRL7, &ctrl7_read)) {
+    if (i2c.readReg(REG_CTRL7, &ctrl7_read)) {
         if (logger != nullptr) logger->info("IMU", (String("CTRL7 readback: 0x") + String(ctrl7_read, HEX)).c_str());
     }
 
@@ -75,79 +84,101 @@ bool IMU::setBus(TwoWire &bus) {
     
     if (logger != nullptr) logger->success("IMU", "QMI8658 initialized");
     initialized = true;
+    rate_since = millis();
     return true;
 }
 
+// CTRL registers go through the shadow: unchanged writes are skipped
 bool IMU::writeRegister(uint8_t reg, uint8_t value) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_QMI8658);
-    i2c->write(reg);
-    i2c->write(value);
-    return (i2c->endTransmission() == 0);
+    return ctrl_shadow.write(reg, value);
+}
+
+bool IMU::writeRegisters(uint8_t reg, const uint8_t* buffer, size_t len) {
+    // Relies on CTRL1 address auto-increment
+    return i2c.writeRegs(reg, buffer, len);
 }
 
 bool IMU::readRegister(uint8_t reg, uint8_t* value) {
-    return readRegisters(reg, value, 1);
+    return ctrl_shadow.read(reg, value);
 }
 
 bool IMU::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_QMI8658);
-    i2c->write(reg);
-    if (i2c->endTransmission(false) != 0) return false;
-    
-    if (i2c->requestFrom(ADDR_QMI8658, len) != len) return false;
-    
-    for (size_t i = 0; i < len; i++) {
-        buffer[i] = i2c->read();
-    }
-    
+    return i2c.readRegs(reg, buffer, len);
+}
+
+bool IMU::readRaw(RawSample& sample) {
+    Lock lock(*this);
+    if (!initialized) return false;
+
+    // AX_L..GZ_H are contiguous (0x35..0x40): one 12-byte burst
+    uint8_t raw[12];
+    if (!readRegisters(REG_AX_L, raw, 12)) return false;
+
+    // Combine bytes (little endian), minus calibration
+    decodeAccel(raw, sample);
+    sample.gx = clampCounts((int16_t)(raw[7] << 8 | raw[6]) - calibration.gyro_bias[0]);
+    sample.gy = clampCounts((int16_t)(raw[9] << 8 | raw[8]) - calibration.gyro_bias[1]);
+    sample.gz = clampCounts((int16_t)(raw[11] << 8 | raw[10]) - calibration.gyro_bias[2]);
     return true;
 }
 
-bool IMU::readAccel(AccelData& data) {
+bool IMU::readRawAccel(RawSample& sample) {
+    Lock lock(*this);
     if (!initialized) return false;
-    
+
     uint8_t raw[6];
     if (!readRegisters(REG_AX_L, raw, 6)) return false;
-    
-    // Combine bytes (little endian)
-    int16_t ax = (int16_t)(raw[1] << 8 | raw[0]);
-    int16_t ay = (int16_t)(raw[3] << 8 | raw[2]);
-    int16_t az = (int16_t)(raw[5] << 8 | raw[4]);
-    
-    // Convert to g (8g range, 16-bit)
-    const float scale = 8.0f / 32768.0f;
-    data.x = ax * scale;
-    data.y = ay * scale;
-    data.z = az * scale;
-    
+
+    decodeAccel(raw, sample);
+    return true;
+}
+
+void IMU::decodeAccel(const uint8_t* raw, ImuSample& sample) const {
+    int32_t x = (int16_t)(raw[1] << 8 | raw[0]) - calibration.accel_offset[0];
+    int32_t y = (int16_t)(raw[3] << 8 | raw[2]) - calibration.accel_offset[1];
+    int32_t z = (int16_t)(raw[5] << 8 | raw[4]) - calibration.accel_offset[2];
+    if (accel_scaled) {
+        x = (x * calibration.accel_scale[0]) >> 14;
+        y = (y * calibration.accel_scale[1]) >> 14;
+        z = (z * calibration.accel_scale[2]) >> 14;
+    }
+    sample.ax = clampCounts(x);
+    sample.ay = clampCounts(y);
+    sample.az = clampCounts(z);
+}
+
+void IMU::setCalibration(const ImuCalibration& cal) {
+    Lock lock(*this);
+    calibration = cal;
+    accel_scaled = cal.hasAccelScale();
+}
+
+bool IMU::readAccel(AccelData& data) {
+    RawSample raw;
+    if (!readRawAccel(raw)) return false;
+
+    data.x = countsToG(raw.ax);
+    data.y = countsToG(raw.ay);
+    data.z = countsToG(raw.az);
     return true;
 }
 
 bool IMU::readGyro(GyroData& data) {
+    Lock lock(*this);
     if (!initialized) return false;
     
     uint8_t raw[6];
     if (!readRegisters(REG_GX_L, raw, 6)) return false;
     
-    // Combine bytes (little endian)
-    int16_t gx = (int16_t)(raw[1] << 8 | raw[0]);
-    int16_t gy = (int16_t)(raw[3] << 8 | raw[2]);
-    int16_t gz = (int16_t)(raw[5] << 8 | raw[4]);
-    
-    // Convert to dps (1024dps range, 16-bit)
-    const float scale = 1024.0f / 32768.0f;
-    data.x = gx * scale;
-    data.y = gy * scale;
-    data.z = gz * scale;
-    
+    // Same bias as the raw path, so the heartbeat shows what the detectors see
+    data.x = countsToDps(clampCounts((int16_t)(raw[1] << 8 | raw[0]) - calibration.gyro_bias[0]));
+    data.y = countsToDps(clampCounts((int16_t)(raw[3] << 8 | raw[2]) - calibration.gyro_bias[1]));
+    data.z = countsToDps(clampCounts((int16_t)(raw[5] << 8 | raw[4]) - calibration.gyro_bias[2]));
     return true;
 }
 
 bool IMU::readTemperature(float& temp) {
+    Lock lock(*this);
     if (!initialized) return false;
     
     uint8_t raw[2];
@@ -161,125 +192,138 @@ bool IMU::readTemperature(float& temp) {
     return true;
 }
 
-bool IMU::checkWristTilt() {
-    if (!initialized) return false;
-    
-    // Rate limiting: only check every 50ms
-    static unsigned long last_check = 0;
+void IMU::pollWristGesture() {
+    Lock lock(*this);
+    if (!initialized) return;
     unsigned long now = millis();
-    if (now - last_check < 50) return false;
-    last_check = now;
-    
-    AccelData accel;
-    GyroData gyro;
-    
-    if (!readAccel(accel) || !readGyro(gyro)) return false;
+
+    RawSample sample;
+    if (!readRaw(sample)) return;
     checkDataReadyStatus();  // Read STATUS0 to de-assert INT2 and re-arm ISR
 
-    // Simple state machine: remember rotation, wait for target position
-    static enum { IDLE, TRIGGERED } state = IDLE;
-    static unsigned long last_rotation_time = 0;
-    static unsigned long state_time = 0;
+    // Gyro is off (or still settling) at low rate — don't let stale values look like rotation
+    if (!isGyroReady()) {
+        sample.gx = sample.gy = sample.gz = 0;
+    }
 
-    // Target position: WATCH_UP (X > 0.2, Z < -0.2)
-    bool watch_up = (accel.x > 0.20f && accel.z < -0.20f);
-    bool strong_rotation = (abs(gyro.x) > 40.0f || abs(gyro.y) > 40.0f || abs(gyro.z) > 40.0f);
-    
-    // Remember when we last saw rotation
-    if (strong_rotation) {
-        last_rotation_time = now;
+    if (adaptive_rate) {
+        ImuRatePolicy::Rate wanted = rate_policy.update(sample, now);
+        if (wanted != sample_rate) setSampleRate(wanted);
     }
-    
-    switch (state) {
-        case IDLE:
-            // If we see watch_up position AND had rotation in last 1.5 seconds = gesture!
-            // last_rotation_time == 0 means no rotation seen yet (boot state) — skip
-            if (watch_up && last_rotation_time != 0 && (now - last_rotation_time < 1500)) {
-                state = TRIGGERED;
-                state_time = now;
-                if (logger != nullptr) logger->info("IMU_TILT", "✓ Wrist raise gesture!");
-                return true;
-            }
-            break;
-            
-        case TRIGGERED:
-            // Cooldown: wait 1s, then back to IDLE when NOT in watch_up position
-            if (now - state_time > 1000 && !watch_up) {
-                state = IDLE;
-            }
-            break;
+
+    uint8_t events = gesture_source == GESTURE_MODEL ? gesture_classifier.update(sample, now) : wrist_gesture.update(sample, now);
+    if (logger != nullptr) {
+        if (events & WristGesture::RAISE) logger->info("IMU_TILT", "✓ Wrist raise gesture!");
+        if (events & WristGesture::LOWER) logger->info("IMU_TILT", "✓ Wrist lowered - sleep!");
     }
-    
-    return false;
+    pending_gestures |= events;
+}
+
+bool IMU::setSampleRate(ImuRatePolicy::Rate rate) {
+    Lock lock(*this);
+    if (!initialized || motion_wake_armed) return false;
+    if (rate == sample_rate) return true;
+    // AttitudeEngine needs the gyro
+    if (rate == ImuRatePolicy::RATE_LOW && attitude_enabled) return false;
+
+    // ODR may only change with the sensors disabled
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+    if (rate == ImuRatePolicy::RATE_LOW) {
+        // CTRL2: ±8g, aODR 1101 = 21Hz low-power (only valid with gyro off).
+        // The tap engine needs normal mode, so with taps on stay at aODR 0110 accel-only.
+        if (!writeRegister(REG_CTRL2, tap_enabled ? 0x26 : 0x2D)) return false;
+        if (!writeRegister(REG_CTRL7, 0x01)) return false;
+    } else {
+        if (!writeRegister(REG_CTRL2, 0x26)) return false;
+        if (!writeRegister(REG_CTRL3, 0x66)) return false;
+        if (!writeRegister(REG_CTRL7, 0x03)) return false;
+        gyro_ready_time = millis() + ImuRatePolicy::GYRO_STARTUP_MS;
+    }
+    checkDataReadyStatus();  // Re-arm INT1 — data-ready keeps firing at the new rate
+
+    noteSampleRate(rate);
+    if (logger != nullptr) logger->debug("IMU", (String("ODR -> ") + String(getSampleRateHz(), 1) + "Hz").c_str());
+    return true;
+}
+
+void IMU::noteSampleRate(ImuRatePolicy::Rate rate) {
+    unsigned long now = millis();
+    rate_residency_ms[sample_rate] += now - rate_since;
+    rate_since = now;
+    if (rate != sample_rate) rate_switches++;
+    sample_rate = rate;
+}
+
+void IMU::setAdaptiveRate(bool enabled) {
+    Lock lock(*this);
+    adaptive_rate = enabled;
+    rate_policy.reset(sample_rate, millis());
+    if (!enabled) setSampleRate(ImuRatePolicy::RATE_HIGH);
+}
+
+float IMU::getRateHz(ImuRatePolicy::Rate rate) const {
+    return tap_enabled ? ImuRatePolicy::HIGH_HZ : ImuRatePolicy::hz(rate);
+}
+
+uint32_t IMU::getRateResidencyMs(ImuRatePolicy::Rate rate) const {
+    uint32_t ms = rate_residency_ms[rate];
+    if (rate == sample_rate) ms += millis() - rate_since;
+    return ms;
+}
+
+void IMU::resetRateStats() {
+    Lock lock(*this);
+    rate_residency_ms[ImuRatePolicy::RATE_LOW] = 0;
+    rate_residency_ms[ImuRatePolicy::RATE_HIGH] = 0;
+    rate_switches = 0;
+    rate_since = millis();
+}
+
+void IMU::setGestureSource(GestureSource source) {
+    Lock lock(*this);
+    gesture_source = source;
+    wrist_gesture.reset();
+    gesture_classifier.reset();
+    pending_gestures = 0;
+    if (logger != nullptr) logger->info("IMU", source == GESTURE_MODEL ? "Wrist gestures: int8 model" : "Wrist gestures: heuristic");
+}
+
+bool IMU::checkWristTilt() {
+    Lock lock(*this);
+    if (!initialized) return false;
+
+    bool raised = pending_gestures & WristGesture::RAISE;
+    pending_gestures &= ~WristGesture::RAISE;
+    return raised;
 }
 
 bool IMU::checkWristTiltDown() {
+    Lock lock(*this);
     if (!initialized) return false;
-    
-    // Rate limiting: only check every 50ms
-    static unsigned long last_check = 0;
-    unsigned long now = millis();
-    if (now - last_check < 50) return false;
-    last_check = now;
-    
-    AccelData accel;
-    GyroData gyro;
-    
-    if (!readAccel(accel) || !readGyro(gyro)) return false;
-    checkDataReadyStatus();  // Read STATUS0 to de-assert INT2 and re-arm ISR
 
-    // Simple state machine: remember rotation, wait for target position
-    static enum { IDLE, TRIGGERED } state = IDLE;
-    static unsigned long last_rotation_time = 0;
-    static unsigned long state_time = 0;
-
-    // Target positions
-    bool watch_up = (accel.x > 0.20f && accel.z < -0.20f);
-    bool arm_down_standing = (accel.y < -0.35f);
-    bool arm_down_sitting = (accel.y > 0.10f && accel.z < -0.40f);
-    bool arm_down = arm_down_standing || arm_down_sitting;
-    bool strong_rotation = (abs(gyro.x) > 40.0f || abs(gyro.y) > 40.0f || abs(gyro.z) > 40.0f);
-    
-    // Remember when we last saw rotation
-    if (strong_rotation) {
-        last_rotation_time = now;
-    }
-    
-    switch (state) {
-        case IDLE:
-            // If we see arm_down position AND had rotation in last 1.5 seconds = gesture!
-            // last_rotation_time == 0 means no rotation seen yet (boot state) — skip
-            if (arm_down && last_rotation_time != 0 && (now - last_rotation_time < 1500)) {
-                state = TRIGGERED;
-                state_time = now;
-                if (logger != nullptr) logger->info("IMU_TILT", "✓ Wrist lowered - sleep!");
-                return true;
-            }
-            break;
-            
-        case TRIGGERED:
-            // Cooldown: wait 1s, then back to IDLE when NOT in arm_down position
-            if (now - state_time > 1000 && !arm_down) {
-                state = IDLE;
-            }
-            break;
-    }
-    
-    return false;
+    bool lowered = pending_gestures & WristGesture::LOWER;
+    pending_gestures &= ~WristGesture::LOWER;
+    return lowered;
 }
 
 bool IMU::checkDataReadyStatus() {
+    Lock lock(*this);
     if (!initialized) return false;
 
-    uint8_t status0 = 0;
-    if (!readRegister(REG_STATUS0, &status0)) return false;
+    // STATUS0 and STATUS1 are adjacent — with taps enabled pick up STATUS1 in the same burst
+    uint8_t status[2] = {0, 0};
+    if (!readRegisters(REG_STATUS0, status, tap_enabled ? 2 : 1)) return false;
+
+    // STATUS1 bit 1: tap detected (cleared on read)
+    if (status[1] & 0x02) latchTap(last_isr_us);
 
     // Reading STATUS0 clears INT2 in syncSmpl mode, re-arming it for the next event.
     // Bit 0: Accel data ready, Bit 1: Gyro data ready
-    return (status0 & 0x03) == 0x03;  // Both accel and gyro ready
+    return (status[0] & 0x03) == 0x03;  // Both accel and gyro ready
 }
 
 void IMU::clearDataReadyFlag() {
+    Lock lock(*this);
     motion_detected = false;
     // Must read STATUS0 to de-assert INT2 in syncSmpl mode, otherwise INT2 stays
     // HIGH and no new rising edge fires — the ISR would never trigger again.
@@ -287,38 +331,428 @@ void IMU::clearDataReadyFlag() {
 }
 
 bool IMU::checkMotion() {
+    Lock lock(*this);
     if (!initialized) return false;
     
-    // Rate limiting: only check every 100ms
-    static unsigned long last_check = 0;
-    unsigned long now = millis();
-    if (now - last_check < 100) return false;
-    last_check = now;
-    
-    AccelData accel;
-    if (!readAccel(accel)) return false;
+    RawSample sample;
+    if (!readRawAccel(sample)) return false;
     
-    // Calculate magnitude of acceleration vector
-    float magnitude = sqrt(accel.x * accel.x + accel.y * accel.y + accel.z * accel.z);
+    // Squared magnitude of acceleration vector — no sqrt, no float
+    uint32_t magnitude_sq = magnitudeSquared(sample);
     
     // Initialize on first run
-    if (last_accel_magnitude == 0.0f) {
-        last_accel_magnitude = magnitude;
+    if (last_accel_magnitude_sq == 0) {
+        last_accel_magnitude_sq = magnitude_sq;
         return false;
     }
     
-    // Check if change in magnitude exceeds threshold
-    float delta = abs(magnitude - last_accel_magnitude);
-    last_accel_magnitude = magnitude;
+    // Check if change in (squared) magnitude exceeds threshold
+    uint32_t delta = magnitude_sq > last_accel_magnitude_sq ? magnitude_sq - last_accel_magnitude_sq
+                                                            : last_accel_magnitude_sq - magnitude_sq;
+    last_accel_magnitude_sq = magnitude_sq;
     
     // Motion detected
-    if (delta > motion_threshold) {
-        // Debounce: only report motion once per 2 seconds
-        if (now - last_motion_time > 2000) {
-            last_motion_time = now;
-            return true;
+    return delta > motion_threshold_sq;
+}
+
+bool IMU::enableAttitudeEngine(AttitudeRate rate) {
+    Lock lock(*this);
+    if (!initialized) return false;
+    if (!setSampleRate(ImuRatePolicy::RATE_HIGH)) return false;
+
+    // Sensors must be disabled while the AE output rate is changed
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+
+    // CTRL6: [7] = sMoD (0 = continuous), [2:0] = sODR
+    if (!writeRegister(REG_CTRL6, rate & 0x07)) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to configure AttitudeEngine rate");
+        return false;
+    }
+
+    // CTRL7: [3] = sEN (AttitudeEngine), [1] = gEN, [0] = aEN
+    if (!writeRegister(REG_CTRL7, 0x0B)) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to enable AttitudeEngine");
+        return false;
+    }
+    delay(50);
+
+    resetAttitude();
+    attitude_enabled = true;
+    if (logger != nullptr) logger->info("IMU", (String("AttitudeEngine enabled, sODR=") + String(rate)).c_str());
+    return true;
+}
+
+bool IMU::disableAttitudeEngine() {
+    Lock lock(*this);
+    if (!initialized) return false;
+
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+    if (!writeRegister(REG_CTRL6, 0x00)) return false;
+    // Back to plain accel + gyro sampling
+    if (!writeRegister(REG_CTRL7, 0x03)) return false;
+    delay(50);
+
+    attitude_enabled = false;
+    if (logger != nullptr) logger->info("IMU", "AttitudeEngine disabled");
+    return true;
+}
+
+bool IMU::readAttitudeDelta(Quaternion& dq, float dv[3]) {
+    // dQW..dVZ are contiguous (0x49..0x56): one 14-byte burst
+    uint8_t raw[14];
+    if (!readRegisters(REG_dQW_L, raw, 14)) return false;
+
+    dq.w = (int16_t)(raw[1] << 8 | raw[0]) * AE_DQ_SCALE;
+    dq.x = (int16_t)(raw[3] << 8 | raw[2]) * AE_DQ_SCALE;
+    dq.y = (int16_t)(raw[5] << 8 | raw[4]) * AE_DQ_SCALE;
+    dq.z = (int16_t)(raw[7] << 8 | raw[6]) * AE_DQ_SCALE;
+    dv[0] = (int16_t)(raw[9] << 8 | raw[8]) * AE_DV_SCALE;
+    dv[1] = (int16_t)(raw[11] << 8 | raw[10]) * AE_DV_SCALE;
+    dv[2] = (int16_t)(raw[13] << 8 | raw[12]) * AE_DV_SCALE;
+    return true;
+}
+
+bool IMU::updateAttitude() {
+    Lock lock(*this);
+    if (!initialized || !attitude_enabled) return false;
+
+    // STATUS0 bit 3: sDA (AttitudeEngine data available)
+    uint8_t status0 = 0;
+    if (!readRegister(REG_STATUS0, &status0)) return false;
+    if (!(status0 & 0x08)) return false;
+
+    Quaternion dq;
+    float dv[3];
+    if (!readAttitudeDelta(dq, dv)) return false;
+
+    attitude.orientation = attitude.orientation * dq;
+    attitude.orientation.normalize();
+    attitude.vx += dv[0];
+    attitude.vy += dv[1];
+    attitude.vz += dv[2];
+    attitude.updates++;
+    return true;
+}
+
+bool IMU::sendCtrl9Command(uint8_t cmd) {
+    if (!i2c.isAttached()) return false;
+
+    // Hold the bus for the whole handshake so nobody else's traffic lands between command and ack
+    I2CBus::Lock lock(*i2c.getBus(), i2c.getClock());
+    if (!writeRegister(REG_CTRL9, cmd)) return false;
+
+    // STATUSINT bit 7: CmdDone — set once the sensor has executed the command
+    uint8_t status = 0;
+    unsigned long start = millis();
+    while (!readRegister(REG_STATUSINT, &status) || !(status & 0x80)) {
+        if (millis() - start > 100) {
+            if (logger != nullptr) logger->failure("IMU", (String("CTRL9 command 0x") + String(cmd, HEX) + " timed out").c_str());
+            return false;
         }
+        delay(1);
     }
-    
-    return false;
+
+    // Acknowledge so the sensor clears CmdDone
+    if (!writeRegister(REG_CTRL9, CTRL_CMD_ACK)) return false;
+    start = millis();
+    while (readRegister(REG_STATUSINT, &status) && (status & 0x80)) {
+        if (millis() - start > 100) return false;
+        delay(1);
+    }
+    return true;
+}
+
+bool IMU::enableMotionWake(uint8_t modes, const MotionConfig& config) {
+    Lock lock(*this);
+    if (!initialized) return false;
+    modes &= (MOTION_ANY | MOTION_NO | MOTION_SIGNIFICANT);
+    if (modes == 0) return false;
+    // Taps stay live as a wake source; that keeps the accel out of low-power mode
+    if (tap_enabled) modes |= MOTION_TAP;
+
+    // Windows are in samples — stretch them so they cover the same time at the higher tap rate
+    const uint16_t scale = tap_enabled ? 6 : 1;
+    auto window8 = [scale](uint8_t w) -> uint8_t { uint16_t n = w * scale; return n > 0xFF ? 0xFF : n; };
+    auto window16 = [scale](uint16_t w) -> uint16_t { uint32_t n = (uint32_t)w * scale; return n > 0xFFFF ? 0xFFFF : n; };
+    uint16_t sig_wait = window16(config.sig_wait_window);
+    uint16_t sig_confirm = window16(config.sig_confirm_window);
+
+    // Thresholds are unsigned 3.5 fixed point: 1 LSB = 1/32 g
+    auto threshold = [](float g) -> uint8_t {
+        float counts = g * 32.0f;
+        if (counts < 1.0f) return 1;
+        if (counts > 255.0f) return 255;
+        return (uint8_t)counts;
+    };
+
+    // Motion engines may only be configured with the sensors disabled
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+    if (!writeRegister(REG_CTRL8, 0x00)) return false;
+    attitude_enabled = false;
+
+    // First pass (CAL1_L..CAL4_H): any/no-motion thresholds per axis
+    // CAL4_L MOTION_MODE_CTRL: [7] no-motion AND, [6:4] no-motion ZYX, [3] any-motion OR, [2:0] any-motion ZYX
+    uint8_t any = threshold(config.any_threshold_g);
+    uint8_t no = threshold(config.no_threshold_g);
+    const uint8_t thresholds[8] = { any, any, any, no, no, no, 0xF7, 0x01 };
+    if (!writeRegisters(REG_CAL1_L, thresholds, sizeof(thresholds)) || !sendCtrl9Command(CTRL_CMD_CONFIGURE_MOTION)) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to configure motion thresholds");
+        return false;
+    }
+
+    // Second pass: any/no-motion windows and significant-motion wait/confirm windows
+    const uint8_t windows[8] = {
+        window8(config.any_window), window8(config.no_window),
+        (uint8_t)(sig_wait & 0xFF), (uint8_t)(sig_wait >> 8),
+        (uint8_t)(sig_confirm & 0xFF), (uint8_t)(sig_confirm >> 8),
+        0x00, 0x02
+    };
+    if (!writeRegisters(REG_CAL1_L, windows, sizeof(windows)) || !sendCtrl9Command(CTRL_CMD_CONFIGURE_MOTION)) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to configure motion windows");
+        return false;
+    }
+
+    // Accelerometer: ±8g, aODR 1101 = 21Hz low-power mode (0110 normal mode when taps are on)
+    if (!writeRegister(REG_CTRL2, tap_enabled ? 0x26 : 0x2D)) return false;
+
+    // CTRL8: [6] = activity interrupts on INT1, [3:0] = engine enables
+    if (!writeRegister(REG_CTRL8, 0x40 | modes)) return false;
+
+    // CTRL7: [5] = data-ready disabled so INT1 only fires on motion events, [0] = aEN (gyro off)
+    if (!writeRegister(REG_CTRL7, 0x21)) return false;
+
+    readMotionEvents();  // Drop any stale event before the CPU goes to sleep
+    motion_wake_armed = true;
+    noteSampleRate(ImuRatePolicy::RATE_LOW);  // Same 21Hz accel-only operating point
+    if (logger != nullptr) logger->info("IMU", (String("Motion wake armed, engines=0x") + String(modes, HEX)).c_str());
+    return true;
+}
+
+bool IMU::disableMotionWake() {
+    Lock lock(*this);
+    if (!initialized) return false;
+
+    if (!restoreActiveConfig()) return false;
+
+    readMotionEvents();
+    motion_wake_armed = false;
+    return true;
+}
+
+bool IMU::restoreActiveConfig() {
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+    if (!writeRegister(REG_CTRL8, tap_enabled ? 0x41 : 0x00)) return false;
+
+    // Restore the setBus() configuration: ±8g / ±1024dps at 112Hz
+    RegSequence::Result result;
+    if (!RegSequence::run(i2c, ACTIVE_SEQUENCE, true, result, &ctrl_shadow)) return false;
+
+    // gpio_wakeup_enable() switches the pin to level triggering — re-attach the edge ISR
+    attachInterrupt(digitalPinToInterrupt(interrupt_pin), motionISR, RISING);
+
+    noteSampleRate(ImuRatePolicy::RATE_HIGH);
+    rate_policy.reset(sample_rate, millis());
+    gyro_ready_time = millis();
+    return true;
+}
+
+bool IMU::enableFifoBatching(uint8_t watermark) {
+    Lock lock(*this);
+    if (!initialized || motion_wake_armed) return false;
+    if (watermark == 0 || watermark > FIFO_CAPACITY) watermark = FIFO_CAPACITY;
+
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+    if (!writeRegister(REG_CTRL8, 0x00)) return false;
+    attitude_enabled = false;
+
+    // Accelerometer: ±8g, aODR 1101 = 21Hz low-power
+    if (!writeRegister(REG_CTRL2, 0x2D)) return false;
+
+    // FIFO_CTRL: [3:2] size 11 = 128 samples, [1:0] mode 10 = stream (oldest dropped when full)
+    fifo_ctrl = 0x0E;
+    if (!writeRegister(REG_FIFO_WTM_TH, watermark)) return false;
+    if (!writeRegister(REG_FIFO_CTRL, fifo_ctrl)) return false;
+    if (!sendCtrl9Command(CTRL_CMD_RST_FIFO)) return false;
+
+    // CTRL7: [5] = data-ready disabled so INT1 only fires on the watermark, [0] = aEN
+    if (!writeRegister(REG_CTRL7, 0x21)) return false;
+
+    fifo_batching = true;
+    noteSampleRate(ImuRatePolicy::RATE_LOW);
+    if (logger != nullptr) logger->info("IMU", (String("FIFO batching: watermark ") + String(watermark) + " samples").c_str());
+    return true;
+}
+
+bool IMU::disableFifoBatching() {
+    Lock lock(*this);
+    if (!initialized) return false;
+    if (!fifo_batching) return true;
+
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+    if (!writeRegister(REG_FIFO_CTRL, 0x00)) return false;  // Bypass
+    fifo_batching = false;
+    return restoreActiveConfig();
+}
+
+uint16_t IMU::readFifo(RawSample* samples, uint16_t max) {
+    Lock lock(*this);
+    if (!initialized || !fifo_batching) return 0;
+
+    // FIFO_SMPL_CNT + FIFO_STATUS[1:0]: fill level in 2-byte words
+    uint8_t level[2];
+    if (!readRegisters(REG_FIFO_SMPL_CNT, level, 2)) return 0;
+    uint16_t bytes = (((level[1] & 0x03) << 8) | level[0]) * 2;
+    uint16_t count = bytes / 6;
+    if (count > max) count = max;
+    if (count == 0) return 0;
+
+    // FIFO read mode: the sensor serves FIFO_DATA until rd_mode is cleared in FIFO_CTRL
+    I2CBus::Lock bus_lock(*i2c.getBus(), i2c.getClock());
+    if (!sendCtrl9Command(CTRL_CMD_REQ_FIFO)) return 0;
+
+    // Drain in chunks that fit the Wire buffer (20 samples = 120 bytes)
+    uint16_t done = 0;
+    uint8_t raw[120];
+    while (done < count) {
+        uint16_t chunk = count - done > 20 ? 20 : count - done;
+        if (!readRegisters(REG_FIFO_DATA, raw, chunk * 6)) break;
+        for (uint16_t i = 0; i < chunk; i++) {
+            decodeAccel(raw + i * 6, samples[done + i]);
+            samples[done + i].gx = samples[done + i].gy = samples[done + i].gz = 0;
+        }
+        done += chunk;
+    }
+
+    writeRegister(REG_FIFO_CTRL, fifo_ctrl);  // Leave read mode
+    return done;
+}
+
+uint8_t IMU::readMotionEvents() {
+    Lock lock(*this);
+    if (!initialized) return 0;
+
+    // STATUS1: [7] = significant motion, [6] = no motion, [5] = any motion (cleared on read)
+    uint8_t status1 = 0;
+    if (!readRegister(REG_STATUS1, &status1)) return 0;
+
+    uint8_t events = 0;
+    if (status1 & 0x20) events |= MOTION_ANY;
+    if (status1 & 0x40) events |= MOTION_NO;
+    if (status1 & 0x80) events |= MOTION_SIGNIFICANT;
+    if (status1 & 0x02) {
+        events |= MOTION_TAP;
+        latchTap(micros());  // INT1 woke the CPU via GPIO wakeup, not the ISR — stamp it now
+    }
+    return events;
+}
+
+void IMU::latchTap(uint32_t time_us) {
+    if (!readRegister(REG_TAP_STATUS, &tap_status)) return;
+    tap_pending = true;
+    tap_time_us = time_us;
+}
+
+bool IMU::readTap(TapEvent& event) {
+    Lock lock(*this);
+    if (!tap_pending) return false;
+    tap_pending = false;
+
+    // TAP_STATUS: [7] polarity (1 = negative), [5:4] axis (1 = X, 2 = Y, 3 = Z), [1:0] 1 = single, 2 = double
+    uint8_t taps = tap_status & 0x03;
+    uint8_t axis = (tap_status >> 4) & 0x03;
+    if (taps == 0 || taps == 3 || axis == 0) return false;
+
+    event.taps = taps;
+    event.axis = axis - 1;
+    event.negative = tap_status & 0x80;
+    event.time_us = tap_time_us;
+    return true;
+}
+
+uint8_t IMU::ctrl7Active() const {
+    if (attitude_enabled) return 0x0B;
+    return sample_rate == ImuRatePolicy::RATE_HIGH ? 0x03 : 0x01;
+}
+
+bool IMU::enableTap(const TapConfig& config) {
+    Lock lock(*this);
+    if (!initialized || motion_wake_armed) return false;
+
+    auto samples = [](uint16_t ms) -> uint16_t {
+        uint32_t n = (uint32_t)(ms * TAP_SAMPLE_HZ / 1000.0f + 0.5f);
+        return n < 1 ? 1 : n > 0xFFFF ? 0xFFFF : n;
+    };
+    uint16_t peak = samples(config.peak_window_ms);
+    uint16_t tap = samples(config.tap_window_ms);
+    uint16_t dtap = samples(config.dtap_window_ms);
+    // alpha/gamma are 1/128 steps, magnitude thresholds unsigned 5.10 g²
+    uint8_t alpha = (uint8_t)(config.alpha * 128.0f);
+    uint8_t gamma = (uint8_t)(config.gamma * 128.0f);
+    uint16_t peak_threshold = (uint16_t)(config.peak_threshold_g2 * 1024.0f);
+    uint16_t udm_threshold = (uint16_t)(config.udm_threshold_g2 * 1024.0f);
+
+    // Engines may only be configured with the sensors disabled
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+
+    // First pass: peak window, axis priority, tap and double-tap windows; CAL4_L reserved, CAL4_H = pass 1
+    const uint8_t first[8] = {
+        (uint8_t)(peak > 0xFF ? 0xFF : peak), config.priority,
+        (uint8_t)(tap & 0xFF), (uint8_t)(tap >> 8),
+        (uint8_t)(dtap & 0xFF), (uint8_t)(dtap >> 8),
+        0x00, 0x01
+    };
+    // Second pass: alpha, gamma, peak magnitude and undefined-motion thresholds; CAL4_H = pass 2
+    const uint8_t second[8] = {
+        alpha, gamma,
+        (uint8_t)(peak_threshold & 0xFF), (uint8_t)(peak_threshold >> 8),
+        (uint8_t)(udm_threshold & 0xFF), (uint8_t)(udm_threshold >> 8),
+        0x00, 0x02
+    };
+    if (!writeRegisters(REG_CAL1_L, first, sizeof(first)) || !sendCtrl9Command(CTRL_CMD_CONFIGURE_TAP) ||
+        !writeRegisters(REG_CAL1_L, second, sizeof(second)) || !sendCtrl9Command(CTRL_CMD_CONFIGURE_TAP)) {
+        if (logger != nullptr) logger->failure("IMU", "Failed to configure tap engine");
+        writeRegister(REG_CTRL7, ctrl7Active());
+        return false;
+    }
+
+    // Low rate must leave low-power mode for the tap engine
+    if (sample_rate == ImuRatePolicy::RATE_LOW && !writeRegister(REG_CTRL2, 0x26)) return false;
+
+    // CTRL8: [6] = activity interrupts on INT1, [0] = tap engine
+    if (!writeRegister(REG_CTRL8, 0x41)) return false;
+    if (!writeRegister(REG_CTRL7, ctrl7Active())) return false;
+    if (sample_rate == ImuRatePolicy::RATE_HIGH) gyro_ready_time = millis() + ImuRatePolicy::GYRO_STARTUP_MS;
+
+    tap_enabled = true;
+    tap_pending = false;
+    checkDataReadyStatus();  // Re-arm INT1
+    if (logger != nullptr) {
+        logger->info("IMU", (String("Tap engine enabled: peak ") + String(peak) + ", tap " + String(tap) + ", double " + String(dtap) + " samples").c_str());
+    }
+    return true;
+}
+
+bool IMU::disableTap() {
+    Lock lock(*this);
+    if (!initialized || motion_wake_armed) return false;
+    if (!tap_enabled) return true;
+
+    if (!writeRegister(REG_CTRL7, 0x00)) return false;
+    if (!writeRegister(REG_CTRL8, 0x00)) return false;
+    if (sample_rate == ImuRatePolicy::RATE_LOW && !writeRegister(REG_CTRL2, 0x2D)) return false;
+    if (!writeRegister(REG_CTRL7, ctrl7Active())) return false;
+    if (sample_rate == ImuRatePolicy::RATE_HIGH) gyro_ready_time = millis() + ImuRatePolicy::GYRO_STARTUP_MS;
+
+    tap_enabled = false;
+    tap_pending = false;
+    checkDataReadyStatus();
+    if (logger != nullptr) logger->info("IMU", "Tap engine disabled");
+    return true;
+}
+
+void IMU::setMotionThreshold(float threshold_g) {
+    motion_threshold = threshold_g;
+    // |a|² − |b|² = (|a| − |b|)(|a| + |b|), and |a| + |b| ≈ 2g around rest,
+    // so a magnitude change of Δ is roughly 2·g·Δ in the squared domain
+    motion_threshold_sq = 2u * ImuSample::ACCEL_COUNTS_PER_G * (uint32_t)accelCounts(threshold_g);
 }
@@ -1,27 +1,70 @@
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
 
 #include "config.h"
+#include "../i2c/i2c_bus.hpp"
+#include "../i2c/reg_sequence.hpp"
+#include "../i2c/reg_shadow.hpp"
 #include "../../logger/logger.hpp"
+#include "attitude.hpp"
+#include "imu_sample.hpp"
+#include "wrist_gesture.hpp"
+#include "gesture_classifier.hpp"
+#include "rate_policy.hpp"
 
 class IMU {
+public:
+    typedef void (*IrqHook)(void* ctx);   // Must be IRAM-safe
+
 private:
     static constexpr uint8_t ADDR_QMI8658 = 0x6B;
     static constexpr uint8_t CHIP_ID = 0x05;
     
-    TwoWire* i2c = nullptr;
+    SemaphoreHandle_t mutex = nullptr;   // Recursive; created in setBus()
+    I2CDevice i2c{"IMU", ADDR_QMI8658, I2C_FAST_HZ};
+    RegShadow ctrl_shadow{i2c, REG_CTRL1, REG_CTRL8 - REG_CTRL1 + 1};  // CTRL1..CTRL8 only change when we write them
+    static const RegStep INIT_SEQUENCE[];    // Reset + ±8g / ±1024dps at 112Hz
+    static const RegStep ACTIVE_SEQUENCE[];  // Back to the INIT_SEQUENCE sensor config
     Logger* logger = nullptr;
     bool initialized = false;
+    uint8_t revision_id = 0;
     uint8_t interrupt_pin = IMU_INT1;
     static volatile bool motion_detected;
     static volatile uint32_t isr_count;   // increments every data-ready ISR — use to verify INT1 fires
+    static volatile uint32_t last_isr_us; // micros() of the latest INT1 edge — timestamps latched events
     static void IRAM_ATTR motionISR();
+    static IrqHook irq_hook;              // Also called from the ISR, e.g. to wake the main loop
+    static void* irq_hook_ctx;
     
-    // Software motion detection
-    float last_accel_magnitude = 0.0f;
+    // Software motion detection (integer path: squared magnitude in raw counts²)
+    uint32_t last_accel_magnitude_sq = 0;
     float motion_threshold = 0.15f;  // g threshold for motion (walking ~0.2g, running ~0.5g)
-    unsigned long last_motion_time = 0;
+    uint32_t motion_threshold_sq = 0;
+
+    // Wrist gestures: one sample per pollWristGesture() feeds both raise and lower detection
+    WristGesture wrist_gesture;
+    GestureClassifier gesture_classifier;
+    uint8_t gesture_source = 0;  // GestureSource
+    uint8_t pending_gestures = 0;
+
+    // Output data rate: fixed 112Hz unless adaptive, then driven by rate_policy from pollWristGesture()
+    ImuRatePolicy rate_policy;
+    bool adaptive_rate = false;
+    ImuRatePolicy::Rate sample_rate = ImuRatePolicy::RATE_HIGH;
+    unsigned long rate_since = 0;
+    unsigned long gyro_ready_time = 0;  // Gyro fields are zeroed until power-up settles
+    uint32_t rate_residency_ms[ImuRatePolicy::RATE_COUNT] = {0, 0};
+    uint32_t rate_switches = 0;
+    void noteSampleRate(ImuRatePolicy::Rate rate);
+
+    // AttitudeEngine state (orientation integrated from device dQ/dV)
+    static constexpr float AE_DQ_SCALE = 1.0f / 16384.0f;  // dQ is Q1.14
+    static constexpr float AE_DV_SCALE = 1.0f / 1024.0f;   // dV LSB = 2^-10 m/s
+    bool attitude_enabled = false;
+
+    // Bias/offset/scale subtracted in the sample path (see ImuCalibrator)
+    ImuCalibration calibration;
+    bool accel_scaled = false;  // Skip the Q14 multiply while scale is identity
     
     // QMI8658 Register addresses
     enum Registers : uint8_t {
@@ -82,20 +125,52 @@ private:
         REG_dVY_H = 0x54,
         REG_dVZ_L = 0x55,
         REG_dVZ_H = 0x56,
+        REG_AE_REG1 = 0x57,
+        REG_AE_REG2 = 0x58,
+        REG_TAP_STATUS = 0x59,
         REG_RESET = 0x60,
     };
     
-    enum MotionInterruptMode : uint8_t {
-        MOTION_ANY = 0,         // Any motion
-        MOTION_NO = 1,          // No motion
-        MOTION_SIGNIFICANT = 2  // Significant motion
+    // CTRL9 host commands
+    enum Ctrl9Command : uint8_t {
+        CTRL_CMD_ACK = 0x00,
+        CTRL_CMD_RST_FIFO = 0x04,
+        CTRL_CMD_REQ_FIFO = 0x05,
+        CTRL_CMD_CONFIGURE_TAP = 0x0C,
+        CTRL_CMD_CONFIGURE_MOTION = 0x0E,
     };
     
+    bool motion_wake_armed = false;
+
+    // Tap engine: STATUS1 is read alongside STATUS0 on the data-ready path, TAP_STATUS only on a hit
+    static constexpr float TAP_SAMPLE_HZ = 112.1f;  // Engine windows count accel samples
+    bool tap_enabled = false;
+    bool tap_pending = false;
+    uint8_t tap_status = 0;
+    uint32_t tap_time_us = 0;
+    void latchTap(uint32_t time_us);
+    uint8_t ctrl7Active() const;  // CTRL7 for the current rate / AttitudeEngine state
+    bool restoreActiveConfig();   // Back to 112Hz accel + gyro with data-ready on INT1
+
+    // FIFO batching: accel-only samples collected by the sensor, drained on the watermark
+    static constexpr uint16_t FIFO_CAPACITY = 128;  // Samples (FIFO_CTRL size 11)
+    bool fifo_batching = false;
+    uint8_t fifo_ctrl = 0;
+    
     bool writeRegister(uint8_t reg, uint8_t value);
+    bool writeRegisters(uint8_t reg, const uint8_t* buffer, size_t len);
     bool readRegister(uint8_t reg, uint8_t* value);
     bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
+    bool readAttitudeDelta(Quaternion& dq, float dv[3]);
+    bool sendCtrl9Command(uint8_t cmd);
+
+    static int16_t clampCounts(int32_t v) { return v > 32767 ? 32767 : v < -32768 ? -32768 : (int16_t)v; }
+    void decodeAccel(const uint8_t* raw, ImuSample& sample) const;
 
 public:
+    // Raw sensor counts — what the detectors consume (unit helpers in imu_sample.hpp)
+    using RawSample = ImuSample;
+
     struct AccelData {
         float x;  // g
         float y;  // g
@@ -107,26 +182,161 @@ public:
         float y;  // dps
         float z;  // dps
     };
+
+    // Wrist gesture stage fed by pollWristGesture()
+    enum GestureSource : uint8_t {
+        GESTURE_HEURISTIC = 0,   // WristGesture thresholds
+        GESTURE_MODEL = 1        // GestureClassifier int8 decision tree
+    };
+
+    // Motion engines — values are the CTRL8 enable bits, combine with |
+    enum MotionInterruptMode : uint8_t {
+        MOTION_ANY = 0x02,          // Any motion
+        MOTION_NO = 0x04,           // No motion
+        MOTION_SIGNIFICANT = 0x08,  // Significant motion
+        MOTION_TAP = 0x01           // Tap engine — added automatically while enableTap() is active
+    };
+
+    // Tap engine parameters; windows are converted to samples at TAP_SAMPLE_HZ
+    struct TapConfig {
+        uint8_t priority = 0;               // Axis priority when several axes peak (0 = X > Y > Z)
+        uint16_t peak_window_ms = 60;       // Max width of a tap peak
+        uint16_t tap_window_ms = 200;       // Quiet time after a peak before it counts as a tap
+        uint16_t dtap_window_ms = 500;      // Second tap must start within this to make a double tap
+        float alpha = 0.0625f;              // Low-pass weight of the magnitude tracker
+        float gamma = 0.25f;                // Weight of the peak tracker
+        float peak_threshold_g2 = 0.8f;     // Peak |a|² excursion (g²) to start a tap
+        float udm_threshold_g2 = 0.4f;      // Undefined-motion threshold (g²) — larger motion cancels the tap
+    };
+
+    struct TapEvent {
+        uint8_t taps;       // 1 = single, 2 = double
+        uint8_t axis;       // 0 = X, 1 = Y, 2 = Z
+        bool negative;      // Polarity of the first peak
+        uint32_t time_us;   // micros() of the INT1 edge that delivered it (within one sample)
+    };
+
+    struct MotionConfig {
+        float any_threshold_g = 0.10f;      // Per-axis any-motion threshold (1/32 g resolution)
+        uint8_t any_window = 2;             // Consecutive samples above threshold
+        float no_threshold_g = 0.05f;       // Per-axis no-motion threshold
+        uint8_t no_window = 63;             // Consecutive samples below threshold
+        uint16_t sig_wait_window = 64;      // Samples to wait after any-motion before confirming
+        uint16_t sig_confirm_window = 128;  // Samples in which any-motion must re-occur
+    };
+
+    // AttitudeEngine output rate — CTRL6 sODR[2:0]
+    enum AttitudeRate : uint8_t {
+        AE_RATE_1HZ = 0,
+        AE_RATE_2HZ = 1,
+        AE_RATE_4HZ = 2,
+        AE_RATE_8HZ = 3,
+        AE_RATE_16HZ = 4,
+        AE_RATE_32HZ = 5,
+        AE_RATE_64HZ = 6
+    };
+
+    struct AttitudeData {
+        Quaternion orientation;   // Integrated from device dQ
+        float vx = 0.0f;          // Accumulated dV (m/s, body frame)
+        float vy = 0.0f;
+        float vz = 0.0f;
+        uint32_t updates = 0;     // Number of dQ/dV packets integrated
+    };
     
-    IMU(Logger* logger) : logger(logger) {}
+    IMU(Logger* logger) : logger(logger) { setMotionThreshold(motion_threshold); }
+
+    // The sensor task (core 0) reads samples while the loop (core 1) runs gestures, motion,
+    // the rate policy and sleep. Every public call below takes this lock; hold it to keep
+    // several calls together (e.g. the rate a sample was read at). Nests.
+    class Lock {
+    private:
+        IMU& imu;
+    public:
+        Lock(IMU& imu) : imu(imu) { if (imu.mutex) xSemaphoreTakeRecursive(imu.mutex, portMAX_DELAY); }
+        ~Lock() { if (imu.mutex) xSemaphoreGiveRecursive(imu.mutex); }
+        Lock(const Lock&) = delete;
+        Lock& operator=(const Lock&) = delete;
+    };
     
-    bool setBus(TwoWire& bus);
+    bool setBus(I2CBus& bus);
     bool isInitialized() const { return initialized; }
-    bool readAccel(AccelData& data);
-    bool readGyro(GyroData& data);
+    uint8_t getRevision() const { return revision_id; }  // REG_REVISION_ID, read in setBus()
+    const RegShadow::Stats& getShadowStats() const { return ctrl_shadow.getStats(); }
+    bool readRaw(RawSample& sample);  // Accel + gyro in one 12-byte burst, no float conversion
+    bool readRawAccel(RawSample& sample);  // Accel only (6 bytes); gyro fields untouched
+    bool readAccel(AccelData& data);  // Float g — display/logging only
+    bool readGyro(GyroData& data);    // Float dps — display/logging only
     bool readTemperature(float& temp);
     
     // Data ready interrupt
     bool isDataReady() { return motion_detected; }
+    void setIrqHook(IrqHook hook, void* ctx) { irq_hook_ctx = ctx; irq_hook = hook; }
+    void replayIrq() { motionISR(); }    // An edge missed while the pin was a sleep wake source
     void clearDataReadyFlag();    // Clears software flag AND reads STATUS0 to re-arm INT1
     bool checkDataReadyStatus();  // Poll STATUS0 register instead of interrupt
     uint32_t getIsrCount()  { return isr_count; }
     void resetIsrCount()    { isr_count = 0; }
+
+    void setGestureSource(GestureSource source);
+    GestureSource getGestureSource() const { return (GestureSource)gesture_source; }
+    void setGestureModel(const GestureClassifier::Model& model) { gesture_classifier.setModel(model); }
+
+    // Output data rate — RATE_LOW is accel-only 21Hz low-power, RATE_HIGH is accel + gyro at 112Hz
+    bool setSampleRate(ImuRatePolicy::Rate rate);
+    ImuRatePolicy::Rate getSampleRate() const { return sample_rate; }
+    float getSampleRateHz() const { return getRateHz(sample_rate); }
+    // Gyro powered and past GYRO_STARTUP_MS since it came on — its fields are real rotation
+    bool isGyroReady() const { return sample_rate == ImuRatePolicy::RATE_HIGH && (long)(millis() - gyro_ready_time) >= 0; }
+    float getRateHz(ImuRatePolicy::Rate rate) const;  // Real ODR — the tap engine holds RATE_LOW at 112Hz
+    void setAdaptiveRate(bool enabled);
+    bool isAdaptiveRate() const { return adaptive_rate; }
+    uint32_t getRateResidencyMs(ImuRatePolicy::Rate rate) const;  // Includes the current period
+    uint32_t getRateSwitches() const { return rate_switches; }
+    void resetRateStats();
+
+    // Calibration applied to every raw read
+    void setCalibration(const ImuCalibration& cal);
+    const ImuCalibration& getCalibration() const { return calibration; }
+
+    // AttitudeEngine: sensor fuses gyro/accel internally and outputs dQ/dV at the AE rate
+    bool enableAttitudeEngine(AttitudeRate rate = AE_RATE_64HZ);
+    bool disableAttitudeEngine();
+    bool isAttitudeEngineEnabled() const { return attitude_enabled; }
+    bool updateAttitude();  // Reads dQ/dV in one burst if sDA is set; returns true on new data
+    const AttitudeData& getAttitude() const { return attitude; }
+    void resetAttitude() { attitude = AttitudeData(); }
+
+    // Hardware motion engines on INT1: accel drops to 21Hz low-power, gyro and data-ready off
+    bool enableMotionWake(uint8_t modes, const MotionConfig& config);
+    bool enableMotionWake(uint8_t modes) { return enableMotionWake(modes, MotionConfig()); }
+    bool disableMotionWake();  // Restores 112Hz accel + gyro sampling and the data-ready ISR
+    bool isMotionWakeArmed() const { return motion_wake_armed; }
+    uint8_t readMotionEvents();  // Reads (and clears) STATUS1, returns MotionInterruptMode bits
+
+    // FIFO batching for low-duty-cycle logging: accel-only 21Hz low-power into the sensor FIFO,
+    // INT1 fires only at the watermark (data-ready off). Drain with readFifo() after each wake.
+    bool enableFifoBatching(uint8_t watermark = 96);
+    bool disableFifoBatching();
+    bool isFifoBatching() const { return fifo_batching; }
+    uint16_t readFifo(RawSample* samples, uint16_t max);  // Accel fields only; returns samples read
+
+    // Tap / double-tap engine on INT1 alongside data-ready; also a wake source in motion-wake mode
+    bool enableTap(const TapConfig& config);
+    bool enableTap() { return enableTap(TapConfig()); }
+    bool disableTap();
+    bool isTapEnabled() const { return tap_enabled; }
+    bool readTap(TapEvent& event);  // Returns (and consumes) the latest latched tap, no bus traffic
     
     // Software motion detection
-    bool checkMotion();  // Returns true if significant motion detected
+    // Rates are the caller's: the loop runs motion at 10Hz and gestures at 20Hz
+    bool checkMotion();  // Returns true if significant motion detected since the last call
+    void pollWristGesture();  // One sample into the gesture detectors
     bool checkWristTilt();  // Returns true if wrist raise/tilt gesture detected
     bool checkWristTiltDown();  // Returns true if arm lowered (watch down)
-    void setMotionThreshold(float threshold_g) { motion_threshold = threshold_g; }
+    void setMotionThreshold(float threshold_g);
     float getMotionThreshold() const { return motion_threshold; }
+
+private:
+    AttitudeData attitude;
 };
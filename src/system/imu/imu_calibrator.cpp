@@ -0,0 +1,246 @@
+#include "imu_calibrator.hpp"
+
+static bool parseTriple(const String& value, int16_t out[3]) {
+    int first = value.indexOf(',');
+    int second = value.indexOf(',', first + 1);
+    if (first < 0 || second < 0) return false;
+    out[0] = value.substring(0, first).toInt();
+    out[1] = value.substring(first + 1, second).toInt();
+    out[2] = value.substring(second + 1).toInt();
+    return true;
+}
+
+static String formatTriple(const int16_t v[3]) {
+    return String(v[0]) + "," + String(v[1]) + "," + String(v[2]);
+}
+
+bool ImuCalibrator::begin() {
+    if (!imu.isInitialized()) return false;
+
+    if (load()) {
+        imu.setCalibration(cal);
+
+        float temp;
+        if (gyro_valid && imu.readTemperature(temp) && fabsf(temp - cal_temp_c) > MAX_TEMP_DRIFT_C) {
+            gyro_stale = true;
+            if (logger) logger->info("IMUCAL", (String("Temperature moved ") + String(temp - cal_temp_c, 1) + "°C since calibration - refining gyro bias when still").c_str());
+        }
+        return true;
+    }
+
+    // No usable cache — update() estimates it from the live stream, nothing blocks here
+    if (logger) logger->info("IMUCAL", "No cached calibration - gyro bias will be estimated when the watch is still");
+    return false;
+}
+
+void ImuCalibrator::resetWindow() {
+    for (int i = 0; i < 6; i++) window.sum[i] = 0;
+    for (int i = 0; i < 3; i++) {
+        window.min[i] = 32767;
+        window.max[i] = -32768;
+    }
+    window.count = 0;
+}
+
+bool ImuCalibrator::addToWindow(const ImuSample& s) {
+    const int16_t gyro[3] = {s.gx, s.gy, s.gz};
+    for (int i = 0; i < 3; i++) {
+        if (gyro[i] < window.min[i]) window.min[i] = gyro[i];
+        if (gyro[i] > window.max[i]) window.max[i] = gyro[i];
+        if (window.max[i] - window.min[i] > STILL_GYRO_RANGE) {
+            resetWindow();
+            return false;
+        }
+    }
+
+    window.sum[0] += s.ax;
+    window.sum[1] += s.ay;
+    window.sum[2] += s.az;
+    window.sum[3] += s.gx;
+    window.sum[4] += s.gy;
+    window.sum[5] += s.gz;
+    window.count++;
+    return true;
+}
+
+bool ImuCalibrator::finishGyro() {
+    // Samples were already bias-corrected, so the mean is the residual
+    ImuCalibration next = cal;
+    for (int i = 0; i < 3; i++) {
+        int32_t bias = cal.gyro_bias[i] + window.sum[3 + i] / (int32_t)window.count;
+        if (bias > MAX_GYRO_BIAS || bias < -MAX_GYRO_BIAS) {
+            if (logger) logger->warn("IMUCAL", "Gyro bias out of range - treating window as motion");
+            resetWindow();
+            return false;
+        }
+        next.gyro_bias[i] = bias;
+    }
+    resetWindow();
+
+    cal = next;
+    imu.setCalibration(cal);
+    gyro_valid = true;
+    gyro_stale = false;
+    imu.readTemperature(cal_temp_c);
+
+    if (logger) {
+        logger->success("IMUCAL", (String("Gyro bias: ") + String(countsToDps(cal.gyro_bias[0]), 2) + ", " + String(countsToDps(cal.gyro_bias[1]), 2) + ", " +
+                                   String(countsToDps(cal.gyro_bias[2]), 2) + " dps").c_str());
+    }
+    save();
+    return true;
+}
+
+bool ImuCalibrator::collectStill(uint32_t timeout_ms) {
+    resetWindow();
+    uint32_t start = millis();
+    while (millis() - start < timeout_ms) {
+        if (!imu.checkDataReadyStatus()) {
+            delay(2);
+            continue;
+        }
+        ImuSample sample;
+        if (!imu.readRaw(sample)) continue;
+        addToWindow(sample);
+        if (window.count >= STILL_SAMPLES) return true;
+    }
+    return false;
+}
+
+bool ImuCalibrator::calibrateGyro(uint32_t timeout_ms) {
+    if (!collectStill(timeout_ms)) return false;
+    return finishGyro();
+}
+
+bool ImuCalibrator::needsSamples() const {
+    return !gyro_valid || gyro_stale;
+}
+
+void ImuCalibrator::update(const ImuSample& sample) {
+    if (!needsSamples()) return;
+    if (addToWindow(sample) && window.count >= STILL_SAMPLES) finishGyro();
+}
+
+const char* ImuCalibrator::poseName(uint8_t pose) {
+    static const char* names[6] = {"+X", "-X", "+Y", "-Y", "+Z", "-Z"};
+    return pose < 6 ? names[pose] : "?";
+}
+
+bool ImuCalibrator::calibrateAccel(uint32_t timeout_ms) {
+    if (!imu.isInitialized()) return false;
+
+    // Poses are measured uncorrected — keep the gyro bias, drop accel corrections
+    ImuCalibration measuring = cal;
+    for (int i = 0; i < 3; i++) {
+        measuring.accel_offset[i] = 0;
+        measuring.accel_scale[i] = ImuCalibration::SCALE_ONE;
+    }
+    imu.setCalibration(measuring);
+
+    if (logger) logger->info("IMUCAL", "Accel calibration: hold the watch still with each face pointing down in turn (6 poses)");
+
+    pose_mask = 0;
+    uint32_t start = millis();
+    while (pose_mask != ALL_POSES && millis() - start < timeout_ms) {
+        if (!collectStill(timeout_ms - (millis() - start))) break;
+
+        int32_t mean[3];
+        for (int i = 0; i < 3; i++) mean[i] = window.sum[i] / (int32_t)window.count;
+
+        // Pose = dominant axis and its sign
+        int axis = 0;
+        for (int i = 1; i < 3; i++) {
+            if (abs(mean[i]) > abs(mean[axis])) axis = i;
+        }
+        if (abs(mean[axis]) < POSE_MIN) continue;
+        uint8_t pose = axis * 2 + (mean[axis] < 0 ? 1 : 0);
+        if (pose_mask & (1 << pose)) continue;
+
+        for (int i = 0; i < 3; i++) pose_mean[pose][i] = mean[i];
+        pose_mask |= 1 << pose;
+        if (logger) logger->info("IMUCAL", (String("Captured pose ") + poseName(pose) + " (" + String(__builtin_popcount(pose_mask)) + "/6)").c_str());
+    }
+
+    if (pose_mask != ALL_POSES) {
+        imu.setCalibration(cal);
+        if (logger) logger->warn("IMUCAL", "Accel calibration timed out - keeping previous values");
+        return false;
+    }
+
+    // Offset is the midpoint of ±1g on each axis, scale maps the span to 2g
+    ImuCalibration next = cal;
+    for (int axis = 0; axis < 3; axis++) {
+        int32_t plus = pose_mean[axis * 2][axis];
+        int32_t minus = pose_mean[axis * 2 + 1][axis];
+        int32_t span = plus - minus;
+        next.accel_offset[axis] = (plus + minus) / 2;
+        next.accel_scale[axis] = (int16_t)(((int32_t)2 * ImuSample::ACCEL_COUNTS_PER_G * ImuCalibration::SCALE_ONE) / span);
+    }
+
+    cal = next;
+    accel_valid = true;
+    imu.setCalibration(cal);
+    if (logger) {
+        logger->success("IMUCAL", (String("Accel offset: ") + formatTriple(cal.accel_offset) + " counts, scale (Q14): " + formatTriple(cal.accel_scale)).c_str());
+    }
+    save();
+    return true;
+}
+
+bool ImuCalibrator::load() {
+    if (!fs.isInitialized() || !fs.exists(IMU_CALIBRATION_FILE)) return false;
+
+    String text = fs.readFile(IMU_CALIBRATION_FILE);
+    ImuCalibration loaded;
+    bool rev_ok = false, has_gyro = false, has_accel = false;
+    float temp = 0.0f;
+
+    int pos = 0;
+    while (pos < (int)text.length()) {
+        int end = text.indexOf('\n', pos);
+        if (end < 0) end = text.length();
+        String line = text.substring(pos, end);
+        line.trim();
+        pos = end + 1;
+
+        int eq = line.indexOf('=');
+        if (line.startsWith("#") || eq < 0) continue;
+        String key = line.substring(0, eq);
+        String value = line.substring(eq + 1);
+
+        if (key == "rev") rev_ok = value.toInt() == imu.getRevision();
+        else if (key == "temp") temp = value.toFloat();
+        else if (key == "gyro") has_gyro = parseTriple(value, loaded.gyro_bias);
+        else if (key == "accel_offset") has_accel = parseTriple(value, loaded.accel_offset);
+        else if (key == "accel_scale") has_accel = has_accel && parseTriple(value, loaded.accel_scale);
+    }
+
+    if (!rev_ok) {
+        if (logger) logger->warn("IMUCAL", "Cached calibration is for a different chip revision - ignoring");
+        return false;
+    }
+    if (!has_gyro) return false;
+
+    cal = loaded;
+    cal_temp_c = temp;
+    gyro_valid = true;
+    accel_valid = has_accel;
+    if (logger) {
+        logger->success("IMUCAL", (String("Loaded calibration: gyro ") + formatTriple(cal.gyro_bias) + (accel_valid ? " + accel" : "")).c_str());
+    }
+    return true;
+}
+
+bool ImuCalibrator::save() {
+    if (!fs.isInitialized()) return false;
+
+    String text = "# QMI8658 calibration (raw counts, accel scale Q14)\n";
+    text += "rev=" + String(imu.getRevision()) + "\n";
+    text += "temp=" + String(cal_temp_c, 1) + "\n";
+    text += "gyro=" + formatTriple(cal.gyro_bias) + "\n";
+    if (accel_valid) {
+        text += "accel_offset=" + formatTriple(cal.accel_offset) + "\n";
+        text += "accel_scale=" + formatTriple(cal.accel_scale) + "\n";
+    }
+    return fs.writeFile(IMU_CALIBRATION_FILE, text);
+}
@@ -0,0 +1,76 @@
+#pragma once
+#include <Arduino.h>
+#include "../../logger/logger.hpp"
+#include "../storage/fs_manager.hpp"
+#include "imu.hpp"
+
+#define IMU_CALIBRATION_FILE    "/imu_cal.txt"
+
+/**
+ * IMU calibration service.
+ *  - Gyro bias: averaged over ~2s of stillness from the live sample stream
+ *    via update(), or on demand with the blocking calibrateGyro().
+ *  - Accel offset/scale (optional): six-pose calibration, one pose per axis
+ *    direction, held still.
+ * Results are cached in LittleFS keyed by REG_REVISION_ID and handed to
+ * IMU::setCalibration(), which subtracts them in the raw read path.
+ */
+class ImuCalibrator {
+private:
+    static constexpr uint16_t STILL_SAMPLES = 224;               // ~2s at 112Hz
+    static constexpr int16_t STILL_GYRO_RANGE = gyroCounts(3.0f); // Max per-axis peak-to-peak while still
+    static constexpr int16_t MAX_GYRO_BIAS = gyroCounts(30.0f);   // Reject anything larger as motion
+    static constexpr int16_t POSE_MIN = accelCounts(0.8f);        // Dominant axis must see at least this
+    static constexpr float MAX_TEMP_DRIFT_C = 15.0f;              // Re-estimate gyro bias beyond this
+    static constexpr uint8_t ALL_POSES = 0x3F;
+
+    // Still-window accumulator shared by boot, streaming and pose capture
+    struct Window {
+        int32_t sum[6];
+        int16_t min[3];
+        int16_t max[3];
+        uint16_t count;
+    };
+
+    Logger* logger = nullptr;
+    IMU& imu;
+    FSManager& fs;
+
+    ImuCalibration cal;
+    bool gyro_valid = false;
+    bool gyro_stale = false;      // Cached bias came from a different temperature
+    bool accel_valid = false;
+    float cal_temp_c = 0.0f;
+
+    Window window;
+    int32_t pose_mean[6][3];      // Uncorrected accel means per pose (+X, -X, +Y, -Y, +Z, -Z)
+    uint8_t pose_mask = 0;
+
+    void resetWindow();
+    bool addToWindow(const ImuSample& sample);  // Returns false (and restarts) on motion
+    bool finishGyro();                          // Folds the window mean into the bias
+    bool collectStill(uint32_t timeout_ms);     // Blocking poll until a full still window
+    static const char* poseName(uint8_t pose);
+
+    bool load();
+    bool save();
+
+public:
+    ImuCalibrator(Logger* logger, IMU& imu, FSManager& fs) : logger(logger), imu(imu), fs(fs) {}
+
+    // Loads the cached calibration; without one, update() estimates the gyro bias from the stream
+    bool begin();
+
+    // Blocking gyro bias estimate — the watch must lie still
+    bool calibrateGyro(uint32_t timeout_ms = 3000);
+
+    // Streaming refinement: feed full (accel + gyro) samples while needsSamples()
+    void update(const ImuSample& sample);
+    bool needsSamples() const;
+
+    // Six-pose accel calibration, blocking; prompts via the logger
+    bool calibrateAccel(uint32_t timeout_ms = 60000);
+
+    bool isGyroCalibrated() const { return gyro_valid; }
+    bool isAccelCalibrated() const { return accel_valid; }
+};
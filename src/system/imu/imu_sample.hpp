@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+
+// Raw QMI8658 counts for one accel + gyro sample.
+// Full-scale ranges must match CTRL2 aFS / CTRL3 gFS as configured in IMU::setBus().
+struct ImuSample {
+    static constexpr int32_t ACCEL_FS_G = 8;
+    static constexpr int32_t GYRO_FS_DPS = 1024;
+    static constexpr int32_t ACCEL_COUNTS_PER_G = 32768 / ACCEL_FS_G;
+    static constexpr int32_t GYRO_COUNTS_PER_DPS = 32768 / GYRO_FS_DPS;
+
+    int16_t ax, ay, az;
+    int16_t gx, gy, gz;
+};
+
+// Threshold conversion for the integer detector path — use in constexpr context
+constexpr int16_t accelCounts(float g) { return (int16_t)(g * ImuSample::ACCEL_COUNTS_PER_G); }
+constexpr int16_t gyroCounts(float dps) { return (int16_t)(dps * ImuSample::GYRO_COUNTS_PER_DPS); }
+
+// Float conversion — display and logging only
+constexpr float countsToG(int16_t counts) { return counts * (1.0f / ImuSample::ACCEL_COUNTS_PER_G); }
+constexpr float countsToDps(int16_t counts) { return counts * (1.0f / ImuSample::GYRO_COUNTS_PER_DPS); }
+
+// |a|² in counts² — each term ≤ 2^30, so the sum of three fits in 32 bits unsigned
+inline uint32_t magnitudeSquared(const ImuSample& s) {
+    return (uint32_t)((int32_t)s.ax * s.ax) + (uint32_t)((int32_t)s.ay * s.ay) + (uint32_t)((int32_t)s.az * s.az);
+}
+
+// |a| − 1g in g from |a|², no square root: (|a|² − 1) / 2 overstates a deviation d by d²/2
+// (0.005g at ±0.1g). Above ~11g (past 2^31 counts²) it saturates.
+inline float magnitudeDeviationG(uint32_t magnitude_sq) {
+    constexpr int32_t ONE_G_SQ = ImuSample::ACCEL_COUNTS_PER_G * ImuSample::ACCEL_COUNTS_PER_G;
+    int32_t excess = (int32_t)(magnitude_sq > 0x7FFFFFFFu ? 0x7FFFFFFFu : magnitude_sq) - ONE_G_SQ;
+    return excess * (1.0f / (2.0f * ONE_G_SQ));
+}
+
+// Per-axis corrections in raw counts, applied by IMU::readRaw()/readRawAccel().
+// Accel: corrected = (raw - offset) * scale, scale in Q14 (SCALE_ONE = 1.0).
+struct ImuCalibration {
+    static constexpr int16_t SCALE_ONE = 16384;
+
+    int16_t gyro_bias[3] = {0, 0, 0};
+    int16_t accel_offset[3] = {0, 0, 0};
+    int16_t accel_scale[3] = {SCALE_ONE, SCALE_ONE, SCALE_ONE};
+
+    bool hasAccelScale() const {
+        return accel_scale[0] != SCALE_ONE || accel_scale[1] != SCALE_ONE || accel_scale[2] != SCALE_ONE;
+    }
+};
@@ -0,0 +1,289 @@
+#include "imu_trace.hpp"
+#include "wrist_gesture.hpp"
+#include "gesture_classifier.hpp"
+
+bool ImuTrace::start(SDCard& sd, const char* path, float odr_hz) {
+    if (recording) stop();
+    if (!sd.isInitialized()) {
+        if (logger) logger->error("TRACE", "SD card not available");
+        return false;
+    }
+
+    file = sd.open(path, FILE_WRITE);
+    if (!file) {
+        if (logger) logger->error("TRACE", (String("Failed to create ") + path).c_str());
+        return false;
+    }
+
+    start_ms = millis();
+    Header header;
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.record_size = sizeof(Record);
+    header.accel_fs_g = ImuSample::ACCEL_FS_G;
+    header.gyro_fs_dps = ImuSample::GYRO_FS_DPS;
+    header.odr_hz = odr_hz;
+    header.start_ms = start_ms;
+    if (file.write((const uint8_t*)&header, sizeof(header)) != sizeof(header)) {
+        if (logger) logger->error("TRACE", "Failed to write header");
+        file.close();
+        return false;
+    }
+
+    buffered = 0;
+    records = 0;
+    dropped = 0;
+    write_max_us = 0;
+    recording = true;
+    if (logger) logger->info("TRACE", (String("Recording IMU trace to ") + path).c_str());
+    return true;
+}
+
+void ImuTrace::record(const ImuSample& sample, uint32_t now_ms) {
+    if (!recording) return;
+
+    Record& r = buffer[buffered++];
+    r.t_ms = now_ms - start_ms;
+    r.sample = sample;
+    records++;
+
+    if (buffered == BUFFER_RECORDS) flush();
+}
+
+void ImuTrace::flush() {
+    if (!recording || buffered == 0) return;
+
+    uint32_t t0 = micros();
+    size_t bytes = buffered * sizeof(Record);
+    if (file.write((const uint8_t*)buffer, bytes) != bytes) dropped += buffered;
+    uint32_t elapsed = micros() - t0;
+    if (elapsed > write_max_us) write_max_us = elapsed;
+
+    buffered = 0;
+}
+
+void ImuTrace::stop() {
+    if (!recording) return;
+    flush();
+    file.close();
+    recording = false;
+    if (logger) {
+        logger->info("TRACE", (String("Trace closed: ") + String(records) + " records, " + String(dropped) + " dropped, max write " + String(write_max_us) + "us").c_str());
+    }
+}
+
+size_t ImuTrace::loadLabels(SDCard& sd, const char* path, Label* labels, size_t max) {
+    String labels_path = String(path) + ".labels";
+    if (!sd.exists(labels_path.c_str())) return 0;
+
+    String text = sd.readFile(labels_path.c_str());
+    size_t count = 0;
+    int pos = 0;
+    while (pos < (int)text.length() && count < max) {
+        int end = text.indexOf('\n', pos);
+        if (end < 0) end = text.length();
+        String line = text.substring(pos, end);
+        line.trim();
+        pos = end + 1;
+
+        int space = line.indexOf(' ');
+        if (space < 0) continue;
+        String kind = line.substring(0, space);
+        uint8_t event = kind == "raise" ? WristGesture::RAISE : kind == "lower" ? WristGesture::LOWER : WristGesture::NONE;
+        if (event == WristGesture::NONE) continue;
+
+        labels[count].event = event;
+        labels[count].t_ms = line.substring(space + 1).toInt();
+        labels[count].matched = 0;
+        count++;
+    }
+    return count;
+}
+
+void ImuTrace::scoreEvents(uint8_t events, uint32_t t_ms, bool have_onset, uint32_t onset,
+                           Label* labels, size_t label_count, uint8_t lane, LaneStats& stats) {
+    for (uint8_t event = WristGesture::RAISE; event <= WristGesture::LOWER; event <<= 1) {
+        if (!(events & event)) continue;
+        if (event == WristGesture::RAISE) stats.raises++;
+        else stats.lowers++;
+
+        if (have_onset) {
+            uint32_t latency = t_ms - onset;
+            stats.latency_count++;
+            stats.latency_sum_ms += latency;
+            if (latency > stats.latency_max_ms) stats.latency_max_ms = latency;
+        }
+
+        bool matched = false;
+        for (size_t l = 0; l < label_count && !matched; l++) {
+            Label& label = labels[l];
+            if ((label.matched & lane) || label.event != event) continue;
+            if (t_ms + MATCH_BEFORE_MS >= label.t_ms && t_ms <= label.t_ms + MATCH_AFTER_MS) {
+                label.matched |= lane;
+                matched = true;
+            }
+        }
+        if (matched) stats.matched++;
+        else if (label_count > 0) stats.false_positives++;
+    }
+}
+
+void ImuTrace::logLane(const char* name, const LaneStats& stats, size_t label_count, uint32_t duration_ms) {
+    logger->info("TRACE", (String(name) + ": " + String(stats.raises) + " raise, " + String(stats.lowers) + " lower").c_str());
+    if (stats.latency_count > 0) {
+        logger->info("TRACE", (String(name) + " latency from motion onset: avg " + String(stats.latencyAvgMs()) + "ms, max " + String(stats.latency_max_ms) + "ms").c_str());
+    }
+    if (label_count > 0) {
+        float hours = duration_ms / 3600000.0f;
+        logger->info("TRACE", (String(name) + " labels: matched " + String(stats.matched) + ", missed " + String(stats.missed) + ", false positives " +
+                               String(stats.false_positives) + (hours > 0 ? String(" (") + String(stats.false_positives / hours, 1) + "/h)" : String(""))).c_str());
+    }
+}
+
+bool ImuTrace::replay(SDCard& sd, const char* path, ReplayReport& report) {
+    report = ReplayReport();
+
+    File in = sd.open(path, FILE_READ);
+    if (!in) {
+        if (logger) logger->error("TRACE", (String("Cannot open ") + path).c_str());
+        return false;
+    }
+
+    Header header;
+    if (in.read((uint8_t*)&header, sizeof(header)) != sizeof(header) ||
+        header.magic != MAGIC || header.version != VERSION || header.record_size != sizeof(Record)) {
+        if (logger) logger->error("TRACE", "Not an IMU trace (bad header)");
+        in.close();
+        return false;
+    }
+    if (header.accel_fs_g != ImuSample::ACCEL_FS_G || header.gyro_fs_dps != ImuSample::GYRO_FS_DPS) {
+        if (logger) logger->error("TRACE", "Trace full-scale range differs from the detector thresholds");
+        in.close();
+        return false;
+    }
+
+    static constexpr uint8_t LANE_FIXED = 0x01;
+    static constexpr uint8_t LANE_ADAPTIVE = 0x02;
+    static constexpr uint8_t LANE_MODEL = 0x04;
+
+    Label labels[MAX_LABELS];
+    size_t label_count = loadLabels(sd, path, labels, MAX_LABELS);
+    report.labels = label_count;
+
+    WristGesture fixed;
+    WristGesture adaptive;
+    GestureClassifier model;
+    ImuRatePolicy policy;
+    ImuRatePolicy::Rate rate = ImuRatePolicy::RATE_HIGH;
+    uint32_t rate_since = 0;
+    uint32_t gyro_ready = 0;
+    bool policy_started = false;
+    ImuSample low_sample = {};     // Latest sample on the 21Hz grid
+    uint32_t next_low_tick = 0;
+
+    bool polled_any = false;
+    uint32_t last_poll = 0;
+    bool rotating = false;
+    uint32_t last_rotation = 0;
+    bool have_onset = false;
+    uint32_t onset = 0;
+
+    // Reuse the capture buffer — replay and capture never run together
+    size_t got;
+    while ((got = in.read((uint8_t*)buffer, sizeof(buffer)) / sizeof(Record)) > 0) {
+        for (size_t i = 0; i < got; i++) {
+            const Record& r = buffer[i];
+            report.records++;
+            report.duration_ms = r.t_ms;
+
+            // Motion onset: first strong rotation after a quiet period
+            if (WristGesture::isStrongRotation(r.sample)) {
+                if (!rotating || r.t_ms - last_rotation >= ONSET_QUIET_MS) {
+                    onset = r.t_ms;
+                    have_onset = true;
+                }
+                rotating = true;
+                last_rotation = r.t_ms;
+            }
+
+            if (r.t_ms >= next_low_tick) {
+                low_sample = r.sample;
+                next_low_tick = r.t_ms + (uint32_t)(1000.0f / ImuRatePolicy::LOW_HZ);
+            }
+
+            if (polled_any && r.t_ms - last_poll < POLL_INTERVAL_MS) continue;
+            polled_any = true;
+            last_poll = r.t_ms;
+            report.polled++;
+
+            uint32_t c0 = ESP.getCycleCount();
+            uint8_t events = fixed.update(r.sample, r.t_ms);
+            report.fixed.cycles += ESP.getCycleCount() - c0;
+            scoreEvents(events, r.t_ms, have_onset, onset, labels, label_count, LANE_FIXED, report.fixed);
+
+            c0 = ESP.getCycleCount();
+            events = model.update(r.sample, r.t_ms);
+            report.model.cycles += ESP.getCycleCount() - c0;
+            scoreEvents(events, r.t_ms, have_onset, onset, labels, label_count, LANE_MODEL, report.model);
+
+            // Adaptive lane: same poll, but gyro reads as zero while powered down or settling
+            if (!policy_started) {
+                policy.reset(rate, r.t_ms);
+                rate_since = r.t_ms;
+                policy_started = true;
+            }
+            ImuSample sample = rate == ImuRatePolicy::RATE_LOW ? low_sample : r.sample;
+            if (rate == ImuRatePolicy::RATE_LOW || r.t_ms < gyro_ready) sample.gx = sample.gy = sample.gz = 0;
+
+            c0 = ESP.getCycleCount();
+            ImuRatePolicy::Rate wanted = policy.update(sample, r.t_ms);
+            if (wanted != rate) {
+                (rate == ImuRatePolicy::RATE_LOW ? report.low_ms : report.high_ms) += r.t_ms - rate_since;
+                rate_since = r.t_ms;
+                rate = wanted;
+                report.rate_switches++;
+                if (rate == ImuRatePolicy::RATE_HIGH) gyro_ready = r.t_ms + ImuRatePolicy::GYRO_STARTUP_MS;
+            }
+            events = adaptive.update(sample, r.t_ms);
+            report.adaptive.cycles += ESP.getCycleCount() - c0;
+            scoreEvents(events, r.t_ms, have_onset, onset, labels, label_count, LANE_ADAPTIVE, report.adaptive);
+        }
+    }
+    in.close();
+    (rate == ImuRatePolicy::RATE_LOW ? report.low_ms : report.high_ms) += report.duration_ms - rate_since;
+
+    for (size_t l = 0; l < label_count; l++) {
+        if (!(labels[l].matched & LANE_FIXED)) report.fixed.missed++;
+        if (!(labels[l].matched & LANE_ADAPTIVE)) report.adaptive.missed++;
+        if (!(labels[l].matched & LANE_MODEL)) report.model.missed++;
+    }
+
+    uint32_t total_ms = report.low_ms + report.high_ms;
+    if (total_ms > 0) {
+        report.adaptive_avg_hz = (report.low_ms * ImuRatePolicy::LOW_HZ + report.high_ms * ImuRatePolicy::HIGH_HZ) / total_ms;
+    }
+    report.latency_ok = report.adaptive.latencyAvgMs() <= report.fixed.latencyAvgMs() + LATENCY_BUDGET_MS &&
+                        report.adaptive.missed <= report.fixed.missed;
+
+    if (logger) {
+        logger->info("TRACE", (String("Replay ") + path + ": " + String(report.records) + " records, " + String(report.duration_ms / 1000.0f, 1) + "s, " + String(report.polled) + " polled").c_str());
+        logLane("Fixed 112Hz", report.fixed, label_count, report.duration_ms);
+        logLane("Adaptive", report.adaptive, label_count, report.duration_ms);
+        logLane("Model", report.model, label_count, report.duration_ms);
+        if (label_count == 0) logger->info("TRACE", "No .labels sidecar - false-positive rate not available");
+
+        logger->info("TRACE", (String("Adaptive ODR: avg ") + String(report.adaptive_avg_hz, 1) + "Hz vs " + String(ImuRatePolicy::HIGH_HZ, 1) + "Hz, low " +
+                               String(report.low_ms) + "ms / high " + String(report.high_ms) + "ms, " + String(report.rate_switches) + " switches").c_str());
+        if (report.latency_ok) {
+            logger->success("TRACE", (String("Adaptive latency within ") + String(LATENCY_BUDGET_MS) + "ms budget").c_str());
+        } else {
+            logger->failure("TRACE", (String("Adaptive latency/misses over budget (") + String(LATENCY_BUDGET_MS) + "ms)").c_str());
+        }
+        if (report.polled > 0) {
+            logger->info("TRACE", (String("Detector CPU: ") + String((uint32_t)(report.fixed.cycles / report.polled)) + " cycles/poll fixed, " +
+                                   String((uint32_t)(report.adaptive.cycles / report.polled)) + " adaptive, " +
+                                   String((uint32_t)(report.model.cycles / report.polled)) + " model (per window)").c_str());
+        }
+    }
+    return true;
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <Arduino.h>
+#include "../../logger/logger.hpp"
+#include "../storage/sd_card.hpp"
+#include "imu_sample.hpp"
+#include "rate_policy.hpp"
+
+/**
+ * Binary capture of timestamped raw IMU samples to the SD card, plus a replay
+ * harness that runs WristGesture over a captured trace.
+ *
+ * File layout (little-endian):
+ *   Header  "IMUT", version, record size, accel FS (g), gyro FS (dps), ODR (Hz), start millis()
+ *   Record  t_ms (uint32, relative to start) + ax ay az gx gy gz (int16 counts) = 16 bytes
+ *
+ * Records are buffered and written in 512-byte blocks so capture costs a memcpy
+ * per sample and one SD write every 32 samples.
+ *
+ * Optional labels live next to the trace in "<trace>.labels", one per line:
+ *   raise <t_ms>
+ *   lower <t_ms>
+ */
+class ImuTrace {
+public:
+    static constexpr uint32_t MAGIC = 0x54554D49;  // "IMUT"
+    static constexpr uint16_t VERSION = 1;
+
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t record_size;
+        uint16_t accel_fs_g;
+        uint16_t gyro_fs_dps;
+        float odr_hz;
+        uint32_t start_ms;
+    };
+
+    struct Record {
+        uint32_t t_ms;
+        ImuSample sample;
+    };
+
+    static_assert(sizeof(Header) == 20, "ImuTrace header layout changed");
+    static_assert(sizeof(Record) == 16, "ImuTrace record layout changed");
+
+    // Detector results for one replay lane
+    struct LaneStats {
+        uint32_t raises = 0;
+        uint32_t lowers = 0;
+        uint32_t matched = 0;
+        uint32_t missed = 0;
+        uint32_t false_positives = 0;
+        uint32_t latency_count = 0;   // Detections with a known motion onset
+        uint32_t latency_sum_ms = 0;
+        uint32_t latency_max_ms = 0;
+        uint64_t cycles = 0;          // Detector CPU time, excluding SD reads
+
+        uint32_t latencyAvgMs() const { return latency_count ? latency_sum_ms / latency_count : 0; }
+    };
+
+    struct ReplayReport {
+        uint32_t records = 0;
+        uint32_t polled = 0;          // Records fed to the detector after 50ms decimation
+        uint32_t duration_ms = 0;
+        uint32_t labels = 0;
+        LaneStats fixed;              // Detector at the fixed 112Hz rate (the trace as captured)
+        LaneStats adaptive;           // Same detector behind a simulated ImuRatePolicy
+        LaneStats model;              // GestureClassifier (int8 tree) at the fixed rate
+        uint32_t low_ms = 0;          // Simulated residency at each rate
+        uint32_t high_ms = 0;
+        uint32_t rate_switches = 0;
+        float adaptive_avg_hz = 0.0f;
+        bool latency_ok = false;      // Adaptive average latency within LATENCY_BUDGET_MS of fixed
+    };
+
+    static constexpr uint32_t LATENCY_BUDGET_MS = 150;  // Extra gesture latency allowed for adaptive ODR
+
+private:
+    static constexpr size_t BUFFER_RECORDS = 32;        // 512 bytes — one SD sector
+    static constexpr uint32_t POLL_INTERVAL_MS = 50;    // Same rate as IMU::pollWristGesture()
+    static constexpr uint32_t ONSET_QUIET_MS = 500;     // Rotation after this much quiet starts a motion
+    static constexpr uint32_t MATCH_BEFORE_MS = 500;    // Detection may precede its label by this much
+    static constexpr uint32_t MATCH_AFTER_MS = 1500;    // ...or trail it by this much
+    static constexpr size_t MAX_LABELS = 64;
+
+    Logger* logger = nullptr;
+    File file;
+    bool recording = false;
+    uint32_t start_ms = 0;
+
+    Record buffer[BUFFER_RECORDS];
+    size_t buffered = 0;
+    uint32_t records = 0;
+    uint32_t dropped = 0;             // Records lost to failed SD writes
+    uint32_t write_max_us = 0;        // Slowest block write
+
+    struct Label {
+        uint8_t event;                // WristGesture::Event
+        uint32_t t_ms;
+        uint8_t matched;              // Bit per lane
+    };
+
+    static size_t loadLabels(SDCard& sd, const char* path, Label* labels, size_t max);
+    static void scoreEvents(uint8_t events, uint32_t t_ms, bool have_onset, uint32_t onset,
+                            Label* labels, size_t label_count, uint8_t lane, LaneStats& stats);
+    void logLane(const char* name, const LaneStats& stats, size_t label_count, uint32_t duration_ms);
+
+public:
+    ImuTrace(Logger* logger) : logger(logger) {}
+
+    bool start(SDCard& sd, const char* path, float odr_hz);
+    void record(const ImuSample& sample, uint32_t now_ms);
+    void flush();
+    void stop();
+
+    bool isRecording() const { return recording; }
+    uint32_t getRecordCount() const { return records; }
+    uint32_t getDroppedCount() const { return dropped; }
+    uint32_t getWriteMaxUs() const { return write_max_us; }
+
+    // Runs WristGesture over a trace at the live polling rate, fixed and with simulated
+    // adaptive ODR, plus the GestureClassifier model, and logs all three
+    bool replay(SDCard& sd, const char* path, ReplayReport& report);
+};
@@ -0,0 +1,33 @@
+#include "rate_policy.hpp"
+
+void ImuRatePolicy::reset(Rate new_rate, uint32_t now_ms) {
+    rate = new_rate;
+    have_reference = false;
+    last_active = now_ms;
+}
+
+ImuRatePolicy::Rate ImuRatePolicy::update(const ImuSample& s, uint32_t now_ms) {
+    const int16_t accel[3] = {s.ax, s.ay, s.az};
+
+    bool moved = false;
+    if (have_reference) {
+        for (int i = 0; i < 3; i++) {
+            if (abs32((int32_t)accel[i] - reference[i]) > WAKE_DELTA) moved = true;
+        }
+    }
+    if (!have_reference || moved) {
+        for (int i = 0; i < 3; i++) reference[i] = accel[i];
+        have_reference = true;
+    }
+
+    bool rotating = rate == RATE_HIGH &&
+                    (abs32(s.gx) > ACTIVE_ROTATION || abs32(s.gy) > ACTIVE_ROTATION || abs32(s.gz) > ACTIVE_ROTATION);
+
+    if (moved || rotating) {
+        last_active = now_ms;
+        rate = RATE_HIGH;
+    } else if (rate == RATE_HIGH && now_ms - last_active > STILL_TIMEOUT_MS) {
+        rate = RATE_LOW;
+    }
+    return rate;
+}
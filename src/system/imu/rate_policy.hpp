@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+#include "imu_sample.hpp"
+
+/**
+ * Activity-adaptive output data rate policy.
+ * RATE_LOW: accel only at 21Hz low-power, gyro powered down.
+ * RATE_HIGH: accel + gyro at 112Hz.
+ * Steps up as soon as the accel moves away from where it settled, and back down
+ * after STILL_TIMEOUT_MS without motion. Pure logic — IMU applies the result,
+ * trace replay simulates it.
+ */
+class ImuRatePolicy {
+public:
+    enum Rate : uint8_t {
+        RATE_LOW = 0,
+        RATE_HIGH = 1,
+        RATE_COUNT
+    };
+
+    static constexpr float LOW_HZ = 21.0f;
+    static constexpr float HIGH_HZ = 112.1f;
+    static constexpr uint32_t GYRO_STARTUP_MS = 60;    // Gyro output invalid after power-up for this long
+    static constexpr uint32_t STILL_TIMEOUT_MS = 5000; // Quiet time before dropping to RATE_LOW
+
+    static constexpr int16_t WAKE_DELTA = accelCounts(0.08f);  // Per-axis accel change that counts as motion
+    static constexpr int16_t ACTIVE_ROTATION = gyroCounts(10.0f);
+
+    static float hz(Rate rate) { return rate == RATE_HIGH ? HIGH_HZ : LOW_HZ; }
+
+    // HIGH_HZ periods one sample spans, Q8: what 112Hz filters owe each sample at a rate
+    static constexpr uint16_t TICKS_Q8[RATE_COUNT] = {(uint16_t)(256.0f * HIGH_HZ / LOW_HZ + 0.5f), 256};
+
+    // Feed one sample (gyro ignored in RATE_LOW); returns the rate the IMU should run at
+    Rate update(const ImuSample& sample, uint32_t now_ms);
+    void reset(Rate rate, uint32_t now_ms);
+    Rate getRate() const { return rate; }
+
+private:
+    Rate rate = RATE_HIGH;
+    bool have_reference = false;
+    int16_t reference[3] = {0, 0, 0};   // Accel where the wearer last settled
+    uint32_t last_active = 0;
+
+    static int32_t abs32(int32_t v) { return v < 0 ? -v : v; }
+};
@@ -0,0 +1,43 @@
+#include "wrist_gesture.hpp"
+
+void WristGesture::reset() {
+    raise = Detector();
+    lower = Detector();
+    rotation_seen = false;
+    last_rotation_time = 0;
+}
+
+uint8_t WristGesture::update(const ImuSample& sample, uint32_t now_ms) {
+    // Remember when we last saw rotation
+    if (isStrongRotation(sample)) {
+        rotation_seen = true;
+        last_rotation_time = now_ms;
+    }
+    bool recent_rotation = rotation_seen && (now_ms - last_rotation_time < ROTATION_WINDOW_MS);
+
+    uint8_t events = NONE;
+    if (step(raise, isWatchUp(sample), recent_rotation, now_ms)) events |= RAISE;
+    if (step(lower, isArmDown(sample), recent_rotation, now_ms)) events |= LOWER;
+    return events;
+}
+
+bool WristGesture::step(Detector& detector, bool in_position, bool recent_rotation, uint32_t now_ms) {
+    switch (detector.state) {
+        case IDLE:
+            // Target position reached AND rotation in the last 1.5 seconds = gesture!
+            if (in_position && recent_rotation) {
+                detector.state = TRIGGERED;
+                detector.state_time = now_ms;
+                return true;
+            }
+            break;
+
+        case TRIGGERED:
+            // Cooldown: wait 1s, then back to IDLE once out of the target position
+            if (now_ms - detector.state_time > COOLDOWN_MS && !in_position) {
+                detector.state = IDLE;
+            }
+            break;
+    }
+    return false;
+}
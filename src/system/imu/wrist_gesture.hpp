@@ -0,0 +1,56 @@
+#pragma once
+#include <stdint.h>
+#include "imu_sample.hpp"
+
+/**
+ * Wrist raise / lower detection on raw IMU counts.
+ * Remembers recent strong rotation and fires when the watch reaches the target
+ * position within the rotation window. All state lives in the instance, so the
+ * live detector and trace replays run independently.
+ */
+class WristGesture {
+public:
+    enum Event : uint8_t {
+        NONE = 0x00,
+        RAISE = 0x01,   // Watch face turned towards the wearer
+        LOWER = 0x02    // Arm dropped (standing or sitting)
+    };
+
+    // Target positions and rotation threshold in raw counts
+    static constexpr int16_t WATCH_UP_X          = accelCounts(0.20f);
+    static constexpr int16_t WATCH_UP_Z          = accelCounts(-0.20f);
+    static constexpr int16_t ARM_DOWN_STANDING_Y = accelCounts(-0.35f);
+    static constexpr int16_t ARM_DOWN_SITTING_Y  = accelCounts(0.10f);
+    static constexpr int16_t ARM_DOWN_SITTING_Z  = accelCounts(-0.40f);
+    static constexpr int16_t STRONG_ROTATION     = gyroCounts(40.0f);
+
+    static constexpr uint32_t ROTATION_WINDOW_MS = 1500;  // Position must follow rotation within this
+    static constexpr uint32_t COOLDOWN_MS = 1000;         // Minimum time before re-arming
+
+    static bool isWatchUp(const ImuSample& s) { return s.ax > WATCH_UP_X && s.az < WATCH_UP_Z; }
+    static bool isArmDown(const ImuSample& s) {
+        return s.ay < ARM_DOWN_STANDING_Y || (s.ay > ARM_DOWN_SITTING_Y && s.az < ARM_DOWN_SITTING_Z);
+    }
+    static bool isStrongRotation(const ImuSample& s) {
+        return abs32(s.gx) > STRONG_ROTATION || abs32(s.gy) > STRONG_ROTATION || abs32(s.gz) > STRONG_ROTATION;
+    }
+
+    // Feed one sample; returns the Event bits that fired on it
+    uint8_t update(const ImuSample& sample, uint32_t now_ms);
+    void reset();
+
+private:
+    enum State : uint8_t { IDLE, TRIGGERED };
+    struct Detector {
+        State state = IDLE;
+        uint32_t state_time = 0;
+    };
+
+    Detector raise;
+    Detector lower;
+    bool rotation_seen = false;  // No rotation yet after boot/reset — don't fire
+    uint32_t last_rotation_time = 0;
+
+    static int32_t abs32(int16_t v) { return v < 0 ? -(int32_t)v : v; }
+    static bool step(Detector& detector, bool in_position, bool recent_rotation, uint32_t now_ms);
+};
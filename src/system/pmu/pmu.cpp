@@ -1,8 +1,11 @@
 #include "pmu.hpp"
 
-bool PMU::setBus(TwoWire &wire) {
+bool PMU::setBus(I2CBus &bus) {
+    i2c.attach(bus);
+    I2CDevice::Lock lock(i2c);
+
     logger->debug("PMU", "Starting AXP2101 initialization...");
-    if (!pmu.begin(wire, pmuAddress, PMU_SDA, PMU_SCL)) {
+    if (!pmu.begin(bus.getWire(), pmuAddress, PMU_SDA, PMU_SCL)) {
         logger->failure("PMU", "AXP2101 not found");
         initialized = false;
         return false;
@@ -4,36 +4,49 @@
 #include "XPowersAXP2101.tpp"
 
 #include "../../logger/logger.hpp"
+#include "../i2c/i2c_bus.hpp"
 
 class PMU {
 private:
     Logger* logger = nullptr;
     XPowersAXP2101 pmu;
     uint8_t pmuAddress = 0x34;
+    I2CDevice i2c{"PMU", pmuAddress, I2C_FAST_HZ};
     bool initialized = false;
 public:
     PMU(Logger *logger) { this->logger = logger; };
-    bool setBus(TwoWire &wire);
+    bool setBus(I2CBus &bus);
     
     bool isInitialized() const { return initialized; }
     
+    // XPowersLib drives TwoWire directly — every call holds the shared bus
     bool isBatteryConnect() {
-        return initialized ? pmu.isBatteryConnect() : false;
+        if (!initialized) return false;
+        I2CDevice::Lock lock(i2c);
+        return pmu.isBatteryConnect();
     }
     
     bool isCharging() {
-        return initialized ? pmu.isCharging() : false;
+        if (!initialized) return false;
+        I2CDevice::Lock lock(i2c);
+        return pmu.isCharging();
     }
     
     bool isUSBConnected() {
-        return initialized ? pmu.isVbusIn() : false;
+        if (!initialized) return false;
+        I2CDevice::Lock lock(i2c);
+        return pmu.isVbusIn();
     }
     
     uint8_t getBatteryPercent() {
-        return initialized ? pmu.getBatteryPercent() : 0;
+        if (!initialized) return 0;
+        I2CDevice::Lock lock(i2c);
+        return pmu.getBatteryPercent();
     }
     
     uint16_t getBattVoltage() {
-        return initialized ? pmu.getBattVoltage() : 0;
+        if (!initialized) return 0;
+        I2CDevice::Lock lock(i2c);
+        return pmu.getBattVoltage();
     }
 };
\ No newline at end of file
@@ -0,0 +1,235 @@
+#include "power_manager.hpp"
+#include "esp_timer.h"
+#include "../scheduler/loop_scheduler.hpp"
+
+bool PowerManager::begin() {
+    window_start_us = esp_timer_get_time();
+    if (esp_sleep_enable_gpio_wakeup() != ESP_OK) {
+        if (logger) logger->failure("POWER", "GPIO wakeup unavailable");
+        return false;
+    }
+    return true;
+}
+
+uint32_t PowerManager::addLine(const char* name, uint8_t pin, bool active_low, gpio_int_type_t isr_edge, WakeFn on_wake, void* ctx) {
+    if (line_count >= MAX_LINES) {
+        if (logger) logger->error("POWER", (String("No room for wake line ") + name).c_str());
+        return 0;
+    }
+    Line& line = lines[line_count];
+    line.name = name;
+    line.pin = (gpio_num_t)pin;
+    line.active_low = active_low;
+    line.isr_edge = isr_edge;
+    line.on_wake = on_wake;
+    line.ctx = ctx;
+    line.wakes = 0;
+    return 1UL << line_count++;
+}
+
+int8_t PowerManager::addLock(const char* name) {
+    if (lock_count >= MAX_LOCKS) {
+        if (logger) logger->error("POWER", (String("No room for lock ") + name).c_str());
+        return -1;
+    }
+    locks[lock_count].name = name;
+    locks[lock_count].count = 0;
+    locks[lock_count].vetoes = 0;
+    return lock_count++;
+}
+
+void PowerManager::acquire(int8_t lock) {
+    if (lock < 0 || lock >= lock_count) return;
+    portENTER_CRITICAL(&mux);
+    locks[lock].count++;
+    portEXIT_CRITICAL(&mux);
+}
+
+void PowerManager::release(int8_t lock) {
+    if (lock < 0 || lock >= lock_count) return;
+    portENTER_CRITICAL(&mux);
+    if (locks[lock].count > 0) locks[lock].count--;
+    portEXIT_CRITICAL(&mux);
+}
+
+bool PowerManager::beginTransfer(int8_t lock) {
+    if (lock < 0 || lock >= lock_count) return true;
+    portENTER_CRITICAL(&mux);
+    bool ok = !entering;
+    if (ok) {
+        locks[lock].count++;
+        transfers++;
+    }
+    portEXIT_CRITICAL(&mux);
+    return ok;
+}
+
+void PowerManager::endTransfer(int8_t lock) {
+    if (lock < 0 || lock >= lock_count) return;
+    portENTER_CRITICAL(&mux);
+    if (locks[lock].count > 0) locks[lock].count--;
+    if (transfers > 0) transfers--;
+    portEXIT_CRITICAL(&mux);
+}
+
+void PowerManager::addScheduler(LoopScheduler& scheduler) {
+    if (scheduler_count >= MAX_SCHEDULERS) {
+        if (logger) logger->error("POWER", "No room for another scheduler");
+        return;
+    }
+    schedulers[scheduler_count++] = &scheduler;
+}
+
+bool PowerManager::enter(bool veto) {
+    while (true) {
+        bool locked = false;
+        portENTER_CRITICAL(&mux);
+        if (veto) {
+            for (uint8_t i = 0; i < lock_count; i++) {
+                if (locks[i].count > 0) {
+                    locks[i].vetoes++;
+                    locked = true;
+                }
+            }
+        }
+        bool busy = transfers > 0;
+        if (!locked && !busy) entering = true;
+        portEXIT_CRITICAL(&mux);
+
+        if (locked) return false;
+        if (!busy) return true;
+        delayMicroseconds(50);   // A transfer on the other core — well under a millisecond
+    }
+}
+
+void PowerManager::leave() {
+    portENTER_CRITICAL(&mux);
+    entering = false;
+    portEXIT_CRITICAL(&mux);
+}
+
+uint32_t PowerManager::activeLines(uint32_t mask) const {
+    uint32_t active = 0;
+    for (uint8_t i = 0; i < line_count; i++) {
+        if (!(mask & (1UL << i))) continue;
+        int level = gpio_get_level(lines[i].pin);
+        if (lines[i].active_low ? level == 0 : level != 0) active |= 1UL << i;
+    }
+    return active;
+}
+
+void PowerManager::dispatch(uint32_t woke) {
+    for (uint8_t i = 0; i < line_count; i++) {
+        if ((woke & (1UL << i)) && lines[i].on_wake) lines[i].on_wake(lines[i].ctx);
+    }
+}
+
+uint32_t PowerManager::sleep(uint32_t timeout_ms, uint32_t mask) {
+    // An explicit sleep ignores the locks, but not a transfer already on the bus
+    enter(false);
+    uint32_t woke = sleepClaimed(timeout_ms, mask);
+    leave();
+    return woke;
+}
+
+uint32_t PowerManager::sleepClaimed(uint32_t timeout_ms, uint32_t mask) {
+    mask &= allLines();
+
+    // A level wake source would retrigger the edge ISR until the driver clears the line
+    for (uint8_t i = 0; i < line_count; i++) {
+        if ((mask & (1UL << i)) && lines[i].isr_edge != GPIO_INTR_DISABLE) gpio_intr_disable(lines[i].pin);
+    }
+
+    // Already asserted: it would wake us at once, hand it to its driver instead
+    uint32_t woke = activeLines(mask);
+    if (woke) {
+        stats.refused++;
+    } else {
+        for (uint8_t i = 0; i < line_count; i++) {
+            if (mask & (1UL << i)) gpio_wakeup_enable(lines[i].pin, lines[i].active_low ? GPIO_INTR_LOW_LEVEL : GPIO_INTR_HIGH_LEVEL);
+        }
+        if (timeout_ms > 0) esp_sleep_enable_timer_wakeup((uint64_t)timeout_ms * 1000);
+        else esp_sleep_disable_wakeup_source(ESP_SLEEP_WAKEUP_TIMER);
+
+        int64_t start = esp_timer_get_time();
+        esp_light_sleep_start();
+        stats.sleep_us += esp_timer_get_time() - start;
+        stats.sleeps++;
+
+        esp_sleep_wakeup_cause_t cause = esp_sleep_get_wakeup_cause();
+        if (cause == ESP_SLEEP_WAKEUP_GPIO) woke = activeLines(mask);
+        if (cause == ESP_SLEEP_WAKEUP_TIMER) stats.timer_wakes++;
+        else if (!woke) stats.other_wakes++;
+
+        for (uint8_t i = 0; i < line_count; i++) {
+            if (!(mask & (1UL << i))) continue;
+            gpio_wakeup_disable(lines[i].pin);
+            if (woke & (1UL << i)) lines[i].wakes++;
+        }
+    }
+
+    // gpio_wakeup_disable() also clears the interrupt type — put the edge back
+    for (uint8_t i = 0; i < line_count; i++) {
+        if (!(mask & (1UL << i)) || lines[i].isr_edge == GPIO_INTR_DISABLE) continue;
+        gpio_set_intr_type(lines[i].pin, lines[i].isr_edge);
+        gpio_intr_enable(lines[i].pin);
+    }
+
+    dispatch(woke);
+    return woke;
+}
+
+bool PowerManager::idle(uint32_t wait_ms, void* ctx) {
+    PowerManager* self = static_cast<PowerManager*>(ctx);
+    // The other cores' timers stop with the chip too (the sensor task's touch long press)
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < self->scheduler_count; i++) {
+        uint32_t next = self->schedulers[i]->msUntilNext(now);
+        if (next < wait_ms) wait_ms = next;
+    }
+    if (wait_ms < IDLE_SLEEP_MIN_MS || !self->enter(true)) return false;
+
+    // A line held active (the button, mostly) has had its edge — replaying it every pass would spin the loop
+    if (self->activeLines(self->allLines())) {
+        self->stats.refused++;
+        self->leave();
+        return false;
+    }
+    self->sleepClaimed(wait_ms == LoopScheduler::NO_DEADLINE ? 0 : wait_ms, self->allLines());
+    self->leave();
+    return true;
+}
+
+void PowerManager::logStats() {
+    int64_t now = esp_timer_get_time();
+    // In ms: a window or total sleep in µs would wrap 32 bits after ~71 minutes
+    uint32_t window_ms = (uint32_t)((now - window_start_us) / 1000);
+    uint32_t sleep_ms = (uint32_t)(stats.sleep_us / 1000);
+    if (sleep_ms > window_ms) sleep_ms = window_ms;
+    if (logger && window_ms > 0) {
+        logger->info("POWER", (String("Light sleep ") + String(sleep_ms * 100.0f / window_ms, 1) + "% (" +
+                               String(sleep_ms) + "ms asleep, " + String(window_ms - sleep_ms) + "ms active, " +
+                               String(stats.sleeps) + " sleeps)").c_str());
+
+        String line = String("Wakes: timer ") + String(stats.timer_wakes);
+        for (uint8_t i = 0; i < line_count; i++) line += String(", ") + lines[i].name + " " + String(lines[i].wakes);
+        line += String(", other ") + String(stats.other_wakes) + ", refused " + String(stats.refused);
+        logger->info("POWER", line.c_str());
+
+        line = "Held off by:";
+        bool any = false;
+        for (uint8_t i = 0; i < lock_count; i++) {
+            if (!locks[i].vetoes) continue;
+            line += String(" ") + locks[i].name + " " + String(locks[i].vetoes);
+            any = true;
+        }
+        if (any) logger->info("POWER", line.c_str());
+    }
+
+    stats = Stats();
+    for (uint8_t i = 0; i < line_count; i++) lines[i].wakes = 0;
+    portENTER_CRITICAL(&mux);
+    for (uint8_t i = 0; i < lock_count; i++) locks[i].vetoes = 0;
+    portEXIT_CRITICAL(&mux);
+    window_start_us = now;
+}
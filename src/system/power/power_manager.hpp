@@ -0,0 +1,117 @@
+#pragma once
+#include <Arduino.h>
+
+#include "driver/gpio.h"
+#include "esp_sleep.h"
+#include "../../logger/logger.hpp"
+
+class LoopScheduler;
+
+/**
+ * Light sleep with the peripheral interrupt lines as wake sources.
+ *
+ * Each line is a GPIO interrupt pin (touch, IMU, RTC, button). While asleep it
+ * is a level wake source; its edge ISR is masked so the level can't retrigger
+ * it on wake, then restored. A GPIO wake is attributed to the lines found at
+ * their active level, and each one's wake handler replays the edge the masked
+ * ISR missed.
+ *
+ * idle() is the main loop's idle hook: it light-sleeps until the next deadline
+ * (its own or another task's scheduler, see addScheduler()) unless a lock is held.
+ * Locks stand in for esp_pm locks — held by whatever has work in flight off the
+ * loop (queued I2C transfers, a WiFi attempt, a USB host).
+ *
+ * Light sleep stalls the other core wherever it is. A task there that touches the
+ * bus brackets it with beginTransfer()/endTransfer(): the check and the claim are
+ * one critical section with the sleep's own, so either the transfer vetoes the
+ * sleep or the sleep comes first and beginTransfer() fails until the wake.
+ * The stock Arduino core is built without CONFIG_PM_ENABLE and tickless idle,
+ * so the loop enters light sleep itself rather than the FreeRTOS idle task.
+ */
+class PowerManager {
+public:
+    static constexpr uint8_t MAX_LINES = 6;
+    static constexpr uint8_t MAX_LOCKS = 6;
+    static constexpr uint8_t MAX_SCHEDULERS = 2;
+    static constexpr uint32_t IDLE_SLEEP_MIN_MS = 10;    // Shorter waits aren't worth the entry/exit cost
+
+    typedef void (*WakeFn)(void* ctx);
+
+    struct Stats {
+        uint32_t sleeps = 0;
+        uint64_t sleep_us = 0;
+        uint32_t timer_wakes = 0;
+        uint32_t other_wakes = 0;      // GPIO wake with no line still active, or another source
+        uint32_t refused = 0;          // A line was already active
+    };
+
+private:
+    struct Line {
+        const char* name;
+        gpio_num_t pin;
+        bool active_low;
+        gpio_int_type_t isr_edge;      // GPIO_INTR_DISABLE: no ISR on this pin
+        WakeFn on_wake;
+        void* ctx;
+        uint32_t wakes;
+    };
+
+    struct Lock {
+        const char* name;
+        int16_t count;
+        uint32_t vetoes;               // Idle sleeps it prevented
+    };
+
+    Logger* logger = nullptr;
+    Line lines[MAX_LINES];
+    uint8_t line_count = 0;
+    Lock locks[MAX_LOCKS];
+    uint8_t lock_count = 0;
+    LoopScheduler* schedulers[MAX_SCHEDULERS] = {nullptr};
+    uint8_t scheduler_count = 0;
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    uint8_t transfers = 0;         // beginTransfer() sections in flight
+    bool entering = false;         // A sleep has been claimed — no new transfers until the wake
+
+    Stats stats;
+    int64_t window_start_us = 0;
+
+    uint32_t activeLines(uint32_t mask) const;
+    void dispatch(uint32_t woke);
+    bool enter(bool veto);         // Claims the sleep; veto = give up if any lock is held
+    void leave();
+    uint32_t sleepClaimed(uint32_t timeout_ms, uint32_t mask);
+
+public:
+    PowerManager(Logger* logger) : logger(logger) {}
+
+    bool begin();
+
+    // Line bit, 0 if full. on_wake runs on the sleeping task after a wake attributed to the line.
+    uint32_t addLine(const char* name, uint8_t pin, bool active_low, gpio_int_type_t isr_edge, WakeFn on_wake = nullptr, void* ctx = nullptr);
+    uint32_t allLines() const { return (1UL << line_count) - 1; }
+
+    // Counted like esp_pm locks: idle() won't sleep while any is held. -1 if full.
+    int8_t addLock(const char* name);
+    void acquire(int8_t lock);
+    void release(int8_t lock);
+
+    // A short section on another core that must not straddle a light sleep (a bus transfer).
+    // Counts as holding the lock; false while a sleep is being entered — try again after the wake.
+    bool beginTransfer(int8_t lock);
+    void endTransfer(int8_t lock);
+
+    // Another task's scheduler (the sensor core): idle() sleeps no longer than its next deadline
+    void addScheduler(LoopScheduler& scheduler);
+
+    // Light sleep until timeout_ms (0 = no timer) or one of the lines asserts.
+    // Returns the lines that woke it — without sleeping if one was already active.
+    uint32_t sleep(uint32_t timeout_ms, uint32_t lines);
+
+    // LoopScheduler idle hook (ctx = PowerManager)
+    static bool idle(uint32_t wait_ms, void* ctx);
+
+    const Stats& getStats() const { return stats; }
+    // Sleep residency, wake attribution and lock vetoes since the last call
+    void logStats();
+};
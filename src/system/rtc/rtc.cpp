@@ -1,17 +1,21 @@
 #include "rtc.hpp"
 
-bool RTC::setBus(TwoWire &bus) {
-    i2c = &bus;
+bool RTC::setBus(I2CBus &bus) {
+    i2c.attach(bus);
+
+    // CONTROL_2 AF (bit 6) and TF (bit 3) are set by the chip and cleared by writing 0
+    shadow.setCached(REG_CONTROL_1, REG_OFFSET);
+    shadow.setCached(REG_CONTROL_2, REG_CONTROL_2, 0x48);
+    shadow.invalidate();
     
-    // Test communication by reading control register
-    uint8_t ctrl1 = 0;
-    if (!readRegister(REG_CONTROL_1, &ctrl1)) {
+    // Test communication and load the shadow in one burst
+    if (!shadow.refresh()) {
         if (logger) logger->failure("RTC", "PCF85063 not found");
         return false;
     }
     
     // Enable RTC, disable 12h mode (use 24h)
-    if (!writeRegister(REG_CONTROL_1, 0x00)) {
+    if (!shadow.write(REG_CONTROL_1, 0x00)) {
         if (logger) logger->failure("RTC", "Failed to configure PCF85063");
         return false;
     }
@@ -29,11 +33,13 @@ void IRAM_ATTR RTC::isrArg(void* arg) {
     RTC* self = static_cast<RTC*>(arg);
     if (self) {
         self->irq_pending = true;
+        if (self->irq_hook) self->irq_hook(self->irq_hook_ctx);
     }
 }
 
 // Called from main-loop context to read CONTROL_2 and set specific flags.
 // PCF85063 CONTROL_2: bit6=AF (alarm), bit3=TF (timer); no distinct MF bit.
+// Flags always come from the device — the shadow doesn't hold them.
 void RTC::updateIrqFlags() {
     if (!irq_pending) return;
     irq_pending = false;
@@ -48,13 +54,9 @@ void RTC::updateIrqFlags() {
     if (!(ctrl2 & 0x48))  minute_triggered = true;
 }
 
-bool RTC::writeRegister(uint8_t reg, uint8_t value) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_PCF85063);
-    i2c->write(reg);
-    i2c->write(value);
-    return (i2c->endTransmission() == 0);
+bool RTC::writeRegisters(uint8_t reg, const uint8_t* buffer, size_t len) {
+    // PCF85063 auto-increments the register address
+    return i2c.writeRegs(reg, buffer, len);
 }
 
 bool RTC::readRegister(uint8_t reg, uint8_t* value) {
@@ -62,19 +64,7 @@ bool RTC::readRegister(uint8_t reg, uint8_t* value) {
 }
 
 bool RTC::readRegisters(uint8_t reg, uint8_t* buffer, size_t len) {
-    if (!i2c) return false;
-    
-    i2c->beginTransmission(ADDR_PCF85063);
-    i2c->write(reg);
-    if (i2c->endTransmission(false) != 0) return false;
-    
-    if (i2c->requestFrom(ADDR_PCF85063, len) != len) return false;
-    
-    for (size_t i = 0; i < len; i++) {
-        buffer[i] = i2c->read();
-    }
-    
-    return true;
+    return i2c.readRegs(reg, buffer, len);
 }
 
 bool RTC::setDateTime(const DateTime& dt) {
@@ -90,13 +80,7 @@ bool RTC::setDateTime(const DateTime& dt) {
     data[6] = decToBcd(dt.year - 2000);
     
     // Write all time/date registers at once
-    i2c->beginTransmission(ADDR_PCF85063);
-    i2c->write(REG_SECONDS);
-    for (int i = 0; i < 7; i++) {
-        i2c->write(data[i]);
-    }
-    
-    bool success = (i2c->endTransmission() == 0);
+    bool success = i2c.writeRegs(REG_SECONDS, data, sizeof(data));
     
     if (logger) {
         if (success) {
@@ -114,7 +98,10 @@ bool RTC::getDateTime(DateTime& dt) {
 
     uint8_t data[7];
     if (!readRegisters(REG_SECONDS, data, 7)) return false;
+    return decodeDateTime(data, dt);
+}
 
+bool RTC::decodeDateTime(const uint8_t* data, DateTime& dt) {
     // Bit 7 of the seconds register is the OS (Oscillator Stop) flag.
     // It is set when the RTC loses power and the time is no longer valid.
     if (data[0] & 0x80) {
@@ -133,6 +120,33 @@ bool RTC::getDateTime(DateTime& dt) {
     return true;
 }
 
+bool RTC::requestDateTime(I2CScheduler& scheduler) {
+    if (!initialized || poll_pending) return false;
+    poll_pending = true;
+    if (scheduler.read(i2c, REG_SECONDS, poll_data, sizeof(poll_data), I2CScheduler::PRIORITY_NORMAL, onPolled, this)) return true;
+    poll_pending = false;
+    return false;
+}
+
+void RTC::onPolled(const I2CScheduler::Transfer& transfer, bool ok, void* ctx) {
+    (void)transfer;
+    RTC* self = static_cast<RTC*>(ctx);
+    DateTime dt;
+    if (ok && self->decodeDateTime(self->poll_data, dt)) {
+        self->polled = dt;
+        self->polled_ms = millis();
+        self->poll_valid = true;
+    }
+    self->poll_pending = false;
+}
+
+bool RTC::getPolledDateTime(DateTime& dt, uint32_t* age_ms) const {
+    if (!poll_valid || poll_pending) return false;
+    dt = polled;
+    if (age_ms) *age_ms = millis() - polled_ms;
+    return true;
+}
+
 bool RTC::setTime(uint8_t hour, uint8_t minute, uint8_t second) {
     DateTime dt;
     if (!getDateTime(dt)) return false;
@@ -159,24 +173,18 @@ bool RTC::setAlarm(uint8_t hour, uint8_t minute, uint8_t second, uint8_t day) {
     if (!initialized) return false;
     
     // 0x80 = alarm disabled for that field
-    uint8_t alarm_second = (second == 0xFF) ? 0x80 : (decToBcd(second) & 0x7F);
-    uint8_t alarm_minute = (minute == 0xFF) ? 0x80 : (decToBcd(minute) & 0x7F);
-    uint8_t alarm_hour = (hour == 0xFF) ? 0x80 : (decToBcd(hour) & 0x3F);
-    uint8_t alarm_day = (day == 0xFF) ? 0x80 : (decToBcd(day) & 0x3F);
-    uint8_t alarm_weekday = 0x80; // Disable weekday alarm
-    
-    // Write alarm registers
-    if (!writeRegister(REG_SECOND_ALARM, alarm_second)) return false;
-    if (!writeRegister(REG_MINUTE_ALARM, alarm_minute)) return false;
-    if (!writeRegister(REG_HOUR_ALARM, alarm_hour)) return false;
-    if (!writeRegister(REG_DAY_ALARM, alarm_day)) return false;
-    if (!writeRegister(REG_WEEKDAY_ALARM, alarm_weekday)) return false;
+    uint8_t alarm[5];
+    alarm[0] = (second == 0xFF) ? 0x80 : (decToBcd(second) & 0x7F);
+    alarm[1] = (minute == 0xFF) ? 0x80 : (decToBcd(minute) & 0x7F);
+    alarm[2] = (hour == 0xFF) ? 0x80 : (decToBcd(hour) & 0x3F);
+    alarm[3] = (day == 0xFF) ? 0x80 : (decToBcd(day) & 0x3F);
+    alarm[4] = 0x80; // Disable weekday alarm
+    
+    // SECOND_ALARM..WEEKDAY_ALARM in one burst
+    if (!writeRegisters(REG_SECOND_ALARM, alarm, sizeof(alarm))) return false;
     
     // Enable alarm interrupt in CONTROL_2 (bit 7 = AIE)
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 |= 0x80; // Set AIE bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    if (!shadow.update(REG_CONTROL_2, 0x80, 0x80)) return false;
     
     if (logger) {
         logger->success("RTC", (String("Alarm set: ") + String(hour) + ":" + String(minute)).c_str());
@@ -188,12 +196,8 @@ bool RTC::setAlarm(uint8_t hour, uint8_t minute, uint8_t second, uint8_t day) {
 bool RTC::clearAlarm() {
     if (!initialized) return false;
     
-    // Disable alarm interrupt in CONTROL_2
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 &= ~0x80; // Clear AIE bit
-    ctrl2 &= ~0x40; // Clear AF (alarm flag)
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    // Disable alarm interrupt (AIE) in CONTROL_2 and clear AF (alarm flag)
+    if (!shadow.update(REG_CONTROL_2, 0x80, 0x00, 0x40)) return false;
     
     alarm_triggered = false;
     
@@ -206,19 +210,16 @@ bool RTC::setTimer(uint8_t value, TimerClockFreq freq) {
     if (!initialized) return false;
     
     // PCF85063 uses OFFSET register as timer countdown
-    if (!writeRegister(REG_OFFSET, value)) return false;
+    if (!shadow.write(REG_OFFSET, value)) return false;
     
     // Enable timer in CONTROL_1
     // Bit 3 = TE (timer enable), bits [2:1] = TD (clock divider / frequency)
     uint8_t ctrl1 = (freq & 0x03) << 1;  // TD[1:0] in bits [2:1]
     ctrl1 |= 0x08;                        // TE = bit 3
-    if (!writeRegister(REG_CONTROL_1, ctrl1)) return false;
+    if (!shadow.write(REG_CONTROL_1, ctrl1)) return false;
     
     // Enable timer interrupt in CONTROL_2 (bit 4 = TIE)
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 |= 0x10;  // Set TIE bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    if (!shadow.update(REG_CONTROL_2, 0x10, 0x10)) return false;
     
     if (logger) {
         const char* freq_str[] = {"4096Hz", "64Hz", "1Hz", "1/60Hz"};
@@ -231,18 +232,11 @@ bool RTC::setTimer(uint8_t value, TimerClockFreq freq) {
 bool RTC::clearTimer() {
     if (!initialized) return false;
     
-    // Disable timer in CONTROL_1
-    uint8_t ctrl1 = 0;
-    if (!readRegister(REG_CONTROL_1, &ctrl1)) return false;
-    ctrl1 &= ~0x08;  // Clear TE (timer enable, bit 3)
-    if (!writeRegister(REG_CONTROL_1, ctrl1)) return false;
+    // Disable timer in CONTROL_1: clear TE (timer enable, bit 3)
+    if (!shadow.update(REG_CONTROL_1, 0x08, 0x00)) return false;
     
-    // Disable timer interrupt in CONTROL_2
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 &= ~0x10;  // Clear TIE bit
-    ctrl2 &= ~0x08;  // Clear TF (timer flag)
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    // Disable timer interrupt (TIE) in CONTROL_2 and clear TF (timer flag)
+    if (!shadow.update(REG_CONTROL_2, 0x10, 0x00, 0x08)) return false;
     
     timer_triggered = false;
     
@@ -255,10 +249,7 @@ bool RTC::enableMinuteInterrupt() {
     if (!initialized) return false;
     
     // Enable minute interrupt in CONTROL_2 (bit 0 = MI)
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 |= 0x01;  // Set MI bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    if (!shadow.update(REG_CONTROL_2, 0x01, 0x01)) return false;
     
     if (logger) logger->info("RTC", "Minute interrupt enabled");
     
@@ -268,11 +259,8 @@ bool RTC::enableMinuteInterrupt() {
 bool RTC::disableMinuteInterrupt() {
     if (!initialized) return false;
     
-    // Disable minute interrupt in CONTROL_2
-    uint8_t ctrl2 = 0;
-    if (!readRegister(REG_CONTROL_2, &ctrl2)) return false;
-    ctrl2 &= ~0x01;  // Clear MI bit
-    if (!writeRegister(REG_CONTROL_2, ctrl2)) return false;
+    // Disable minute interrupt in CONTROL_2 (MI bit)
+    if (!shadow.update(REG_CONTROL_2, 0x01, 0x00)) return false;
     
     minute_triggered = false;
     
@@ -285,10 +273,7 @@ bool RTC::setClockOut(ClockOutFreq freq) {
     if (!initialized) return false;
     
     // Set CLKOUT frequency in CONTROL_1 bits [7:5]
-    uint8_t ctrl1 = 0;
-    if (!readRegister(REG_CONTROL_1, &ctrl1)) return false;
-    ctrl1 = (ctrl1 & 0x1F) | ((freq & 0x07) << 5);
-    if (!writeRegister(REG_CONTROL_1, ctrl1)) return false;
+    if (!shadow.update(REG_CONTROL_1, 0xE0, (freq & 0x07) << 5)) return false;
     
     if (logger) {
         const char* freq_str[] = {"32768Hz", "16384Hz", "8192Hz", "4096Hz", "2048Hz", "1024Hz", "1Hz", "OFF"};
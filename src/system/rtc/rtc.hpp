@@ -1,15 +1,20 @@
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
-
 #include "config.h"
+#include "../i2c/i2c_bus.hpp"
+#include "../i2c/i2c_scheduler.hpp"
+#include "../i2c/reg_shadow.hpp"
 #include "../../logger/logger.hpp"
 
 class RTC {
+public:
+    typedef void (*IrqHook)(void* ctx);   // Must be IRAM-safe
+
 private:
     static constexpr uint8_t ADDR_PCF85063 = 0x51;
     
-    TwoWire* i2c = nullptr;
+    I2CDevice i2c{"RTC", ADDR_PCF85063, I2C_FAST_HZ};
+    RegShadow shadow{i2c, REG_CONTROL_1, REG_OFFSET - REG_CONTROL_1 + 1};  // Control/offset config, AF/TF flags excluded
     Logger* logger = nullptr;
     bool initialized = false;
     
@@ -35,6 +40,8 @@ private:
     
     uint8_t interrupt_pin = RTC_INT;
     volatile bool irq_pending = false;
+    IrqHook irq_hook = nullptr;     // Also called from the ISR, e.g. to wake the main loop
+    void* irq_hook_ctx = nullptr;
     bool alarm_triggered = false;
     bool timer_triggered = false;
     bool minute_triggered = false;
@@ -45,7 +52,7 @@ private:
     uint8_t bcdToDec(uint8_t val) { return (val / 16 * 10) + (val % 16); }
     uint8_t decToBcd(uint8_t val) { return (val / 10 * 16) + (val % 10); }
     
-    bool writeRegister(uint8_t reg, uint8_t value);
+    bool writeRegisters(uint8_t reg, const uint8_t* buffer, size_t len);
     bool readRegister(uint8_t reg, uint8_t* value);
     bool readRegisters(uint8_t reg, uint8_t* buffer, size_t len);
     static void IRAM_ATTR isrArg(void* arg);
@@ -60,14 +67,35 @@ public:
         uint8_t month;
         uint16_t year;
     };
+
+private:
+    // Time registers read through the scheduler; written by its worker task
+    uint8_t poll_data[7];
+    volatile bool poll_pending = false;
+    volatile bool poll_valid = false;
+    DateTime polled = {};
+    unsigned long polled_ms = 0;
+
+    bool decodeDateTime(const uint8_t* data, DateTime& dt);
+    static void onPolled(const I2CScheduler::Transfer& transfer, bool ok, void* ctx);
+
+public:
     
     RTC(Logger* logger) : logger(logger) {}
     
-    bool setBus(TwoWire &bus);
+    bool setBus(I2CBus &bus);
     bool isInitialized() const { return initialized; }
+    void setIrqHook(IrqHook hook, void* ctx) { irq_hook_ctx = ctx; irq_hook = hook; }
+    void replayIrq() { isrArg(this); }   // An edge missed while the pin was a sleep wake source
+    const RegShadow::Stats& getShadowStats() const { return shadow.getStats(); }
     
     bool setDateTime(const DateTime& dt);
     bool getDateTime(DateTime& dt);
+
+    // Queues a time read at normal priority instead of holding the bus for it.
+    // getPolledDateTime() has the result once it lands; age_ms says how old it is.
+    bool requestDateTime(I2CScheduler& scheduler);
+    bool getPolledDateTime(DateTime& dt, uint32_t* age_ms = nullptr) const;
     
     // Convenience functions
     bool setTime(uint8_t hour, uint8_t minute, uint8_t second);
@@ -0,0 +1,219 @@
+#include "loop_scheduler.hpp"
+
+void LoopScheduler::begin() {
+    task = xTaskGetCurrentTaskHandle();
+    core = xPortGetCoreID();
+    now_ms = millis();
+    wheel.begin(now_ms);
+    window_start_us = micros();
+}
+
+uint32_t LoopScheduler::addSource(const char* name) {
+    if (source_count >= MAX_SOURCES) {
+        if (logger) logger->error("LOOP", (String("No room for event source ") + name).c_str());
+        return 0;
+    }
+    Source& source = sources[source_count];
+    source.scheduler = this;
+    source.bit = 1UL << source_count;
+    source.name = name;
+    source.signals = 0;
+    source_count++;
+    return source.bit;
+}
+
+void* LoopScheduler::hookContext(uint32_t source) {
+    for (uint8_t i = 0; i < source_count; i++) {
+        if (sources[i].bit == source) return &sources[i];
+    }
+    return nullptr;
+}
+
+void IRAM_ATTR LoopScheduler::signalFromISR(void* ctx) {
+    Source* source = static_cast<Source*>(ctx);
+    if (!source) return;
+    LoopScheduler* self = source->scheduler;
+
+    portENTER_CRITICAL_ISR(&self->mux);
+    self->pending |= source->bit;
+    source->signals++;
+    portEXIT_CRITICAL_ISR(&self->mux);
+
+    if (self->task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(self->task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void IRAM_ATTR LoopScheduler::armFromISR(Timer& timer, uint32_t delay_ms) {
+    wheel.armFromISR(timer, millis() + delay_ms);
+    if (task) {
+        BaseType_t woken = pdFALSE;
+        vTaskNotifyGiveFromISR(task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+}
+
+void LoopScheduler::jobDue(void* ctx) {
+    static_cast<Job*>(ctx)->due = true;
+}
+
+// Called from runDue() on the loop task, before it takes the pending bits — no notification needed
+void LoopScheduler::deliver(uint32_t events, void* ctx) {
+    LoopScheduler* self = static_cast<LoopScheduler*>(ctx);
+    portENTER_CRITICAL(&self->mux);
+    self->pending |= events;
+    for (uint8_t i = 0; i < self->source_count; i++) {
+        if (events & self->sources[i].bit) self->sources[i].signals++;
+    }
+    portEXIT_CRITICAL(&self->mux);
+}
+
+void LoopScheduler::post(uint32_t bits) {
+    portENTER_CRITICAL(&mux);
+    pending |= bits;
+    for (uint8_t i = 0; i < source_count; i++) {
+        if (bits & sources[i].bit) sources[i].signals++;
+    }
+    portEXIT_CRITICAL(&mux);
+    if (task) xTaskNotifyGive(task);
+}
+
+int8_t LoopScheduler::add(const char* name, Kind kind, uint32_t period_ms, uint32_t events, JobFn fn, void* ctx) {
+    if (job_count >= MAX_JOBS) {
+        if (logger) logger->error("LOOP", (String("No room for job ") + name).c_str());
+        return -1;
+    }
+    Job& job = jobs[job_count];
+    job.name = name;
+    job.fn = fn;
+    job.ctx = ctx;
+    job.kind = kind;
+    job.due = false;
+    job.period_ms = period_ms;
+    job.next_ms = now_ms + period_ms;
+    job.events = events;
+    job.timer.fn = jobDue;
+    job.timer.ctx = &job;
+    job.stats = JobStats();
+    if (kind != EVENT) wheel.armAt(job.timer, job.next_ms);
+    return job_count++;
+}
+
+int8_t LoopScheduler::every(const char* name, uint32_t period_ms, JobFn fn, void* ctx, uint32_t events) {
+    return add(name, period_ms > 0 ? PERIODIC : EVENT, period_ms, events, fn, ctx);
+}
+
+int8_t LoopScheduler::on(const char* name, uint32_t events, JobFn fn, void* ctx) {
+    return add(name, EVENT, 0, events, fn, ctx);
+}
+
+int8_t LoopScheduler::after(const char* name, uint32_t delay_ms, JobFn fn, void* ctx, uint32_t events) {
+    return add(name, ONESHOT, delay_ms, events, fn, ctx);
+}
+
+void LoopScheduler::rearm(int8_t index, uint32_t delay_ms) {
+    if (index < 0 || index >= job_count) return;
+    Job& job = jobs[index];
+    if (job.kind == EVENT) return;
+    job.due = false;
+    job.next_ms = now_ms + delay_ms;
+    wheel.armAt(job.timer, job.next_ms);
+}
+
+void LoopScheduler::cancel(int8_t index) {
+    if (index < 0 || index >= job_count) return;
+    wheel.cancel(jobs[index].timer);
+    jobs[index].due = false;
+    jobs[index].events = 0;
+}
+
+void LoopScheduler::runOnce() {
+    runDue(millis());
+
+    uint32_t wait = msUntilNext(millis());
+    if (wait == 0 || !task) return;
+
+    // Any signal since runDue() took the pending bits has already given the notification
+    TickType_t ticks = wait == NO_DEADLINE ? portMAX_DELAY : pdMS_TO_TICKS(wait);
+    if (ticks == 0) ticks = 1;
+    uint32_t start = micros();
+    if (!idle_fn || pending || !idle_fn(wait, idle_ctx)) ulTaskNotifyTake(pdTRUE, ticks);
+    idle_us += micros() - start;
+    wakes++;
+}
+
+void LoopScheduler::runDue(uint32_t now) {
+    now_ms = now;
+    // Marks jobs due and posts timer events, so both are seen below
+    wheel.advance(now);
+
+    portENTER_CRITICAL(&mux);
+    uint32_t events = pending;
+    pending = 0;
+    portEXIT_CRITICAL(&mux);
+
+    for (uint8_t i = 0; i < job_count; i++) {
+        Job& job = jobs[i];
+        bool by_event = (job.events & events) != 0;
+        bool by_time = job.due;
+        if (!by_event && !by_time) continue;
+        job.due = false;
+
+        // Reschedule before running, so a job can rearm or cancel itself
+        if (by_time) {
+            uint32_t late = now - job.next_ms;
+            if (late > job.stats.max_late_ms) job.stats.max_late_ms = late;
+            if (job.kind == PERIODIC) {
+                job.next_ms += job.period_ms;
+                if ((int32_t)(job.next_ms - now) <= 0) job.next_ms = now + job.period_ms;
+                wheel.armAt(job.timer, job.next_ms);
+            }
+        }
+
+        uint32_t start = micros();
+        job.fn(job.ctx);
+        uint32_t us = micros() - start;
+        job.stats.runs++;
+        job.stats.total_us += us;
+        if (us > job.stats.max_us) job.stats.max_us = us;
+    }
+}
+
+uint32_t LoopScheduler::msUntilNext(uint32_t now) const {
+    if (pending) return 0;
+    return wheel.msUntilNext(now);
+}
+
+void LoopScheduler::logStats() {
+    uint32_t window_us = micros() - window_start_us;
+    if (logger && window_us > 0) {
+        String line = String("Core ") + String(core) + " idle " + String(idle_us * 100.0f / window_us, 1) + "%, " + String(wakes) +
+                      " wakes, events";
+        for (uint8_t i = 0; i < source_count; i++) line += String(" ") + sources[i].name + " " + String(sources[i].signals);
+        logger->info(name, line.c_str());
+
+        // Three busiest jobs by total run time
+        bool shown[MAX_JOBS] = {false};
+        line = "Busiest:";
+        for (uint8_t n = 0; n < 3; n++) {
+            int8_t best = -1;
+            for (uint8_t i = 0; i < job_count; i++) {
+                if (!shown[i] && jobs[i].stats.runs && (best < 0 || jobs[i].stats.total_us > jobs[best].stats.total_us)) best = i;
+            }
+            if (best < 0) break;
+            shown[best] = true;
+            const JobStats& s = jobs[best].stats;
+            line += String(" ") + jobs[best].name + " " + String(s.runs) + "x avg " + String(s.total_us / s.runs) + "us max " +
+                    String(s.max_us) + "us late " + String(s.max_late_ms) + "ms";
+        }
+        logger->info(name, line.c_str());
+    }
+
+    for (uint8_t i = 0; i < job_count; i++) jobs[i].stats = JobStats();
+    for (uint8_t i = 0; i < source_count; i++) sources[i].signals = 0;
+    idle_us = 0;
+    wakes = 0;
+    window_start_us = micros();
+}
@@ -0,0 +1,134 @@
+#pragma once
+#include <Arduino.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../../logger/logger.hpp"
+#include "timer_wheel.hpp"
+
+/**
+ * Cooperative main-loop scheduler.
+ *
+ * Jobs are periodic, one-shot or bound to event sources (or periodic and
+ * event-bound at once). Sources are signalled from ISRs through
+ * signalFromISR() — hand it to a driver's IRQ hook with hookContext() —
+ * or from task context with post().
+ *
+ * runOnce() runs whatever is due, then blocks the calling task on its
+ * notification until the next deadline or the next event. Jobs run to
+ * completion on the loop task, one at a time.
+ *
+ * A periodic job that is late (light sleep, a long job) runs once and
+ * restarts its period from now rather than catching up.
+ *
+ * Job deadlines live on a TimerWheel, which other code can also arm its own
+ * timers on (arm / armFromISR): rate limits, holdoffs and timeouts that
+ * either call back on the loop task or signal an event source.
+ */
+class LoopScheduler {
+public:
+    static constexpr uint8_t MAX_JOBS = 16;
+    static constexpr uint8_t MAX_SOURCES = 8;
+    static constexpr uint32_t NO_DEADLINE = 0xFFFFFFFF;
+
+    typedef void (*JobFn)(void* ctx);
+    typedef TimerWheel::Timer Timer;
+    typedef bool (*IdleFn)(uint32_t wait_ms, void* ctx);   // True if it waited (e.g. light sleep) itself
+
+    struct JobStats {
+        uint32_t runs = 0;
+        uint32_t total_us = 0;
+        uint32_t max_us = 0;
+        uint32_t max_late_ms = 0;   // Worst start after the deadline
+    };
+
+private:
+    enum Kind : uint8_t {
+        PERIODIC = 0,
+        ONESHOT,
+        EVENT
+    };
+
+    struct Job {
+        const char* name;
+        JobFn fn;
+        void* ctx;
+        Kind kind;
+        bool due;                 // Its timer fired in this runDue()
+        uint32_t period_ms;
+        uint32_t next_ms;
+        uint32_t events;          // Source bits that also run it
+        Timer timer;
+        JobStats stats;
+    };
+
+    struct Source {
+        LoopScheduler* scheduler;
+        uint32_t bit;
+        const char* name;
+        volatile uint32_t signals;
+    };
+
+    Logger* logger = nullptr;
+    const char* name;             // Log tag
+    Job jobs[MAX_JOBS];
+    uint8_t job_count = 0;
+    Source sources[MAX_SOURCES];
+    uint8_t source_count = 0;
+
+    TaskHandle_t task = nullptr;
+    BaseType_t core = 0;
+    IdleFn idle_fn = nullptr;
+    void* idle_ctx = nullptr;
+    uint32_t now_ms = 0;          // Time of the last runDue() — new deadlines count from here
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    volatile uint32_t pending = 0;
+    TimerWheel wheel;
+
+    uint32_t idle_us = 0;
+    uint32_t wakes = 0;
+    uint32_t window_start_us = 0;
+
+    int8_t add(const char* name, Kind kind, uint32_t period_ms, uint32_t events, JobFn fn, void* ctx);
+    static void jobDue(void* ctx);
+    static void deliver(uint32_t events, void* ctx);   // Wheel event sink
+
+public:
+    LoopScheduler(Logger* logger, const char* name = "LOOP") : logger(logger), name(name) { wheel.setEventSink(deliver, this); }
+
+    // Binds the scheduler to the calling task (the one that will call runOnce())
+    void begin();
+
+    // Event source bit, 0 if full
+    uint32_t addSource(const char* name);
+    void* hookContext(uint32_t source);
+    static void IRAM_ATTR signalFromISR(void* ctx);
+    void post(uint32_t sources);
+
+    // Job index, -1 if full. period_ms = 0 with events makes a pure event job.
+    int8_t every(const char* name, uint32_t period_ms, JobFn fn, void* ctx, uint32_t events = 0);
+    int8_t on(const char* name, uint32_t events, JobFn fn, void* ctx);
+    int8_t after(const char* name, uint32_t delay_ms, JobFn fn, void* ctx, uint32_t events = 0);   // Disarmed after it fires
+    void rearm(int8_t job, uint32_t delay_ms);                              // Restart a one-shot (or a period)
+    void cancel(int8_t job);                                                // Stops its timer and its events
+    bool isArmed(int8_t job) const { return job >= 0 && job < job_count && jobs[job].timer.isArmed(); }
+
+    // Free-standing timers: fn runs on the loop task, or without one its events are posted like a source.
+    // arm() counts from the current pass, so call it from the loop task; armFromISR() also wakes the loop.
+    void arm(Timer& timer, uint32_t delay_ms) { wheel.armAt(timer, now_ms + delay_ms); }
+    void IRAM_ATTR armFromISR(Timer& timer, uint32_t delay_ms);
+    void disarm(Timer& timer) { wheel.cancel(timer); }
+
+    // Called instead of the notification wait while nothing is pending (wait_ms = NO_DEADLINE: none)
+    void setIdle(IdleFn fn, void* ctx) { idle_ctx = ctx; idle_fn = fn; }
+
+    // runOnce() is runDue() + a block for msUntilNext(); both take the time so a virtual clock can drive them
+    void runOnce();
+    void runDue(uint32_t now_ms);
+    uint32_t msUntilNext(uint32_t now_ms) const;
+
+    const JobStats& getStats(int8_t job) const { return jobs[job].stats; }
+    // Idle share of its core, wakes and the busiest jobs since the last call.
+    // May be called from another task: counts racing the reset are lost, nothing worse.
+    void logStats();
+};
@@ -0,0 +1,232 @@
+#include "timer_wheel.hpp"
+
+void IRAM_ATTR TimerWheel::link(Timer& timer, uint16_t slot) {
+    timer.prev = nullptr;
+    timer.next = heads[slot];
+    if (timer.next) timer.next->prev = &timer;
+    heads[slot] = &timer;
+    timer.slot = slot;
+    if (slot < DUE) occupied[slot >> SLOT_BITS] |= 1ULL << (slot & (SLOTS - 1));
+    stats.armed++;
+}
+
+void IRAM_ATTR TimerWheel::unlink(Timer& timer) {
+    uint16_t slot = timer.slot;
+    if (timer.prev) timer.prev->next = timer.next;
+    else heads[slot] = timer.next;
+    if (timer.next) timer.next->prev = timer.prev;
+    if (slot < DUE && !heads[slot]) occupied[slot >> SLOT_BITS] &= ~(1ULL << (slot & (SLOTS - 1)));
+    timer.next = timer.prev = nullptr;
+    timer.slot = IDLE;
+    stats.armed--;
+}
+
+// Files a timer for the wheel as seen from base, the next tick to be handled
+void IRAM_ATTR TimerWheel::file(Timer& timer, uint32_t base) {
+    uint32_t delta = timer.expires - base;
+    if ((int32_t)delta < 0) {
+        link(timer, DUE);
+        return;
+    }
+
+    uint8_t level = 0;
+    while (level < LEVELS - 1 && delta >= (1UL << (SLOT_BITS * (level + 1)))) level++;
+    // Beyond the top level's span: park in its last slot and refile on the way down
+    uint32_t at = delta >= SPAN_MS ? base + SPAN_MS - 1 : timer.expires;
+    link(timer, level * SLOTS + ((at >> (level * SLOT_BITS)) & (SLOTS - 1)));
+}
+
+void TimerWheel::move(uint16_t from, uint16_t to) {
+    while (Timer* timer = heads[from]) {
+        unlink(*timer);
+        link(*timer, to);
+    }
+}
+
+// Level's slot for the block starting at tick has come round: spread it over the levels below
+void TimerWheel::cascade(uint8_t level, uint32_t tick) {
+    uint16_t slot = level * SLOTS + ((tick >> (level * SLOT_BITS)) & (SLOTS - 1));
+    while (Timer* timer = heads[slot]) {
+        unlink(*timer);
+        file(*timer, tick);
+        stats.cascaded++;
+    }
+}
+
+// First occupied slot of a level in time order from base, and the tick it is handled at
+// (level 0: its expiry; above: its cascade)
+int16_t TimerWheel::firstSlot(uint8_t level, uint32_t base, uint32_t& tick) const {
+    uint64_t bits = occupied[level];
+    if (!bits) return -1;
+
+    uint8_t shift = level * SLOT_BITS;
+    // First block of this level starting at or after base
+    uint32_t block = (uint32_t)(((uint64_t)base + (1ULL << shift) - 1) >> shift);
+    uint8_t start = block & (SLOTS - 1);
+    uint64_t rotated = start ? (bits >> start) | (bits << (SLOTS - start)) : bits;
+    uint8_t offset = __builtin_ctzll(rotated);
+    tick = (block + offset) << shift;
+    return (start + offset) & (SLOTS - 1);
+}
+
+bool TimerWheel::nextTick(uint32_t base, uint32_t& tick) const {
+    bool found = false;
+    uint32_t best = 0;
+    for (uint8_t level = 0; level < LEVELS; level++) {
+        uint32_t at;
+        if (firstSlot(level, base, at) < 0) continue;
+        if (!found || at - base < best) best = at - base;
+        found = true;
+    }
+    tick = base + best;
+    return found;
+}
+
+void TimerWheel::begin(uint32_t now) {
+    portENTER_CRITICAL(&mux);
+    for (uint16_t slot = 0; slot < DUE; slot++) move(slot, DUE);
+    processed = now;
+    Timer* timer = heads[DUE];
+    while (timer) {
+        Timer* next = timer->next;
+        unlink(*timer);
+        file(*timer, processed + 1);
+        timer = next;
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+void TimerWheel::armAt(Timer& timer, uint32_t expires_ms) {
+    portENTER_CRITICAL(&mux);
+    if (timer.slot != IDLE) unlink(timer);
+    timer.expires = expires_ms;
+    file(timer, processed + 1);
+    portEXIT_CRITICAL(&mux);
+}
+
+void IRAM_ATTR TimerWheel::armFromISR(Timer& timer, uint32_t expires_ms) {
+    portENTER_CRITICAL_ISR(&mux);
+    if (timer.slot != IDLE) unlink(timer);
+    timer.expires = expires_ms;
+    file(timer, processed + 1);
+    portEXIT_CRITICAL_ISR(&mux);
+}
+
+void TimerWheel::cancel(Timer& timer) {
+    portENTER_CRITICAL(&mux);
+    if (timer.slot != IDLE) unlink(timer);
+    portEXIT_CRITICAL(&mux);
+}
+
+void IRAM_ATTR TimerWheel::cancelFromISR(Timer& timer) {
+    portENTER_CRITICAL_ISR(&mux);
+    if (timer.slot != IDLE) unlink(timer);
+    portEXIT_CRITICAL_ISR(&mux);
+}
+
+// Fires what is due now. Timers armed due from inside a callback wait for the next pass.
+void TimerWheel::fireDue(uint32_t now) {
+    portENTER_CRITICAL(&mux);
+    move(DUE, FIRING);
+    while (Timer* timer = heads[FIRING]) {
+        unlink(*timer);
+        TimerFn fn = timer->fn;
+        void* ctx = timer->ctx;
+        uint32_t events = timer->events;
+        if (timer->period_ms) {
+            // Late (light sleep, a long callback): fire once and restart the period from now
+            uint32_t next = timer->expires + timer->period_ms;
+            if ((int32_t)(next - now) <= 0) next = now + timer->period_ms;
+            timer->expires = next;
+            file(*timer, processed + 1);
+        }
+        stats.fired++;
+        portEXIT_CRITICAL(&mux);
+
+        if (fn) fn(ctx);
+        else if (events && sink) sink(events, sink_ctx);
+
+        portENTER_CRITICAL(&mux);
+    }
+    portEXIT_CRITICAL(&mux);
+}
+
+uint32_t TimerWheel::advance(uint32_t now) {
+    uint32_t fired = stats.fired;
+    fireDue(now);
+
+    while (true) {
+        portENTER_CRITICAL(&mux);
+        uint32_t base = processed + 1;
+        uint32_t tick;
+        if ((int32_t)(now - base) < 0) {
+            portEXIT_CRITICAL(&mux);
+            break;
+        }
+        // Nothing until after now: skip the empty ticks in one go
+        if (!nextTick(base, tick) || tick - base > now - base) {
+            processed = now;
+            portEXIT_CRITICAL(&mux);
+            break;
+        }
+
+        stats.ticks++;
+        for (uint8_t level = LEVELS - 1; level > 0; level--) {
+            if ((tick & ((1UL << (level * SLOT_BITS)) - 1)) == 0) cascade(level, tick);
+        }
+        move(tick & (SLOTS - 1), DUE);
+        processed = tick;
+        portEXIT_CRITICAL(&mux);
+
+        fireDue(now);
+    }
+    return stats.fired - fired;
+}
+
+uint32_t TimerWheel::msUntilNext(uint32_t now) const {
+    portENTER_CRITICAL(&mux);
+    if (heads[DUE] || heads[FIRING]) {
+        portEXIT_CRITICAL(&mux);
+        return 0;
+    }
+
+    // The first occupied slot of each level holds that level's earliest timers; above
+    // level 0 a slot spans many ticks, so walk it for the exact expiry
+    uint32_t base = processed + 1;
+    bool found = false;
+    uint32_t best = 0;
+    for (uint8_t level = 0; level < LEVELS; level++) {
+        uint32_t tick;
+        int16_t index = firstSlot(level, base, tick);
+        if (index < 0) continue;
+        if (level == 0) {
+            if (!found || tick - base < best) best = tick - base;
+            found = true;
+            continue;
+        }
+        for (const Timer* timer = heads[level * SLOTS + index]; timer; timer = timer->next) {
+            if (!found || timer->expires - base < best) best = timer->expires - base;
+            found = true;
+        }
+    }
+    portEXIT_CRITICAL(&mux);
+
+    if (!found) return NO_DEADLINE;
+    int32_t until = (int32_t)(base + best - now);
+    return until > 0 ? (uint32_t)until : 0;
+}
+
+TimerWheel::Stats TimerWheel::getStats() const {
+    portENTER_CRITICAL(&mux);
+    Stats copy = stats;
+    portEXIT_CRITICAL(&mux);
+    return copy;
+}
+
+void TimerWheel::resetStats() {
+    portENTER_CRITICAL(&mux);
+    uint32_t armed = stats.armed;
+    stats = Stats();
+    stats.armed = armed;
+    portEXIT_CRITICAL(&mux);
+}
@@ -0,0 +1,105 @@
+#pragma once
+#include <Arduino.h>
+
+#include "freertos/FreeRTOS.h"
+#include "../../logger/logger.hpp"
+
+/**
+ * Hierarchical timer wheel, 1ms resolution.
+ *
+ * Four levels of 64 slots: level 0 holds timers due within 64ms, one slot
+ * per tick; each level above covers 64x the span of the one below (4s,
+ * 4.6min, 4.6h). A timer is filed by its expiry and moves down a level
+ * whenever the level below wraps onto its slot, so arm and cancel are O(1)
+ * list operations and each timer is touched at most once per level.
+ * Anything further out than 4.6h parks in the top level and is refiled.
+ *
+ * Timers are owned by the caller and linked into the wheel. On expiry a
+ * timer either calls its fn or, without one, hands its event bits to the
+ * event sink (e.g. LoopScheduler::post). Callbacks run in advance() with
+ * the wheel unlocked, so they may arm or cancel any timer, their own too.
+ *
+ * arm/cancel are safe from any task and from ISRs (armFromISR); advance()
+ * belongs to one task. msUntilNext() is exact, so the idle path can sleep
+ * until the first expiry rather than polling.
+ */
+class TimerWheel {
+public:
+    static constexpr uint8_t LEVELS = 4;
+    static constexpr uint8_t SLOT_BITS = 6;
+    static constexpr uint32_t SLOTS = 1UL << SLOT_BITS;
+
+private:
+    static constexpr uint16_t DUE = LEVELS * SLOTS;    // Expired, waiting for advance() to fire
+    static constexpr uint16_t FIRING = DUE + 1;        // Taken by the current fireDue() pass
+    static constexpr uint16_t IDLE = 0xFFFF;
+
+public:
+    static constexpr uint32_t SPAN_MS = 1UL << (SLOT_BITS * LEVELS);   // Longest delay filed directly
+    static constexpr uint32_t NO_DEADLINE = 0xFFFFFFFF;
+
+    typedef void (*TimerFn)(void* ctx);
+    typedef void (*EventSink)(uint32_t events, void* ctx);
+
+    struct Timer {
+        TimerFn fn = nullptr;         // Called on expiry...
+        void* ctx = nullptr;
+        uint32_t events = 0;          // ...or, without fn, these go to the event sink
+        uint32_t period_ms = 0;       // 0 = one-shot
+
+        bool isArmed() const { return slot != IDLE; }
+        uint32_t getExpiry() const { return expires; }
+
+    private:
+        friend class TimerWheel;
+        Timer* next = nullptr;
+        Timer* prev = nullptr;
+        uint32_t expires = 0;
+        uint16_t slot = IDLE;
+    };
+
+    struct Stats {
+        uint32_t armed = 0;           // Timers in the wheel now
+        uint32_t fired = 0;
+        uint32_t cascaded = 0;        // Moves down a level
+        uint32_t ticks = 0;           // Ticks actually visited (empty ones are skipped)
+    };
+
+private:
+    Timer* heads[FIRING + 1] = {nullptr};
+    uint64_t occupied[LEVELS] = {0};
+    uint32_t processed = 0;           // Every tick up to here has been handled
+    EventSink sink = nullptr;
+    void* sink_ctx = nullptr;
+    mutable portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+    Stats stats;
+
+    // Callers hold mux
+    void IRAM_ATTR link(Timer& timer, uint16_t slot);
+    void IRAM_ATTR unlink(Timer& timer);
+    void IRAM_ATTR file(Timer& timer, uint32_t base);
+    void move(uint16_t from, uint16_t to);
+    void cascade(uint8_t level, uint32_t tick);
+    int16_t firstSlot(uint8_t level, uint32_t base, uint32_t& tick) const;
+    bool nextTick(uint32_t base, uint32_t& tick) const;
+    void fireDue(uint32_t now);
+
+public:
+    // Starts the clock at now; refiles anything armed before
+    void begin(uint32_t now);
+    void setEventSink(EventSink sink, void* ctx) { sink_ctx = ctx; this->sink = sink; }
+
+    // Expiry in ms on the clock advance() is driven with. Re-arming an armed timer moves it.
+    void armAt(Timer& timer, uint32_t expires_ms);
+    void IRAM_ATTR armFromISR(Timer& timer, uint32_t expires_ms);
+    void cancel(Timer& timer);
+    void IRAM_ATTR cancelFromISR(Timer& timer);
+
+    // Fires everything due up to now, in expiry order. Returns how many fired.
+    uint32_t advance(uint32_t now);
+    // ms until the first expiry (0 = due), NO_DEADLINE if nothing is armed
+    uint32_t msUntilNext(uint32_t now) const;
+
+    Stats getStats() const;
+    void resetStats();
+};
@@ -0,0 +1,120 @@
+#include "sensor_task.hpp"
+
+SensorTask::SensorTask(Logger* logger, IMU& imu, TouchController& touch)
+    : logger(logger), imu(imu), touch(touch), sched(logger, "SENSORS") {}
+
+bool SensorTask::begin(LoopScheduler& consumer, uint32_t source, BaseType_t core) {
+    this->consumer = &consumer;
+    consumer_source = source;
+
+    imu_source = sched.addSource("imu");
+    touch_source = sched.addSource("touch");
+    sched.on("IMU", imu_source, [](void* ctx) {
+        SensorTask* self = static_cast<SensorTask*>(ctx);
+        if (!self->beginTransfer(self->imu_source)) return;
+        self->readImu();
+        self->endTransfer();
+    }, this);
+    sched.on("Touch", touch_source, [](void* ctx) {
+        SensorTask* self = static_cast<SensorTask*>(ctx);
+        if (!self->beginTransfer(self->touch_source)) return;
+        self->touch.handleInterrupt();
+        self->endTransfer();
+
+        uint32_t wait = self->touch.msUntilLongPress();
+        if (wait != TouchController::NO_DEADLINE) self->sched.arm(self->long_press, wait);
+        else self->sched.disarm(self->long_press);
+    }, this);
+    long_press.fn = [](void* ctx) {
+        static_cast<SensorTask*>(ctx)->touch.checkLongPress();
+    };
+    long_press.ctx = this;
+
+    if (xTaskCreatePinnedToCore(taskEntry, "sensors", TASK_STACK, this, TASK_PRIORITY, &task, core) != pdPASS) {
+        if (logger) logger->failure("SENSORS", "Failed to create sensor task");
+        task = nullptr;
+        return false;
+    }
+
+    // Interrupts go to the sensor core from here on; service anything already latched
+    imu.setIrqHook(LoopScheduler::signalFromISR, sched.hookContext(imu_source));
+    touch.setIrqHook(LoopScheduler::signalFromISR, sched.hookContext(touch_source));
+    sched.post(imu_source | touch_source);
+
+    if (logger) logger->success("SENSORS", (String("Sensor task on core ") + String(core)).c_str());
+    return true;
+}
+
+void SensorTask::setPowerLock(PowerManager& power, int8_t lock) {
+    this->power = &power;
+    power_lock = lock;
+    power.addScheduler(sched);
+}
+
+// The loop has claimed a light sleep: stay off the bus and run again once the chip is back
+bool SensorTask::beginTransfer(uint32_t source) {
+    if (!power || power->beginTransfer(power_lock)) return true;
+    sched.post(source);
+    vTaskDelay(1);   // Stalled by the sleep itself; this only yields until then
+    return false;
+}
+
+void SensorTask::endTransfer() {
+    if (power) power->endTransfer(power_lock);
+}
+
+void SensorTask::taskEntry(void* arg) {
+    SensorTask* self = static_cast<SensorTask*>(arg);
+    self->sched.begin();
+    while (true) {
+        self->sched.runOnce();
+    }
+}
+
+void SensorTask::send(const SensorMessage& message) {
+    // A full queue drops the newest — the loop is behind and a stale backlog helps no one
+    if (queue.push(message)) consumer->post(consumer_source);
+}
+
+void SensorTask::readImu() {
+    // The loop may be switching the rate or arming a sleep mode — one lock for the whole read
+    IMU::Lock lock(imu);
+
+    // Overnight batching owns INT1 — the loop drains the FIFO after the watermark wake
+    if (imu.isFifoBatching()) return;
+
+    SensorMessage message;
+    if (imu.isDataReady()) {
+        imu.clearDataReadyFlag();
+
+        // Every sample goes out tagged with its rate; the gyro is powered down at low rate
+        ImuRatePolicy::Rate rate = imu.getSampleRate();
+        message.type = SensorMessage::IMU_SAMPLE;
+        message.rate = rate;
+        message.sample = ImuSample();
+        bool gyro = want_gyro && rate == ImuRatePolicy::RATE_HIGH;
+        bool ok = gyro ? imu.readRaw(message.sample) : imu.readRawAccel(message.sample);
+        // An accel-only read leaves the gyro at 0, and for GYRO_STARTUP_MS after a switch up it is noise
+        message.gyro_valid = gyro && imu.isGyroReady();
+        message.time_us = micros();
+        if (ok) send(message);
+    }
+
+    // Taps are latched from STATUS1 while servicing data-ready (or on a motion wake)
+    IMU::TapEvent tap;
+    if (imu.readTap(tap)) {
+        message.type = SensorMessage::IMU_TAP;
+        message.time_us = tap.time_us;
+        message.tap = tap;
+        send(message);
+    }
+}
+
+void SensorTask::logStats() {
+    sched.logStats();
+    if (logger) {
+        logger->info("SENSORS", (String("Queue ") + String(queue.size()) + "/" + String(QUEUE_DEPTH) + ", high water " +
+                                 String(queue.getHighWater()) + ", dropped " + String(queue.getDrops())).c_str());
+    }
+    queue.resetStats();
+}
@@ -0,0 +1,88 @@
+#pragma once
+#include <Arduino.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "../../logger/logger.hpp"
+#include "spsc_queue.hpp"
+#include "../imu/imu.hpp"
+#include "../touch/touch_controller.hpp"
+#include "../scheduler/loop_scheduler.hpp"
+#include "../power/power_manager.hpp"
+
+// One reading handed from the sensor core to the main loop
+struct SensorMessage {
+    enum Type : uint8_t {
+        IMU_SAMPLE = 0,     // sample: accel, plus gyro if wantGyro() was set
+        IMU_TAP             // tap
+    };
+
+    Type type;
+    uint8_t rate;           // IMU_SAMPLE: ImuRatePolicy::Rate it was read at (RATE_LOW has no gyro)
+    bool gyro_valid;        // IMU_SAMPLE: gyro fields were read and the gyro had settled
+    uint32_t time_us;       // micros() when it was read
+    union {
+        ImuSample sample;
+        IMU::TapEvent tap;
+    };
+};
+
+/**
+ * Sensor acquisition on its own core.
+ *
+ * A task pinned to core 0 (with WiFi, away from the Arduino loop on core 1)
+ * owns the IMU data-ready and touch interrupts. It reads each IMU sample and
+ * latched tap and pushes them through a lock-free SPSC queue; the main loop
+ * drains the queue and does the processing, UI and storage. Touch stays in its
+ * driver (gesture detection) but now runs on this core too.
+ *
+ * The task runs its own LoopScheduler, so its IRQ wakes and busy share are
+ * reported the same way as the main loop's.
+ */
+class SensorTask {
+public:
+    static constexpr uint32_t QUEUE_DEPTH = 64;        // ~0.5s of 112Hz samples
+    static constexpr uint32_t TASK_STACK = 4096;
+    static constexpr UBaseType_t TASK_PRIORITY = 4;    // Above the loop, below the I2C scheduler
+
+    typedef SpscQueue<SensorMessage, QUEUE_DEPTH> Queue;
+
+private:
+    Logger* logger = nullptr;
+    IMU& imu;
+    TouchController& touch;
+    LoopScheduler sched;
+    Queue queue;
+    TaskHandle_t task = nullptr;
+
+    LoopScheduler* consumer = nullptr;   // Signalled after each push
+    uint32_t consumer_source = 0;
+    PowerManager* power = nullptr;       // Transfer held while a job is on the bus
+    int8_t power_lock = -1;
+    volatile bool want_gyro = false;
+    uint32_t imu_source = 0;
+    uint32_t touch_source = 0;
+    LoopScheduler::Timer long_press;     // Finger down: fires at the touch long-press threshold
+
+    static void taskEntry(void* arg);
+    void send(const SensorMessage& message);
+    bool beginTransfer(uint32_t source);
+    void endTransfer();
+    void readImu();
+
+public:
+    SensorTask(Logger* logger, IMU& imu, TouchController& touch);
+
+    // Takes over the IMU and touch IRQ hooks and starts the task; messages signal source on consumer
+    bool begin(LoopScheduler& consumer, uint32_t source, BaseType_t core = 0);
+    bool isRunning() const { return task != nullptr; }
+    // Bus work vetoes light sleep, or waits for the wake; idle also honours this core's deadlines
+    void setPowerLock(PowerManager& power, int8_t lock);
+
+    // Consumer side — the main loop only
+    bool receive(SensorMessage& message) { return queue.pop(message); }
+    void setWantGyro(bool want) { want_gyro = want; }   // Gyro costs 6 more bytes per sample
+
+    // Sensor core busy share and queue depth since the last call
+    void logStats();
+};
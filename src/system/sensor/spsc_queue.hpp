@@ -0,0 +1,61 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+
+/**
+ * Bounded single-producer / single-consumer ring, lock-free.
+ *
+ * One task pushes and one task pops — they may run on different cores. The
+ * producer owns head, the consumer owns tail; each publishes its index with a
+ * release store after touching the slot, and reads the other's with an acquire
+ * load, so no lock or critical section is needed. Indices run freely and wrap
+ * at 2^32, which keeps every slot usable.
+ *
+ * push() fails when full rather than overwriting — the producer decides
+ * whether to drop (counted) or retry.
+ */
+template <typename T, uint32_t CAPACITY>
+class SpscQueue {
+    static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "SpscQueue capacity must be a power of two");
+    static constexpr uint32_t MASK = CAPACITY - 1;
+
+    T slots[CAPACITY];
+    std::atomic<uint32_t> head{0};        // Next slot to write — producer only
+    std::atomic<uint32_t> tail{0};        // Next slot to read — consumer only
+    std::atomic<uint32_t> drops{0};       // Failed pushes
+    std::atomic<uint32_t> high_water{0};  // Deepest fill seen by the producer
+
+public:
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t depth = h - tail.load(std::memory_order_acquire);
+        if (depth >= CAPACITY) {
+            drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        slots[h & MASK] = item;
+        head.store(h + 1, std::memory_order_release);
+        if (depth + 1 > high_water.load(std::memory_order_relaxed)) high_water.store(depth + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool pop(T& item) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        item = slots[t & MASK];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Approximate from any task other than the two ends
+    uint32_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    bool empty() const { return size() == 0; }
+    static constexpr uint32_t capacity() { return CAPACITY; }
+
+    uint32_t getDrops() const { return drops.load(std::memory_order_relaxed); }
+    uint32_t getHighWater() const { return high_water.load(std::memory_order_relaxed); }
+    void resetStats() {
+        drops.store(0, std::memory_order_relaxed);
+        high_water.store(0, std::memory_order_relaxed);
+    }
+};
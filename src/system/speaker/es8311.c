@@ -17,6 +17,9 @@
 typedef struct {
     unsigned int port;
     uint16_t dev_addr;
+    es8311_bus_hook_t bus_lock;
+    es8311_bus_hook_t bus_unlock;
+    void *bus_ctx;
 } es8311_dev_t;
 
 /*
@@ -147,14 +150,20 @@ static inline esp_err_t es8311_write_reg(es8311_handle_t dev, uint8_t reg_addr,
 {
     es8311_dev_t *es = (es8311_dev_t *) dev;
     const uint8_t write_buf[2] = {reg_addr, data};
-    return i2cWrite(es->port, es->dev_addr, write_buf, sizeof(write_buf), 1000);
+    if (es->bus_lock) es->bus_lock(es->bus_ctx);
+    esp_err_t ret = i2cWrite(es->port, es->dev_addr, write_buf, sizeof(write_buf), 1000);
+    if (es->bus_unlock) es->bus_unlock(es->bus_ctx);
+    return ret;
 }
 
 static inline esp_err_t es8311_read_reg(es8311_handle_t dev, uint8_t reg_addr, uint8_t *reg_value)
 {
     es8311_dev_t *es = (es8311_dev_t *) dev;
     size_t readCount = 0;
-    return i2cWriteReadNonStop(es->port, es->dev_addr, &reg_addr, 1, reg_value, 1, 1000, &readCount);
+    if (es->bus_lock) es->bus_lock(es->bus_ctx);
+    esp_err_t ret = i2cWriteReadNonStop(es->port, es->dev_addr, &reg_addr, 1, reg_value, 1, 1000, &readCount);
+    if (es->bus_unlock) es->bus_unlock(es->bus_ctx);
+    return ret;
 }
 
 /*
@@ -348,6 +357,14 @@ esp_err_t es8311_init(es8311_handle_t dev, const es8311_clock_config_t *const cl
     return ESP_OK;
 }
 
+void es8311_set_bus_hooks(es8311_handle_t dev, es8311_bus_hook_t lock, es8311_bus_hook_t unlock, void *ctx)
+{
+    es8311_dev_t *es = (es8311_dev_t *) dev;
+    es->bus_lock = lock;
+    es->bus_unlock = unlock;
+    es->bus_ctx = ctx;
+}
+
 void es8311_delete(es8311_handle_t dev)
 {
     free(dev);
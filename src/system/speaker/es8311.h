@@ -25,6 +25,9 @@ extern "C" {
 
 typedef void *es8311_handle_t;
 
+/* Called around every register access so the codec can share a bus with other drivers */
+typedef void (*es8311_bus_hook_t)(void *ctx);
+
 typedef enum {
     ES8311_MIC_GAIN_MIN = -1,
     ES8311_MIC_GAIN_0DB,
@@ -215,6 +218,16 @@ esp_err_t es8311_microphone_fade(es8311_handle_t dev, const es8311_fade_t fade);
  */
 es8311_handle_t es8311_create(const unsigned int port, const uint16_t dev_addr);
 
+/**
+ * @brief Set bus lock hooks, called before and after every register access
+ *
+ * @param dev    ES8311 handle
+ * @param lock   Take the I2C bus (may be NULL)
+ * @param unlock Release the I2C bus (may be NULL)
+ * @param ctx    Passed to both hooks
+ */
+void es8311_set_bus_hooks(es8311_handle_t dev, es8311_bus_hook_t lock, es8311_bus_hook_t unlock, void *ctx);
+
 /**
  * @brief Delete ES8311 object
  *
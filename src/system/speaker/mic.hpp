@@ -1,9 +1,10 @@
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
 #include "driver/i2s.h"
 #include "config.h"
-#include "logger/logger.hpp"
+#include "../../logger/logger.hpp"
+#include "../i2c/i2c_bus.hpp"
+#include "../i2c/reg_sequence.hpp"
 
 // ES7210 I2C address (AD0=AD1=GND on Waveshare board)
 #define ES7210_I2C_ADDR     0x40
@@ -15,13 +16,12 @@ class Mic {
 private:
     Logger* logger = nullptr;
     bool initialized = false;
-
-    esp_err_t writeReg(uint8_t reg, uint8_t val);
+    I2CDevice i2c{"MIC", ES7210_I2C_ADDR, I2C_STANDARD_HZ};
 
 public:
     Mic(Logger* logger) : logger(logger) {}
 
-    bool begin();
+    bool begin(I2CBus& bus);
     bool isInitialized() const { return initialized; }
 
     // Read raw PCM samples (16-bit signed stereo, same rate as speaker)
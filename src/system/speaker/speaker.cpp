@@ -1,7 +1,8 @@
 #include "speaker.hpp"
 
-bool Speaker::begin() {
+bool Speaker::begin(I2CBus& bus) {
     logger->info("SPEAKER", "Initializing ES8311 + I2S...");
+    i2c.attach(bus);
 
     // Configure I2S in master TX+RX mode with MCLK
     const i2s_config_t i2s_config = {
@@ -52,6 +53,7 @@ bool Speaker::begin() {
         i2s_driver_uninstall(SPEAKER_I2S_PORT);
         return false;
     }
+    es8311_set_bus_hooks(es_handle, lockBus, unlockBus, &i2c);
 
     const es8311_clock_config_t es_clk = {
         .mclk_inverted      = false,
@@ -69,6 +71,8 @@ bool Speaker::begin() {
 
     es8311_microphone_config(es_handle, false);
     es8311_voice_volume_set(es_handle, SPEAKER_VOLUME_DEFAULT, NULL);
+    volume = SPEAKER_VOLUME_DEFAULT;
+    if (i2c.readReg(ES8311_DAC_REG31, &dac_reg31)) muted = (dac_reg31 & 0x60) != 0;
 
     initialized = true;
     logger->success("SPEAKER", "ES8311 ready");
@@ -109,11 +113,31 @@ size_t Speaker::play(const uint8_t* data, size_t len) {
 }
 
 void Speaker::setVolume(int volume) {
-    if (!initialized) return;
-    es8311_voice_volume_set(es_handle, volume, NULL);
+    if (!initialized || volume == this->volume) return;
+    if (scheduler && scheduler->isRunning()) {
+        // Same register value es8311_voice_volume_set() writes, queued behind sensor traffic
+        int level = volume < 0 ? 0 : (volume > 100 ? 100 : volume);
+        uint8_t reg32 = level == 0 ? 0 : level * 256 / 100 - 1;
+        if (scheduler->write(i2c, ES8311_DAC_REG32, reg32, I2CScheduler::PRIORITY_BACKGROUND, onWritten, this)) this->volume = volume;
+        return;
+    }
+    if (es8311_voice_volume_set(es_handle, volume, NULL) == ESP_OK) this->volume = volume;
 }
 
 void Speaker::mute(bool enable) {
-    if (!initialized) return;
-    es8311_voice_mute(es_handle, enable);
+    if (!initialized || muted == (int8_t)enable) return;
+    if (scheduler && scheduler->isRunning()) {
+        uint8_t reg31 = enable ? (dac_reg31 | 0x60) : (dac_reg31 & ~0x60);
+        if (scheduler->write(i2c, ES8311_DAC_REG31, reg31, I2CScheduler::PRIORITY_BACKGROUND, onWritten, this)) muted = enable;
+        return;
+    }
+    if (es8311_voice_mute(es_handle, enable) == ESP_OK) muted = enable;
+}
+
+// Worker task: a failed write leaves the codec state unknown, so the next call retries
+void Speaker::onWritten(const I2CScheduler::Transfer& transfer, bool ok, void* ctx) {
+    if (ok) return;
+    Speaker* self = static_cast<Speaker*>(ctx);
+    if (transfer.reg == ES8311_DAC_REG32) self->volume = -1;
+    else self->muted = -1;
 }
@@ -1,12 +1,14 @@
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
 #include "driver/i2s.h"
 #include "config.h"
-#include "logger/logger.hpp"
+#include "../../logger/logger.hpp"
+#include "../i2c/i2c_bus.hpp"
+#include "../i2c/i2c_scheduler.hpp"
 
 extern "C" {
     #include "es8311.h"
+    #include "es8311_reg.h"
 }
 
 #define SPEAKER_SAMPLE_RATE     16000
@@ -18,11 +20,26 @@ private:
     Logger* logger = nullptr;
     bool initialized = false;
     es8311_handle_t es_handle = nullptr;
+    I2CDevice i2c{"CODEC", ES8311_ADDRESS_0, I2C_STANDARD_HZ};
+
+    // Last values sent to the codec — repeated calls don't touch the bus (-1 = unknown)
+    volatile int volume = -1;
+    volatile int8_t muted = -1;
+    uint8_t dac_reg31 = 0;    // DAC mute register as read at init; mute only flips bits 6:5
+
+    // Volume and mute go through here once running, at background priority
+    I2CScheduler* scheduler = nullptr;
+    static void onWritten(const I2CScheduler::Transfer& transfer, bool ok, void* ctx);
+
+    // es8311.c talks to the HAL on port 0 — these hold the shared bus around each access
+    static void lockBus(void* ctx) { static_cast<I2CDevice*>(ctx)->lock(); }
+    static void unlockBus(void* ctx) { static_cast<I2CDevice*>(ctx)->unlock(); }
 
 public:
     Speaker(Logger* logger) : logger(logger) {}
 
-    bool begin();
+    bool begin(I2CBus& bus);
+    void setScheduler(I2CScheduler& scheduler) { this->scheduler = &scheduler; }
 
     bool isInitialized() const { return initialized; }
 
@@ -43,6 +43,32 @@ bool FSManager::writeFile(const char* path, const String& data) {
     return true;
 }
 
+bool FSManager::writeFile(const char* path, const uint8_t* data, size_t len) {
+    File file = LittleFS.open(path, FILE_WRITE);
+    if (!file) {
+        logger->failure("FSManager", String("Failed to open file for writing: " + String(path)).c_str());
+        return false;
+    }
+
+    size_t written = file.write(data, len);
+    file.close();
+    return written == len;
+}
+
+bool FSManager::appendFile(const char* path, const uint8_t* data, size_t len, size_t* written) {
+    if (written) *written = 0;
+    File file = LittleFS.open(path, FILE_APPEND);
+    if (!file) {
+        logger->failure("FSManager", String("Failed to open file for appending: " + String(path)).c_str());
+        return false;
+    }
+
+    size_t n = file.write(data, len);
+    file.close();
+    if (written) *written = n;
+    return n == len;
+}
+
 String FSManager::readFile(const char* path) {
     logger->debug("FSManager", String("Reading file: " + String(path)).c_str());
     
@@ -1,7 +1,7 @@
 #pragma once
 #include <Arduino.h>
 #include <LittleFS.h>
-#include "logger/logger.hpp"
+#include "../../logger/logger.hpp"
 
 class FSManager {
 private:
@@ -16,5 +16,10 @@ public:
     size_t usedKB() { return LittleFS.usedBytes() / 1024; }
     bool exists(const char* path) { return LittleFS.exists(path); }
     bool writeFile(const char* path, const String& data);
+    bool writeFile(const char* path, const uint8_t* data, size_t len);
+    // False on a short write; written (if given) reports how much did reach the file
+    bool appendFile(const char* path, const uint8_t* data, size_t len, size_t* written = nullptr);
+    bool remove(const char* path) { return LittleFS.remove(path); }
+    bool rename(const char* from, const char* to) { return LittleFS.rename(from, to); }
     String readFile(const char* path);
 };
@@ -3,7 +3,7 @@
 #include <SPI.h>
 #include <SD.h>
 #include "config.h"
-#include "logger/logger.hpp"
+#include "../../logger/logger.hpp"
 
 class SDCard {
 private:
@@ -36,6 +36,9 @@ public:
     bool mkdir(const char* path)   { return SD.mkdir(path); }
     bool remove(const char* path)  { return SD.remove(path); }
 
+    // Direct file handle for streaming/binary use (caller closes)
+    File open(const char* path, const char* mode = FILE_READ) { return SD.open(path, mode); }
+
     bool writeFile(const char* path, const String& data);
     bool appendFile(const char* path, const String& data);
     String readFile(const char* path);
@@ -1,89 +1,51 @@
 #include "system_manager.hpp"
+#include "boot/boot_profiler.hpp"
 
 SystemManager::SystemManager(Logger* logger)
-    : logger(logger), pmu(logger), display(logger), touchController(logger), fsManager(logger), rtc(logger), imu(logger), motor(logger), sdCard(logger), speaker(logger), mic(logger), wifiSync(logger)
+    : logger(logger), i2cBus(logger), i2cScheduler(logger, i2cBus), pmu(logger), display(logger), touchController(logger), fsManager(logger), rtc(logger), imu(logger), motor(logger), sdCard(logger), speaker(logger), mic(logger), wifiSync(logger), imuTrace(logger), imuCalibrator(logger, imu, fsManager), sleepTracker(logger, imu, fsManager), initGraph(logger), loop(logger), sensors(logger, imu, touchController), power(logger), button(logger, BTN_BOOT)
 {
     logger->header("SystemManager Initialization");
 
     // init power button
-    pinMode(BTN_BOOT, INPUT_PULLUP);
-    
-    // Initialize I2C bus (100kHz Standard Mode)
-    logger->info("I2C", "Initializing bus at 100kHz...");
-    Wire.begin(I2C_SDA, I2C_SCL, 100000);
-    this->i2c = &Wire;
-
-    logger->debug("I2C", "Scanning bus...");
-    for (uint8_t addr = 1; addr < 127; ++addr) {
-        i2c->beginTransmission(addr);
-        if (i2c->endTransmission() == 0) {
-            char buf[32];
-            snprintf(buf, sizeof(buf), "Found device at 0x%02X", addr);
-            logger->debug("I2C", buf);
-        }
-    }
-
-    logger->success("I2C", "Bus initialized at 100kHz");
+    button.begin();
 
-    // Initialize PMU
-    logger->info("PMU", "Initializing AXP2101...");
-    if (!pmu.setBus(*i2c)) {
-        logger->failure("PMU", "AXP2101 initialization failed");
+    // LittleFS is mounted while the members are constructed — WiFi credentials and calibration need it
+    logger->info("LittleFS", "Checking LittleFS...");
+    if (!fsManager.isInitialized()) {
+        logger->failure("LittleFS", "Failed to initialize LittleFS");
         logger->footer();
         return;
     }
 
-    // Initialize Display (must come after PMU to ensure power rails are up)
-    logger->info("DISPLAY", "Initializing CO5300 AMOLED...");
-    if (!display.init()) {
-        logger->failure("DISPLAY", "CO5300 initialization failed");
-        logger->footer();
-        return;
-    }
+    declareInit();
 
-    // Initialize Touch
-    logger->info("TOUCH", "Initializing Touch Controller...");
-    if (!touchController.setBus(*i2c)) {
-        logger->failure("TOUCH", "Touch Controller initialization failed");
-        logger->footer();
-        return;
-    }
+#ifdef BOOT_PROFILE
+    BootProfiler::attachBus(i2cBus);
+#endif
 
-    // Initialize RTC
-    logger->info("RTC", "Initializing PCF85063...");
-    if (!rtc.setBus(*i2c)) {
-        logger->failure("RTC", "PCF85063 initialization failed");
+    // Independent peripherals come up concurrently on both cores
+    BOOT_STAGE("Init graph");
+    bool ok = initGraph.run();
+    initGraph.log("INIT GRAPH");
+    if (!ok) {
+        logger->failure("SYSTEM", "Required component failed to initialize");
         logger->footer();
         return;
     }
-    
-    // Sync RTC from NTP via WiFi (credentials in /wifi.txt on LittleFS)
-    wifiSync.syncTime(rtc);
 
-    // Initialize IMU
-    logger->info("IMU", "Initializing QMI8658...");
-    if (!imu.setBus(*i2c)) {
-        logger->failure("IMU", "QMI8658 initialization failed");
-        logger->footer();
-        return;
-    }
+    // System clock from the RTC now; NTP sync runs in the background from the loop
+    wifiSync.setCallback(onTimeSync, this);
+    wifiSync.begin(rtc);
 
-    // Initialize File System
-    logger->info("LittleFS", "Initializing LittleFS...");
-    if (!fsManager.isInitialized()) {
-        logger->failure("LittleFS", "Failed to initialize LittleFS");
-        logger->footer();
-        return;
-    }
-    
-    // Initialize SD Card (optional — system continues if no card present)
-    sdCard.begin();
+    declareLoop();
 
-    // Initialize Speaker (optional — system continues if not present)
-    speaker.begin();
+#ifdef IMU_TRACE_REPLAY
+    // Build with -DIMU_TRACE_REPLAY to run the wrist gesture detector over a captured trace
+    ImuTrace::ReplayReport report;
+    imuTrace.replay(sdCard, "/imu_trace.bin", report);
+#endif
 
-    // Initialize Motor
-    motor.begin();
+    BOOT_STAGE("Startup feedback");
     motor.doubleBuzz();  // Startup confirmation — two pulses = system ready
 
     // Speaker startup beep (1kHz, 200ms)
@@ -92,9 +54,6 @@ SystemManager::SystemManager(Logger* logger)
         speaker.beep(1000, 200);
     }
 
-    // Initialize Microphone (ES7210) — shares I2S port with speaker
-    mic.begin();
-
     logger->success("SYSTEM", "All components initialized successfully");
     logger->footer();
     
@@ -102,106 +61,454 @@ SystemManager::SystemManager(Logger* logger)
     return;
 }
 
-void SystemManager::update() {
-    static unsigned long lastTime = 0;
-    unsigned long current_time = millis();
-    unsigned long idle_time = current_time - last_activity_time;
-    
-    // Button check: short press = sleep, long press (>1s) = mic loopback test
-    if (digitalRead(BTN_BOOT) == LOW) {
-        unsigned long pressStart = millis();
-        while (digitalRead(BTN_BOOT) == LOW) delay(10);
-        if (millis() - pressStart > 1000) {
-            // Long press: loopback mic → speaker for 3 seconds
-            logger->info("MIC", "Loopback test: speak now (3s)...");
-            static int16_t buf[512];
-            // Log first batch of samples for diagnosis
-            size_t got = mic.read(buf, 512, 200);
-            if (got > 0) {
-                int32_t sum = 0;
-                int16_t peak = 0;
-                for (size_t i = 0; i < got; i++) {
-                    sum += abs(buf[i]);
-                    if (abs(buf[i]) > abs(peak)) peak = buf[i];
-                }
-                char dbg[64];
-                snprintf(dbg, sizeof(dbg), "samples=%u peak=%d avg=%d",
-                         (unsigned)got, (int)peak, (int)(sum / got));
-                logger->info("MIC", dbg);
-                speaker.play((const uint8_t*)buf, got * sizeof(int16_t));
+// Bring-up order as a graph: each node lists what it needs, everything else overlaps.
+// Model times (ms total / ms holding the I2C bus) come from the driver delays and a boot
+// log; they order the ready nodes.
+void SystemManager::declareInit() {
+    int8_t bus = initGraph.add("I2C", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        // Scans at 100kHz, each driver switches to its own clock per transaction
+        self->logger->info("I2C", "Initializing bus at 100kHz...");
+        if (!self->i2cBus.begin(I2C_SDA, I2C_SCL, I2C_STANDARD_HZ)) return false;
+
+        self->logger->debug("I2C", "Scanning bus...");
+        self->i2cBus.scan();
+#ifdef I2C_TRACE
+        // Build with -DI2C_TRACE to keep a ring of recent transactions, dumped by the heartbeat after a failure
+        self->i2cBus.setTracing(true);
+#endif
+        self->logger->success("I2C", "Bus initialized at 100kHz");
+        return true;
+    }, this);
+    initGraph.setModel(bus, 15, 15);
+
+    // Async transfers (priority + deadline) share the bus with the synchronous driver calls
+    int8_t scheduler = initGraph.add("I2C scheduler", [](void* ctx) {
+        return static_cast<SystemManager*>(ctx)->i2cScheduler.begin();
+    }, this, {bus});
+    initGraph.setModel(scheduler, 1);
+
+    int8_t power = initGraph.add("PMU", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->logger->info("PMU", "Initializing AXP2101...");
+        if (self->pmu.setBus(self->i2cBus)) return true;
+        self->logger->failure("PMU", "AXP2101 initialization failed");
+        return false;
+    }, this, {bus});
+    initGraph.setModel(power, 40, 40);
+
+    // Everything below needs the PMU rails
+    int8_t screen = initGraph.add("Display", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->logger->info("DISPLAY", "Initializing CO5300 AMOLED...");
+        if (self->display.init()) return true;
+        self->logger->failure("DISPLAY", "CO5300 initialization failed");
+        return false;
+    }, this, {power});
+    initGraph.setModel(screen, 180);
+
+    int8_t touch = initGraph.add("Touch", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->logger->info("TOUCH", "Initializing Touch Controller...");
+        if (self->touchController.setBus(self->i2cBus)) return true;
+        self->logger->failure("TOUCH", "Touch Controller initialization failed");
+        return false;
+    }, this, {power});
+    initGraph.setModel(touch, 150, 3);
+
+    int8_t clock = initGraph.add("RTC", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->logger->info("RTC", "Initializing PCF85063...");
+        if (self->rtc.setBus(self->i2cBus)) return true;
+        self->logger->failure("RTC", "PCF85063 initialization failed");
+        return false;
+    }, this, {power});
+    initGraph.setModel(clock, 5, 3);
+
+    int8_t sensor = initGraph.add("IMU", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->logger->info("IMU", "Initializing QMI8658...");
+        if (self->imu.setBus(self->i2cBus)) return true;
+        self->logger->failure("IMU", "QMI8658 initialization failed");
+        return false;
+    }, this, {power});
+    initGraph.setModel(sensor, 60, 10);
+
+    // SD card is optional — system continues if no card present
+    int8_t card = initGraph.add("SD card", [](void* ctx) {
+        return static_cast<SystemManager*>(ctx)->sdCard.begin();
+    }, this, {power}, InitGraph::RES_NONE, false);
+    initGraph.setModel(card, 250);
+
+    // Build with -DIMU_TRACE_CAPTURE to record every IMU sample to the SD card. "IMU features"
+    // waits for it, so the adaptive rate sees the capture; without a card both are skipped.
+    int8_t capture = -1;
+    bool capturing = false;
+#if defined(IMU_TRACE_CAPTURE) && !defined(IMU_TRACE_REPLAY)
+    capture = initGraph.add("IMU trace", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        return self->imuTrace.start(self->sdCard, "/imu_trace.bin", ImuRatePolicy::HIGH_HZ);
+    }, this, {sensor, card}, InitGraph::RES_NONE, false);
+    initGraph.setModel(capture, 10);
+    capturing = true;
+#endif
+
+    int8_t features = initGraph.add("IMU features", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+#ifdef IMU_GESTURE_MODEL
+        // Build with -DIMU_GESTURE_MODEL to use the generated int8 classifier instead of the thresholds
+        self->imu.setGestureSource(IMU::GESTURE_MODEL);
+#endif
+        // Drop to accel-only low rate when still (a trace capture needs the full-rate stream)
+        if (!self->imuTrace.isRecording()) self->imu.setAdaptiveRate(true);
+
+#ifdef IMU_TAP_ENGINE
+        // Build with -DIMU_TAP_ENGINE for tap / double-tap on INT1 — works with the display and touch controller
+        // asleep, but the engine keeps the accelerometer at 112Hz in low-rate and motion-wake modes
+        self->imu.enableTap();
+#endif
+        return true;
+    }, this, {sensor, capture}, InitGraph::RES_NONE, !capturing);
+    initGraph.setModel(features, 5, 3);
+
+    // Speaker is optional; the mic runs off its I2S port and MCLK
+    int8_t audio_out = initGraph.add("Speaker", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        if (!self->speaker.begin(self->i2cBus)) return false;
+        self->speaker.setScheduler(self->i2cScheduler);    // Volume and mute queue as background transfers
+        return true;
+    }, this, {power}, InitGraph::RES_I2S, false);
+    initGraph.setModel(audio_out, 30, 5);
+
+    int8_t audio_in = initGraph.add("Microphone", [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        return self->mic.begin(self->i2cBus);
+    }, this, {audio_out}, InitGraph::RES_I2S, false);
+    initGraph.setModel(audio_in, 20, 5);
+
+    int8_t vibration = initGraph.add("Motor", [](void* ctx) {
+        static_cast<SystemManager*>(ctx)->motor.begin();
+        return true;
+    }, this, {power});
+    initGraph.setModel(vibration, 1);
+}
+
+// Main loop as jobs: periodic work runs at its own rate, interrupt-driven work only when its
+// IRQ fires, and update() sleeps in between instead of spinning. IMU and touch interrupts
+// are taken on the sensor core, which hands readings over as messages.
+void SystemManager::declareLoop() {
+    loop.begin();
+
+    uint32_t sensor_msgs = loop.addSource("sensors");
+    uint32_t rtc_irq = loop.addSource("rtc");
+    uint32_t button_irq = loop.addSource("button");
+    rtc.setIrqHook(LoopScheduler::signalFromISR, loop.hookContext(rtc_irq));
+    button.setIrqHook(LoopScheduler::signalFromISR, loop.hookContext(button_irq));
+    button.setCallback(onButton, this);
+
+    // Every interrupt line can wake the chip from light sleep; a wake replays the
+    // edge its driver missed, which signals the loop like the real interrupt
+    power.begin();
+    button_line = power.addLine("button", BTN_BOOT, true, GPIO_INTR_ANYEDGE, [](void* ctx) {
+        static_cast<SystemManager*>(ctx)->button.replayIrq();
+    }, this);
+    power.addLine("touch", TOUCH_INT, true, GPIO_INTR_NEGEDGE, [](void* ctx) {
+        static_cast<SystemManager*>(ctx)->touchController.replayIrq();
+    }, this);
+    if (imu.isInitialized()) {
+        imu_line = power.addLine("imu", IMU_INT1, false, GPIO_INTR_POSEDGE, [](void* ctx) {
+            static_cast<SystemManager*>(ctx)->imu.replayIrq();
+        }, this);
+    }
+    if (rtc.isInitialized()) {
+        rtc_line = power.addLine("rtc", RTC_INT, true, GPIO_INTR_NEGEDGE, [](void* ctx) {
+            static_cast<SystemManager*>(ctx)->rtc.replayIrq();
+        }, this);
+    }
+
+    // Idle waits become light sleep unless someone has work in flight off the loop
+    i2cScheduler.setPowerLock(power, power.addLock("I2C"));
+    wifiSync.setPowerLock(power, power.addLock("WiFi"));
+    sensors.setPowerLock(power, power.addLock("Sensors"));
+    usb_lock = power.addLock("USB");
+    audio_lock = power.addLock("Audio");
+    holdUsb();
+    loop.setIdle(PowerManager::idle, &power);
+
+    // Sensor acquisition on core 0; processing, UI and storage stay here on core 1
+    sensors.begin(loop, sensor_msgs, 0);
+
+    // IMU calibration — cached in LittleFS; without a cache the gyro bias is estimated from
+    // the sample stream (Sensor messages below) the first time the watch lies still
+    loop.after("IMU calibration", 0, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->imuCalibrator.begin();
+#ifdef IMU_ACCEL_CALIBRATE
+        // Build with -DIMU_ACCEL_CALIBRATE to run the six-pose accelerometer calibration
+        self->imuCalibrator.calibrateAccel();
+#endif
+    }, this);
+
+    // Background NTP → RTC sync, never blocks
+    loop.every("WiFi sync", 250, [](void* ctx) {
+        static_cast<SystemManager*>(ctx)->wifiSync.service();
+    }, this);
+
+    // Runs on every edge and at the debounce / long-press / double-click deadlines, nothing in between
+    button_job = loop.after("Button", 0, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        uint32_t wait = self->button.service(millis());
+        if (wait != Button::NO_DEADLINE) self->loop.rearm(self->button_job, wait);
+    }, this, button_irq);
+
+    loopback_job = loop.every("Loopback", LOOPBACK_POLL_MS, [](void* ctx) {
+        static_cast<SystemManager*>(ctx)->serviceLoopback();
+    }, this);
+    loop.cancel(loopback_job);
+
+    // Step counting / activity recognition run on every IMU sample from the sensor core
+    loop.on("Sensor messages", sensor_msgs, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        SensorMessage message;
+        while (self->sensors.receive(message)) {
+            if (message.type == SensorMessage::IMU_SAMPLE) self->processActivitySample(message.sample, message.time_us, (ImuRatePolicy::Rate)message.rate, message.gyro_valid);
+            else if (message.type == SensorMessage::IMU_TAP) self->handleTap(message.tap);
+        }
+        // Gyro is only needed for trace capture and bias estimation — skip the extra 6 bytes otherwise
+        self->sensors.setWantGyro(self->imuTrace.isRecording() || self->imuCalibrator.needsSamples());
+    }, this);
+
+    // Wrist tilt up wakes the display, down puts it to sleep
+    loop.every("Wrist gestures", 50, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        if (self->fifo_woken) return;
+        self->imu.pollWristGesture();
+        if (self->imu.checkWristTilt()) {
+            if (self->sleeping) {
+                self->logger->info("IMU", "⌚ Wrist raise - waking display!");
+                self->touchController.wake();
+                self->display.powerOn();
+                self->sleeping = false;
             }
-            unsigned long end = millis() + 2800;
-            while (millis() < end) {
-                got = mic.read(buf, 512, 50);
-                if (got > 0) speaker.play((const uint8_t*)buf, got * sizeof(int16_t));
+            self->last_activity_time = millis();
+        }
+        if (self->imu.checkWristTiltDown()) {
+            if (!self->sleeping) {
+                self->logger->info("IMU", "⌚ Wrist lowered - entering sleep");
+                self->sleep();
             }
-            logger->info("MIC", "Loopback done");
-        } else {
-            this->sleep();
         }
-        return;
-    }
-
-    touchController.handleInterrupt();
-    
-    // Check IMU for wrist gestures (has its own rate limiting)
-    // Check for wrist tilt UP to wake display
-    if (imu.checkWristTilt()) {
-        if (sleeping) {
-            logger->info("IMU", "⌚ Wrist raise - waking display!");
-            touchController.wake();
-            display.powerOn();
-            sleeping = false;
+    }, this);
+
+    // A motion wake that didn't turn into a wrist raise goes straight back to sleep (armed in wakeup())
+    motion_wake_job = loop.after("Motion wake", MOTION_WAKE_WINDOW, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        if (self->sleeping && self->motion_woken) {
+            self->motion_woken = false;
+            self->sleep();
         }
-        last_activity_time = millis();
+    }, this);
+    loop.cancel(motion_wake_job);
+
+    // General motion resets the idle timer (prevents sleep during active use), at most once per holdoff
+    loop.every("Motion", 100, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        if (self->fifo_woken || !self->imu.checkMotion() || self->motion_holdoff.isArmed()) return;
+        self->last_activity_time = millis();
+        self->loop.arm(self->motion_holdoff, MOTION_HOLDOFF_MS);
+    }, this);
+
+    loop.on("RTC", rtc_irq, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        if (self->rtc.isAlarmTriggered()) {
+            self->logger->info("RTC", "⏰ ALARM TRIGGERED!");
+            self->rtc.clearAlarmFlag();
+            self->rtc.clearAlarm();
+        }
+        if (self->rtc.isTimerTriggered()) {
+            self->logger->info("RTC", "⏱ TIMER TRIGGERED!");
+            self->rtc.clearTimerFlag();
+        }
+        if (self->rtc.isMinuteTriggered()) {
+            self->logger->info("RTC", "🕐 MINUTE TICK");
+            self->rtc.clearMinuteFlag();
+        }
+    }, this);
+
+    // Auto sleep
+    loop.every("Idle sleep", 1000, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->holdUsb();
+        if (!self->sleeping && millis() - self->last_activity_time > LIGHT_SLEEP_TIMEOUT) {
+            self->logger->info("SYSTEM", "Entering light sleep (inactive >30s)");
+            self->sleep();
+        }
+    }, this);
+
+    loop.every("Heartbeat", 5000, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        self->logger->debug("SYSTEM", "Heartbeat log");
+        self->logHeartbeat();
+        self->loop.logStats();
+        self->sensors.logStats();
+        self->power.logStats();
+    }, this);
+
+    // A FIFO watermark wake has been drained in wakeup(), or an RTC wake has been
+    // serviced by the job above — back to sleep. Last, so the RTC job runs first;
+    // the gesture and motion jobs skip while fifo_woken since the IMU is still batching.
+    resleep_job = loop.after("Resleep", 0, [](void* ctx) {
+        SystemManager* self = static_cast<SystemManager*>(ctx);
+        if (self->sleeping && (self->fifo_woken || self->rtc_woken)) {
+            self->fifo_woken = false;
+            self->rtc_woken = false;
+            self->sleep();
+        }
+    }, this);
+    loop.cancel(resleep_job);
+
+    // Service anything latched before the hooks were installed
+    loop.post(rtc_irq | button_irq);
+}
+
+void SystemManager::update() {
+    // Runs what's due, then blocks until the next deadline or interrupt
+    loop.runOnce();
+}
+
+// Keep the USB link up while a host is listening — light sleep would drop it
+void SystemManager::holdUsb() {
+    bool connected = logger->isConnected();
+    if (connected == usb_held) return;
+    if (connected) power.acquire(usb_lock);
+    else power.release(usb_lock);
+    usb_held = connected;
+}
+
+// Click = sleep / wake, long press (>1s) = mic loopback test
+void SystemManager::onButton(const Button::Event& event, void* ctx) {
+    SystemManager* self = static_cast<SystemManager*>(ctx);
+    switch (event.type) {
+        case Button::PRESS:
+        case Button::RELEASE:
+            self->logger->debug("BUTTON", (String(Button::eventName(event.type)) + " at " + String(event.time_ms) + "ms").c_str());
+            break;
+        case Button::CLICK:
+            if (self->sleeping) {
+                self->touchController.wake();
+                self->display.powerOn();
+                self->sleeping = false;
+                self->last_activity_time = millis();
+            } else {
+                self->sleep();
+            }
+            break;
+        case Button::DOUBLE_CLICK:
+            self->logger->info("BUTTON", "Double click");
+            self->last_activity_time = millis();
+            break;
+        case Button::LONG_PRESS:
+            self->startLoopback();
+            break;
     }
+}
 
-    // Check for wrist tilt DOWN to sleep
-    if (imu.checkWristTiltDown()) {
-        if (!sleeping) {
-            logger->info("IMU", "⌚ Wrist lowered - entering sleep");
-            sleep();
+void SystemManager::startLoopback() {
+    if (loop.isArmed(loopback_job)) return;
+    logger->info("MIC", "Loopback test: speak now (3s)...");
+    power.acquire(audio_lock);
+    loopback_end = millis() + LOOPBACK_MS;
+    loopback_logged = false;
+    last_activity_time = millis();
+    loop.rearm(loopback_job, 0);
+}
+
+// Loopback mic → speaker, a poll's worth of samples at a time without waiting on I2S
+void SystemManager::serviceLoopback() {
+    static int16_t buf[512];
+    size_t got = mic.read(buf, 512, 0);
+    if (got > 0) {
+        // Log first batch of samples for diagnosis
+        if (!loopback_logged) {
+            int32_t sum = 0;
+            int16_t peak = 0;
+            for (size_t i = 0; i < got; i++) {
+                sum += abs(buf[i]);
+                if (abs(buf[i]) > abs(peak)) peak = buf[i];
+            }
+            char dbg[64];
+            snprintf(dbg, sizeof(dbg), "samples=%u peak=%d avg=%d",
+                     (unsigned)got, (int)peak, (int)(sum / got));
+            logger->info("MIC", dbg);
+            loopback_logged = true;
         }
+        speaker.play((const uint8_t*)buf, got * sizeof(int16_t));
     }
 
-    // General motion resets the idle timer (prevents sleep during active use)
-    if (imu.checkMotion()) {
-        last_activity_time = millis();
+    if ((int32_t)(millis() - loopback_end) >= 0) {
+        loop.cancel(loopback_job);
+        power.release(audio_lock);
+        logger->info("MIC", "Loopback done");
     }
+}
 
-    // Check RTC alarm
-    if (rtc.isAlarmTriggered()) {
-        logger->info("RTC", "⏰ ALARM TRIGGERED!");
-        rtc.clearAlarmFlag();
-        rtc.clearAlarm();
+void SystemManager::processActivitySample(const IMU::RawSample& raw, uint32_t time_us, ImuRatePolicy::Rate rate, bool gyro_valid) {
+    // Trace and gyro bias want real gyro readings: not accel-only reads, not a gyro still starting up
+    if (gyro_valid && (imuTrace.isRecording() || imuCalibrator.needsSamples())) {
+        imuTrace.record(raw, millis() - (micros() - time_us) / 1000);   // Back-dated to the read on the sensor core
+        imuCalibrator.update(raw);
     }
-
-    // Check RTC countdown timer
-    if (rtc.isTimerTriggered()) {
-        logger->info("RTC", "⏱ TIMER TRIGGERED!");
-        rtc.clearTimerFlag();
+    // Integer |a|², no float conversion or sqrt on the way in
+    uint32_t magnitude_sq = magnitudeSquared(raw);
+
+    // The filters run at 112Hz: a low-rate sample is held for the ticks it spans,
+    // so windows and cadence keep their length and a still wearer reads as Still.
+    // The tap engine holds RATE_LOW at 112Hz, so it counts as the high rate.
+    activity_phase += ImuRatePolicy::TICKS_Q8[imu.isTapEnabled() ? ImuRatePolicy::RATE_HIGH : rate];
+    uint8_t ticks = (uint8_t)(activity_phase >> 8);
+    activity_phase &= 0xFF;
+
+    uint32_t start = ESP.getCycleCount();
+    bool changed = false;
+    for (uint8_t i = 0; i < ticks; i++) {
+        bool step = pedometer.update(magnitude_sq);
+        changed |= activityClassifier.update(magnitude_sq, pedometer.getCadence(), step);
     }
+    uint32_t cycles = ESP.getCycleCount() - start;
 
-    // Check RTC minute tick
-    if (rtc.isMinuteTriggered()) {
-        logger->info("RTC", "🕐 MINUTE TICK");
-        rtc.clearMinuteFlag();
-    }
+    activity_cycles += cycles;
+    activity_samples++;
+    if (cycles > activity_cycles_max) activity_cycles_max = cycles;
 
-    // Auto Sleep Logic
-    if (idle_time > LIGHT_SLEEP_TIMEOUT && !sleeping) {
-        logger->info("SYSTEM", "Entering light sleep (inactive >30s)");
-        sleep();
+    if (changed) {
+        logger->info("ACTIVITY", (String("Activity: ") + ActivityClassifier::name(activityClassifier.getActivity())).c_str());
     }
-    
-    // Heartbeat every 5 seconds
-    if (millis() - lastTime > 5000) {
-        lastTime = millis();
-        this->logger->debug("SYSTEM", "Heartbeat log");
-        this->logHeartbeat();
+}
+
+void SystemManager::handleTap(const IMU::TapEvent& tap) {
+    static const char axes[] = {'X', 'Y', 'Z'};
+    uint32_t latency_us = micros() - tap.time_us;
+    logger->info("IMU", (String(tap.taps == 2 ? "Double tap" : "Tap") + " on " + axes[tap.axis] + (tap.negative ? "-" : "+") +
+                         " (" + String(latency_us) + "us after INT1)").c_str());
+
+    // Double tap wakes the display, same as a wrist raise
+    if (tap.taps == 2) {
+        if (sleeping) {
+            touchController.wake();
+            display.powerOn();
+            sleeping = false;
+            motion_woken = false;
+        }
+        last_activity_time = millis();
     }
 }
 
+bool SystemManager::inSleepWindow() {
+    RTC::DateTime now;
+    if (!rtc.isInitialized() || !rtc.getDateTime(now)) return false;
+    return now.hour >= SLEEP_TRACK_START_HOUR || now.hour < SLEEP_TRACK_END_HOUR;
+}
+
 void SystemManager::sleep() {
     logger->info("SYSTEM", "Entering light sleep mode...");
 
@@ -209,35 +516,89 @@ void SystemManager::sleep() {
         display.powerOff();
         delay(50);
         touchController.sleep();
-
-        // Wait until button is released (HIGH)
-        while (digitalRead(BTN_BOOT) == LOW) {
-            delay(10);
-        }
     }
 
-    logger->info("SYSTEM", "Button released, preparing for light sleep...");
+    // A button still held is a level wake source and refuses the sleep — the button
+    // job sees its release, and the click that follows is swallowed below
+    logger->info("SYSTEM", "Preparing for light sleep...");
 
     sleeping = true;
-    esp_sleep_enable_ext0_wakeup((gpio_num_t)BTN_BOOT, 0); // Wakeup on LOW
-    esp_sleep_enable_timer_wakeup(1000000); // Wakeup after 1 second (microseconds)
-    esp_light_sleep_start();
+    motion_woken = false;
+    fifo_woken = false;
+    rtc_woken = false;
+    uint32_t wake_lines = button_line | rtc_line;   // Touch is powered down
+    uint32_t timeout_ms = 0;
+
+    // Overnight: the IMU batches samples in its FIFO and INT1 wakes us at the watermark.
+    // Otherwise the motion engines drive INT1 — sleep until the sensor reports movement.
+    // Fall back to 1 second polling if neither can be armed.
+    bool track = imu.isInitialized() && inSleepWindow();
+    if (!track && sleepTracker.isActive()) sleepTracker.stop();
+    if (track && !sleepTracker.isActive()) {
+        RTC::DateTime now;
+        if (!rtc.getDateTime(now) || !sleepTracker.start(now)) track = false;
+    }
+
+    if (track && sleepTracker.arm()) {
+        wake_lines |= imu_line;
+    } else if (imu.isInitialized() && (imu.isMotionWakeArmed() || imu.enableMotionWake(IMU::MOTION_ANY | IMU::MOTION_SIGNIFICANT))) {
+        wake_lines |= imu_line;
+    } else {
+        timeout_ms = 1000;
+    }
+    uint32_t woke = power.sleep(timeout_ms, wake_lines);
 
     // After light sleep: reinitialize display
     logger->info("SYSTEM", "Waking up from light sleep...");
-    wakeup();
+    wakeup(woke);
 }
 
-void SystemManager::wakeup() {
-    esp_sleep_wakeup_cause_t wakeup_reason = esp_sleep_get_wakeup_cause();
+void SystemManager::wakeup(uint32_t woke) {
+    // FIFO watermark: drain and score, then sleep again. Anything else hands the IMU back.
+    if (sleepTracker.isArmed()) {
+        if (woke & imu_line) {
+            sleepTracker.service();
+            fifo_woken = true;
+            loop.rearm(resleep_job, 0);
+        } else {
+            sleepTracker.disarm();
+        }
+    }
+
+    // Any wake source ends motion-wake mode so gesture detection gets full-rate data again
+    if (imu.isMotionWakeArmed()) {
+        uint8_t events = imu.readMotionEvents();
+        imu.disableMotionWake();
+
+        if (woke & imu_line) {
+            logger->info("SYSTEM", (String("Woke up by IMU motion (events=0x") + String(events, HEX) + ")").c_str());
+            motion_woken = true;
+            loop.rearm(motion_wake_job, MOTION_WAKE_WINDOW);
+        }
+    }
 
-    if (wakeup_reason == ESP_SLEEP_WAKEUP_EXT0) {
+    if (woke & button_line) {
         logger->info("SYSTEM", "Woke up by button press");
+        button.swallowPress(millis());   // The press that woke us shouldn't also click us back to sleep
+        fifo_woken = false;
         touchController.wake();
         display.powerOn();
         sleeping = false;
         last_activity_time = millis();
     }
+
+    // RTC alarm, timer or minute tick: the RTC job services it, then back to sleep
+    if (sleeping && !motion_woken && (woke & rtc_line)) {
+        logger->info("SYSTEM", "Woke up by RTC interrupt");
+        rtc_woken = true;
+        loop.rearm(resleep_job, 0);
+    }
+}
+
+void SystemManager::onTimeSync(const WiFiSync::Event& event, void* ctx) {
+    SystemManager* self = static_cast<SystemManager*>(ctx);
+    self->time_sync_result = event.result;
+    self->time_sync_reported = true;
 }
 
 void SystemManager::logHeartbeat() {
@@ -264,19 +625,49 @@ void SystemManager::logHeartbeat() {
     logger->info("BATTERY", (String("Battery Connected: ") + String(this->getPMU().isBatteryConnect() ? "Yes" : "No")).c_str());
     logger->info("BATTERY", (String("Charging: ") + String(this->getPMU().isCharging() ? "Yes" : "No")).c_str());
 
-    // RTC Status
+    // RTC Status: the time polled through the scheduler, and the next poll queued
     if (rtc.isInitialized()) {
         RTC::DateTime dt;
-        if (rtc.getDateTime(dt)) {
+        uint32_t age_ms = 0;
+        if (rtc.getPolledDateTime(dt, &age_ms)) {
             char timeStr[32];
             snprintf(timeStr, sizeof(timeStr), "%04d-%02d-%02d %02d:%02d:%02d", 
                         dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second);
-            logger->info("RTC", (String("Current Time: ") + String(timeStr)).c_str());
-        } else {
+            logger->info("RTC", (String("Current Time: ") + String(timeStr) + " (read " + String(age_ms) + "ms ago)").c_str());
+        } else if (heartbeat > 1) {
             logger->warn("RTC", "Failed to read time");
         }
+        rtc.requestDateTime(i2cScheduler);
     }
     
+    // Background time sync
+    if (time_sync_reported) {
+        logger->info("WIFI", (String("Time sync: ") + WiFiSync::stateName(wifiSync.getState()) + ", " + String(wifiSync.getSyncCount()) + " synced, " +
+                              String(wifiSync.getFailureCount()) + " failed, last: " + WiFiSync::resultName(time_sync_result)).c_str());
+        wifiSync.logConnectStats();
+    }
+
+    // I2C bus usage since the last heartbeat
+    {
+        static unsigned long last_summary = 0;
+        uint32_t failures = i2cBus.logSummary(millis() - last_summary);
+        if (failures > 0 && i2cBus.isTracing()) i2cBus.dumpTrace();
+        i2cBus.resetStats();
+        last_summary = millis();
+        if (i2cScheduler.isRunning()) {
+            i2cScheduler.logStats();
+            i2cScheduler.resetStats();
+        }
+    }
+
+    // Register shadows: round trips saved on the shared bus
+    {
+        const RegShadow::Stats& is = imu.getShadowStats();
+        const RegShadow::Stats& rs = rtc.getShadowStats();
+        logger->info("I2C", (String("Shadow: IMU ") + String(is.hits) + " hits / " + String(is.misses) + " misses / " + String(is.skipped) + " skipped writes, RTC " +
+                             String(rs.hits) + " / " + String(rs.misses) + " / " + String(rs.skipped)).c_str());
+    }
+
     // IMU Status
     if (imu.isInitialized()) {
         IMU::AccelData accel;
@@ -297,6 +688,39 @@ void SystemManager::logHeartbeat() {
         // INT1 fire count — expect ~560 per 5s interval at 112Hz if interrupt is working
         logger->info("IMU", (String("INT1 fires this interval: ") + String(imu.getIsrCount())).c_str());
         imu.resetIsrCount();
+
+        logger->info("ACTIVITY", (String("Steps: ") + String(pedometer.getSteps()) + " cadence=" + String(pedometer.getCadence(), 0) +
+                                  "spm activity=" + ActivityClassifier::name(activityClassifier.getActivity())).c_str());
+        if (activity_samples > 0) {
+            logger->info("ACTIVITY", (String("Cost: ") + String(activity_cycles / activity_samples) + " cycles/sample avg, " +
+                                      String(activity_cycles_max) + " max over " + String(activity_samples) + " samples").c_str());
+        }
+        activity_cycles = 0;
+        activity_cycles_max = 0;
+        activity_samples = 0;
+
+        if (imu.isAdaptiveRate()) {
+            uint32_t low_ms = imu.getRateResidencyMs(ImuRatePolicy::RATE_LOW);
+            uint32_t high_ms = imu.getRateResidencyMs(ImuRatePolicy::RATE_HIGH);
+            uint32_t total_ms = low_ms + high_ms;
+            if (total_ms > 0) {
+                float avg_hz = (low_ms * imu.getRateHz(ImuRatePolicy::RATE_LOW) + high_ms * imu.getRateHz(ImuRatePolicy::RATE_HIGH)) / total_ms;
+                logger->info("IMU", (String("ODR: now ") + String(imu.getSampleRateHz(), 1) + "Hz, low " + String(low_ms) + "ms / high " + String(high_ms) +
+                                     "ms, avg " + String(avg_hz, 1) + "Hz, " + String(imu.getRateSwitches()) + " switches").c_str());
+            }
+            imu.resetRateStats();
+        }
+
+        if (imuTrace.isRecording()) {
+            imuTrace.flush();
+            logger->info("TRACE", (String("Trace: ") + String(imuTrace.getRecordCount()) + " records, " + String(imuTrace.getDroppedCount()) +
+                                  " dropped, max write " + String(imuTrace.getWriteMaxUs()) + "us").c_str());
+        }
+    }
+
+    // Overnight actigraphy
+    if (sleepTracker.isActive()) {
+        sleepTracker.logSummary();
     }
     
     motor.buzz();
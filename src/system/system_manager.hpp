@@ -6,6 +6,8 @@
 #include <LittleFS.h>
 
 #include "config.h"
+#include "i2c/i2c_bus.hpp"
+#include "i2c/i2c_scheduler.hpp"
 #include "pmu/pmu.hpp"
 #include "display/display.hpp"
 #include "button/button.hpp"
@@ -13,11 +15,20 @@
 #include "touch/touch_controller.hpp"
 #include "rtc/rtc.hpp"
 #include "imu/imu.hpp"
+#include "imu/imu_trace.hpp"
+#include "imu/imu_calibrator.hpp"
 #include "motor/motor.hpp"
 #include "storage/sd_card.hpp"
 #include "speaker/speaker.hpp"
 #include "speaker/mic.hpp"
 #include "wifi/wifi_sync.hpp"
+#include "activity/pedometer.hpp"
+#include "activity/activity_classifier.hpp"
+#include "activity/sleep_tracker.hpp"
+#include "boot/init_graph.hpp"
+#include "scheduler/loop_scheduler.hpp"
+#include "power/power_manager.hpp"
+#include "sensor/sensor_task.hpp"
 
 class SystemManager {
 private:
@@ -25,9 +36,21 @@ private:
     bool sleeping = false;
     unsigned long last_activity_time = 0;
     static constexpr unsigned long LIGHT_SLEEP_TIMEOUT = 30000;  // 30 seconds
+    static constexpr unsigned long MOTION_WAKE_WINDOW = 3000;    // Awake time after an IMU motion wake
+    static constexpr uint32_t MOTION_HOLDOFF_MS = 2000;         // Motion counts as activity once per this
+    static constexpr uint32_t LOOPBACK_MS = 3000;               // Mic → speaker test after a long press
+    static constexpr uint32_t LOOPBACK_POLL_MS = 10;
+    bool motion_woken = false;
+    static constexpr uint8_t SLEEP_TRACK_START_HOUR = 22;       // Overnight actigraphy window (RTC local time)
+    static constexpr uint8_t SLEEP_TRACK_END_HOUR = 8;
+    bool fifo_woken = false;
+    bool rtc_woken = false;
+    bool time_sync_reported = false;            // Set by the first WiFiSync event
+    WiFiSync::Result time_sync_result = WiFiSync::RESULT_SYNCED;
     
     Logger* logger = nullptr;
-    TwoWire* i2c = nullptr;
+    I2CBus i2cBus;
+    I2CScheduler i2cScheduler;
     PMU pmu;
     FSManager fsManager;
     Display display;
@@ -39,9 +62,49 @@ private:
     Speaker speaker;
     Mic mic;
     WiFiSync wifiSync;
+    ImuTrace imuTrace;
+    ImuCalibrator imuCalibrator;
+    SleepTracker sleepTracker;
+    InitGraph initGraph;
+    LoopScheduler loop;
+    SensorTask sensors;
+    int8_t motion_wake_job = -1;    // One-shot: back to sleep MOTION_WAKE_WINDOW after a motion wake
+    int8_t resleep_job = -1;        // One-shot: back to sleep after a FIFO or RTC wake has been serviced
+    LoopScheduler::Timer motion_holdoff;   // No fn or events: armed is the state
+    PowerManager power;
+    uint32_t button_line = 0;       // PowerManager wake line bits
+    uint32_t imu_line = 0;
+    uint32_t rtc_line = 0;
+    int8_t usb_lock = -1;
+    bool usb_held = false;
+    Button button;
+    int8_t button_job = -1;         // One-shot: rearmed to whatever deadline the button asks for
+    int8_t loopback_job = -1;       // Mic → speaker while a long-press test runs
+    int8_t audio_lock = -1;
+    uint32_t loopback_end = 0;
+    bool loopback_logged = false;
+    Pedometer pedometer;
+    ActivityClassifier activityClassifier;
+
+    // Per-sample cost of pedometer + activity classifier (CPU cycles, reset each heartbeat)
+    uint32_t activity_cycles = 0;
+    uint32_t activity_cycles_max = 0;
+    uint32_t activity_samples = 0;
+
+    uint16_t activity_phase = 0;   // Q8 filter ticks owed to the current sample (low rate is held, see below)
+    void processActivitySample(const IMU::RawSample& raw, uint32_t time_us, ImuRatePolicy::Rate rate, bool gyro_valid);
+    void handleTap(const IMU::TapEvent& tap);
+    bool inSleepWindow();
+    void declareInit();
+    void declareLoop();
+    static void onButton(const Button::Event& event, void* ctx);
+    void startLoopback();
+    void serviceLoopback();
+    void holdUsb();
+    static void onTimeSync(const WiFiSync::Event& event, void* ctx);
 
     void sleep();
-    void wakeup();
+    void wakeup(uint32_t woke);
     void logHeartbeat();
 public:
     SystemManager(Logger* logger);
@@ -54,8 +117,12 @@ public:
     SDCard& getSDCard() { return sdCard; }
     Speaker& getSpeaker() { return speaker; }
     Mic& getMic() { return mic; }
+    Pedometer& getPedometer() { return pedometer; }
+    ActivityClassifier& getActivityClassifier() { return activityClassifier; }
     Logger* getLogger() { return logger; }
-    TwoWire* getI2C() { return i2c; }
+    I2CBus& getI2C() { return i2cBus; }
+    I2CScheduler& getI2CScheduler() { return i2cScheduler; }
+    const InitGraph& getInitGraph() const { return initGraph; }
     
     void update();
 };
\ No newline at end of file
@@ -2,21 +2,18 @@
 
 #include <Arduino.h>
 
-bool TouchController::setBus(TwoWire &bus) {
-    i2c = &bus;
+bool TouchController::setBus(I2CBus &bus) {
+    i2c.attach(bus);
     return init();
 }
 
 bool TouchController::sleep() {
-    if (!initialized || !i2c) return false;
-    i2c->beginTransmission(i2c_addr);
-    i2c->write(REG_POWER_MODE);
-    i2c->write(0x03);  // Deep sleep mode
-    return (i2c->endTransmission() == 0);
+    if (!initialized) return false;
+    return i2c.writeReg(REG_POWER_MODE, 0x03);  // Deep sleep mode
 }
 
 bool TouchController::wake() {
-    if (!i2c) return false;
+    if (!i2c.isAttached()) return false;
     // Hardware reset to exit deep sleep (I2C is unresponsive in deep sleep)
     pinMode(reset_pin, OUTPUT);
     digitalWrite(reset_pin, LOW);
@@ -24,14 +21,11 @@ bool TouchController::wake() {
     digitalWrite(reset_pin, HIGH);
     delay(50);
     // Restore operating mode
-    i2c->beginTransmission(i2c_addr);
-    i2c->write(REG_POWER_MODE);
-    i2c->write(0x01);
-    return (i2c->endTransmission() == 0);
+    return i2c.writeReg(REG_POWER_MODE, 0x01);
 }
 
 bool TouchController::init() {
-    if (!i2c) {
+    if (!i2c.isAttached()) {
         if (logger) logger->failure("TOUCH", "I2C bus not set");
         return false;
     }
@@ -46,10 +40,7 @@ bool TouchController::init() {
     delay(50);
 
     // Initialize power mode
-    i2c->beginTransmission(i2c_addr);
-    i2c->write(REG_POWER_MODE);
-    i2c->write(0x01);
-    if (i2c->endTransmission() != 0) {
+    if (!i2c.writeReg(REG_POWER_MODE, 0x01)) {
         if (logger) logger->failure("TOUCH", "Power mode init failed");
         return false;
     }
@@ -77,6 +68,7 @@ void IRAM_ATTR TouchController::isrArg(void* arg) {
     TouchController* self = static_cast<TouchController*>(arg);
     if (self) {
         self->touch_event = true;
+        if (self->irq_hook) self->irq_hook(self->irq_hook_ctx);
     }
 }
 
@@ -155,38 +147,42 @@ void TouchController::handleInterrupt() {
         touch_last_y = y;
         
         // Check for long press while finger is still down
-        if (!long_press_fired && touch_active) {
-            uint32_t duration = millis() - touch_start_time;
-            if (duration > 500) {
-                int16_t dx = x - touch_start_x;
-                int16_t dy = y - touch_start_y;
-                int16_t abs_dx = dx < 0 ? -dx : dx;
-                int16_t abs_dy = dy < 0 ? -dy : dy;
-                
-                // Fire long press if minimal movement (<20px)
-                if (abs_dx < 20 && abs_dy < 20) {
-                    long_press_fired = true;
-                    if (logger) {
-                        logger->info("TOUCH", "Gesture: Long Press");
-                    }
-                }
-            }
+        checkLongPress();
+    }
+}
+
+void TouchController::checkLongPress() {
+    if (long_press_fired || !touch_active) return;
+    if (millis() - touch_start_time < LONG_PRESS_MS) return;
+
+    int16_t dx = touch_last_x - touch_start_x;
+    int16_t dy = touch_last_y - touch_start_y;
+    int16_t abs_dx = dx < 0 ? -dx : dx;
+    int16_t abs_dy = dy < 0 ? -dy : dy;
+
+    // Fire long press if minimal movement (<20px)
+    if (abs_dx < 20 && abs_dy < 20) {
+        long_press_fired = true;
+        if (logger) {
+            logger->info("TOUCH", "Gesture: Long Press");
         }
     }
 }
 
+uint32_t TouchController::msUntilLongPress() const {
+    if (long_press_fired || !touch_active) return NO_DEADLINE;
+    uint32_t held = millis() - touch_start_time;
+    return held >= LONG_PRESS_MS ? 0 : LONG_PRESS_MS - held;
+}
+
 bool TouchController::safeReadRegisters(uint8_t reg, uint8_t* buf, size_t len, int retries) {
-    if (!i2c) return false;
+    if (!i2c.isAttached()) return false;
 
+    // 500us between address write and read; retries back off outside the bus lock
     for (int i=0; i<retries; i++) {
-        i2c->beginTransmission(i2c_addr);
-        i2c->write(reg);
-        if (i2c->endTransmission(false) != 0) { delay(10 + i*10); continue; }
-        delayMicroseconds(500);
-        size_t got = i2c->requestFrom(static_cast<uint8_t>(i2c_addr), static_cast<size_t>(len));
-        if (got < len) { delay(10 + i*10); continue; }
-        for (size_t j=0; j<len; j++) buf[j] = i2c->read();
-        return true;
+        if (i > 0) i2c.noteRetry();
+        if (i2c.readRegs(reg, buf, len, 500)) return true;
+        delay(10 + i*10);
     }
     return false;
 }
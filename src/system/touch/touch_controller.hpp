@@ -1,22 +1,27 @@
 #pragma once
 #include <Arduino.h>
-#include <Wire.h>
-
 #include "config.h"
+#include "../i2c/i2c_bus.hpp"
 #include "../../logger/logger.hpp"
 
 class TouchController {
+public:
+    typedef void (*IrqHook)(void* ctx);   // Must be IRAM-safe
+    static constexpr uint32_t LONG_PRESS_MS = 500;
+    static constexpr uint32_t NO_DEADLINE = 0xFFFFFFFF;
+
 private:
     static constexpr uint8_t ADDR_FT3168 = 0x38;
     static constexpr uint8_t DEV_ID = 3;
 
-    uint8_t i2c_addr = ADDR_FT3168; // default I2C address
     uint8_t interrupt_pin = TOUCH_INT;
     uint8_t reset_pin = TOUCH_RST;
-    TwoWire* i2c = nullptr;
+    I2CDevice i2c{"TOUCH", ADDR_FT3168, I2C_FAST_HZ};
     Logger* logger = nullptr;
     bool initialized = false;
     volatile bool touch_event = false;
+    IrqHook irq_hook = nullptr;     // Also called from the ISR, e.g. to wake the main loop
+    void* irq_hook_ctx = nullptr;
     
     // Software gesture detection
     bool touch_active = false;
@@ -33,9 +38,14 @@ private:
 public:
     // Constructor: optionally specify I2C address for different FT3x68 variants
     TouchController(Logger* logger) { this->logger = logger; };
-    bool setBus(TwoWire &bus);
+    bool setBus(I2CBus &bus);
 
     void handleInterrupt();
+    // Long press without waiting for the next report: check when msUntilLongPress() runs out
+    void checkLongPress();
+    uint32_t msUntilLongPress() const;   // NO_DEADLINE = no finger down, or already fired
+    void setIrqHook(IrqHook hook, void* ctx) { irq_hook_ctx = ctx; irq_hook = hook; }
+    void replayIrq() { isrArg(this); }   // An edge missed while the pin was a sleep wake source
     bool sleep();   // Deep sleep mode — use wake() to restore
     bool wake();    // Hardware reset + restore normal mode after sleep
 
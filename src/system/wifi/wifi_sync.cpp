@@ -1,4 +1,73 @@
 #include "wifi_sync.hpp"
+#include <string.h>
+#include <sys/time.h>
+#include "esp_sntp.h"
+
+namespace {
+
+// WiFi station + SNTP. Radio and SNTP run only during an attempt.
+class ArduinoNetwork : public WiFiSync::Network {
+public:
+    void connect(const char* ssid, const char* password, const WiFiSync::Link* link) override {
+        WiFi.mode(WIFI_STA);
+        if (link && link->ip) WiFi.config(IPAddress(link->ip), IPAddress(link->gateway), IPAddress(link->subnet), IPAddress(link->dns));
+        else WiFi.config(IPAddress(), IPAddress(), IPAddress());  // All zero: DHCP
+        // Known BSSID + channel: directed connect, no scan
+        if (link) WiFi.begin(ssid, password, link->channel, link->bssid);
+        else WiFi.begin(ssid, password);
+    }
+
+    bool isConnected() override { return WiFi.status() == WL_CONNECTED; }
+
+    void getLink(WiFiSync::Link& link) override {
+        const uint8_t* bssid = WiFi.BSSID();
+        if (bssid) memcpy(link.bssid, bssid, sizeof(link.bssid));
+        link.channel = WiFi.channel();
+        link.ip      = WiFi.localIP();
+        link.gateway = WiFi.gatewayIP();
+        link.subnet  = WiFi.subnetMask();
+        link.dns     = WiFi.dnsIP();
+    }
+
+    void startNtp() override {
+        // The clock is already seeded from the RTC, so a plausible local time
+        // doesn't mean NTP answered — wait for SNTP's own sync status
+        sntp_set_sync_status(SNTP_SYNC_STATUS_RESET);
+        configTime(0, 0, NTP_SERVER);  // UTC: no offset, no DST
+    }
+
+    bool getNtpTime(struct tm& timeinfo) override {
+        if (sntp_get_sync_status() != SNTP_SYNC_STATUS_COMPLETED) return false;
+        return getLocalTime(&timeinfo, 0);
+    }
+
+    void disconnect() override {
+        sntp_stop();
+        WiFi.disconnect(true);
+        WiFi.mode(WIFI_OFF);
+    }
+};
+
+ArduinoNetwork arduino_network;
+
+// WIFI_LINK_CACHE_FILE layout
+struct LinkFile {
+    uint32_t magic;
+    uint32_t ssid_hash;      // Cache belongs to the credentials it was made with
+    uint32_t saved;          // UTC seconds the lease came from DHCP
+    WiFiSync::Link link;
+};
+constexpr uint32_t LINK_MAGIC = 0x4B4E4C57;  // "WLNK"
+
+uint32_t hashSsid(const String& ssid) {
+    uint32_t h = 2166136261u;  // FNV-1a
+    for (size_t i = 0; i < ssid.length(); i++) h = (h ^ (uint8_t)ssid[i]) * 16777619u;
+    return h;
+}
+
+}  // namespace
+
+WiFiSync::WiFiSync(Logger* logger) : logger(logger), network(&arduino_network) {}
 
 bool WiFiSync::loadCredentials(String& ssid, String& password) {
     File f = LittleFS.open(WIFI_CREDENTIALS_FILE, "r");
@@ -17,73 +86,258 @@ bool WiFiSync::loadCredentials(String& ssid, String& password) {
     return true;
 }
 
-bool WiFiSync::waitForConnect(uint32_t timeoutMs) {
-    unsigned long start = millis();
-    while (WiFi.status() != WL_CONNECTED) {
-        if (millis() - start > timeoutMs) return false;
-        delay(200);
+bool WiFiSync::seedClock(RTC& rtc, Logger* logger) {
+    RTC::DateTime dt;
+    if (!rtc.getDateTime(dt)) return false;
+
+    struct tm timeinfo = {};
+    timeinfo.tm_year = dt.year - 1900;
+    timeinfo.tm_mon  = dt.month - 1;
+    timeinfo.tm_mday = dt.day;
+    timeinfo.tm_hour = dt.hour;
+    timeinfo.tm_min  = dt.minute;
+    timeinfo.tm_sec  = dt.second;
+    struct timeval tv = {mktime(&timeinfo), 0};  // TZ unset: mktime is UTC
+    if (settimeofday(&tv, nullptr) != 0) return false;
+
+    if (logger) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "Clock seeded from RTC: %04d-%02d-%02d %02d:%02d:%02d UTC",
+                 dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second);
+        logger->info("WIFI", buf);
     }
     return true;
 }
 
-bool WiFiSync::waitForNTP(struct tm& timeinfo, uint32_t timeoutMs) {
-    unsigned long start = millis();
-    while (!getLocalTime(&timeinfo)) {
-        if (millis() - start > timeoutMs) return false;
-        delay(200);
+bool WiFiSync::begin(RTC& rtc) {
+    this->rtc = &rtc;
+    if (!seedClock(rtc, logger) && logger) logger->warn("WIFI", "RTC time invalid, clock unset until NTP sync");
+
+    if (!loadCredentials(ssid, password)) {
+        enter(DISABLED, millis());
+        report(RESULT_NO_CREDENTIALS, 0);
+        return false;
     }
+    loadLink();
+    startAttempt(millis());
     return true;
 }
 
-bool WiFiSync::syncTime(RTC& rtc) {
-    String ssid, password;
-    if (!loadCredentials(ssid, password)) return false;
+void WiFiSync::loadLink() {
+    File f = LittleFS.open(WIFI_LINK_CACHE_FILE, "r");
+    if (!f) return;
+    LinkFile file;
+    bool ok = f.read((uint8_t*)&file, sizeof(file)) == sizeof(file);
+    f.close();
+    if (!ok || file.magic != LINK_MAGIC || file.ssid_hash != hashSsid(ssid)) return;
 
-    logger->info("WIFI", ("Connecting to: " + ssid).c_str());
-    WiFi.mode(WIFI_STA);
-    WiFi.begin(ssid.c_str(), password.c_str());
+    link = file.link;
+    link_saved = file.saved;
+    link_valid = true;
+}
 
-    if (!waitForConnect(WIFI_CONNECT_TIMEOUT_MS)) {
-        logger->failure("WIFI", "Connection timed out");
-        WiFi.disconnect(true);
-        WiFi.mode(WIFI_OFF);
-        return false;
+void WiFiSync::saveLink(const Link& fresh, bool dhcp) {
+    bool changed = !link_valid || memcmp(fresh.bssid, link.bssid, sizeof(link.bssid)) != 0 || fresh.channel != link.channel;
+    if (dhcp) {
+        link_saved = (uint32_t)time(nullptr);
+        changed = true;
     }
-    logger->success("WIFI", ("Connected, IP: " + WiFi.localIP().toString()).c_str());
+    link = fresh;
+    link_valid = true;
+    if (!changed) return;
 
-    // Sync NTP (UTC: no offset, no DST)
-    configTime(0, 0, NTP_SERVER);
+    LinkFile file = {LINK_MAGIC, hashSsid(ssid), link_saved, link};
+    File f = LittleFS.open(WIFI_LINK_CACHE_FILE, "w");
+    if (!f) return;
+    f.write((const uint8_t*)&file, sizeof(file));
+    f.close();
+}
 
-    struct tm timeinfo;
-    if (!waitForNTP(timeinfo, NTP_TIMEOUT_MS)) {
-        logger->failure("WIFI", "NTP sync timed out");
-        WiFi.disconnect(true);
-        WiFi.mode(WIFI_OFF);
-        return false;
+void WiFiSync::dropLink() {
+    link_valid = false;
+    LittleFS.remove(WIFI_LINK_CACHE_FILE);
+}
+
+bool WiFiSync::leaseFresh() const {
+    // Same clock for both ends; an NTP step backwards just means DHCP once more
+    uint32_t now = (uint32_t)time(nullptr);
+    return link.ip != 0 && link_saved != 0 && now >= link_saved && now - link_saved < WIFI_LEASE_REUSE_S;
+}
+
+void WiFiSync::enter(State next, uint32_t now) {
+    bool was_busy = isBusy();
+    state = next;
+    if (power && isBusy() != was_busy) {
+        if (was_busy) power->release(power_lock);
+        else power->acquire(power_lock);
     }
+    state_since = now;
+}
 
-    // Write to RTC
-    RTC::DateTime dt;
-    dt.year    = timeinfo.tm_year + 1900;
-    dt.month   = timeinfo.tm_mon + 1;
-    dt.day     = timeinfo.tm_mday;
-    dt.hour    = timeinfo.tm_hour;
-    dt.minute  = timeinfo.tm_min;
-    dt.second  = timeinfo.tm_sec;
-    dt.weekday = timeinfo.tm_wday;
-
-    bool ok = rtc.setDateTime(dt);
-    if (ok) {
-        char buf[48];
-        snprintf(buf, sizeof(buf), "RTC set to %04d-%02d-%02d %02d:%02d:%02d UTC",
-                 dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second);
-        logger->success("WIFI", buf);
+void WiFiSync::startAttempt(uint32_t now) {
+    attempt++;
+    attempt_start = now;
+    connect_ms = 0;
+    fast = link_valid;
+    static_ip = fast && leaseFresh();
+
+    Link hint = link;
+    if (!static_ip) hint.ip = 0;
+    if (logger) {
+        String line = String("Connecting to: ") + ssid + " (attempt " + String(attempt);
+        if (fast) line += String(", cached AP ch ") + String(link.channel) + (static_ip ? ", cached IP" : ", DHCP");
+        logger->info("WIFI", (line + ")").c_str());
+    }
+    network->connect(ssid.c_str(), password.c_str(), fast ? &hint : nullptr);
+    enter(CONNECTING, now);
+}
+
+void WiFiSync::connected(uint32_t now) {
+    connect_ms = now - attempt_start;
+    if (fast) {
+        connect_stats.fast++;
+        connect_stats.fast_ms += connect_ms;
     } else {
-        logger->failure("WIFI", "Failed to write time to RTC");
+        connect_stats.full++;
+        connect_stats.full_ms += connect_ms;
+    }
+    if (connect_ms > connect_stats.max_ms) connect_stats.max_ms = connect_ms;
+
+    Link fresh = {};
+    network->getLink(fresh);
+    saveLink(fresh, !static_ip);
+    if (logger) {
+        logger->success("WIFI", (String("Connected in ") + String(connect_ms) + "ms (" + (fast ? "cached AP" : "scan") + "), IP: " +
+                                 WiFi.localIP().toString()).c_str());
+    }
+}
+
+void WiFiSync::logConnectStats() {
+    if (!logger) return;
+    const ConnectStats& s = connect_stats;
+    String line = String("Connect: cached ") + String(s.fast);
+    if (s.fast) line += " avg " + String(s.fast_ms / s.fast) + "ms";
+    line += ", scan " + String(s.full);
+    if (s.full) line += " avg " + String(s.full_ms / s.full) + "ms";
+    line += ", " + String(s.fallbacks) + " fallbacks, max " + String(s.max_ms) + "ms";
+    logger->info("WIFI", line.c_str());
+}
+
+void WiFiSync::fail(Result result, uint32_t now) {
+    network->disconnect();
+    failures++;
+
+    uint32_t backoff = WIFI_RETRY_BASE_MS;
+    for (uint8_t i = 1; i < attempt && backoff < WIFI_RETRY_MAX_MS; i++) backoff *= 2;
+    if (backoff > WIFI_RETRY_MAX_MS) backoff = WIFI_RETRY_MAX_MS;
+
+    next_attempt = now + backoff;
+    enter(BACKOFF, now);
+    report(result, backoff, connect_ms);
+}
+
+void WiFiSync::report(Result result, uint32_t next_ms, uint32_t connect_ms) {
+    if (logger) {
+        String line = String(resultName(result));
+        if (next_ms > 0) line += ", next attempt in " + String(next_ms / 1000) + "s";
+        if (result == RESULT_SYNCED) logger->success("WIFI", line.c_str());
+        else logger->warn("WIFI", line.c_str());
+    }
+    if (callback) {
+        Event event = {result, attempt, next_ms, connect_ms};
+        callback(event, callback_ctx);
+    }
+}
+
+void WiFiSync::service(uint32_t now) {
+    switch (state) {
+        case DISABLED:
+            return;
+
+        case CONNECTING:
+            if (network->isConnected()) {
+                connected(now);
+                network->startNtp();
+                enter(WAIT_NTP, now);
+            } else if (fast && now - state_since > WIFI_FAST_CONNECT_TIMEOUT_MS) {
+                // AP moved channel or went away — forget it and scan within this attempt
+                if (logger) logger->warn("WIFI", "Cached AP not answering, scanning");
+                connect_stats.fallbacks++;
+                network->disconnect();
+                dropLink();
+                fast = false;
+                static_ip = false;
+                network->connect(ssid.c_str(), password.c_str(), nullptr);
+                enter(CONNECTING, now);
+            } else if (now - state_since > WIFI_CONNECT_TIMEOUT_MS) {
+                fail(RESULT_CONNECT_TIMEOUT, now);
+            }
+            return;
+
+        case WAIT_NTP: {
+            struct tm timeinfo;
+            if (network->getNtpTime(timeinfo)) {
+                network->disconnect();
+
+                RTC::DateTime dt;
+                dt.year    = timeinfo.tm_year + 1900;
+                dt.month   = timeinfo.tm_mon + 1;
+                dt.day     = timeinfo.tm_mday;
+                dt.hour    = timeinfo.tm_hour;
+                dt.minute  = timeinfo.tm_min;
+                dt.second  = timeinfo.tm_sec;
+                dt.weekday = timeinfo.tm_wday;
+                if (rtc && !rtc->setDateTime(dt)) {
+                    fail(RESULT_RTC_WRITE_FAILED, now);
+                    return;
+                }
+                if (logger) {
+                    char buf[48];
+                    snprintf(buf, sizeof(buf), "RTC set to %04d-%02d-%02d %02d:%02d:%02d UTC",
+                             dt.year, dt.month, dt.day, dt.hour, dt.minute, dt.second);
+                    logger->info("WIFI", buf);
+                }
+
+                syncs++;
+                last_sync = now ? now : 1;
+                next_attempt = now + WIFI_RESYNC_MS;
+                enter(SYNCED, now);
+                report(RESULT_SYNCED, WIFI_RESYNC_MS, connect_ms);
+                attempt = 0;
+            } else if (now - state_since > NTP_TIMEOUT_MS) {
+                // Associated but no traffic: a reused lease may have been handed out again
+                if (static_ip) link_saved = 0;
+                fail(RESULT_NTP_TIMEOUT, now);
+            }
+            return;
+        }
+
+        case SYNCED:
+        case BACKOFF:
+            if ((int32_t)(now - next_attempt) >= 0) startAttempt(now);
+            return;
     }
+}
 
-    WiFi.disconnect(true);
-    WiFi.mode(WIFI_OFF);
-    logger->info("WIFI", "WiFi disconnected");
-    return ok;
+const char* WiFiSync::stateName(State state) {
+    switch (state) {
+        case DISABLED:   return "disabled";
+        case CONNECTING: return "connecting";
+        case WAIT_NTP:   return "waiting for NTP";
+        case SYNCED:     return "synced";
+        case BACKOFF:    return "backing off";
+    }
+    return "?";
 }
+
+const char* WiFiSync::resultName(Result result) {
+    switch (result) {
+        case RESULT_SYNCED:           return "Time synced";
+        case RESULT_NO_CREDENTIALS:   return "No WiFi credentials, time sync disabled";
+        case RESULT_CONNECT_TIMEOUT:  return "Connection timed out";
+        case RESULT_NTP_TIMEOUT:      return "NTP sync timed out";
+        case RESULT_RTC_WRITE_FAILED: return "Failed to write time to RTC";
+    }
+    return "?";
+}
+
@@ -2,25 +2,164 @@
 #include <Arduino.h>
 #include <WiFi.h>
 #include <LittleFS.h>
-#include "logger/logger.hpp"
+#include <time.h>
+#include "../../logger/logger.hpp"
 #include "../rtc/rtc.hpp"
+#include "../power/power_manager.hpp"
 
 #define WIFI_CREDENTIALS_FILE   "/wifi.txt"
+#define WIFI_LINK_CACHE_FILE    "/wifi_link.bin"
 #define NTP_SERVER              "pool.ntp.org"
 #define NTP_TIMEOUT_MS          10000
 #define WIFI_CONNECT_TIMEOUT_MS 15000
+#define WIFI_RETRY_BASE_MS      30000       // First retry after a failed attempt, doubles each time
+#define WIFI_RETRY_MAX_MS       1800000     // Backoff cap (30 min)
+#define WIFI_RESYNC_MS          86400000    // Re-sync daily once synced
+#define WIFI_FAST_CONNECT_TIMEOUT_MS 3000   // Directed connect to the cached AP before falling back to a scan
+#define WIFI_LEASE_REUSE_S      43200       // Reuse the cached IP as static config for 12h, then DHCP again
 
+/**
+ * Background NTP → RTC time sync.
+ *
+ * begin() seeds the system clock from the RTC and starts the first attempt
+ * without waiting on the network. service() advances the state machine from
+ * the main loop and never blocks:
+ *
+ *   CONNECTING → WAIT_NTP → SYNCED (radio off, re-sync in a day)
+ *        ↓           ↓
+ *        └──→ BACKOFF (radio off, 30s doubling to 30 min) → CONNECTING
+ *
+ * Every attempt ends in an Event passed to the callback.
+ *
+ * The last good association (BSSID, channel, IP lease) is cached in LittleFS.
+ * An attempt first does a directed connect to it, skipping the scan and, while
+ * the lease is fresh, DHCP. If that fails it falls back to a full scan within
+ * the same attempt.
+ */
 class WiFiSync {
+public:
+    enum State : uint8_t {
+        DISABLED = 0,    // No credentials
+        CONNECTING,
+        WAIT_NTP,
+        SYNCED,
+        BACKOFF
+    };
+
+    enum Result : uint8_t {
+        RESULT_SYNCED = 0,
+        RESULT_NO_CREDENTIALS,
+        RESULT_CONNECT_TIMEOUT,
+        RESULT_NTP_TIMEOUT,
+        RESULT_RTC_WRITE_FAILED
+    };
+
+    struct Event {
+        Result result;
+        uint8_t attempt;         // 1-based attempt since the last success
+        uint32_t next_ms;        // Until the next attempt (0 = none scheduled)
+        uint32_t connect_ms;     // Association + IP time of this attempt (0 = never connected)
+    };
+
+    // Last good association, reused for a directed connect
+    struct Link {
+        uint8_t bssid[6];
+        uint8_t channel;
+        uint32_t ip;             // 0 = use DHCP
+        uint32_t gateway;
+        uint32_t subnet;
+        uint32_t dns;
+    };
+
+    struct ConnectStats {
+        uint32_t fast = 0;       // Directed connects that succeeded
+        uint32_t fast_ms = 0;    // Total time of those
+        uint32_t full = 0;       // Connects after a scan
+        uint32_t full_ms = 0;
+        uint32_t fallbacks = 0;  // Directed connects that gave up and scanned
+        uint32_t max_ms = 0;
+    };
+
+    typedef void (*EventCallback)(const Event& event, void* ctx);
+
+    // Network side of an attempt — tests swap in a scripted stand-in
+    class Network {
+    public:
+        virtual ~Network() {}
+        // link = nullptr: scan for the SSID and use DHCP
+        virtual void connect(const char* ssid, const char* password, const Link* link) = 0;
+        virtual bool isConnected() = 0;
+        virtual void getLink(Link& link) = 0;                // While connected
+        virtual void startNtp() = 0;
+        virtual bool getNtpTime(struct tm& timeinfo) = 0;   // True once a server has answered
+        virtual void disconnect() = 0;
+    };
+
 private:
     Logger* logger = nullptr;
+    Network* network;
+    RTC* rtc = nullptr;
+    String ssid;
+    String password;
+
+    // Link cache
+    Link link = {};
+    bool link_valid = false;
+    uint32_t link_saved = 0;     // UTC seconds when the IP lease was last taken from DHCP
+    bool fast = false;           // Current attempt is a directed connect
+    bool static_ip = false;      // ... reusing the cached lease instead of DHCP
+    uint32_t connect_ms = 0;     // Of the current attempt
+    uint32_t attempt_start = 0;
+    ConnectStats connect_stats;
+
+    State state = DISABLED;
+    uint32_t state_since = 0;
+    uint32_t next_attempt = 0;
+    uint8_t attempt = 0;
+    uint32_t syncs = 0;
+    uint32_t failures = 0;
+    uint32_t last_sync = 0;
+
+    EventCallback callback = nullptr;
+    void* callback_ctx = nullptr;
+    PowerManager* power = nullptr;   // Lock held while the radio is up — light sleep would drop the link
+    int8_t power_lock = -1;
 
     bool loadCredentials(String& ssid, String& password);
-    bool waitForConnect(uint32_t timeoutMs);
-    bool waitForNTP(struct tm& timeinfo, uint32_t timeoutMs);
+    void enter(State next, uint32_t now);
+    void startAttempt(uint32_t now);
+    void fail(Result result, uint32_t now);
+    void report(Result result, uint32_t next_ms, uint32_t connect_ms = 0);
+    void loadLink();
+    void saveLink(const Link& fresh, bool dhcp);
+    void dropLink();
+    void connected(uint32_t now);
+    bool leaseFresh() const;
 
 public:
-    WiFiSync(Logger* logger) : logger(logger) {}
+    WiFiSync(Logger* logger);
+
+    // Seed the system clock from the RTC, then start syncing in the background.
+    // Returns false if there are no credentials (the clock is still seeded).
+    bool begin(RTC& rtc);
+    void service() { service(millis()); }
+    void service(uint32_t now);
+
+    void setCallback(EventCallback callback, void* ctx) { this->callback = callback; callback_ctx = ctx; }
+    void setNetwork(Network& network) { this->network = &network; }
+    void setPowerLock(PowerManager& power, int8_t lock) { this->power = &power; power_lock = lock; }
+
+    State getState() const { return state; }
+    bool isBusy() const { return state == CONNECTING || state == WAIT_NTP; }
+    uint32_t getSyncCount() const { return syncs; }
+    uint32_t getFailureCount() const { return failures; }
+    uint32_t getLastSync() const { return last_sync; }      // millis() of the last success, 0 = never
+    const ConnectStats& getConnectStats() const { return connect_stats; }
+    bool hasCachedLink() const { return link_valid; }
+    void logConnectStats();
+    static const char* stateName(State state);
+    static const char* resultName(Result result);
 
-    // Connect to WiFi, sync NTP → RTC, then disconnect. Returns true if RTC was updated.
-    bool syncTime(RTC& rtc);
+    // System time (UTC) from the RTC — false if the RTC has lost its time
+    static bool seedClock(RTC& rtc, Logger* logger);
 };
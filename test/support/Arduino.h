@@ -0,0 +1,171 @@
+#pragma once
+/**
+ * Arduino core stand-in for the native test build (pio test -e native).
+ *
+ * Just the API the drivers under test use: String, the clock (sim/clock.hpp),
+ * GPIO levels and interrupts (sim/pins.hpp) and a few ESP32 extras.
+ */
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <algorithm>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+#include "sim/clock.hpp"
+#include "sim/pins.hpp"
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#define HIGH 0x1
+#define LOW  0x0
+
+#define INPUT          0x01
+#define OUTPUT         0x03
+#define PULLUP         0x04
+#define INPUT_PULLUP   0x05
+#define PULLDOWN       0x08
+#define INPUT_PULLDOWN 0x09
+
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+using std::max;
+using std::min;
+
+class String {
+private:
+    std::string text;
+
+    template <typename T>
+    static std::string integer(T value, unsigned char base) {
+        if (base == DEC) return std::to_string(value);
+        typedef typename std::make_unsigned<T>::type U;
+        U n = (U)value;
+        std::string digits;
+        do {
+            digits.insert(digits.begin(), "0123456789abcdef"[n % base]);
+            n /= base;
+        } while (n);
+        return digits;
+    }
+
+    static std::string decimal(double value, unsigned int places) {
+        char buf[64];
+        snprintf(buf, sizeof(buf), "%.*f", (int)places, value);
+        return buf;
+    }
+
+public:
+    String() {}
+    String(const char* c) : text(c ? c : "") {}
+    String(const std::string& s) : text(s) {}
+    explicit String(char c) : text(1, c) {}
+    template <typename T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, char>::value, int>::type = 0>
+    String(T value, unsigned char base = DEC) : text(integer(value, base)) {}
+    template <typename T, typename std::enable_if<std::is_enum<T>::value, int>::type = 0>
+    String(T value, unsigned char base = DEC) : text(integer((int)value, base)) {}
+    explicit String(float value, unsigned int places = 2) : text(decimal(value, places)) {}
+    explicit String(double value, unsigned int places = 2) : text(decimal(value, places)) {}
+
+    const char* c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    bool isEmpty() const { return text.empty(); }
+    void reserve(unsigned int size) { text.reserve(size); }
+
+    char operator[](unsigned int index) const { return index < text.size() ? text[index] : 0; }
+    char charAt(unsigned int index) const { return (*this)[index]; }
+
+    String& operator+=(const String& other) { text += other.text; return *this; }
+    String& operator+=(const char* other) { text += other ? other : ""; return *this; }
+    String& operator+=(char c) { text += c; return *this; }
+    bool concat(const String& other) { text += other.text; return true; }
+
+    bool operator==(const String& other) const { return text == other.text; }
+    bool operator==(const char* other) const { return text == (other ? other : ""); }
+    bool operator!=(const String& other) const { return text != other.text; }
+    bool operator!=(const char* other) const { return !(*this == other); }
+    bool equals(const String& other) const { return text == other.text; }
+
+    int indexOf(char c, unsigned int from = 0) const {
+        size_t at = text.find(c, from);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+    int indexOf(const String& s, unsigned int from = 0) const {
+        size_t at = text.find(s.text, from);
+        return at == std::string::npos ? -1 : (int)at;
+    }
+    String substring(unsigned int from, unsigned int to = 0xFFFFFFFF) const {
+        if (from > text.size()) return String();
+        return String(text.substr(from, to == 0xFFFFFFFF ? std::string::npos : to - from));
+    }
+    bool startsWith(const String& prefix) const { return text.compare(0, prefix.text.size(), prefix.text) == 0; }
+    void trim() {
+        size_t first = text.find_first_not_of(" \t\r\n");
+        size_t last = text.find_last_not_of(" \t\r\n");
+        text = first == std::string::npos ? std::string() : text.substr(first, last - first + 1);
+    }
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return (float)atof(text.c_str()); }
+
+    friend String operator+(const String& a, const String& b) { return String(a.text + b.text); }
+    friend String operator+(const String& a, const char* b) { return String(a.text + (b ? b : "")); }
+    friend String operator+(const char* a, const String& b) { return String((a ? a : "") + b.text); }
+    friend String operator+(const String& a, char b) { return String(a.text + b); }
+};
+
+// Clock
+
+inline unsigned long millis() { return (unsigned long)(sim::nowUs() / 1000); }
+inline unsigned long micros() { return (unsigned long)sim::nowUs(); }
+inline void delay(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+inline void delayMicroseconds(uint32_t us) { std::this_thread::sleep_for(std::chrono::microseconds(us)); }
+inline void yield() { std::this_thread::yield(); }
+
+// What -Wl,--wrap=delay leaves behind for the boot profiler's delay() wrapper to call
+extern "C" inline void __real_delay(uint32_t ms) { delay(ms); }
+
+// GPIO
+
+inline void pinMode(uint8_t pin, uint8_t mode) { sim::Pins::get().setMode(pin, mode); }
+inline int digitalRead(uint8_t pin) { return sim::Pins::get().level(pin); }
+inline void digitalWrite(uint8_t pin, uint8_t value) { sim::Pins::get().setLevel(pin, value); }
+inline int digitalPinToInterrupt(uint8_t pin) { return pin; }
+inline void attachInterrupt(uint8_t pin, void (*isr)(), int mode) { sim::Pins::get().attach(pin, mode, isr, nullptr, nullptr); }
+inline void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) { sim::Pins::get().attach(pin, mode, nullptr, isr, arg); }
+inline void detachInterrupt(uint8_t pin) { sim::Pins::get().detach(pin); }
+
+// ESP32 extras
+
+class EspClass {
+public:
+    // 240MHz worth of cycles on the host clock
+    uint32_t getCycleCount() { return (uint32_t)(sim::nowUs() * 240); }
+    uint32_t getCpuFreqMHz() { return 240; }
+    uint32_t getFreeHeap() { return 256 * 1024; }
+};
+
+inline EspClass ESP;
+
+// SNTP is never started in the native build: configTime() does nothing and the host clock is the local time
+inline void configTime(long gmt_offset_sec, int daylight_offset_sec, const char* server1, const char* server2 = nullptr, const char* server3 = nullptr) {
+    (void)gmt_offset_sec; (void)daylight_offset_sec; (void)server1; (void)server2; (void)server3;
+}
+inline bool getLocalTime(struct tm* info, uint32_t ms = 5000) {
+    (void)ms;
+    time_t now = time(nullptr);
+    return localtime_r(&now, info) != nullptr;
+}
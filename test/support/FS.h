@@ -0,0 +1,106 @@
+#pragma once
+#include <Arduino.h>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * FS stand-in for the native test build, shared by LittleFS and SD: files live
+ * in memory for the life of the process, so a second driver instance sees what
+ * the first wrote (as after a reboot). Tests can seed or inspect them with the
+ * same API. Flat: no directories. setCapacity() makes writes come up short
+ * once the volume is full.
+ */
+#define FILE_READ   "r"
+#define FILE_WRITE  "w"
+#define FILE_APPEND "a"
+
+class File {
+private:
+    std::shared_ptr<std::vector<uint8_t>> data;
+    size_t position = 0;
+    bool writable = false;
+    uint64_t room = 0;    // Free space on the volume when opened
+
+public:
+    File() {}
+    File(std::shared_ptr<std::vector<uint8_t>> data, bool writable, bool append, uint64_t room = UINT64_MAX)
+        : data(data), position(append ? data->size() : 0), writable(writable), room(room) {}
+
+    operator bool() const { return data != nullptr; }
+
+    size_t size() const { return data ? data->size() : 0; }
+    int available() const { return data ? (int)(data->size() - position) : 0; }
+
+    int read() { return available() > 0 ? (*data)[position++] : -1; }
+    size_t read(uint8_t* buffer, size_t length) {
+        size_t n = std::min(length, (size_t)available());
+        if (n) memcpy(buffer, data->data() + position, n);
+        position += n;
+        return n;
+    }
+    String readStringUntil(char terminator) {
+        std::string text;
+        int c;
+        while ((c = read()) >= 0 && c != terminator) text += (char)c;
+        return String(text);
+    }
+
+    size_t write(const uint8_t* buffer, size_t length) {
+        if (!data || !writable) return 0;
+        if (length > room) length = room;
+        room -= length;
+        data->insert(data->end(), buffer, buffer + length);
+        position = data->size();
+        return length;
+    }
+    size_t write(uint8_t c) { return write(&c, 1); }
+    size_t print(const char* text) { return write((const uint8_t*)text, strlen(text)); }
+    size_t print(const String& text) { return print(text.c_str()); }
+
+    bool isDirectory() const { return false; }
+    File openNextFile() { return File(); }
+    const char* name() const { return ""; }
+
+    void flush() {}
+    void close() { data.reset(); }
+};
+
+class MemoryFS {
+protected:
+    std::map<std::string, std::shared_ptr<std::vector<uint8_t>>> files;
+    bool mounted = true;
+    uint64_t capacity = UINT64_MAX;
+
+public:
+    void format() { files.clear(); }
+    void setCapacity(uint64_t bytes) { capacity = bytes; }
+
+    bool exists(const char* path) const { return files.count(path) != 0; }
+    bool remove(const char* path) { return files.erase(path) != 0; }
+    bool rename(const char* from, const char* to) {
+        auto it = files.find(from);
+        if (it == files.end()) return false;
+        files[to] = it->second;
+        files.erase(from);
+        return true;
+    }
+    bool mkdir(const char* path) { (void)path; return mounted; }
+
+    File open(const char* path, const char* mode = FILE_READ) {
+        if (!mounted) return File();
+        bool write = mode[0] == 'w';
+        bool append = mode[0] == 'a';
+        auto it = files.find(path);
+        if (!write && !append) return it == files.end() ? File() : File(it->second, false, false);
+        if (write || it == files.end()) files[path] = std::make_shared<std::vector<uint8_t>>();
+        uint64_t used = usedBytes();
+        return File(files[path], true, append, capacity > used ? capacity - used : 0);
+    }
+
+    uint64_t usedBytes() const {
+        uint64_t used = 0;
+        for (const auto& f : files) used += f.second->size();
+        return used;
+    }
+};
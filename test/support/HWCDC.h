@@ -0,0 +1,16 @@
+#pragma once
+#include <Arduino.h>
+
+// USB CDC serial stand-in: Logger output goes to stdout
+class HWCDC {
+public:
+    void begin(unsigned long baud = 115200) { (void)baud; }
+    operator bool() const { return true; }
+
+    size_t print(const char* text) { return fputs(text, stdout) >= 0 ? strlen(text) : 0; }
+    size_t print(const String& text) { return print(text.c_str()); }
+    size_t println(const char* text) { size_t n = print(text); fputc('\n', stdout); return n + 1; }
+    size_t println(const String& text) { return println(text.c_str()); }
+    size_t println() { fputc('\n', stdout); return 1; }
+    void flush() { fflush(stdout); }
+};
@@ -0,0 +1,13 @@
+#pragma once
+#include "FS.h"
+
+// LittleFS on the in-memory FS (FS.h)
+class LittleFSFS : public MemoryFS {
+public:
+    bool begin(bool format_on_fail = false) { (void)format_on_fail; mounted = true; return true; }
+    void end() { mounted = false; }
+
+    uint64_t totalBytes() const { return capacity == UINT64_MAX ? 1536ULL * 1024 : capacity; }
+};
+
+inline LittleFSFS LittleFS;
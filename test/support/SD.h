@@ -0,0 +1,36 @@
+#pragma once
+#include "FS.h"
+#include "SPI.h"
+
+/**
+ * SD on the in-memory FS (FS.h): a card is always present unless a test
+ * calls removeCard() first.
+ */
+enum sdcard_type_t { CARD_NONE = 0, CARD_MMC, CARD_SD, CARD_SDHC, CARD_UNKNOWN };
+
+class SDFS : public MemoryFS {
+private:
+    bool card = true;
+
+public:
+    bool begin(uint8_t ss, SPIClass& spi, uint32_t frequency = 4000000, const char* mountpoint = "/sd", uint8_t max_files = 5,
+               bool format_if_empty = false) {
+        (void)ss;
+        (void)spi;
+        (void)frequency;
+        (void)mountpoint;
+        (void)max_files;
+        (void)format_if_empty;
+        mounted = card;
+        return card;
+    }
+    void end() { mounted = false; }
+
+    sdcard_type_t cardType() const { return mounted ? CARD_SDHC : CARD_NONE; }
+    uint64_t totalBytes() const { return mounted ? 32ULL << 30 : 0; }
+
+    void insertCard() { card = true; }
+    void removeCard() { card = false; mounted = false; }
+};
+
+inline SDFS SD;
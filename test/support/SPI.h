@@ -0,0 +1,37 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * SPI stand-in for the native test build: nothing on the other end, reads
+ * return the idle-high bus.
+ */
+#define HSPI      2
+#define FSPI      1
+#define MSBFIRST  1
+#define SPI_MODE0 0
+
+struct SPISettings {
+    SPISettings(uint32_t clock = 1000000, uint8_t bit_order = MSBFIRST, uint8_t mode = SPI_MODE0) {
+        (void)clock;
+        (void)bit_order;
+        (void)mode;
+    }
+};
+
+class SPIClass {
+public:
+    explicit SPIClass(uint8_t bus = HSPI) { (void)bus; }
+
+    void begin(int8_t sck = -1, int8_t miso = -1, int8_t mosi = -1, int8_t ss = -1) {
+        (void)sck;
+        (void)miso;
+        (void)mosi;
+        (void)ss;
+    }
+    void end() {}
+    void beginTransaction(const SPISettings& settings) { (void)settings; }
+    void endTransaction() {}
+    uint8_t transfer(uint8_t data) { (void)data; return 0xFF; }
+};
+
+inline SPIClass SPI(FSPI);
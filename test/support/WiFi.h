@@ -0,0 +1,61 @@
+#pragma once
+#include <Arduino.h>
+
+/**
+ * WiFi station stand-in for the native test build: a radio with no access
+ * point in range. It never connects; drivers that need a network take a
+ * scripted one from the test instead.
+ */
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6
+} wl_status_t;
+
+typedef enum {
+    WIFI_OFF = 0,
+    WIFI_STA,
+    WIFI_AP,
+    WIFI_AP_STA
+} wifi_mode_t;
+
+class IPAddress {
+private:
+    uint32_t address = 0;
+
+public:
+    IPAddress() {}
+    IPAddress(uint32_t address) : address(address) {}
+    IPAddress(uint8_t a, uint8_t b, uint8_t c, uint8_t d) : address(a | (b << 8) | (c << 16) | ((uint32_t)d << 24)) {}
+    operator uint32_t() const { return address; }
+
+    String toString() const {
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%u.%u.%u.%u", address & 0xFF, (address >> 8) & 0xFF, (address >> 16) & 0xFF, address >> 24);
+        return String(buf);
+    }
+};
+
+class WiFiClass {
+private:
+    wifi_mode_t current = WIFI_OFF;
+
+public:
+    bool mode(wifi_mode_t mode) { current = mode; return true; }
+    wifi_mode_t getMode() const { return current; }
+    bool config(IPAddress, IPAddress, IPAddress, IPAddress = IPAddress()) { return true; }
+    wl_status_t begin(const char*, const char* = nullptr, int32_t = 0, const uint8_t* = nullptr, bool = true) { return WL_DISCONNECTED; }
+    wl_status_t status() const { return current == WIFI_OFF ? WL_IDLE_STATUS : WL_DISCONNECTED; }
+    bool disconnect(bool wifi_off = false) { if (wifi_off) current = WIFI_OFF; return true; }
+
+    const uint8_t* BSSID() const { return nullptr; }
+    int32_t channel() const { return 0; }
+    IPAddress localIP() const { return IPAddress(); }
+    IPAddress gatewayIP() const { return IPAddress(); }
+    IPAddress subnetMask() const { return IPAddress(); }
+    IPAddress dnsIP(uint8_t = 0) const { return IPAddress(); }
+};
+
+inline WiFiClass WiFi;
@@ -0,0 +1,178 @@
+#pragma once
+#include <Arduino.h>
+#include "sim/device.hpp"
+
+/**
+ * TwoWire on a simulated bus, for the native test build.
+ *
+ * Transactions go to the sim::Device models attached at their addresses;
+ * an address nobody answers NACKs. Each transaction advances the clock by
+ * its time on the wire at the current bus clock.
+ *
+ * Faults are per address and deterministic (seeded xorshift), so a failing
+ * run can be repeated:
+ *   nack_percent        the address phase is NACKed, the device never sees it
+ *   short_read_percent  a read delivers one byte less than asked
+ *   latency_us          the device stretches the clock before answering
+ */
+class TwoWire {
+public:
+    static constexpr size_t BUFFER_LENGTH = 128;   // As the ESP32 core
+    static constexpr uint8_t MAX_DEVICES = 8;
+    static constexpr uint8_t MAX_FAULTS = 8;
+
+    struct Fault {
+        uint8_t addr;
+        uint8_t nack_percent;
+        uint8_t short_read_percent;
+        uint16_t latency_us;
+    };
+
+private:
+    uint8_t bus_num;
+    bool started = false;
+    uint32_t frequency = 100000;
+
+    sim::Device* devices[MAX_DEVICES] = {nullptr};
+    uint8_t device_count = 0;
+    Fault faults[MAX_FAULTS];
+    uint8_t fault_count = 0;
+    uint32_t seed = 0x2545F491;
+    uint32_t injected = 0;
+    uint32_t transactions = 0;
+
+    uint8_t tx_addr = 0;
+    uint8_t tx_buffer[BUFFER_LENGTH];
+    size_t tx_len = 0;
+    bool tx_overflow = false;
+    uint8_t rx_buffer[BUFFER_LENGTH];
+    size_t rx_len = 0;
+    size_t rx_pos = 0;
+
+    sim::Device* deviceAt(uint8_t addr) const {
+        for (uint8_t i = 0; i < device_count; i++) {
+            if (devices[i]->address == addr) return devices[i];
+        }
+        return nullptr;
+    }
+
+    const Fault* faultFor(uint8_t addr) const {
+        for (uint8_t i = 0; i < fault_count; i++) {
+            if (faults[i].addr == addr) return &faults[i];
+        }
+        return nullptr;
+    }
+
+    bool roll(uint8_t percent) {
+        if (percent == 0) return false;
+        seed ^= seed << 13;
+        seed ^= seed >> 17;
+        seed ^= seed << 5;
+        if (seed % 100 >= percent) return false;
+        injected++;
+        return true;
+    }
+
+    // Start + address + payload bytes with their ACK bits + stop
+    void wireTime(size_t bytes) {
+        uint64_t bits = 2 + 9 * (1 + bytes);
+        sim::advanceUs(bits * 1000000ULL / (frequency ? frequency : 100000));
+        transactions++;
+    }
+
+public:
+    explicit TwoWire(uint8_t bus_num) : bus_num(bus_num) {}
+
+    bool begin(int sda = -1, int scl = -1, uint32_t hz = 0) {
+        (void)sda;
+        (void)scl;
+        if (hz) frequency = hz;
+        started = true;
+        return true;
+    }
+    bool end() { started = false; return true; }
+    bool setClock(uint32_t hz) { frequency = hz; return true; }
+    uint32_t getClock() { return frequency; }
+
+    void beginTransmission(uint8_t addr) {
+        tx_addr = addr;
+        tx_len = 0;
+        tx_overflow = false;
+    }
+    void beginTransmission(int addr) { beginTransmission((uint8_t)addr); }
+
+    size_t write(uint8_t value) {
+        if (tx_len >= BUFFER_LENGTH) {
+            tx_overflow = true;
+            return 0;
+        }
+        tx_buffer[tx_len++] = value;
+        return 1;
+    }
+    size_t write(const uint8_t* data, size_t len) {
+        size_t n = 0;
+        while (n < len && write(data[n])) n++;
+        return n;
+    }
+
+    // 0 ok, 1 too long, 2 address NACK, 3 data NACK, 4 other — as the Arduino core
+    uint8_t endTransmission(bool stop = true) {
+        (void)stop;
+        if (!started) return 4;
+        if (tx_overflow) return 1;
+        const Fault* fault = faultFor(tx_addr);
+        if (fault && fault->latency_us) sim::advanceUs(fault->latency_us);
+        sim::Device* device = deviceAt(tx_addr);
+        if (!device || !device->present() || (fault && roll(fault->nack_percent))) {
+            wireTime(0);
+            return 2;
+        }
+        wireTime(tx_len);
+        return device->transmit(tx_buffer, tx_len) ? 0 : 3;
+    }
+
+    size_t requestFrom(uint8_t addr, size_t len, bool stop = true) {
+        (void)stop;
+        rx_len = rx_pos = 0;
+        if (!started || len > BUFFER_LENGTH) return 0;
+        sim::Device* device = deviceAt(addr);
+        if (!device || !device->present()) {
+            wireTime(0);
+            return 0;
+        }
+        const Fault* fault = faultFor(addr);
+        if (fault && roll(fault->short_read_percent) && len > 0) len--;
+        rx_len = device->receive(rx_buffer, len);
+        wireTime(rx_len);
+        return rx_len;
+    }
+
+    int available() { return (int)(rx_len - rx_pos); }
+    int read() { return rx_pos < rx_len ? rx_buffer[rx_pos++] : -1; }
+    int peek() { return rx_pos < rx_len ? rx_buffer[rx_pos] : -1; }
+
+    // Simulation
+
+    void attach(sim::Device& device) {
+        if (deviceAt(device.address) || device_count >= MAX_DEVICES) return;
+        devices[device_count++] = &device;
+    }
+    void detachAll() { device_count = 0; }
+
+    void injectFault(uint8_t addr, uint8_t nack_percent, uint8_t short_read_percent = 0, uint16_t latency_us = 0) {
+        Fault* fault = const_cast<Fault*>(faultFor(addr));
+        if (!fault) {
+            if (fault_count >= MAX_FAULTS) return;
+            fault = &faults[fault_count++];
+        }
+        *fault = {addr, (uint8_t)(nack_percent > 100 ? 100 : nack_percent),
+                  (uint8_t)(short_read_percent > 100 ? 100 : short_read_percent), latency_us};
+    }
+    void clearFaults() { fault_count = 0; }
+    void seedFaults(uint32_t value) { seed = value ? value : 1; }
+    uint32_t getFaultsInjected() const { return injected; }
+    uint32_t getTransactions() const { return transactions; }
+};
+
+inline TwoWire Wire(0);
+inline TwoWire Wire1(1);
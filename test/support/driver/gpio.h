@@ -0,0 +1,22 @@
+#pragma once
+#include "esp_err.h"
+#include "sim/pins.hpp"
+
+typedef int gpio_num_t;
+
+typedef enum {
+    GPIO_INTR_DISABLE = 0,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL
+} gpio_int_type_t;
+
+// Levels come from the simulated pins; interrupt and wake masking is the chip's business, not the test's
+inline int gpio_get_level(gpio_num_t pin) { return sim::Pins::get().level(pin); }
+inline esp_err_t gpio_intr_enable(gpio_num_t) { return ESP_OK; }
+inline esp_err_t gpio_intr_disable(gpio_num_t) { return ESP_OK; }
+inline esp_err_t gpio_set_intr_type(gpio_num_t, gpio_int_type_t) { return ESP_OK; }
+inline esp_err_t gpio_wakeup_enable(gpio_num_t, gpio_int_type_t) { return ESP_OK; }
+inline esp_err_t gpio_wakeup_disable(gpio_num_t) { return ESP_OK; }
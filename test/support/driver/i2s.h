@@ -0,0 +1,16 @@
+#pragma once
+#include <stddef.h>
+#include "esp_err.h"
+#include "freertos/FreeRTOS.h"
+
+// No audio in the native build: reads return nothing, the codecs are tested over I2C
+typedef enum { I2S_NUM_0 = 0, I2S_NUM_1, I2S_NUM_MAX } i2s_port_t;
+
+inline esp_err_t i2s_read(i2s_port_t port, void* dest, size_t size, size_t* bytes_read, TickType_t ticks_to_wait) {
+    (void)port;
+    (void)dest;
+    (void)size;
+    (void)ticks_to_wait;
+    *bytes_read = 0;
+    return ESP_OK;
+}
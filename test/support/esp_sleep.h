@@ -0,0 +1,54 @@
+#pragma once
+#include <stdint.h>
+#include "esp_err.h"
+#include "sim/clock.hpp"
+
+/**
+ * Light sleep in the native test build: the clock jumps to the timer wake
+ * (as the chip's would) and returns at once. Without a timer it returns
+ * straight away as an unattributed wake.
+ */
+typedef enum {
+    ESP_SLEEP_WAKEUP_UNDEFINED = 0,
+    ESP_SLEEP_WAKEUP_ALL,
+    ESP_SLEEP_WAKEUP_EXT0,
+    ESP_SLEEP_WAKEUP_EXT1,
+    ESP_SLEEP_WAKEUP_TIMER,
+    ESP_SLEEP_WAKEUP_TOUCHPAD,
+    ESP_SLEEP_WAKEUP_ULP,
+    ESP_SLEEP_WAKEUP_GPIO
+} esp_sleep_wakeup_cause_t;
+
+typedef esp_sleep_wakeup_cause_t esp_sleep_source_t;
+
+namespace sim {
+
+struct Sleep {
+    uint64_t timer_us = 0;
+    esp_sleep_wakeup_cause_t cause = ESP_SLEEP_WAKEUP_UNDEFINED;
+    uint32_t count = 0;
+};
+
+inline Sleep& sleepState() {
+    static Sleep state;
+    return state;
+}
+
+}  // namespace sim
+
+inline esp_err_t esp_sleep_enable_gpio_wakeup() { return ESP_OK; }
+inline esp_err_t esp_sleep_enable_timer_wakeup(uint64_t us) { sim::sleepState().timer_us = us; return ESP_OK; }
+inline esp_err_t esp_sleep_disable_wakeup_source(esp_sleep_source_t source) {
+    if (source == ESP_SLEEP_WAKEUP_TIMER || source == ESP_SLEEP_WAKEUP_ALL) sim::sleepState().timer_us = 0;
+    return ESP_OK;
+}
+
+inline esp_err_t esp_light_sleep_start() {
+    sim::Sleep& s = sim::sleepState();
+    s.count++;
+    s.cause = s.timer_us ? ESP_SLEEP_WAKEUP_TIMER : ESP_SLEEP_WAKEUP_UNDEFINED;
+    sim::advanceUs(s.timer_us);
+    return ESP_OK;
+}
+
+inline esp_sleep_wakeup_cause_t esp_sleep_get_wakeup_cause() { return sim::sleepState().cause; }
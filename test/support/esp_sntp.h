@@ -0,0 +1,12 @@
+#pragma once
+
+// SNTP never answers in the native build — tests script the network through WiFiSync::Network
+typedef enum {
+    SNTP_SYNC_STATUS_RESET,
+    SNTP_SYNC_STATUS_COMPLETED,
+    SNTP_SYNC_STATUS_IN_PROGRESS
+} sntp_sync_status_t;
+
+inline void sntp_set_sync_status(sntp_sync_status_t) {}
+inline sntp_sync_status_t sntp_get_sync_status() { return SNTP_SYNC_STATUS_RESET; }
+inline void sntp_stop() {}
@@ -0,0 +1,5 @@
+#pragma once
+#include <stdint.h>
+#include "sim/clock.hpp"
+
+inline int64_t esp_timer_get_time() { return (int64_t)sim::nowUs(); }
@@ -0,0 +1,53 @@
+#pragma once
+/**
+ * FreeRTOS stand-in for the native test build: tasks are std::threads,
+ * semaphores and notifications are mutex + condition variable, a tick is 1ms
+ * of host time. Critical sections are a recursive lock, like the ESP-IDF
+ * spinlock they replace (which also nests on one core).
+ */
+#include <stdint.h>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdPASS  1
+#define pdFAIL  0
+
+#define portMAX_DELAY       ((TickType_t)0xFFFFFFFF)
+#define configTICK_RATE_HZ  1000
+#define portTICK_PERIOD_MS  1
+#define pdMS_TO_TICKS(ms)   ((TickType_t)(ms))
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+struct portMUX_TYPE {
+    std::recursive_mutex lock;
+};
+
+#define portMUX_INITIALIZER_UNLOCKED {}
+
+#define portENTER_CRITICAL(mux)     ((mux)->lock.lock())
+#define portEXIT_CRITICAL(mux)      ((mux)->lock.unlock())
+#define portENTER_CRITICAL_ISR(mux) ((mux)->lock.lock())
+#define portEXIT_CRITICAL_ISR(mux)  ((mux)->lock.unlock())
+#define portYIELD_FROM_ISR(woken)   ((void)(woken))
+
+namespace sim {
+
+// Waits on cv until ready() or the ticks run out (portMAX_DELAY = forever)
+template <typename Ready>
+bool waitTicks(std::condition_variable& cv, std::unique_lock<std::mutex>& lock, TickType_t ticks, Ready ready) {
+    if (ticks == portMAX_DELAY) {
+        cv.wait(lock, ready);
+        return true;
+    }
+    return cv.wait_for(lock, std::chrono::milliseconds(ticks), ready);
+}
+
+}  // namespace sim
@@ -0,0 +1,77 @@
+#pragma once
+#include "FreeRTOS.h"
+
+// Counting semaphore; a mutex is one that starts given, a recursive mutex also tracks its owner
+struct QueueDefinition {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t count = 0;
+    uint32_t max = 1;
+    std::thread::id owner;
+    uint32_t depth = 0;
+};
+typedef QueueDefinition* SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateBinary() { return new QueueDefinition(); }
+
+inline SemaphoreHandle_t xSemaphoreCreateCounting(uint32_t max, uint32_t initial) {
+    SemaphoreHandle_t sem = new QueueDefinition();
+    sem->max = max;
+    sem->count = initial;
+    return sem;
+}
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex() { return xSemaphoreCreateCounting(1, 1); }
+inline SemaphoreHandle_t xSemaphoreCreateRecursiveMutex() { return xSemaphoreCreateCounting(1, 1); }
+inline void vSemaphoreDelete(SemaphoreHandle_t sem) { delete sem; }
+
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(sem->mutex);
+    if (!sim::waitTicks(sem->cv, lock, ticks, [sem]() { return sem->count > 0; })) return pdFALSE;
+    sem->count--;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    {
+        std::lock_guard<std::mutex> guard(sem->mutex);
+        if (sem->count >= sem->max) return pdFALSE;
+        sem->count++;
+    }
+    sem->cv.notify_one();
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreTakeFromISR(SemaphoreHandle_t sem, BaseType_t* woken) {
+    if (woken) *woken = pdFALSE;
+    return xSemaphoreTake(sem, 0);
+}
+
+inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t* woken) {
+    if (woken) *woken = pdTRUE;
+    return xSemaphoreGive(sem);
+}
+
+inline BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    std::unique_lock<std::mutex> lock(sem->mutex);
+    std::thread::id self = std::this_thread::get_id();
+    if (sem->depth > 0 && sem->owner == self) {
+        sem->depth++;
+        return pdTRUE;
+    }
+    if (!sim::waitTicks(sem->cv, lock, ticks, [sem]() { return sem->depth == 0; })) return pdFALSE;
+    sem->owner = self;
+    sem->depth = 1;
+    return pdTRUE;
+}
+
+inline BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    {
+        std::lock_guard<std::mutex> guard(sem->mutex);
+        if (sem->depth == 0 || sem->owner != std::this_thread::get_id()) return pdFALSE;
+        if (--sem->depth > 0) return pdTRUE;
+        sem->owner = std::thread::id();
+    }
+    sem->cv.notify_one();
+    return pdTRUE;
+}
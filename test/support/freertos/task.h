@@ -0,0 +1,76 @@
+#pragma once
+#include "FreeRTOS.h"
+#include <Arduino.h>
+
+typedef void (*TaskFunction_t)(void*);
+
+// One per thread: its notification value and the core it claims to run on
+struct tskTaskControlBlock {
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint32_t notified = 0;
+    BaseType_t core = 1;      // Arduino's loop task runs on core 1
+};
+typedef tskTaskControlBlock* TaskHandle_t;
+
+namespace sim {
+
+// Threads the test starts itself get a control block on first use
+inline TaskHandle_t& currentTask() {
+    thread_local TaskHandle_t task = nullptr;
+    if (!task) task = new tskTaskControlBlock();
+    return task;
+}
+
+}  // namespace sim
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle() { return sim::currentTask(); }
+inline BaseType_t xPortGetCoreID() { return sim::currentTask()->core; }
+inline TickType_t xTaskGetTickCount() { return (TickType_t)millis(); }
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t priority,
+                                          TaskHandle_t* handle, BaseType_t core) {
+    (void)name;
+    (void)stack;
+    (void)priority;
+    TaskHandle_t task = new tskTaskControlBlock();
+    task->core = core == tskNO_AFFINITY ? 0 : core;
+    if (handle) *handle = task;
+    std::thread([fn, arg, task]() {
+        sim::currentTask() = task;
+        fn(arg);
+    }).detach();
+    return pdPASS;
+}
+
+inline BaseType_t xTaskCreate(TaskFunction_t fn, const char* name, uint32_t stack, void* arg, UBaseType_t priority, TaskHandle_t* handle) {
+    return xTaskCreatePinnedToCore(fn, name, stack, arg, priority, handle, tskNO_AFFINITY);
+}
+
+// Only self-deletion at the end of a task function is supported: the thread ends when it returns
+inline void vTaskDelete(TaskHandle_t task) { (void)task; }
+
+inline void vTaskDelay(TickType_t ticks) { std::this_thread::sleep_for(std::chrono::milliseconds(ticks)); }
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    {
+        std::lock_guard<std::mutex> guard(task->mutex);
+        task->notified++;
+    }
+    task->cv.notify_all();
+    return pdPASS;
+}
+
+inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* woken) {
+    xTaskNotifyGive(task);
+    if (woken) *woken = pdTRUE;
+}
+
+inline uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    TaskHandle_t self = sim::currentTask();
+    std::unique_lock<std::mutex> lock(self->mutex);
+    sim::waitTicks(self->cv, lock, ticks, [self]() { return self->notified > 0; });
+    uint32_t value = self->notified;
+    if (value) self->notified = clear ? 0 : value - 1;
+    return value;
+}
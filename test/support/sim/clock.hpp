@@ -0,0 +1,30 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+
+/**
+ * Host clock behind millis()/micros() in the native test build.
+ *
+ * Host time since the first call, plus everything the simulation has
+ * fast-forwarded: wire time on the simulated I2C bus, light sleeps, and
+ * advance() calls from tests that need minutes or hours to pass.
+ * delay() and vTaskDelay() really wait, so threads still interleave.
+ */
+namespace sim {
+
+inline std::atomic<int64_t>& skippedUs() {
+    static std::atomic<int64_t> skipped{0};
+    return skipped;
+}
+
+inline uint64_t nowUs() {
+    static const auto start = std::chrono::steady_clock::now();
+    int64_t elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+    return (uint64_t)(elapsed + skippedUs().load());
+}
+
+inline void advanceUs(uint64_t us) { skippedUs() += (int64_t)us; }
+inline void advanceMs(uint32_t ms) { advanceUs((uint64_t)ms * 1000); }
+
+}  // namespace sim
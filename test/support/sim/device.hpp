@@ -0,0 +1,59 @@
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+
+namespace sim {
+
+/**
+ * A register-file chip on the simulated I2C bus.
+ *
+ * The first byte of a write transaction sets the register pointer and the
+ * rest are stored from there; a read continues from the pointer. Models
+ * override writeReg()/readReg() for side effects (commands, clear-on-read
+ * flags) and next() for their auto-increment rule, and present() when the
+ * chip can stop answering its address (reset, deep sleep).
+ */
+class Device {
+protected:
+    uint8_t regs[256] = {0};
+    uint8_t pointer = 0;
+
+    virtual void writeReg(uint8_t reg, uint8_t value) { regs[reg] = value; }
+    virtual uint8_t readReg(uint8_t reg) { return regs[reg]; }
+    virtual uint8_t next(uint8_t reg) const { return reg + 1; }
+
+public:
+    const uint8_t address;
+
+    explicit Device(uint8_t address) : address(address) {}
+    virtual ~Device() {}
+
+    // False NACKs the address phase, as if nobody were there
+    virtual bool present() const { return true; }
+
+    // A write transaction; false NACKs the data
+    virtual bool transmit(const uint8_t* data, size_t len) {
+        if (len == 0) return true;
+        pointer = data[0];
+        for (size_t i = 1; i < len; i++) {
+            writeReg(pointer, data[i]);
+            pointer = next(pointer);
+        }
+        return true;
+    }
+
+    // A read transaction; returns the bytes delivered
+    virtual size_t receive(uint8_t* buffer, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            buffer[i] = readReg(pointer);
+            pointer = next(pointer);
+        }
+        return len;
+    }
+
+    // Register file as the chip holds it, no side effects
+    uint8_t peek(uint8_t reg) const { return regs[reg]; }
+    void poke(uint8_t reg, uint8_t value) { regs[reg] = value; }
+};
+
+}  // namespace sim
@@ -0,0 +1,97 @@
+#pragma once
+#include <string.h>
+
+#include "device.hpp"
+
+namespace sim {
+
+/**
+ * ES7210 ADC register model.
+ *
+ * The address is strapped (AD0/AD1) to 0x40..0x43. No address auto-increment:
+ * every byte of a write lands on the first register. Writing 0xFF to RESET is
+ * a software reset back to the power-on registers. The clock helpers derive
+ * the sample rate the way the chip does, from MCLK and the divider registers.
+ * failOn() NACKs writes to one register, for bring-up failures.
+ */
+class Es7210 : public Device {
+public:
+    enum Register : uint8_t {
+        RESET = 0x00,
+        CLOCK_OFF = 0x01,
+        MAINCLK = 0x02,
+        LRCK_DIVH = 0x04,
+        LRCK_DIVL = 0x05,
+        POWER_DOWN = 0x06,
+        OSR = 0x07,
+        SDP_INTERFACE1 = 0x11,
+        SDP_INTERFACE2 = 0x12,
+        ADC1_MAX_GAIN = 0x1B,
+        ADC4_MAX_GAIN = 0x1E,
+        ANALOG = 0x40,
+        MIC12_BIAS = 0x41,
+        MIC34_BIAS = 0x42,
+        MIC1_GAIN = 0x43,
+        MIC2_GAIN = 0x44,
+        MIC3_GAIN = 0x45,
+        MIC4_GAIN = 0x46,
+        MIC12_POWER = 0x4B,
+        MIC34_POWER = 0x4C,
+    };
+
+    static constexpr uint8_t RUNNING = 0x41;     // RESET value once the host enables the chip
+
+private:
+    uint32_t resets = 0;
+    int fail_reg = -1;
+
+    void powerOn() {
+        memset(regs, 0, sizeof(regs));
+        regs[RESET] = 0x32;
+        regs[CLOCK_OFF] = 0x7F;
+        regs[MAINCLK] = 0x02;
+        regs[LRCK_DIVL] = 0xFF;
+        regs[OSR] = 0x20;
+        regs[MIC12_POWER] = 0xFF;
+        regs[MIC34_POWER] = 0xFF;
+    }
+
+protected:
+    uint8_t next(uint8_t reg) const override { return reg; }
+
+    void writeReg(uint8_t reg, uint8_t value) override {
+        if (reg == RESET && value == 0xFF) {
+            resets++;
+            powerOn();
+        }
+        regs[reg] = value;
+    }
+
+public:
+    explicit Es7210(uint8_t address = 0x40) : Device(address) { powerOn(); }
+
+    bool transmit(const uint8_t* data, size_t len) override {
+        if (len > 0 && data[0] == fail_reg) return false;
+        return Device::transmit(data, len);
+    }
+
+    void failOn(int reg) { fail_reg = reg; }
+
+    bool isRunning() const { return regs[RESET] == RUNNING; }
+    uint32_t getResets() const { return resets; }
+
+    // ADC sample rate: MCLK / adc_div / OSR
+    uint32_t adcRateHz(uint32_t mclk_hz) const {
+        uint32_t adc_div = (regs[MAINCLK] & 0x1F) + 1;
+        uint32_t osr = regs[OSR] & 0x3F;
+        return osr ? mclk_hz / adc_div / osr : 0;
+    }
+
+    // LRCK: MCLK / (divider + 1)
+    uint32_t lrckHz(uint32_t mclk_hz) const {
+        uint32_t div = ((uint32_t)(regs[LRCK_DIVH] & 0x0F) << 8 | regs[LRCK_DIVL]) + 1;
+        return mclk_hz / div;
+    }
+};
+
+}  // namespace sim
@@ -0,0 +1,102 @@
+#pragma once
+#include <string.h>
+
+#include "device.hpp"
+#include "pins.hpp"
+
+namespace sim {
+
+/**
+ * FT3168 touch controller register model.
+ *
+ * One finger: touch() and release() update FINGER_NUM and the P1 coordinate
+ * registers (event flag in the top bits of XH) and pulse INT low, as the chip
+ * reports each scan. Writing 0x03 to POWER_MODE is deep sleep: the chip stops
+ * answering its address until a low pulse on the reset line, which also
+ * restores the power-on registers.
+ */
+class Ft3168 : public Device {
+public:
+    static constexpr uint8_t ADDRESS = 0x38;
+    static constexpr uint8_t CHIP_ID = 0x03;
+
+    enum Register : uint8_t {
+        FINGER_NUM = 0x02,
+        P1_XH = 0x03,
+        P1_XL = 0x04,
+        P1_YH = 0x05,
+        P1_YL = 0x06,
+        DEVICE_ID = 0xA0,
+        POWER_MODE = 0xA5,
+        GESTURE_MODE = 0xD0,
+        GESTURE_ID = 0xD3,
+    };
+
+    enum Event : uint8_t {
+        EVENT_DOWN = 0x00,
+        EVENT_UP = 0x40,
+        EVENT_CONTACT = 0x80,
+    };
+
+private:
+    int int_pin;
+    int rst_pin;
+    uint8_t chip_id = CHIP_ID;
+    bool asleep = false;
+    uint32_t resets = 0;
+
+    void powerOn() {
+        memset(regs, 0, sizeof(regs));
+        regs[DEVICE_ID] = chip_id;
+        regs[POWER_MODE] = 0x00;
+        asleep = false;
+    }
+
+    static void onReset(void* arg) {
+        Ft3168* self = static_cast<Ft3168*>(arg);
+        self->resets++;
+        self->powerOn();
+    }
+
+    void report(uint8_t fingers, uint8_t event, uint16_t x, uint16_t y) {
+        regs[FINGER_NUM] = fingers;
+        regs[P1_XH] = event | ((x >> 8) & 0x0F);
+        regs[P1_XL] = x & 0xFF;
+        regs[P1_YH] = (y >> 8) & 0x0F;
+        regs[P1_YL] = y & 0xFF;
+        if (int_pin >= 0) Pins::get().pulse(int_pin, 0);
+    }
+
+protected:
+    void writeReg(uint8_t reg, uint8_t value) override {
+        if (reg == DEVICE_ID || reg == FINGER_NUM) return;
+        regs[reg] = value;
+        if (reg == POWER_MODE && value == 0x03) asleep = true;
+    }
+
+public:
+    // Releasing the reset line (rising edge) restarts the chip
+    Ft3168(int int_pin = -1, int rst_pin = -1) : Device(ADDRESS), int_pin(int_pin), rst_pin(rst_pin) {
+        powerOn();
+        if (rst_pin >= 0) Pins::get().attach(rst_pin, Pins::EDGE_RISING, nullptr, onReset, this);
+    }
+    ~Ft3168() {
+        if (rst_pin >= 0) Pins::get().detach(rst_pin);
+    }
+
+    bool present() const override {
+        if (rst_pin >= 0 && Pins::get().level(rst_pin) == 0) return false;   // Held in reset
+        return !asleep;
+    }
+
+    void touch(uint16_t x, uint16_t y) { report(1, regs[FINGER_NUM] ? EVENT_CONTACT : EVENT_DOWN, x, y); }
+    void release() { report(0, EVENT_UP, (regs[P1_XH] & 0x0F) << 8 | regs[P1_XL], (regs[P1_YH] & 0x0F) << 8 | regs[P1_YL]); }
+
+    // Another FT3x68 variant: survives resets
+    void setChipId(uint8_t id) { chip_id = id; regs[DEVICE_ID] = id; }
+
+    bool isAsleep() const { return asleep; }
+    uint32_t getResets() const { return resets; }
+};
+
+}  // namespace sim
@@ -0,0 +1,137 @@
+#pragma once
+#include <string.h>
+#include <time.h>
+
+#include "device.hpp"
+#include "pins.hpp"
+
+namespace sim {
+
+/**
+ * PCF85063 register model.
+ *
+ * Powers up with the OS (oscillator stop) flag set in SECONDS, as after a
+ * lost backup supply; writing SECONDS clears it. Time only moves when the
+ * test calls advance(), which also runs the alarm: a match of every enabled
+ * alarm field sets AF in CONTROL_2 and, with AIE, pulls INT low. AF clears
+ * when the host writes it as 0. Writing 0x58 to CONTROL_1 is a software reset.
+ * The register address wraps from 0x11 back to 0x00.
+ */
+class Pcf85063 : public Device {
+public:
+    static constexpr uint8_t ADDRESS = 0x51;
+
+    enum Register : uint8_t {
+        CONTROL_1 = 0x00,
+        CONTROL_2 = 0x01,
+        OFFSET = 0x02,
+        RAM_BYTE = 0x03,
+        SECONDS = 0x04,
+        MINUTES = 0x05,
+        HOURS = 0x06,
+        DAYS = 0x07,
+        WEEKDAYS = 0x08,
+        MONTHS = 0x09,
+        YEARS = 0x0A,
+        SECOND_ALARM = 0x0B,
+        MINUTE_ALARM = 0x0C,
+        HOUR_ALARM = 0x0D,
+        DAY_ALARM = 0x0E,
+        WEEKDAY_ALARM = 0x0F,
+        TIMER_VALUE = 0x10,
+        TIMER_MODE = 0x11,
+        LAST = TIMER_MODE
+    };
+
+private:
+    int int_pin;
+    uint32_t resets = 0;
+
+    static uint8_t bcd(int value) { return (uint8_t)((value / 10) << 4 | (value % 10)); }
+    static int dec(uint8_t value) { return (value >> 4) * 10 + (value & 0x0F); }
+
+    void powerOn() {
+        memset(regs, 0, sizeof(regs));
+        regs[SECONDS] = 0x80;   // OS: time not valid
+        regs[DAYS] = 0x01;
+        regs[MONTHS] = 0x01;
+        for (uint8_t r = SECOND_ALARM; r <= WEEKDAY_ALARM; r++) regs[r] = 0x80;
+        regs[TIMER_MODE] = 0x18;
+    }
+
+    bool alarmMatches() const {
+        const uint8_t fields[4][2] = {{SECOND_ALARM, SECONDS}, {MINUTE_ALARM, MINUTES}, {HOUR_ALARM, HOURS}, {DAY_ALARM, DAYS}};
+        bool any = false;
+        for (const auto& f : fields) {
+            uint8_t alarm = regs[f[0]];
+            if (alarm & 0x80) continue;   // AEN_x set: field ignored
+            any = true;
+            if ((alarm & 0x7F) != (regs[f[1]] & 0x7F)) return false;
+        }
+        return any;
+    }
+
+    void updateInt() {
+        if (int_pin < 0) return;
+        bool asserted = (regs[CONTROL_2] & 0x80) && (regs[CONTROL_2] & 0x40);
+        Pins::get().setLevel(int_pin, asserted ? 0 : 1);
+    }
+
+protected:
+    uint8_t next(uint8_t reg) const override { return reg >= LAST ? 0 : reg + 1; }
+
+    void writeReg(uint8_t reg, uint8_t value) override {
+        if (reg > LAST) return;
+        if (reg == CONTROL_1 && value == 0x58) {
+            resets++;
+            powerOn();
+            updateInt();
+            return;
+        }
+        if (reg == CONTROL_2) {
+            // AF and TF only clear when written as 0
+            value = (value & ~0x48) | (regs[CONTROL_2] & value & 0x48);
+        }
+        regs[reg] = value;
+        if (reg == CONTROL_2) updateInt();
+    }
+
+    uint8_t readReg(uint8_t reg) override { return reg > LAST ? 0 : regs[reg]; }
+
+public:
+    explicit Pcf85063(int int_pin = -1) : Device(ADDRESS), int_pin(int_pin) { powerOn(); }
+
+    bool oscillatorStopped() const { return regs[SECONDS] & 0x80; }
+
+    // Count seconds forward, running the alarm on each one
+    void advance(uint32_t seconds) {
+        for (uint32_t s = 0; s < seconds; s++) {
+            struct tm t = {};
+            t.tm_sec = dec(regs[SECONDS] & 0x7F);
+            t.tm_min = dec(regs[MINUTES] & 0x7F);
+            t.tm_hour = dec(regs[HOURS] & 0x3F);
+            t.tm_mday = dec(regs[DAYS] & 0x3F);
+            t.tm_mon = dec(regs[MONTHS] & 0x1F) - 1;
+            t.tm_year = dec(regs[YEARS]) + 100;
+            time_t when = timegm(&t) + 1;
+            gmtime_r(&when, &t);
+
+            regs[SECONDS] = (regs[SECONDS] & 0x80) | bcd(t.tm_sec);
+            regs[MINUTES] = bcd(t.tm_min);
+            regs[HOURS] = bcd(t.tm_hour);
+            regs[DAYS] = bcd(t.tm_mday);
+            regs[WEEKDAYS] = t.tm_wday;
+            regs[MONTHS] = bcd(t.tm_mon + 1);
+            regs[YEARS] = bcd(t.tm_year - 100);
+
+            if (alarmMatches() && !(regs[CONTROL_2] & 0x40)) {
+                regs[CONTROL_2] |= 0x40;
+                updateInt();
+            }
+        }
+    }
+
+    uint32_t getResets() const { return resets; }
+};
+
+}  // namespace sim
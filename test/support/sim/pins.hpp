@@ -0,0 +1,99 @@
+#pragma once
+#include <stdint.h>
+#include <mutex>
+
+/**
+ * GPIO levels and edge interrupts for the native test build.
+ *
+ * Drivers see them through digitalRead()/attachInterrupt(); tests and the
+ * device models drive them with setLevel(), which runs a matching ISR
+ * right away on the calling thread.
+ */
+namespace sim {
+
+class Pins {
+public:
+    static constexpr uint8_t COUNT = 49;
+
+    // Arduino attachInterrupt() modes
+    enum Edge : uint8_t {
+        EDGE_NONE = 0,
+        EDGE_RISING = 1,
+        EDGE_FALLING = 2,
+        EDGE_CHANGE = 3
+    };
+
+private:
+    struct Pin {
+        int level = 1;               // Floating inputs read high (pull-ups everywhere on this board)
+        uint8_t mode = 0;
+        uint8_t edge = EDGE_NONE;
+        void (*isr)() = nullptr;
+        void (*isr_arg)(void*) = nullptr;
+        void* arg = nullptr;
+    };
+
+    Pin pins[COUNT];
+    std::mutex mutex;
+
+    Pins() {}
+
+public:
+    static Pins& get() {
+        static Pins instance;
+        return instance;
+    }
+
+    int level(uint8_t pin) {
+        std::lock_guard<std::mutex> guard(mutex);
+        return pin < COUNT ? pins[pin].level : 0;
+    }
+
+    void setMode(uint8_t pin, uint8_t mode) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (pin < COUNT) pins[pin].mode = mode;
+    }
+
+    void attach(uint8_t pin, uint8_t edge, void (*isr)(), void (*isr_arg)(void*), void* arg) {
+        std::lock_guard<std::mutex> guard(mutex);
+        if (pin >= COUNT) return;
+        pins[pin].edge = edge;
+        pins[pin].isr = isr;
+        pins[pin].isr_arg = isr_arg;
+        pins[pin].arg = arg;
+    }
+
+    void detach(uint8_t pin) { attach(pin, EDGE_NONE, nullptr, nullptr, nullptr); }
+
+    bool isAttached(uint8_t pin) {
+        std::lock_guard<std::mutex> guard(mutex);
+        return pin < COUNT && (pins[pin].isr || pins[pin].isr_arg);
+    }
+
+    // Drive the line; an attached ISR whose edge this is runs before returning
+    void setLevel(uint8_t pin, int level) {
+        Pin fired;
+        {
+            std::lock_guard<std::mutex> guard(mutex);
+            if (pin >= COUNT) return;
+            Pin& p = pins[pin];
+            level = level ? 1 : 0;
+            bool rising = !p.level && level;
+            bool falling = p.level && !level;
+            p.level = level;
+            bool match = (rising && (p.edge & EDGE_RISING)) || (falling && (p.edge & EDGE_FALLING));
+            if (!match) return;
+            fired = p;
+        }
+        if (fired.isr) fired.isr();
+        if (fired.isr_arg) fired.isr_arg(fired.arg);
+    }
+
+    // One edge out and back, as an interrupt line pulses
+    void pulse(uint8_t pin, int active = 1) {
+        setLevel(pin, active);
+        setLevel(pin, !active);
+    }
+};
+
+}  // namespace sim
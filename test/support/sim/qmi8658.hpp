@@ -0,0 +1,222 @@
+#pragma once
+#include <string.h>
+#include <deque>
+#include <vector>
+
+#include "device.hpp"
+#include "pins.hpp"
+
+namespace sim {
+
+/**
+ * QMI8658 register model.
+ *
+ * Covers what the IMU driver touches: chip ID, software reset, CTRL1..CTRL9,
+ * the CTRL9 command handshake, status and data registers, AttitudeEngine dQ/dV,
+ * FIFO and tap status.
+ *
+ * CTRL9 protocol: writing a command to CTRL9 snapshots CAL1_L..CAL4_H into the
+ * command log and sets STATUSINT bit 7 (CmdDone) after a configurable number of
+ * STATUSINT polls. The host acknowledges by writing CTRL_CMD_ACK (0x00), which
+ * clears CmdDone. A command written before the previous one was acknowledged
+ * counts as a protocol error.
+ *
+ * Address auto-increment follows CTRL1 bit 6, and FIFO_DATA never increments,
+ * as on the chip. STATUS1 clears on read.
+ */
+class Qmi8658 : public Device {
+public:
+    static constexpr uint8_t ADDRESS = 0x6B;
+    static constexpr uint8_t CHIP_ID = 0x05;
+    static constexpr uint8_t REVISION = 0x7C;
+
+    enum Register : uint8_t {
+        WHO_AM_I = 0x00,
+        REVISION_ID = 0x01,
+        CTRL1 = 0x02,
+        CTRL2 = 0x03,
+        CTRL3 = 0x04,
+        CTRL6 = 0x07,
+        CTRL7 = 0x08,
+        CTRL8 = 0x09,
+        CTRL9 = 0x0A,
+        CAL1_L = 0x0B,
+        FIFO_WTM_TH = 0x13,
+        FIFO_CTRL = 0x14,
+        FIFO_SMPL_CNT = 0x15,
+        FIFO_STATUS = 0x16,
+        FIFO_DATA = 0x17,
+        STATUSINT = 0x2D,
+        STATUS0 = 0x2E,
+        STATUS1 = 0x2F,
+        TEMP_L = 0x33,
+        AX_L = 0x35,
+        GX_L = 0x3B,
+        DQW_L = 0x49,
+        TAP_STATUS = 0x59,
+        RESET = 0x60,
+    };
+
+    enum Command : uint8_t {
+        CMD_ACK = 0x00,
+        CMD_RST_FIFO = 0x04,
+        CMD_REQ_FIFO = 0x05,
+        CMD_CONFIGURE_TAP = 0x0C,
+        CMD_CONFIGURE_MOTION = 0x0E,
+    };
+
+    struct Executed {
+        uint8_t cmd;
+        uint8_t cal[8];       // CAL1_L..CAL4_H when it was issued
+    };
+
+private:
+    int int1_pin;
+    std::vector<Executed> executed;
+    uint8_t done_after = 1;          // STATUSINT polls before CmdDone shows
+    uint8_t polls_left = 0;
+    bool busy = false;               // Command issued, CmdDone not yet visible
+    bool stuck = false;
+    uint32_t protocol_errors = 0;
+    uint32_t resets = 0;
+    std::deque<uint8_t> fifo;        // Accel samples, 6 bytes each
+
+    void powerOn() {
+        memset(regs, 0, sizeof(regs));
+        regs[WHO_AM_I] = CHIP_ID;
+        regs[REVISION_ID] = REVISION;
+        busy = false;
+        fifo.clear();
+    }
+
+    void execute(uint8_t cmd) {
+        if (regs[STATUSINT] & 0x80 || busy) protocol_errors++;
+        Executed e;
+        e.cmd = cmd;
+        memcpy(e.cal, &regs[CAL1_L], sizeof(e.cal));
+        executed.push_back(e);
+
+        if (cmd == CMD_RST_FIFO) fifo.clear();
+        if (cmd == CMD_REQ_FIFO) regs[FIFO_CTRL] |= 0x80;   // rd_mode until the host rewrites FIFO_CTRL
+        if (stuck) return;
+        busy = true;
+        polls_left = done_after;
+    }
+
+    uint16_t fifoWords() const { return fifo.size() / 2; }
+
+protected:
+    uint8_t next(uint8_t reg) const override {
+        if (reg == FIFO_DATA || !(regs[CTRL1] & 0x40)) return reg;
+        return reg + 1;
+    }
+
+    void writeReg(uint8_t reg, uint8_t value) override {
+        if (reg == RESET) {
+            if (value == 0xB0) {
+                resets++;
+                powerOn();
+            }
+            return;
+        }
+        // Read-only beyond the configuration block
+        if (reg < CTRL1 || reg > FIFO_CTRL) return;
+        regs[reg] = value;
+        if (reg != CTRL9) return;
+        if (value == CMD_ACK) {
+            regs[STATUSINT] &= ~0x80;
+            busy = false;
+        } else {
+            execute(value);
+        }
+    }
+
+    uint8_t readReg(uint8_t reg) override {
+        switch (reg) {
+            case STATUSINT:
+                if (busy && polls_left-- == 0) {
+                    busy = false;
+                    regs[STATUSINT] |= 0x80;
+                }
+                return regs[STATUSINT];
+            case STATUS0: {
+                // Data ready for whatever CTRL7 has enabled: aEN, gEN, sEN (AttitudeEngine)
+                uint8_t ctrl7 = regs[CTRL7];
+                return (ctrl7 & 0x01 ? 0x01 : 0) | (ctrl7 & 0x02 ? 0x02 : 0) | (ctrl7 & 0x08 ? 0x08 : 0);
+            }
+            case STATUS1: {
+                uint8_t value = regs[STATUS1];
+                regs[STATUS1] = 0;
+                return value;
+            }
+            case FIFO_SMPL_CNT:
+                return fifoWords() & 0xFF;
+            case FIFO_STATUS:
+                return (fifoWords() >> 8) & 0x03;
+            case FIFO_DATA: {
+                if (!(regs[FIFO_CTRL] & 0x80) || fifo.empty()) return 0;
+                uint8_t value = fifo.front();
+                fifo.pop_front();
+                return value;
+            }
+            default:
+                return regs[reg];
+        }
+    }
+
+public:
+    explicit Qmi8658(int int1_pin = -1) : Device(ADDRESS), int1_pin(int1_pin) {
+        powerOn();
+        if (int1_pin >= 0) Pins::get().setLevel(int1_pin, 0);   // Push-pull, active high
+    }
+
+    void setAccel(int16_t x, int16_t y, int16_t z) { putAxes(AX_L, x, y, z); }
+    void setGyro(int16_t x, int16_t y, int16_t z) { putAxes(GX_L, x, y, z); }
+    // One AttitudeEngine packet: dQ (Q1.14, w x y z) and dV (2^-10 m/s)
+    void setAttitudeDelta(int16_t w, int16_t x, int16_t y, int16_t z, int16_t vx, int16_t vy, int16_t vz) {
+        putAxes(DQW_L, w, x, y);
+        putAxes(DQW_L + 6, z, vx, vy);
+        regs[DQW_L + 12] = vz & 0xFF;
+        regs[DQW_L + 13] = (uint16_t)vz >> 8;
+    }
+    void setTemperature(int16_t raw) {
+        regs[TEMP_L] = raw & 0xFF;
+        regs[TEMP_L + 1] = (uint16_t)raw >> 8;
+    }
+
+    // Queue an accelerometer sample in the FIFO (stream mode keeps the newest 128)
+    void pushFifo(int16_t x, int16_t y, int16_t z) {
+        const int16_t axes[3] = {x, y, z};
+        for (int16_t v : axes) {
+            fifo.push_back(v & 0xFF);
+            fifo.push_back((uint16_t)v >> 8);
+        }
+        while (fifo.size() > 128 * 6) fifo.pop_front();
+    }
+    size_t fifoSamples() const { return fifo.size() / 6; }
+
+    // An engine event: STATUS1 bits (and TAP_STATUS for taps), then a pulse on INT1
+    void raise(uint8_t status1, uint8_t tap_status = 0) {
+        regs[STATUS1] |= status1;
+        if (tap_status) regs[TAP_STATUS] = tap_status;
+        if (int1_pin >= 0) Pins::get().pulse(int1_pin);
+    }
+
+    const std::vector<Executed>& commands() const { return executed; }
+    void clearCommands() { executed.clear(); }
+    void setCommandDelay(uint8_t polls) { done_after = polls; }
+    void setCommandStuck(bool value) { stuck = value; }
+    uint32_t getProtocolErrors() const { return protocol_errors; }
+    uint32_t getResets() const { return resets; }
+
+private:
+    void putAxes(uint8_t reg, int16_t x, int16_t y, int16_t z) {
+        const int16_t axes[3] = {x, y, z};
+        for (int16_t v : axes) {
+            regs[reg++] = v & 0xFF;
+            regs[reg++] = (uint16_t)v >> 8;
+        }
+    }
+};
+
+}  // namespace sim
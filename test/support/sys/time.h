@@ -0,0 +1,31 @@
+#pragma once
+#include_next <sys/time.h>
+#include <stdint.h>
+
+/**
+ * The firmware seeds the system clock from the RTC with settimeofday(). On
+ * the host that would set the machine's clock, so the native build records
+ * the request instead and time() keeps running on host time.
+ */
+namespace sim {
+
+struct WallClock {
+    struct timeval set = {0, 0};    // Last settimeofday() request
+    uint32_t sets = 0;
+};
+
+inline WallClock& wallClock() {
+    static WallClock clock;
+    return clock;
+}
+
+inline int setTimeOfDay(const struct timeval* tv, const void*) {
+    if (!tv) return -1;
+    wallClock().set = *tv;
+    wallClock().sets++;
+    return 0;
+}
+
+}  // namespace sim
+
+#define settimeofday sim::setTimeOfDay
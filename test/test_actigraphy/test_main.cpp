@@ -0,0 +1,151 @@
+#include <unity.h>
+
+#include "system/activity/actigraphy.hpp"
+
+static constexpr float RATE_HZ = 21.0f;    // ImuRatePolicy::LOW_HZ, the rate the sleep tracker batches at
+static constexpr uint32_t PER_EPOCH = (uint32_t)(Actigraphy::EPOCH_S * RATE_HZ + 0.5f);
+
+/**
+ * Synthetic wrist at rest, face down with a slight tilt, plus sensor noise.
+ * Awake minutes fidget on and off; asleep, an occasional turn-over.
+ * Deterministic (LCG), so scores are exact from run to run.
+ */
+class Wrist {
+private:
+    uint32_t seed;
+
+    int16_t noise(int16_t amplitude) {
+        seed = seed * 1664525u + 1013904223u;
+        return (int16_t)((int32_t)((seed >> 16) & 0xFFFF) * 2 * amplitude / 0xFFFF - amplitude);
+    }
+
+public:
+    explicit Wrist(uint32_t seed = 2024) : seed(seed) {}
+
+    ImuSample sample(bool awake, bool turning, uint32_t i) {
+        int16_t move = 0;
+        if (awake && (i / 21) % 7 < 3) move = noise(accelCounts(0.2f));
+        else if (turning && i < 8 * 21) move = noise(accelCounts(0.15f));
+        ImuSample s = {};
+        s.ax = accelCounts(0.10f) + noise(accelCounts(0.005f)) + move;
+        s.ay = accelCounts(0.05f) + noise(accelCounts(0.005f));
+        s.az = accelCounts(-0.99f) + noise(accelCounts(0.005f)) + move / 2;
+        return s;
+    }
+};
+
+// Plays one minute; returns the epoch scored when it closed, if any
+static bool minute(Actigraphy& a, Wrist& wrist, bool awake, bool turning, Actigraphy::Epoch& scored) {
+    bool got = false;
+    for (uint32_t i = 0; i < PER_EPOCH; i++) {
+        if (a.update(wrist.sample(awake, turning, i))) got = a.popScored(scored);
+    }
+    return got;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_epoch_is_four_bytes() {
+    // 240 B per hour of night in RTC memory and flash
+    TEST_ASSERT_EQUAL_UINT32(4, sizeof(Actigraphy::Epoch));
+}
+
+void test_still_night_is_all_sleep() {
+    Actigraphy a(RATE_HZ);
+    Wrist wrist;
+    Actigraphy::Epoch e;
+    for (uint32_t m = 0; m < 60; m++) minute(a, wrist, false, false, e);
+
+    // The look-ahead holds back the last two epochs
+    TEST_ASSERT_EQUAL_UINT32(60 - Actigraphy::LOOKAHEAD, a.getEpochs());
+    TEST_ASSERT_EQUAL_UINT32(60 - Actigraphy::LOOKAHEAD, a.getSleepMinutes());
+    TEST_ASSERT_TRUE(a.hasOnset());
+    TEST_ASSERT_EQUAL_UINT32(0, a.getOnsetMinutes());
+    TEST_ASSERT_EQUAL_UINT8(Actigraphy::STAGE_SLEEP, a.getLastStage());
+}
+
+void test_scores_lag_by_lookahead() {
+    Actigraphy a(RATE_HZ);
+    Wrist wrist;
+    Actigraphy::Epoch e;
+    for (uint8_t m = 0; m < Actigraphy::LOOKAHEAD; m++) TEST_ASSERT_FALSE(minute(a, wrist, false, false, e));
+    TEST_ASSERT_TRUE(minute(a, wrist, false, false, e));
+    TEST_ASSERT_FALSE(a.popScored(e));    // Once per closed epoch
+}
+
+void test_synthetic_nights() {
+    // 8h nights: 20 min falling asleep (fidgeting), two night awakenings,
+    // turn-overs every ~37 min while asleep, wake-up at the end
+    static constexpr uint32_t MINUTES = 480;
+    for (uint32_t night = 0; night < 3; night++) {
+        Actigraphy a(RATE_HZ);
+        Wrist wrist(2024 + night);
+        bool truth[Actigraphy::LOOKAHEAD + 1] = {};    // For epochs still awaiting their score
+        uint32_t agree = 0, scored = 0;
+
+        for (uint32_t m = 0; m < MINUTES; m++) {
+            bool awake = m < 20 || (m >= 150 + night * 7 && m < 160 + night * 7) || (m >= 300 && m < 312) || m >= 465;
+            for (uint8_t k = 0; k < Actigraphy::LOOKAHEAD; k++) truth[k] = truth[k + 1];
+            truth[Actigraphy::LOOKAHEAD] = awake;
+
+            Actigraphy::Epoch e;
+            if (minute(a, wrist, awake, !awake && m % 37 == 0, e)) {
+                scored++;
+                if ((e.stage == Actigraphy::STAGE_WAKE) == truth[0]) agree++;
+            }
+        }
+
+        TEST_ASSERT_EQUAL_UINT32(MINUTES - Actigraphy::LOOKAHEAD, scored);
+        TEST_ASSERT_GREATER_OR_EQUAL(scored * 90 / 100, agree);
+        TEST_ASSERT_TRUE(a.hasOnset());
+        TEST_ASSERT_UINT_WITHIN(5, 20, a.getOnsetMinutes());
+        // Two in the night and the morning wake-up: 10 + 12 + 15 min after onset
+        TEST_ASSERT_EQUAL_UINT32(3, a.getAwakenings());
+        TEST_ASSERT_UINT_WITHIN(5, 37, a.getWasoMinutes());
+        TEST_ASSERT_UINT_WITHIN(10, MINUTES - 20 - 37, a.getSleepMinutes());
+    }
+}
+
+void test_gap_epochs_are_wake() {
+    Actigraphy a(RATE_HZ);
+    Wrist wrist;
+    Actigraphy::Epoch e;
+    for (uint32_t m = 0; m < 30; m++) minute(a, wrist, false, false, e);
+    uint32_t sleep = a.getSleepMinutes();
+
+    // Five minutes with the watch in use, then still again
+    for (uint8_t m = 0; m < 5; m++) a.addGapEpoch();
+    for (uint32_t m = 0; m < 30; m++) minute(a, wrist, false, false, e);
+
+    // Gaps score as wake; the Cole-Kripke window spreads them a few epochs either side
+    TEST_ASSERT_GREATER_OR_EQUAL(5, a.getWasoMinutes());
+    TEST_ASSERT_LESS_OR_EQUAL(5 + 4 + Actigraphy::LOOKAHEAD, a.getWasoMinutes());
+    TEST_ASSERT_EQUAL_UINT32(1, a.getAwakenings());
+    TEST_ASSERT_GREATER_THAN(sleep, a.getSleepMinutes());
+}
+
+void test_reset() {
+    Actigraphy a(RATE_HZ);
+    Wrist wrist;
+    Actigraphy::Epoch e;
+    for (uint32_t m = 0; m < 20; m++) minute(a, wrist, true, false, e);
+    TEST_ASSERT_GREATER_THAN(0, a.getWakeMinutes());
+
+    a.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, a.getEpochs());
+    TEST_ASSERT_FALSE(a.hasOnset());
+    TEST_ASSERT_FALSE(a.popScored(e));
+    TEST_ASSERT_EQUAL_UINT8(Actigraphy::STAGE_UNKNOWN, a.getLastStage());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_epoch_is_four_bytes);
+    RUN_TEST(test_still_night_is_all_sleep);
+    RUN_TEST(test_scores_lag_by_lookahead);
+    RUN_TEST(test_synthetic_nights);
+    RUN_TEST(test_gap_epochs_are_wake);
+    RUN_TEST(test_reset);
+    return UNITY_END();
+}
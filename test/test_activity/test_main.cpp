@@ -0,0 +1,171 @@
+#include <unity.h>
+#include <math.h>
+
+#include "system/activity/pedometer.hpp"
+#include "system/activity/activity_classifier.hpp"
+
+using Activity = ActivityClassifier::Activity;
+
+static constexpr float RATE_HZ = 112.1f;
+
+/**
+ * Synthetic wrist signal: gravity on Z plus a vertical bounce at the step
+ * frequency and a little sensor noise on every axis. Deterministic (LCG),
+ * so step counts are exact from run to run.
+ */
+class Signal {
+private:
+    uint32_t seed = 1;
+    uint32_t index = 0;
+
+    float noise(float amplitude_g) {
+        seed = seed * 1664525u + 1013904223u;
+        return amplitude_g * ((seed >> 8) / 8388608.0f - 1.0f);
+    }
+
+public:
+    float frequency_hz = 0.0f;
+    float amplitude_g = 0.0f;
+    float noise_g = 0.01f;
+
+    void set(float frequency_hz, float amplitude_g) {
+        this->frequency_hz = frequency_hz;
+        this->amplitude_g = amplitude_g;
+    }
+
+    uint32_t next() {
+        float t = index++ / RATE_HZ;
+        float bounce = amplitude_g * sinf(2.0f * (float)M_PI * frequency_hz * t);
+        ImuSample s = {};
+        s.ax = accelCounts(noise(noise_g));
+        s.ay = accelCounts(noise(noise_g));
+        s.az = accelCounts(1.0f + bounce + noise(noise_g));
+        return magnitudeSquared(s);
+    }
+};
+
+struct Run {
+    Pedometer pedometer{RATE_HZ};
+    ActivityClassifier classifier{RATE_HZ};
+    Signal signal;
+    Activity changes[8];
+    uint8_t change_count = 0;
+
+    void play(float seconds) {
+        uint32_t samples = (uint32_t)(seconds * RATE_HZ);
+        for (uint32_t i = 0; i < samples; i++) {
+            uint32_t m = signal.next();
+            bool step = pedometer.update(m);
+            if (classifier.update(m, pedometer.getCadence(), step) && change_count < 8) {
+                changes[change_count++] = classifier.getActivity();
+            }
+        }
+    }
+
+    void set(float frequency_hz, float amplitude_g) { signal.set(frequency_hz, amplitude_g); }
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_still_counts_nothing() {
+    Run run;
+    run.play(60.0f);
+    TEST_ASSERT_EQUAL_UINT32(0, run.pedometer.getSteps());
+    TEST_ASSERT_FALSE(run.pedometer.isWalking());
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_STILL, run.classifier.getActivity());
+    TEST_ASSERT_EQUAL_UINT8(1, run.change_count);
+}
+
+void test_walk() {
+    Run run;
+    run.set(1.8f, 0.3f);
+    run.play(60.0f);
+
+    // 108 steps/min; the first step only starts the rhythm
+    TEST_ASSERT_UINT_WITHIN(3, 107, run.pedometer.getSteps());
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 108.0f, run.pedometer.getCadence());
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_WALK, run.classifier.getActivity());
+}
+
+void test_run() {
+    Run run;
+    run.set(2.8f, 0.8f);
+    run.play(60.0f);
+
+    TEST_ASSERT_UINT_WITHIN(3, 167, run.pedometer.getSteps());
+    TEST_ASSERT_FLOAT_WITHIN(4.0f, 168.0f, run.pedometer.getCadence());
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_RUN, run.classifier.getActivity());
+}
+
+void test_vibration_is_transport() {
+    // Engine buzz: too fast and too small to be steps, too much to be still
+    Run run;
+    run.set(12.0f, 0.06f);
+    run.play(30.0f);
+    TEST_ASSERT_EQUAL_UINT32(0, run.pedometer.getSteps());
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_TRANSPORT, run.classifier.getActivity());
+}
+
+void test_isolated_bumps_are_not_steps() {
+    // Three knocks a second apart never make a regular sequence
+    Pedometer pedometer(RATE_HZ);
+    Signal signal;
+    for (int knock = 0; knock < 3; knock++) {
+        signal.set(0.0f, 0.0f);
+        for (int i = 0; i < (int)RATE_HZ; i++) pedometer.update(signal.next());
+        signal.set(2.0f, 0.5f);
+        for (int i = 0; i < (int)(RATE_HZ / 2); i++) pedometer.update(signal.next());
+    }
+    signal.set(0.0f, 0.0f);
+    for (int i = 0; i < 3 * (int)RATE_HZ; i++) pedometer.update(signal.next());
+    TEST_ASSERT_EQUAL_UINT32(0, pedometer.getSteps());
+}
+
+void test_transitions() {
+    Run run;
+    run.play(10.0f);
+    run.set(1.8f, 0.3f);
+    run.play(20.0f);
+    run.set(2.8f, 0.8f);
+    run.play(20.0f);
+    run.set(0.0f, 0.0f);
+    run.play(15.0f);
+
+    // Each class is confirmed over two windows, so nothing flickers in between
+    TEST_ASSERT_EQUAL_UINT8(4, run.change_count);
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_STILL, run.changes[0]);
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_WALK, run.changes[1]);
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_RUN, run.changes[2]);
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_STILL, run.changes[3]);
+
+    // The walk and run stretches both counted
+    TEST_ASSERT_UINT_WITHIN(6, 36 + 56, run.pedometer.getSteps());
+    TEST_ASSERT_FALSE(run.pedometer.isWalking());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, run.pedometer.getCadence());
+}
+
+void test_reset() {
+    Run run;
+    run.set(1.8f, 0.3f);
+    run.play(10.0f);
+    TEST_ASSERT_GREATER_THAN(0, run.pedometer.getSteps());
+
+    run.pedometer.reset();
+    run.classifier.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, run.pedometer.getSteps());
+    TEST_ASSERT_FALSE(run.pedometer.isWalking());
+    TEST_ASSERT_EQUAL(ActivityClassifier::ACTIVITY_UNKNOWN, run.classifier.getActivity());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_still_counts_nothing);
+    RUN_TEST(test_walk);
+    RUN_TEST(test_run);
+    RUN_TEST(test_vibration_is_transport);
+    RUN_TEST(test_isolated_bumps_are_not_steps);
+    RUN_TEST(test_transitions);
+    RUN_TEST(test_reset);
+    return UNITY_END();
+}
@@ -0,0 +1,127 @@
+#include <unity.h>
+#include <thread>
+
+#include "config.h"
+#include "system/boot/boot_profiler.hpp"
+#include "system/i2c/i2c_bus.hpp"
+#include "sim/device.hpp"
+
+/**
+ * The profiler is one static record per boot, so these run in order as one
+ * boot: stages and steps, markers from other tasks, then BOOT_DONE.
+ */
+
+Logger logger;    // Defined by main.cpp in the firmware
+extern "C" void __wrap_delay(uint32_t ms);    // delay() in the firmware's boot_profile build
+
+static sim::Device pmu_chip(0x34);
+static I2CBus bus(&logger, Wire);
+static I2CDevice pmu("PMU", 0x34, I2C_STANDARD_HZ);
+
+static uint8_t find(const char* name) {
+    for (uint8_t i = 0; i < BootProfiler::getCount(); i++) {
+        if (strcmp(BootProfiler::getEntry(i).name, name) == 0) return i;
+    }
+    TEST_FAIL_MESSAGE(name);
+    return 0;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_stage_splits_delay_and_i2c() {
+    uint8_t regs[16];
+    uint32_t before = bus.getTotalBusyUs();
+    BOOT_STAGE("Power");
+    __wrap_delay(20);
+    for (int i = 0; i < 10; i++) TEST_ASSERT_TRUE(pmu.readRegs(0x00, regs, sizeof(regs)));
+    uint32_t i2c_us = bus.getTotalBusyUs() - before;
+    BOOT_STAGE("Display");
+
+    const BootProfiler::Entry& power = BootProfiler::getEntry(find("Power"));
+    TEST_ASSERT_EQUAL_UINT8(0, power.depth);
+    TEST_ASSERT_GREATER_OR_EQUAL(20000, power.delay_us);
+    // Ten 16-byte reads at 100kHz: about 16ms on the wire
+    TEST_ASSERT_EQUAL_UINT32(i2c_us, power.i2c_us);
+    TEST_ASSERT_GREATER_THAN(15000, power.i2c_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(power.delay_us + power.i2c_us, power.duration_us);
+}
+
+void test_steps_nest() {
+    {
+        BOOT_STEP("Panel");
+        __wrap_delay(5);
+        {
+            BOOT_STEP("Backlight");
+            sim::advanceMs(3);
+        }
+    }
+    BOOT_STAGE("Touch");
+
+    const BootProfiler::Entry& display = BootProfiler::getEntry(find("Display"));
+    const BootProfiler::Entry& panel = BootProfiler::getEntry(find("Panel"));
+    const BootProfiler::Entry& backlight = BootProfiler::getEntry(find("Backlight"));
+    TEST_ASSERT_EQUAL_UINT8(1, panel.depth);
+    TEST_ASSERT_EQUAL_UINT8(2, backlight.depth);
+    TEST_ASSERT_GREATER_OR_EQUAL(3000, backlight.duration_us);
+    TEST_ASSERT_EQUAL_UINT32(0, backlight.delay_us);
+    // A step's time and delay count towards its parents
+    TEST_ASSERT_GREATER_OR_EQUAL(backlight.duration_us + panel.delay_us, panel.duration_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(panel.duration_us, display.duration_us);
+    TEST_ASSERT_EQUAL_UINT32(panel.delay_us, display.delay_us);
+}
+
+void test_depth_is_bounded() {
+    uint8_t count = BootProfiler::getCount();
+    int8_t open[BootProfiler::MAX_DEPTH];
+    // The "Touch" stage is depth 0: room for MAX_DEPTH - 1 steps below it
+    for (uint8_t d = 1; d < BootProfiler::MAX_DEPTH; d++) open[d] = BootProfiler::open("step");
+    TEST_ASSERT_EQUAL_INT8(-1, BootProfiler::open("too deep"));
+    for (uint8_t d = BootProfiler::MAX_DEPTH - 1; d >= 1; d--) BootProfiler::close(open[d]);
+    TEST_ASSERT_EQUAL_UINT8(count + BootProfiler::MAX_DEPTH - 1, BootProfiler::getCount());
+}
+
+void test_other_tasks_ignored() {
+    uint8_t count = BootProfiler::getCount();
+    // The init graph's helper on the other core
+    std::thread helper([]() {
+        BOOT_STAGE("Helper stage");
+        BOOT_STEP("Helper step");
+        BOOT_DONE(&logger);
+    });
+    helper.join();
+    TEST_ASSERT_EQUAL_UINT8(count, BootProfiler::getCount());
+    TEST_ASSERT_FALSE(BootProfiler::isDone());
+}
+
+void test_done_closes_and_freezes() {
+    BOOT_STEP("Left open");
+    sim::advanceMs(1);
+    BOOT_DONE(&logger);
+    TEST_ASSERT_TRUE(BootProfiler::isDone());
+    TEST_ASSERT_GREATER_OR_EQUAL(1000, BootProfiler::getEntry(find("Left open")).duration_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(BootProfiler::getEntry(find("Power")).start_us, BootProfiler::getTotalUs());
+
+    // Nothing recorded after boot, and delay() is no longer attributed
+    uint8_t count = BootProfiler::getCount();
+    uint32_t delay_us = BootProfiler::delay_total_us;
+    BOOT_STAGE("Loop");
+    __wrap_delay(2);
+    TEST_ASSERT_EQUAL_UINT8(count, BootProfiler::getCount());
+    TEST_ASSERT_EQUAL_UINT32(delay_us, BootProfiler::delay_total_us);
+}
+
+int main() {
+    Wire.attach(pmu_chip);
+    bus.begin(I2C_SDA, I2C_SCL, I2C_STANDARD_HZ);
+    pmu.attach(bus);
+    BootProfiler::attachBus(bus);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_stage_splits_delay_and_i2c);
+    RUN_TEST(test_steps_nest);
+    RUN_TEST(test_depth_is_bounded);
+    RUN_TEST(test_other_tasks_ignored);
+    RUN_TEST(test_done_closes_and_freezes);
+    return UNITY_END();
+}
@@ -0,0 +1,119 @@
+#include <unity.h>
+
+#include "system/button/button.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+struct Step {
+    uint32_t at;
+    bool pressed;
+};
+
+// Events as "P4 R155 C155" — first letter of the type and its timestamp
+static void record(const Button::Event& event, void* ctx) {
+    static const char letters[] = "PRCDL";
+    String& log = *static_cast<String*>(ctx);
+    if (log.length()) log += " ";
+    log += letters[event.type];
+    log += String(event.time_ms);
+}
+
+// Replays the steps on a virtual clock, running the machine only at the edges and at the deadlines it asks for
+template <size_t N>
+static String play(const Step (&steps)[N], bool swallow = false) {
+    String log;
+    Button button(nullptr, 0);
+    button.setCallback(record, &log);
+    if (swallow) button.swallowPress(0);
+
+    uint32_t clock = 0;
+    bool level = false;
+    uint32_t end = steps[N - 1].at + 2000;
+    for (size_t i = 0; i <= N; i++) {
+        uint32_t next = i < N ? steps[i].at : end;
+        for (uint8_t guard = 0; guard < 32; guard++) {
+            uint32_t wait = button.update(clock, level);
+            if (wait == Button::NO_DEADLINE || clock + wait >= next) break;
+            clock += wait;
+        }
+        if (i == N) break;
+        clock = next;
+        level = steps[i].pressed;
+        button.update(clock, level);
+    }
+    return log;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_bouncy_click() {
+    const Step steps[] = {{0, true}, {2, false}, {4, true}, {150, false}, {152, true}, {155, false}};
+    TEST_ASSERT_EQUAL_STRING("P4 R155 C155", play(steps).c_str());
+}
+
+void test_double_click() {
+    const Step steps[] = {{0, true}, {100, false}, {250, true}, {350, false}};
+    TEST_ASSERT_EQUAL_STRING("P0 R100 P250 R350 D350", play(steps).c_str());
+}
+
+void test_long_press() {
+    const Step steps[] = {{0, true}, {1500, false}};
+    TEST_ASSERT_EQUAL_STRING("P0 L1000 R1500", play(steps).c_str());
+}
+
+void test_glitch_ignored() {
+    const Step steps[] = {{0, true}, {10, false}, {40, true}, {60, false}};
+    TEST_ASSERT_EQUAL_STRING("", play(steps).c_str());
+}
+
+void test_slow_second_press() {
+    const Step steps[] = {{0, true}, {100, false}, {500, true}, {600, false}};
+    TEST_ASSERT_EQUAL_STRING("P0 R100 C100 P500 R600 C600", play(steps).c_str());
+}
+
+void test_wake_press_swallowed() {
+    const Step steps[] = {{0, true}, {1500, false}, {2000, true}, {2100, false}};
+    TEST_ASSERT_EQUAL_STRING("P0 R1500 P2000 R2100 C2100", play(steps, true).c_str());
+}
+
+void test_pin_edges() {
+    // Active-low on a simulated pin: the ISR counts edges, service() reads the level
+    const uint8_t pin = 0;
+    sim::Pins::get().setLevel(pin, HIGH);
+    String log;
+    Button button(&logger, pin);
+    button.setCallback(record, &log);
+    TEST_ASSERT_TRUE(button.begin());
+    TEST_ASSERT_FALSE(button.isPressed());
+
+    sim::Pins::get().setLevel(pin, LOW);
+    TEST_ASSERT_EQUAL_UINT32(1, button.getEdgeCount());
+    uint32_t t0 = millis();
+    TEST_ASSERT_EQUAL_UINT32(Button::DEBOUNCE_MS, button.service(t0));
+    button.service(t0 + Button::DEBOUNCE_MS);
+    TEST_ASSERT_TRUE(button.isPressed());
+
+    sim::Pins::get().setLevel(pin, HIGH);
+    TEST_ASSERT_EQUAL_UINT32(2, button.getEdgeCount());
+    button.service(t0 + 100);
+    button.service(t0 + 100 + Button::DEBOUNCE_MS);
+    TEST_ASSERT_FALSE(button.isPressed());
+    TEST_ASSERT_EQUAL_UINT32(Button::NO_DEADLINE, button.service(t0 + 100 + Button::DEBOUNCE_MS + Button::MULTI_CLICK_MS));
+
+    String expect = String("P") + String(t0) + " R" + String(t0 + 100) + " C" + String(t0 + 100);
+    TEST_ASSERT_EQUAL_STRING(expect.c_str(), log.c_str());
+    detachInterrupt(pin);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bouncy_click);
+    RUN_TEST(test_double_click);
+    RUN_TEST(test_long_press);
+    RUN_TEST(test_glitch_ignored);
+    RUN_TEST(test_slow_second_press);
+    RUN_TEST(test_wake_press_swallowed);
+    RUN_TEST(test_pin_edges);
+    return UNITY_END();
+}
@@ -0,0 +1,175 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <math.h>
+#include <stdio.h>
+
+#include "system/imu/wrist_gesture.hpp"
+
+/**
+ * The wrist and motion detectors compare raw counts against compile-time
+ * thresholds and use |a|² rather than |a|. These check that they decide
+ * as the float reference does, in g and dps and with a square root.
+ */
+
+// Float reference, as the detectors were before they moved to raw counts
+struct Reference {
+    float ax, ay, az, gx, gy, gz;
+
+    explicit Reference(const ImuSample& s)
+        : ax(countsToG(s.ax)), ay(countsToG(s.ay)), az(countsToG(s.az)), gx(countsToDps(s.gx)), gy(countsToDps(s.gy)), gz(countsToDps(s.gz)) {}
+
+    bool watchUp() const { return ax > 0.20f && az < -0.20f; }
+    bool armDown() const { return ay < -0.35f || (ay > 0.10f && az < -0.40f); }
+    bool rotation() const { return fabsf(gx) > 40.0f || fabsf(gy) > 40.0f || fabsf(gz) > 40.0f; }
+    float magnitude() const { return sqrtf(ax * ax + ay * ay + az * az); }
+};
+
+// Wrist-ish samples: accel within ±2g, gyro within ±128 dps (LCG, repeatable)
+static ImuSample randomSample(uint32_t& seed) {
+    ImuSample s;
+    seed = seed * 1664525u + 1013904223u; s.ax = (int16_t)(seed >> 18) - 8192;
+    seed = seed * 1664525u + 1013904223u; s.ay = (int16_t)(seed >> 18) - 8192;
+    seed = seed * 1664525u + 1013904223u; s.az = (int16_t)(seed >> 18) - 8192;
+    seed = seed * 1664525u + 1013904223u; s.gx = (int16_t)(seed >> 19) - 4096;
+    seed = seed * 1664525u + 1013904223u; s.gy = (int16_t)(seed >> 19) - 4096;
+    seed = seed * 1664525u + 1013904223u; s.gz = (int16_t)(seed >> 19) - 4096;
+    return s;
+}
+
+// Cycles per sample in tenths for a detector path over the batch, best of a few passes
+template <typename Path>
+static uint32_t tenthCyclesPerSample(const ImuSample* samples, uint32_t count, Path path) {
+    static constexpr uint32_t ROUNDS = 20;    // Long enough for the host clock's microsecond
+    uint32_t best = UINT32_MAX;
+    for (int pass = 0; pass < 5; pass++) {
+        uint32_t start = ESP.getCycleCount();
+        for (uint32_t r = 0; r < ROUNDS; r++) {
+            for (uint32_t i = 0; i < count; i++) path(samples[i]);
+        }
+        uint32_t cycles = ESP.getCycleCount() - start;
+        if (cycles < best) best = cycles;
+    }
+    return (uint32_t)(best * 10ULL / (count * ROUNDS));
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_wrist_predicates_match_float() {
+    uint32_t seed = 12345;
+    uint32_t hits[3] = {0, 0, 0};
+    for (uint32_t i = 0; i < 200000; i++) {
+        ImuSample s = randomSample(seed);
+        Reference f(s);
+        TEST_ASSERT_EQUAL(f.watchUp(), WristGesture::isWatchUp(s));
+        TEST_ASSERT_EQUAL(f.armDown(), WristGesture::isArmDown(s));
+        TEST_ASSERT_EQUAL(f.rotation(), WristGesture::isStrongRotation(s));
+        hits[0] += f.watchUp();
+        hits[1] += f.armDown();
+        hits[2] += f.rotation();
+    }
+    // Both outcomes of every predicate were exercised
+    for (uint32_t h : hits) {
+        TEST_ASSERT_GREATER_THAN(1000, h);
+        TEST_ASSERT_LESS_THAN(199000, h);
+    }
+}
+
+void test_thresholds_exact_at_the_edge() {
+    // Every count either side of each threshold
+    ImuSample s = {};
+    s.az = accelCounts(-0.5f);
+    for (int16_t x = WristGesture::WATCH_UP_X - 4; x <= WristGesture::WATCH_UP_X + 4; x++) {
+        s.ax = x;
+        TEST_ASSERT_EQUAL(Reference(s).watchUp(), WristGesture::isWatchUp(s));
+    }
+    s.az = 0;
+    for (int16_t y = WristGesture::ARM_DOWN_STANDING_Y - 4; y <= WristGesture::ARM_DOWN_STANDING_Y + 4; y++) {
+        s.ay = y;
+        TEST_ASSERT_EQUAL(Reference(s).armDown(), WristGesture::isArmDown(s));
+    }
+    for (int16_t g = WristGesture::STRONG_ROTATION - 4; g <= WristGesture::STRONG_ROTATION + 4; g++) {
+        s.gz = -g;
+        TEST_ASSERT_EQUAL(Reference(s).rotation(), WristGesture::isStrongRotation(s));
+    }
+}
+
+void test_squared_motion_matches_float() {
+    // Threshold in the squared domain as IMU::setMotionThreshold() sets it: Δ|a|² ≈ 2g·Δ|a| around rest
+    const float threshold_g = 0.15f;
+    const uint32_t threshold_sq = 2u * ImuSample::ACCEL_COUNTS_PER_G * (uint32_t)accelCounts(threshold_g);
+
+    // Consecutive samples around 1g, as a worn watch sees them
+    uint32_t seed = 777;
+    ImuSample last = {};
+    last.az = accelCounts(1.0f);
+    uint32_t disagree = 0, near = 0, motion = 0;
+    for (uint32_t i = 0; i < 100000; i++) {
+        ImuSample s = {};
+        seed = seed * 1664525u + 1013904223u; s.ax = (int16_t)((int32_t)(seed >> 22) - 512);
+        seed = seed * 1664525u + 1013904223u; s.ay = (int16_t)((int32_t)(seed >> 22) - 512);
+        seed = seed * 1664525u + 1013904223u; s.az = accelCounts(1.0f) + (int16_t)((int32_t)(seed >> 21) - 1024);
+
+        float delta_g = fabsf(Reference(s).magnitude() - Reference(last).magnitude());
+        uint32_t m = magnitudeSquared(s), l = magnitudeSquared(last);
+        bool reference = delta_g > threshold_g;
+        bool integer = (m > l ? m - l : l - m) > threshold_sq;
+        motion += reference;
+
+        // |a| + |b| is only 2g at rest: allow a different call within 25% of the threshold
+        if (fabsf(delta_g - threshold_g) < 0.25f * threshold_g) near++;
+        else if (reference != integer) disagree++;
+        last = s;
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, disagree);
+    TEST_ASSERT_GREATER_THAN(5000, motion);
+    TEST_ASSERT_LESS_THAN(motion / 2, near);
+}
+
+void test_deviation_without_sqrt() {
+    // magnitudeDeviationG overstates a deviation d by d²/2
+    for (float d = -0.3f; d <= 0.3f; d += 0.01f) {
+        ImuSample s = {};
+        s.az = accelCounts(1.0f + d);
+        float expected = sqrtf((float)magnitudeSquared(s)) / ImuSample::ACCEL_COUNTS_PER_G - 1.0f;
+        TEST_ASSERT_FLOAT_WITHIN(d * d / 2 + 0.001f, expected, magnitudeDeviationG(magnitudeSquared(s)));
+    }
+}
+
+void test_integer_path_cost() {
+    // What one 112Hz poll spends deciding: the three predicates and the motion magnitude
+    static ImuSample samples[50000];
+    uint32_t seed = 4242;
+    for (ImuSample& s : samples) s = randomSample(seed);
+    const uint32_t n = sizeof(samples) / sizeof(samples[0]);
+
+    static constexpr float LIMIT_G = 1.15f;
+    static constexpr uint32_t LIMIT_SQ = (uint32_t)(LIMIT_G * LIMIT_G * ImuSample::ACCEL_COUNTS_PER_G * ImuSample::ACCEL_COUNTS_PER_G);
+    volatile uint32_t sink = 0;
+    uint32_t float_cycles = tenthCyclesPerSample(samples, n, [&](const ImuSample& s) {
+        Reference f(s);
+        sink = sink + f.watchUp() + f.armDown() + f.rotation() + (f.magnitude() > LIMIT_G);
+    });
+    uint32_t integer_cycles = tenthCyclesPerSample(samples, n, [&](const ImuSample& s) {
+        sink = sink + WristGesture::isWatchUp(s) + WristGesture::isArmDown(s) + WristGesture::isStrongRotation(s) +
+               (magnitudeSquared(s) > LIMIT_SQ);
+    });
+
+    // Cycles at 240MHz: on the watch from the cycle counter, here from the host clock
+    char line[96];
+    snprintf(line, sizeof(line), "Detector cost: float %u.%u, integer %u.%u cycles/sample", (unsigned)(float_cycles / 10),
+             (unsigned)(float_cycles % 10), (unsigned)(integer_cycles / 10), (unsigned)(integer_cycles % 10));
+    TEST_MESSAGE(line);
+    // No conversions, no sqrt: never dearer than the float path
+    TEST_ASSERT_LESS_OR_EQUAL(float_cycles, integer_cycles);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_wrist_predicates_match_float);
+    RUN_TEST(test_thresholds_exact_at_the_edge);
+    RUN_TEST(test_squared_motion_matches_float);
+    RUN_TEST(test_deviation_without_sqrt);
+    RUN_TEST(test_integer_path_cost);
+    return UNITY_END();
+}
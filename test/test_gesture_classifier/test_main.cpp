@@ -0,0 +1,195 @@
+#include <unity.h>
+#include <Arduino.h>
+#include <stdio.h>
+
+#include "system/imu/gesture_classifier.hpp"
+
+using Node = GestureClassifier::Node;
+
+// Raise while the current ax is above zero, nothing otherwise
+static const Node TILT_NODES[] = {
+    {0, 0, 1, 2},
+    {-1, GestureClassifier::CLASS_NONE, 0, 0},
+    {-1, GestureClassifier::CLASS_RAISE, 0, 0},
+};
+static const GestureClassifier::Model TILT = {TILT_NODES, 3};
+
+static constexpr uint32_t POLL_MS = 50;
+
+static ImuSample tilted(bool up) {
+    ImuSample s = {};
+    s.ax = accelCounts(up ? 0.5f : -0.5f);
+    s.az = accelCounts(-0.85f);
+    return s;
+}
+
+// Fills the window with flat samples; returns the time of the next poll
+static uint32_t fillWindow(GestureClassifier& classifier, uint32_t t) {
+    for (uint8_t i = 0; i < GestureClassifier::WINDOW; i++, t += POLL_MS) {
+        TEST_ASSERT_EQUAL_UINT8(WristGesture::NONE, classifier.update(tilted(false), t));
+    }
+    return t;
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_leaf_walk() {
+    GestureClassifier classifier;
+    int8_t features[GestureClassifier::FEATURES] = {};
+
+    // dax 0, day -30, gxmax 0, ay -30: nodes 0, 12, 13, 14, 15 to the raise leaf
+    features[9] = 0;
+    features[10] = -30;
+    features[6] = 0;
+    features[1] = -30;
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_RAISE, classifier.classify(features));
+
+    // One step off at node 15: ay above -20 is the none leaf next to it
+    features[1] = -19;
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_NONE, classifier.classify(features));
+
+    // The threshold itself goes left
+    classifier.setModel(TILT);
+    features[0] = 0;
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_NONE, classifier.classify(features));
+    features[0] = 1;
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_RAISE, classifier.classify(features));
+}
+
+void test_malformed_table() {
+    int8_t features[GestureClassifier::FEATURES] = {};
+
+    // A child past the end of the table
+    static const Node OUT_OF_RANGE[] = {
+        {0, 0, 7, 1},
+        {-1, GestureClassifier::CLASS_RAISE, 0, 0},
+    };
+    static const GestureClassifier::Model OUT_OF_RANGE_MODEL = {OUT_OF_RANGE, 2};
+    GestureClassifier classifier(OUT_OF_RANGE_MODEL);
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_NONE, classifier.classify(features));
+    features[0] = 1;
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_RAISE, classifier.classify(features));
+
+    // A loop with no leaf: the walk gives up after node_count steps
+    static const Node LOOP[] = {
+        {0, 0, 1, 1},
+        {1, 0, 0, 0},
+    };
+    static const GestureClassifier::Model LOOP_MODEL = {LOOP, 2};
+    classifier.setModel(LOOP_MODEL);
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_NONE, classifier.classify(features));
+}
+
+void test_fires_after_confirm_polls() {
+    GestureClassifier classifier(TILT);
+    uint32_t t = fillWindow(classifier, 1000);
+
+    // The first windows of a class only build the streak
+    for (uint8_t i = 1; i < GestureClassifier::CONFIRM_POLLS; i++, t += POLL_MS) {
+        TEST_ASSERT_EQUAL_UINT8(WristGesture::NONE, classifier.update(tilted(true), t));
+        TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_RAISE, classifier.getLastClass());
+    }
+    TEST_ASSERT_EQUAL_UINT8(WristGesture::RAISE, classifier.update(tilted(true), t));
+
+    // Once per streak, however long it lasts
+    for (uint8_t i = 0; i < GestureClassifier::WINDOW; i++) {
+        t += POLL_MS;
+        TEST_ASSERT_EQUAL_UINT8(WristGesture::NONE, classifier.update(tilted(true), t));
+    }
+}
+
+void test_broken_streak_starts_over() {
+    GestureClassifier classifier(TILT);
+    uint32_t t = fillWindow(classifier, 1000);
+    for (uint8_t i = 1; i < GestureClassifier::CONFIRM_POLLS; i++, t += POLL_MS) classifier.update(tilted(true), t);
+    TEST_ASSERT_EQUAL_UINT8(WristGesture::NONE, classifier.update(tilted(false), t));
+
+    for (uint8_t i = 1; i < GestureClassifier::CONFIRM_POLLS; i++) {
+        t += POLL_MS;
+        TEST_ASSERT_EQUAL_UINT8(WristGesture::NONE, classifier.update(tilted(true), t));
+    }
+    t += POLL_MS;
+    TEST_ASSERT_EQUAL_UINT8(WristGesture::RAISE, classifier.update(tilted(true), t));
+}
+
+void test_cooldown() {
+    GestureClassifier classifier(TILT);
+    uint32_t t = fillWindow(classifier, 1000);
+    uint32_t fired = 0;
+    for (; fired == 0; t += POLL_MS) {
+        if (classifier.update(tilted(true), t) == WristGesture::RAISE) fired = t;
+    }
+
+    // A fresh streak inside the cooldown is held back, then fires as soon as it ends
+    TEST_ASSERT_EQUAL_UINT8(WristGesture::NONE, classifier.update(tilted(false), t));
+    uint32_t refired = 0;
+    for (t += POLL_MS; refired == 0 && t < fired + 2 * GestureClassifier::COOLDOWN_MS; t += POLL_MS) {
+        if (classifier.update(tilted(true), t) == WristGesture::RAISE) refired = t;
+    }
+    TEST_ASSERT_EQUAL_UINT32(fired + GestureClassifier::COOLDOWN_MS, refired);
+}
+
+void test_reset_clears_window() {
+    GestureClassifier classifier(TILT);
+    uint32_t t = fillWindow(classifier, 1000);
+    while (classifier.update(tilted(true), t) != WristGesture::RAISE) t += POLL_MS;
+    classifier.reset();
+    TEST_ASSERT_EQUAL_UINT8(GestureClassifier::CLASS_NONE, classifier.getLastClass());
+
+    // Nothing until the window is full again, and no cooldown carried over
+    for (uint8_t i = 1; i < GestureClassifier::WINDOW; i++) {
+        t += POLL_MS;
+        TEST_ASSERT_EQUAL_UINT8(WristGesture::NONE, classifier.update(tilted(true), t));
+    }
+    for (uint8_t i = 1; i < GestureClassifier::CONFIRM_POLLS; i++) classifier.update(tilted(true), t += POLL_MS);
+    t += POLL_MS;
+    TEST_ASSERT_EQUAL_UINT8(WristGesture::RAISE, classifier.update(tilted(true), t));
+}
+
+void test_window_cost() {
+    // Feature extraction and the tree walk with the shipped model, once per 50ms poll
+    static constexpr uint32_t POLLS = 100000;
+    static ImuSample samples[64];
+    uint32_t seed = 4242;
+    for (ImuSample& s : samples) {
+        seed = seed * 1664525u + 1013904223u;
+        s.ax = (int16_t)(seed >> 16);
+        seed = seed * 1664525u + 1013904223u;
+        s.ay = (int16_t)(seed >> 16);
+        s.az = (int16_t)(seed & 0xFFFF);
+        s.gx = (int16_t)(seed >> 8);
+    }
+
+    GestureClassifier classifier;
+    volatile uint32_t sink = 0;
+    uint32_t best = UINT32_MAX;
+    for (int pass = 0; pass < 5; pass++) {
+        classifier.reset();
+        uint32_t start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < POLLS; i++) sink = sink + classifier.update(samples[i & 63], i * POLL_MS);
+        uint32_t cycles = ESP.getCycleCount() - start;
+        if (cycles < best) best = cycles;
+    }
+
+    // Cycles at 240MHz: on the watch from the cycle counter, here from the host clock
+    uint32_t per_window = best / POLLS;
+    char line[64];
+    snprintf(line, sizeof(line), "Gesture model: %u cycles/window", (unsigned)per_window);
+    TEST_MESSAGE(line);
+    // Well inside 1% of the poll interval
+    TEST_ASSERT_LESS_THAN(240000000 / 1000 * POLL_MS / 100, per_window);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_leaf_walk);
+    RUN_TEST(test_malformed_table);
+    RUN_TEST(test_fires_after_confirm_polls);
+    RUN_TEST(test_broken_streak_starts_over);
+    RUN_TEST(test_cooldown);
+    RUN_TEST(test_reset_clears_window);
+    RUN_TEST(test_window_cost);
+    return UNITY_END();
+}
@@ -0,0 +1,288 @@
+#include <unity.h>
+#include <atomic>
+#include <thread>
+
+#include "config.h"
+#include "system/i2c/i2c_bus.hpp"
+#include "sim/device.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+static I2CBus* bus = nullptr;
+static sim::Device* touch = nullptr;
+static sim::Device* codec = nullptr;
+
+/**
+ * Register file that checks every transaction it sees: at its own clock, and
+ * never while a transaction to another device is still on the wire.
+ */
+class ClockedDevice : public sim::Device {
+private:
+    static std::atomic<int>& onWire() {
+        static std::atomic<int> active{0};
+        return active;
+    }
+
+    void check() {
+        if (onWire()++ != 0) overlaps++;
+        if (Wire.getClock() != hz) wrong_clock++;
+        std::this_thread::yield();    // Give the other thread a window to barge in
+        onWire()--;
+    }
+
+public:
+    const uint32_t hz;
+    std::atomic<uint32_t> seen{0};
+    std::atomic<uint32_t> overlaps{0};
+    std::atomic<uint32_t> wrong_clock{0};
+
+    ClockedDevice(uint8_t address, uint32_t hz) : Device(address), hz(hz) {}
+
+    bool transmit(const uint8_t* data, size_t len) override {
+        check();
+        seen++;
+        return Device::transmit(data, len);
+    }
+    size_t receive(uint8_t* buffer, size_t len) override {
+        check();
+        seen++;
+        return Device::receive(buffer, len);
+    }
+};
+
+// Writes a block tagged with the device and round, reads it back; returns the mismatches
+static uint32_t exchange(I2CDevice* dev, uint32_t rounds) {
+    uint32_t corrupt = 0;
+    uint8_t out[8], in[8];
+    for (uint32_t r = 0; r < rounds; r++) {
+        for (uint8_t i = 0; i < sizeof(out); i++) out[i] = (uint8_t)(dev->getAddress() ^ (r * 7 + i));
+        if (!dev->writeRegs(0x20, out, sizeof(out)) || !dev->readRegs(0x20, in, sizeof(in))) corrupt++;
+        else if (memcmp(out, in, sizeof(in)) != 0) corrupt++;
+    }
+    return corrupt;
+}
+
+void setUp() {
+    Wire.detachAll();
+    Wire.clearFaults();
+    Wire.seedFaults(0x2545F491);
+    touch = new sim::Device(0x38);
+    codec = new sim::Device(0x18);
+    Wire.attach(*touch);
+    Wire.attach(*codec);
+    bus = new I2CBus(&logger, Wire);
+    TEST_ASSERT_TRUE(bus->begin(I2C_SDA, I2C_SCL, I2C_STANDARD_HZ));
+}
+
+void tearDown() {
+    delete bus;
+    delete touch;
+    delete codec;
+    Wire.detachAll();
+}
+
+void test_register_round_trip() {
+    I2CDevice dev("TOUCH", 0x38);
+    dev.attach(*bus);
+
+    const uint8_t data[4] = {0xDE, 0xAD, 0xBE, 0xEF};
+    TEST_ASSERT_TRUE(dev.writeRegs(0x10, data, sizeof(data)));
+    TEST_ASSERT_EQUAL_HEX8(0xBE, touch->peek(0x12));
+
+    uint8_t back[4] = {0};
+    TEST_ASSERT_TRUE(dev.readRegs(0x10, back, sizeof(back)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data, back, sizeof(data));
+
+    const I2CDevice::Stats& s = dev.getStats();
+    TEST_ASSERT_EQUAL_UINT32(2, s.transactions);
+    TEST_ASSERT_EQUAL_UINT32(8, s.bytes);
+    TEST_ASSERT_EQUAL_UINT32(0, s.nacks + s.errors);
+    TEST_ASSERT_GREATER_THAN(0, s.busy_us);
+}
+
+void test_missing_address_nacks() {
+    I2CDevice dev("GHOST", 0x77);
+    dev.attach(*bus);
+    TEST_ASSERT_FALSE(dev.probe());
+    uint8_t value;
+    TEST_ASSERT_FALSE(dev.readReg(0x00, &value));
+    TEST_ASSERT_EQUAL_UINT8(I2CBus::ERROR_ADDR_NACK, bus->getLastError());
+    TEST_ASSERT_EQUAL_UINT32(2, dev.getStats().nacks);
+}
+
+void test_nack_fault() {
+    I2CDevice dev("TOUCH", 0x38);
+    dev.attach(*bus);
+    Wire.injectFault(0x38, 100);
+
+    uint8_t value = 0x5A;
+    TEST_ASSERT_FALSE(dev.writeReg(0x01, value));
+    TEST_ASSERT_EQUAL_HEX8(0x00, touch->peek(0x01));  // Never reached the device
+    TEST_ASSERT_FALSE(dev.readReg(0x01, &value));
+    TEST_ASSERT_EQUAL_UINT32(2, dev.getStats().nacks);
+    TEST_ASSERT_EQUAL_UINT32(0, dev.getStats().errors);
+
+    // Other addresses are unaffected
+    I2CDevice other("CODEC", 0x18, I2C_STANDARD_HZ);
+    other.attach(*bus);
+    TEST_ASSERT_TRUE(other.readReg(0x00, &value));
+}
+
+void test_short_read_fault() {
+    I2CDevice dev("TOUCH", 0x38);
+    dev.attach(*bus);
+    Wire.injectFault(0x38, 0, 100);
+
+    uint8_t buffer[6];
+    TEST_ASSERT_FALSE(dev.readRegs(0x00, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_UINT8(I2CBus::ERROR_SHORT_READ, bus->getLastError());
+    TEST_ASSERT_EQUAL_UINT32(1, dev.getStats().errors);
+    TEST_ASSERT_EQUAL_UINT32(0, dev.getStats().nacks);
+    TEST_ASSERT_TRUE(dev.writeReg(0x00, 1));  // Writes still go through
+}
+
+void test_partial_faults_are_repeatable() {
+    I2CDevice dev("TOUCH", 0x38);
+    dev.attach(*bus);
+    uint8_t value;
+
+    uint32_t nacks[2];
+    for (int run = 0; run < 2; run++) {
+        Wire.seedFaults(1234);
+        Wire.injectFault(0x38, 20);
+        dev.resetStats();
+        for (int i = 0; i < 1000; i++) dev.readReg(0x00, &value);
+        nacks[run] = dev.getStats().nacks;
+    }
+    TEST_ASSERT_EQUAL_UINT32(nacks[0], nacks[1]);
+    TEST_ASSERT_UINT_WITHIN(60, 200, nacks[0]);
+    TEST_ASSERT_EQUAL_UINT32(1000 - nacks[0], dev.getStats().transactions - dev.getStats().nacks);
+}
+
+void test_latency_fault() {
+    I2CDevice dev("TOUCH", 0x38);
+    dev.attach(*bus);
+    uint8_t value;
+
+    // A readReg is two 20-bit transactions: 100us on the wire at 400kHz.
+    // Wire time and stretching advance the clock exactly; the host only adds to it.
+    static constexpr uint32_t WIRE_US = 40 * 1000000ULL / I2C_FAST_HZ;
+    TEST_ASSERT_TRUE(dev.readReg(0x00, &value));
+    TEST_ASSERT_GREATER_OR_EQUAL(WIRE_US, dev.getStats().busy_us);
+    dev.resetStats();
+
+    Wire.injectFault(0x38, 0, 0, 500);
+    TEST_ASSERT_TRUE(dev.readReg(0x00, &value));
+    TEST_ASSERT_GREATER_OR_EQUAL(500 + WIRE_US, dev.getStats().busy_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(dev.getStats().busy_us, dev.getStats().max_us);
+}
+
+void test_per_device_clock() {
+    I2CDevice fast("TOUCH", 0x38, I2C_FAST_HZ);
+    I2CDevice slow("CODEC", 0x18, I2C_STANDARD_HZ);
+    fast.attach(*bus);
+    slow.attach(*bus);
+    uint8_t buffer[16];
+
+    TEST_ASSERT_TRUE(fast.readRegs(0x00, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_UINT32(I2C_FAST_HZ, Wire.getClock());
+    TEST_ASSERT_TRUE(slow.readRegs(0x00, buffer, sizeof(buffer)));
+    TEST_ASSERT_EQUAL_UINT32(I2C_STANDARD_HZ, Wire.getClock());
+
+    // The same transfer takes about four times as long at 100kHz
+    uint32_t fast_us = fast.getStats().busy_us;
+    uint32_t slow_us = slow.getStats().busy_us;
+    TEST_ASSERT_GREATER_THAN(fast_us * 3, slow_us);
+    TEST_ASSERT_LESS_THAN(fast_us * 5, slow_us);
+}
+
+void test_burst_throughput_grows_with_clock() {
+    // The QMI8658 accel+gyro burst at each clock the bus offers
+    sim::Device imu(0x6B);
+    Wire.attach(imu);
+    const uint32_t clocks[] = {I2C_STANDARD_HZ, I2C_FAST_HZ, I2C_FAST_PLUS_HZ};
+    uint32_t per_second[3];
+    uint8_t buffer[12];
+
+    for (uint8_t c = 0; c < 3; c++) {
+        I2CDevice dev("IMU", 0x6B, clocks[c]);
+        dev.attach(*bus);
+        for (int i = 0; i < 200; i++) TEST_ASSERT_TRUE(dev.readRegs(0x35, buffer, sizeof(buffer)));
+
+        const I2CDevice::Stats& s = dev.getStats();
+        TEST_ASSERT_EQUAL_UINT32(200, s.transactions);
+        TEST_ASSERT_EQUAL_UINT32(200 * sizeof(buffer), s.bytes);
+        TEST_ASSERT_EQUAL_UINT32(0, s.nacks + s.errors);
+        per_second[c] = (uint32_t)(s.transactions * 1000000ULL / s.busy_us);
+    }
+
+    // Wire time dominates: about 4x from 100kHz to 400kHz, 2.5x more at 1MHz
+    TEST_ASSERT_GREATER_THAN(per_second[0] * 3, per_second[1]);
+    TEST_ASSERT_LESS_THAN(per_second[0] * 5, per_second[1]);
+    TEST_ASSERT_GREATER_THAN(per_second[1] * 2, per_second[2]);
+    TEST_ASSERT_LESS_THAN(per_second[1] * 3, per_second[2]);
+}
+
+void test_raw_session_counts_once() {
+    I2CDevice dev("PMU", 0x18, I2C_STANDARD_HZ);
+    dev.attach(*bus);
+    {
+        // A library driving TwoWire itself under the device lock
+        I2CDevice::Lock lock(dev);
+        TwoWire& wire = bus->getWire();
+        for (int i = 0; i < 3; i++) {
+            wire.beginTransmission(0x18);
+            wire.write(0x00);
+            TEST_ASSERT_EQUAL_UINT8(0, wire.endTransmission());
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, dev.getStats().transactions);
+    TEST_ASSERT_GREATER_THAN(0, bus->getTotalBusyUs());
+}
+
+void test_threads_share_the_bus() {
+    // The RTC at standard mode so a clock leaking from the IMU side would show
+    ClockedDevice imu_chip(0x6B, I2C_FAST_HZ);
+    ClockedDevice rtc_chip(0x51, I2C_STANDARD_HZ);
+    Wire.attach(imu_chip);
+    Wire.attach(rtc_chip);
+    I2CDevice imu("IMU", 0x6B, I2C_FAST_HZ);
+    I2CDevice rtc("RTC", 0x51, I2C_STANDARD_HZ);
+    imu.attach(*bus);
+    rtc.attach(*bus);
+
+    static constexpr uint32_t ROUNDS = 2000;
+    uint32_t imu_corrupt = 0, rtc_corrupt = 0;
+    std::thread imu_loop([&]() { imu_corrupt = exchange(&imu, ROUNDS); });
+    std::thread rtc_loop([&]() { rtc_corrupt = exchange(&rtc, ROUNDS); });
+    imu_loop.join();
+    rtc_loop.join();
+
+    TEST_ASSERT_EQUAL_UINT32(0, imu_corrupt);
+    TEST_ASSERT_EQUAL_UINT32(0, rtc_corrupt);
+    TEST_ASSERT_EQUAL_UINT32(0, imu_chip.overlaps + rtc_chip.overlaps);
+    TEST_ASSERT_EQUAL_UINT32(0, imu_chip.wrong_clock);
+    TEST_ASSERT_EQUAL_UINT32(0, rtc_chip.wrong_clock);
+
+    // A write, then the pointer write and the read: three on the wire per round
+    TEST_ASSERT_EQUAL_UINT32(3 * ROUNDS, imu_chip.seen);
+    TEST_ASSERT_EQUAL_UINT32(3 * ROUNDS, rtc_chip.seen);
+    TEST_ASSERT_EQUAL_UINT32(2 * ROUNDS, imu.getStats().transactions);
+    TEST_ASSERT_EQUAL_UINT32(2 * ROUNDS, rtc.getStats().transactions);
+    TEST_ASSERT_EQUAL_UINT32(0, imu.getStats().nacks + imu.getStats().errors);
+    TEST_ASSERT_EQUAL_UINT32(0, rtc.getStats().nacks + rtc.getStats().errors);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_register_round_trip);
+    RUN_TEST(test_missing_address_nacks);
+    RUN_TEST(test_nack_fault);
+    RUN_TEST(test_short_read_fault);
+    RUN_TEST(test_partial_faults_are_repeatable);
+    RUN_TEST(test_latency_fault);
+    RUN_TEST(test_per_device_clock);
+    RUN_TEST(test_burst_throughput_grows_with_clock);
+    RUN_TEST(test_raw_session_counts_once);
+    RUN_TEST(test_threads_share_the_bus);
+    return UNITY_END();
+}
@@ -0,0 +1,270 @@
+#include <unity.h>
+#include <atomic>
+
+#include "config.h"
+#include "system/i2c/i2c_scheduler.hpp"
+#include "system/rtc/rtc.hpp"
+#include "sim/device.hpp"
+#include "sim/pcf85063.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+// The worker task runs for the life of the process: everything it touches is static
+static sim::Device imu_chip(0x6B), codec_chip(0x40);
+static sim::Pcf85063 rtc_chip(RTC_INT);
+static I2CBus bus(&logger, Wire);
+static I2CScheduler scheduler(&logger, bus);
+static I2CDevice imu("IMU", 0x6B, I2C_FAST_HZ);              // QMI8658 accel+gyro burst
+static I2CDevice rtc("RTC", 0x51, I2C_FAST_HZ);              // PCF85063 time registers
+static I2CDevice codec("MIC", 0x40, I2C_STANDARD_HZ);        // ES7210 register file
+
+// Callbacks in completion order, tagged by ctx
+struct Recorder {
+    std::atomic<uint8_t> count{0};
+    std::atomic<uint8_t> failed{0};
+    uintptr_t order[64];
+};
+
+static Recorder recorder;
+
+static void record(const I2CScheduler::Transfer&, bool ok, void* ctx) {
+    uint8_t n = recorder.count;
+    if (n < 64) recorder.order[n] = (uintptr_t)ctx;
+    if (!ok) recorder.failed++;
+    recorder.count++;
+}
+
+static uint8_t buffer[64];
+
+static void* tag(uintptr_t n) { return (void*)n; }
+
+static bool drained() {
+    return !scheduler.queued(I2CScheduler::PRIORITY_REALTIME) && !scheduler.queued(I2CScheduler::PRIORITY_NORMAL) &&
+           !scheduler.queued(I2CScheduler::PRIORITY_BACKGROUND);
+}
+
+// Waits until n callbacks have run, or a second of host time
+static void waitFor(uint8_t n) {
+    for (int i = 0; i < 1000 && recorder.count < n; i++) delay(1);
+}
+
+// Puts one transfer on the wire and keeps it there until the lock goes out of scope,
+// so everything submitted meanwhile queues up behind it
+static void occupyWorker() {
+    scheduler.read(rtc, 0x04, buffer, 7, I2CScheduler::PRIORITY_NORMAL, record, tag(99));
+    for (int i = 0; i < 1000 && !drained(); i++) delay(1);
+    TEST_ASSERT_TRUE(drained());
+}
+
+void setUp() {
+    recorder.count = 0;
+    recorder.failed = 0;
+    scheduler.resetStats();
+}
+
+void tearDown() {}
+
+void test_not_running_without_bus() {
+    I2CBus idle_bus(&logger, Wire);
+    I2CScheduler idle(&logger, idle_bus);
+    TEST_ASSERT_FALSE(idle.begin());
+    TEST_ASSERT_FALSE(idle.isRunning());
+    TEST_ASSERT_FALSE(idle.read(imu, 0x35, buffer, 12, I2CScheduler::PRIORITY_REALTIME));
+}
+
+void test_read_and_write() {
+    uint8_t value = 0;
+    TEST_ASSERT_TRUE(scheduler.write(codec, 0x20, 0xA5, I2CScheduler::PRIORITY_BACKGROUND, record, tag(1)));
+    TEST_ASSERT_TRUE(scheduler.read(codec, 0x20, &value, 1, I2CScheduler::PRIORITY_BACKGROUND, record, tag(2)));
+    waitFor(2);
+
+    TEST_ASSERT_EQUAL_UINT8(2, recorder.count);
+    TEST_ASSERT_EQUAL_UINT8(0, recorder.failed);
+    TEST_ASSERT_EQUAL_HEX8(0xA5, codec_chip.peek(0x20));
+    TEST_ASSERT_EQUAL_HEX8(0xA5, value);
+    TEST_ASSERT_EQUAL_UINT32(2, scheduler.getStats(I2CScheduler::PRIORITY_BACKGROUND).completed);
+}
+
+void test_priority_then_deadline() {
+    {
+        I2CBus::Lock hold(bus);
+        occupyWorker();
+        scheduler.read(codec, 0x00, buffer, 1, I2CScheduler::PRIORITY_BACKGROUND, record, tag(4));
+        scheduler.read(rtc, 0x04, buffer, 7, I2CScheduler::PRIORITY_NORMAL, record, tag(3));
+        scheduler.read(imu, 0x35, buffer, 12, I2CScheduler::PRIORITY_REALTIME, record, tag(2), 1500);
+        scheduler.read(imu, 0x35, buffer, 12, I2CScheduler::PRIORITY_REALTIME, record, tag(1), 1000);
+    }
+    waitFor(5);
+
+    // The transfer already on the wire, then by level, earliest deadline first within one
+    TEST_ASSERT_EQUAL_UINT8(5, recorder.count);
+    const uintptr_t expected[] = {99, 1, 2, 3, 4};
+    for (uint8_t i = 0; i < 5; i++) TEST_ASSERT_EQUAL_UINT32(expected[i], recorder.order[i]);
+}
+
+void test_expired_background_competes_with_normal() {
+    {
+        I2CBus::Lock hold(bus);
+        occupyWorker();
+        scheduler.read(rtc, 0x04, buffer, 7, I2CScheduler::PRIORITY_NORMAL, record, tag(2));
+        scheduler.read(codec, 0x00, buffer, 1, I2CScheduler::PRIORITY_BACKGROUND, record, tag(1), 100);
+        delay(5);
+    }
+    waitFor(3);
+
+    // Past its deadline the background read goes ahead of the normal one due later
+    TEST_ASSERT_EQUAL_UINT8(3, recorder.count);
+    TEST_ASSERT_EQUAL_UINT32(1, recorder.order[1]);
+    TEST_ASSERT_EQUAL_UINT32(2, recorder.order[2]);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStats(I2CScheduler::PRIORITY_BACKGROUND).late);
+}
+
+void test_drop_late() {
+    I2CScheduler::Transfer t;
+    t.device = &imu;
+    t.reg = 0x35;
+    t.data = buffer;
+    t.len = 12;
+    t.priority = I2CScheduler::PRIORITY_REALTIME;
+    t.deadline_us = 100;
+    t.drop_late = true;
+    t.callback = record;
+    t.ctx = tag(1);
+    uint32_t transactions = imu.getStats().transactions;
+    {
+        I2CBus::Lock hold(bus);
+        occupyWorker();
+        TEST_ASSERT_TRUE(scheduler.submit(t));
+        delay(5);
+    }
+    waitFor(2);
+
+    // A stale sample is worth less than the bus time: failed without touching the wire
+    TEST_ASSERT_EQUAL_UINT8(1, recorder.failed);
+    const I2CScheduler::Stats& s = scheduler.getStats(I2CScheduler::PRIORITY_REALTIME);
+    TEST_ASSERT_EQUAL_UINT32(1, s.dropped);
+    TEST_ASSERT_EQUAL_UINT32(0, s.completed);
+    TEST_ASSERT_EQUAL_UINT32(transactions, imu.getStats().transactions);
+}
+
+void test_full_queue_rejects() {
+    {
+        I2CBus::Lock hold(bus);
+        occupyWorker();
+        for (uint8_t i = 0; i < I2CScheduler::QUEUE_DEPTH; i++) {
+            TEST_ASSERT_TRUE(scheduler.read(codec, i, &buffer[i], 1, I2CScheduler::PRIORITY_BACKGROUND));
+        }
+        TEST_ASSERT_FALSE(scheduler.read(codec, 0x20, buffer, 1, I2CScheduler::PRIORITY_BACKGROUND));
+        // Each level has its own queue
+        TEST_ASSERT_TRUE(scheduler.read(codec, 0x20, buffer, 1, I2CScheduler::PRIORITY_NORMAL));
+    }
+    for (int i = 0; i < 1000 && !drained(); i++) delay(1);
+
+    const I2CScheduler::Stats& s = scheduler.getStats(I2CScheduler::PRIORITY_BACKGROUND);
+    TEST_ASSERT_EQUAL_UINT32(I2CScheduler::QUEUE_DEPTH + 1, s.submitted);
+    TEST_ASSERT_EQUAL_UINT32(1, s.rejected);
+}
+
+void test_mixed_load() {
+    // Realtime IMU bursts every 2ms, RTC polls every 50ms and 40-register codec batches
+    // every 100ms, topped up as queue slots free
+    static uint8_t imu_buf[12], rtc_buf[7], codec_buf[40];
+    unsigned long start = millis(), last_rtc = 0, last_codec = 0;
+    uint8_t codec_next = sizeof(codec_buf);
+    uint32_t imu_reads = 0;
+    while (millis() - start < 500) {
+        unsigned long now = millis();
+        if (scheduler.read(imu, 0x35, imu_buf, sizeof(imu_buf), I2CScheduler::PRIORITY_REALTIME, nullptr, nullptr, 1000)) imu_reads++;
+        if (now - last_rtc >= 50) {
+            last_rtc = now;
+            scheduler.read(rtc, 0x04, rtc_buf, sizeof(rtc_buf), I2CScheduler::PRIORITY_NORMAL);
+        }
+        if (now - last_codec >= 100) {
+            last_codec = now;
+            codec_next = 0;
+        }
+        while (codec_next < sizeof(codec_buf) && scheduler.read(codec, codec_next, &codec_buf[codec_next], 1, I2CScheduler::PRIORITY_BACKGROUND)) codec_next++;
+        delay(2);
+    }
+    for (int i = 0; i < 1000 && !drained(); i++) delay(1);
+    delay(5);    // The last one off the queue is still on the wire
+    scheduler.logStats();
+
+    const I2CScheduler::Stats& rt = scheduler.getStats(I2CScheduler::PRIORITY_REALTIME);
+    const I2CScheduler::Stats& bg = scheduler.getStats(I2CScheduler::PRIORITY_BACKGROUND);
+    TEST_ASSERT_GREATER_THAN(100, imu_reads);
+    TEST_ASSERT_EQUAL_UINT32(imu_reads, rt.completed);
+    TEST_ASSERT_EQUAL_UINT32(0, rt.rejected + rt.failed);
+    TEST_ASSERT_EQUAL_UINT32(0, bg.failed);
+    TEST_ASSERT_GREATER_OR_EQUAL(4 * sizeof(codec_buf), bg.completed);
+
+    // Realtime waits for at most the transfer on the wire: its latencies sit well below the background ones
+    uint32_t rt_fast = rt.histogram[0] + rt.histogram[1] + rt.histogram[2] + rt.histogram[3] + rt.histogram[4];
+    TEST_ASSERT_GREATER_OR_EQUAL(rt.completed * 9 / 10, rt_fast);    // Under 1ms
+    TEST_ASSERT_LESS_THAN(bg.max_us, rt.max_us);
+}
+
+void test_driver_polls_through_scheduler() {
+    // The heartbeat's time read: queued at normal priority, picked up later
+    static RTC clock(&logger);
+    TEST_ASSERT_TRUE(clock.setBus(bus));
+    RTC::DateTime set = {56, 34, 12, 18, 0, 10, 2026};
+    TEST_ASSERT_TRUE(clock.setDateTime(set));
+
+    RTC::DateTime dt;
+    TEST_ASSERT_FALSE(clock.getPolledDateTime(dt));
+    TEST_ASSERT_TRUE(clock.requestDateTime(scheduler));
+    TEST_ASSERT_FALSE(clock.requestDateTime(scheduler));    // One in flight at a time
+    for (int i = 0; i < 1000 && !clock.getPolledDateTime(dt); i++) delay(1);
+
+    uint32_t age_ms = UINT32_MAX;
+    TEST_ASSERT_TRUE(clock.getPolledDateTime(dt, &age_ms));
+    TEST_ASSERT_LESS_THAN(1000, age_ms);
+    TEST_ASSERT_EQUAL_UINT16(2026, dt.year);
+    TEST_ASSERT_EQUAL_UINT8(10, dt.month);
+    TEST_ASSERT_EQUAL_UINT8(18, dt.day);
+    TEST_ASSERT_EQUAL_UINT8(12, dt.hour);
+    TEST_ASSERT_EQUAL_UINT8(34, dt.minute);
+    TEST_ASSERT_EQUAL_UINT8(56, dt.second);
+    TEST_ASSERT_EQUAL_UINT32(1, scheduler.getStats(I2CScheduler::PRIORITY_NORMAL).completed);
+}
+
+void test_power_lock_held_while_queued() {
+    // Last: the scheduler keeps the lock from here on
+    static PowerManager power(&logger);
+    int8_t lock = power.addLock("i2c");
+    scheduler.setPowerLock(power, lock);
+    {
+        I2CBus::Lock hold(bus);
+        occupyWorker();
+        scheduler.read(imu, 0x35, buffer, 12, I2CScheduler::PRIORITY_REALTIME, record, tag(1));
+        // No light sleep with transfers in flight
+        TEST_ASSERT_FALSE(PowerManager::idle(1000, &power));
+    }
+    waitFor(2);
+    TEST_ASSERT_EQUAL_UINT8(2, recorder.count);
+    TEST_ASSERT_TRUE(PowerManager::idle(1000, &power));
+}
+
+int main() {
+    imu.attach(bus);
+    rtc.attach(bus);
+    codec.attach(bus);
+    Wire.attach(imu_chip);
+    Wire.attach(rtc_chip);
+    Wire.attach(codec_chip);
+    bus.begin(I2C_SDA, I2C_SCL, I2C_STANDARD_HZ);
+    scheduler.begin();
+
+    UNITY_BEGIN();
+    RUN_TEST(test_not_running_without_bus);
+    RUN_TEST(test_read_and_write);
+    RUN_TEST(test_priority_then_deadline);
+    RUN_TEST(test_expired_background_competes_with_normal);
+    RUN_TEST(test_drop_late);
+    RUN_TEST(test_full_queue_rejects);
+    RUN_TEST(test_mixed_load);
+    RUN_TEST(test_driver_polls_through_scheduler);
+    RUN_TEST(test_power_lock_held_while_queued);
+    return UNITY_END();
+}
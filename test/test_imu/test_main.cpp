@@ -0,0 +1,274 @@
+#include <unity.h>
+#include <math.h>
+
+#include "system/imu/imu.hpp"
+#include "sim/qmi8658.hpp"
+
+using sim::Qmi8658;
+
+Logger logger;    // Defined by main.cpp in the firmware
+static I2CBus* bus = nullptr;
+static Qmi8658* chip = nullptr;
+static IMU* imu = nullptr;
+
+void setUp() {
+    Wire.detachAll();
+    Wire.clearFaults();
+    chip = new Qmi8658(IMU_INT1);
+    Wire.attach(*chip);
+    bus = new I2CBus(&logger, Wire);
+    bus->begin(I2C_SDA, I2C_SCL, I2C_FAST_HZ);
+    imu = new IMU(&logger);
+}
+
+void tearDown() {
+    detachInterrupt(IMU_INT1);
+    delete imu;
+    delete bus;
+    delete chip;
+    Wire.detachAll();
+}
+
+static void assertCal(const Qmi8658::Executed& e, uint8_t cmd, const uint8_t (&cal)[8]) {
+    TEST_ASSERT_EQUAL_HEX8(cmd, e.cmd);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(cal, e.cal, 8);
+}
+
+void test_init_configures_sensor() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    TEST_ASSERT_EQUAL_UINT32(1, chip->getResets());
+    TEST_ASSERT_EQUAL_HEX8(Qmi8658::REVISION, imu->getRevision());
+    TEST_ASSERT_EQUAL_HEX8(0x4C, chip->peek(Qmi8658::CTRL1));
+    TEST_ASSERT_EQUAL_HEX8(0x26, chip->peek(Qmi8658::CTRL2));
+    TEST_ASSERT_EQUAL_HEX8(0x66, chip->peek(Qmi8658::CTRL3));
+    TEST_ASSERT_EQUAL_HEX8(0x03, chip->peek(Qmi8658::CTRL7));
+    TEST_ASSERT_TRUE(sim::Pins::get().isAttached(IMU_INT1));
+}
+
+void test_wrong_chip_id_fails() {
+    chip->poke(Qmi8658::WHO_AM_I, 0x00);
+    TEST_ASSERT_FALSE(imu->setBus(*bus));
+    TEST_ASSERT_FALSE(imu->isInitialized());
+    TEST_ASSERT_EQUAL_UINT32(0, chip->getResets());
+}
+
+void test_missing_chip_fails() {
+    Wire.detachAll();
+    TEST_ASSERT_FALSE(imu->setBus(*bus));
+}
+
+void test_tap_handshake() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    TEST_ASSERT_TRUE(imu->enableTap());
+
+    // Two CONFIGURE_TAP passes, default windows at 112.1Hz: peak 7, tap 22, double tap 56 samples;
+    // alpha/gamma in 1/128, thresholds in 5.10 g²
+    const auto& cmds = chip->commands();
+    TEST_ASSERT_EQUAL(2, cmds.size());
+    const uint8_t first[8] = {7, 0, 22, 0, 56, 0, 0x00, 0x01};
+    const uint8_t second[8] = {8, 32, 0x33, 0x03, 0x99, 0x01, 0x00, 0x02};
+    assertCal(cmds[0], Qmi8658::CMD_CONFIGURE_TAP, first);
+    assertCal(cmds[1], Qmi8658::CMD_CONFIGURE_TAP, second);
+
+    // Every command acknowledged before the next
+    TEST_ASSERT_EQUAL_UINT32(0, chip->getProtocolErrors());
+    TEST_ASSERT_EQUAL_HEX8(0x00, chip->peek(Qmi8658::STATUSINT) & 0x80);
+    TEST_ASSERT_EQUAL_HEX8(0x41, chip->peek(Qmi8658::CTRL8));
+    TEST_ASSERT_EQUAL_HEX8(0x03, chip->peek(Qmi8658::CTRL7));
+    TEST_ASSERT_TRUE(imu->isTapEnabled());
+}
+
+void test_tap_event_on_int1() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    TEST_ASSERT_TRUE(imu->enableTap());
+    uint32_t isrs = imu->getIsrCount();
+
+    // Double tap on Y, negative polarity
+    chip->raise(0x02, 0x80 | 0x20 | 0x02);
+    TEST_ASSERT_EQUAL_UINT32(isrs + 1, imu->getIsrCount());
+    imu->clearDataReadyFlag();
+
+    IMU::TapEvent event;
+    TEST_ASSERT_TRUE(imu->readTap(event));
+    TEST_ASSERT_EQUAL_UINT8(2, event.taps);
+    TEST_ASSERT_EQUAL_UINT8(1, event.axis);
+    TEST_ASSERT_TRUE(event.negative);
+    TEST_ASSERT_FALSE(imu->readTap(event));
+}
+
+void test_motion_wake_handshake() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    TEST_ASSERT_TRUE(imu->enableMotionWake(IMU::MOTION_ANY | IMU::MOTION_NO));
+
+    // Thresholds in 1/32 g, then the any/no and significant-motion windows
+    const auto& cmds = chip->commands();
+    TEST_ASSERT_EQUAL(2, cmds.size());
+    const uint8_t thresholds[8] = {3, 3, 3, 1, 1, 1, 0xF7, 0x01};
+    const uint8_t windows[8] = {2, 63, 64, 0, 128, 0, 0x00, 0x02};
+    assertCal(cmds[0], Qmi8658::CMD_CONFIGURE_MOTION, thresholds);
+    assertCal(cmds[1], Qmi8658::CMD_CONFIGURE_MOTION, windows);
+    TEST_ASSERT_EQUAL_UINT32(0, chip->getProtocolErrors());
+
+    TEST_ASSERT_EQUAL_HEX8(0x2D, chip->peek(Qmi8658::CTRL2));
+    TEST_ASSERT_EQUAL_HEX8(0x46, chip->peek(Qmi8658::CTRL8));
+    TEST_ASSERT_EQUAL_HEX8(0x21, chip->peek(Qmi8658::CTRL7));
+
+    chip->raise(0x20);
+    TEST_ASSERT_EQUAL_UINT8(IMU::MOTION_ANY, imu->readMotionEvents());
+    TEST_ASSERT_EQUAL_UINT8(0, imu->readMotionEvents());
+
+    TEST_ASSERT_TRUE(imu->disableMotionWake());
+    TEST_ASSERT_EQUAL_HEX8(0x26, chip->peek(Qmi8658::CTRL2));
+    TEST_ASSERT_EQUAL_HEX8(0x00, chip->peek(Qmi8658::CTRL8));
+    TEST_ASSERT_EQUAL_HEX8(0x03, chip->peek(Qmi8658::CTRL7));
+}
+
+void test_slow_command_completes() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    chip->setCommandDelay(20);
+    TEST_ASSERT_TRUE(imu->enableTap());
+    TEST_ASSERT_EQUAL_UINT32(0, chip->getProtocolErrors());
+}
+
+void test_stuck_command_times_out() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    chip->setCommandStuck(true);
+    TEST_ASSERT_FALSE(imu->enableTap());
+    TEST_ASSERT_FALSE(imu->isTapEnabled());
+    TEST_ASSERT_EQUAL(1, chip->commands().size());
+    TEST_ASSERT_EQUAL_HEX8(0x03, chip->peek(Qmi8658::CTRL7));  // Sensors back on
+}
+
+void test_read_raw_applies_calibration() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    chip->setAccel(100, -200, 4096);
+    chip->setGyro(10, 20, -32768);
+
+    ImuCalibration cal;
+    cal.gyro_bias[0] = 5;
+    cal.gyro_bias[2] = 1;
+    cal.accel_offset[1] = -50;
+    imu->setCalibration(cal);
+
+    IMU::RawSample sample;
+    TEST_ASSERT_TRUE(imu->readRaw(sample));
+    TEST_ASSERT_EQUAL_INT16(100, sample.ax);
+    TEST_ASSERT_EQUAL_INT16(-150, sample.ay);
+    TEST_ASSERT_EQUAL_INT16(4096, sample.az);
+    TEST_ASSERT_EQUAL_INT16(5, sample.gx);
+    TEST_ASSERT_EQUAL_INT16(20, sample.gy);
+    TEST_ASSERT_EQUAL_INT16(-32768, sample.gz);  // Clamped, not wrapped
+}
+
+void test_fifo_drain() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    TEST_ASSERT_TRUE(imu->enableFifoBatching(16));
+    TEST_ASSERT_EQUAL_HEX8(16, chip->peek(Qmi8658::FIFO_WTM_TH));
+    TEST_ASSERT_EQUAL_HEX8(0x0E, chip->peek(Qmi8658::FIFO_CTRL));
+    TEST_ASSERT_EQUAL_HEX8(0x21, chip->peek(Qmi8658::CTRL7));
+
+    // More than one Wire-sized chunk
+    for (int16_t i = 0; i < 45; i++) chip->pushFifo(i, -i, 4096);
+
+    IMU::RawSample samples[64];
+    TEST_ASSERT_EQUAL_UINT16(45, imu->readFifo(samples, 64));
+    for (int16_t i = 0; i < 45; i++) {
+        TEST_ASSERT_EQUAL_INT16(i, samples[i].ax);
+        TEST_ASSERT_EQUAL_INT16(-i, samples[i].ay);
+        TEST_ASSERT_EQUAL_INT16(4096, samples[i].az);
+    }
+    TEST_ASSERT_EQUAL(0, chip->fifoSamples());
+    TEST_ASSERT_EQUAL_HEX8(0x0E, chip->peek(Qmi8658::FIFO_CTRL));  // Out of read mode
+    TEST_ASSERT_EQUAL_UINT16(0, imu->readFifo(samples, 64));
+
+    TEST_ASSERT_TRUE(imu->disableFifoBatching());
+    TEST_ASSERT_EQUAL_HEX8(0x00, chip->peek(Qmi8658::FIFO_CTRL));
+    TEST_ASSERT_EQUAL_HEX8(0x03, chip->peek(Qmi8658::CTRL7));
+}
+
+void test_attitude_engine_matches_gyro_integration() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    TEST_ASSERT_FALSE(imu->updateAttitude());    // Not enabled
+
+    TEST_ASSERT_TRUE(imu->enableAttitudeEngine(IMU::AE_RATE_64HZ));
+    TEST_ASSERT_EQUAL_HEX8(0x06, chip->peek(Qmi8658::CTRL6));
+    TEST_ASSERT_EQUAL_HEX8(0x0B, chip->peek(Qmi8658::CTRL7));
+
+    // One second turning at 90 dps about z, falling at 1g: what the engine reports
+    // at 64Hz, against the gyro integrated in software
+    const float dt = 1.0f / 64;
+    const float half = 0.5f * 90.0f * dt * (float)M_PI / 180.0f;
+    chip->setAttitudeDelta(lroundf(cosf(half) * 16384), 0, 0, lroundf(sinf(half) * 16384), 0, 0, lroundf(9.81f * dt * 1024));
+    Quaternion software;
+    for (int i = 0; i < 64; i++) {
+        TEST_ASSERT_TRUE(imu->updateAttitude());
+        software = software * Quaternion::fromGyro(0.0f, 0.0f, 90.0f, dt);
+        software.normalize();
+    }
+
+    const IMU::AttitudeData& a = imu->getAttitude();
+    TEST_ASSERT_EQUAL_UINT32(64, a.updates);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 90.0f, Quaternion::angleBetween(Quaternion(), a.orientation));
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, Quaternion::angleBetween(software, a.orientation));
+    TEST_ASSERT_FLOAT_WITHIN(0.02f, 9.81f, a.vz);
+    TEST_ASSERT_FLOAT_WITHIN(0.001f, 0.0f, a.vx);
+
+    TEST_ASSERT_TRUE(imu->disableAttitudeEngine());
+    TEST_ASSERT_EQUAL_HEX8(0x00, chip->peek(Qmi8658::CTRL6));
+    TEST_ASSERT_EQUAL_HEX8(0x03, chip->peek(Qmi8658::CTRL7));
+    TEST_ASSERT_FALSE(imu->updateAttitude());
+}
+
+void test_gyro_ready_after_startup() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    TEST_ASSERT_TRUE(imu->setSampleRate(ImuRatePolicy::RATE_LOW));
+    TEST_ASSERT_FALSE(imu->isGyroReady());    // Powered down
+
+    // Powered up again: its output is not rotation until the startup time has passed
+    TEST_ASSERT_TRUE(imu->setSampleRate(ImuRatePolicy::RATE_HIGH));
+    TEST_ASSERT_FALSE(imu->isGyroReady());
+    sim::advanceMs(ImuRatePolicy::GYRO_STARTUP_MS - 10);
+    TEST_ASSERT_FALSE(imu->isGyroReady());
+    sim::advanceMs(10);
+    TEST_ASSERT_TRUE(imu->isGyroReady());
+}
+
+void test_low_rate_holds_for_its_ticks() {
+    // A minute of 21Hz samples owes the 112Hz filters a minute of ticks, to Q8 rounding
+    uint32_t phase = 0, ticks = 0;
+    for (uint32_t i = 0; i < 60 * (uint32_t)ImuRatePolicy::LOW_HZ; i++) {
+        phase += ImuRatePolicy::TICKS_Q8[ImuRatePolicy::RATE_LOW];
+        ticks += phase >> 8;
+        phase &= 0xFF;
+    }
+    TEST_ASSERT_UINT32_WITHIN(60 * ImuRatePolicy::HIGH_HZ / 1000, (uint32_t)(60 * ImuRatePolicy::HIGH_HZ), ticks);
+    TEST_ASSERT_EQUAL_UINT16(256, ImuRatePolicy::TICKS_Q8[ImuRatePolicy::RATE_HIGH]);
+}
+
+void test_nacks_fail_reads() {
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    Wire.injectFault(Qmi8658::ADDRESS, 100);
+    IMU::RawSample sample;
+    TEST_ASSERT_FALSE(imu->readRaw(sample));
+    Wire.clearFaults();
+    TEST_ASSERT_TRUE(imu->readRaw(sample));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_init_configures_sensor);
+    RUN_TEST(test_wrong_chip_id_fails);
+    RUN_TEST(test_missing_chip_fails);
+    RUN_TEST(test_tap_handshake);
+    RUN_TEST(test_tap_event_on_int1);
+    RUN_TEST(test_motion_wake_handshake);
+    RUN_TEST(test_slow_command_completes);
+    RUN_TEST(test_stuck_command_times_out);
+    RUN_TEST(test_read_raw_applies_calibration);
+    RUN_TEST(test_fifo_drain);
+    RUN_TEST(test_attitude_engine_matches_gyro_integration);
+    RUN_TEST(test_gyro_ready_after_startup);
+    RUN_TEST(test_low_rate_holds_for_its_ticks);
+    RUN_TEST(test_nacks_fail_reads);
+    return UNITY_END();
+}
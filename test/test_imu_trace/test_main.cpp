@@ -0,0 +1,192 @@
+#include <unity.h>
+
+#include "system/imu/imu_trace.hpp"
+#include "system/imu/wrist_gesture.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+static const char* TRACE = "/imu_trace.bin";
+static SDCard* sd = nullptr;
+
+static constexpr float RECORD_MS = 1000.0f / ImuRatePolicy::HIGH_HZ;
+static constexpr uint32_t MOVE_MS = 800;        // One raise or lower, rotation throughout
+static constexpr uint32_t CYCLE_MS = 15000;     // Raise at 2s, lower at 8s: long enough to drop to the low rate
+
+struct Pose {
+    float x, y, z;
+};
+
+static constexpr Pose ON_DESK = {0.0f, 0.0f, -1.0f};     // Neither position: nothing to fire on first rotation
+static constexpr Pose ARM_DOWN = {0.0f, -0.90f, -0.30f};
+static constexpr Pose WATCH_UP = {0.50f, 0.0f, -0.85f};
+
+/**
+ * Synthetic wearer: arm down, raise the watch, look for a while, lower it.
+ * Accel follows the arm linearly through each move with the gyro at 150 dps.
+ * The first raise starts from the desk.
+ */
+static ImuSample wrist(uint32_t t_ms) {
+    uint32_t t = t_ms % CYCLE_MS;
+    Pose rest = t_ms < CYCLE_MS ? ON_DESK : ARM_DOWN;
+    Pose from = rest, to = rest;
+    float f = 1.0f;
+    bool moving = false;
+    if (t >= 2000 && t < 8000) {
+        from = rest;
+        to = WATCH_UP;
+        f = t < 2000 + MOVE_MS ? (t - 2000) / (float)MOVE_MS : 1.0f;
+        moving = t < 2000 + MOVE_MS;
+    } else if (t >= 8000) {
+        from = WATCH_UP;
+        to = ARM_DOWN;
+        f = t < 8000 + MOVE_MS ? (t - 8000) / (float)MOVE_MS : 1.0f;
+        moving = t < 8000 + MOVE_MS;
+    }
+    ImuSample s = {};
+    s.ax = accelCounts(from.x + (to.x - from.x) * f);
+    s.ay = accelCounts(from.y + (to.y - from.y) * f);
+    s.az = accelCounts(from.z + (to.z - from.z) * f);
+    s.gx = moving ? gyroCounts(150.0f) : 0;
+    return s;
+}
+
+// Captures the synthetic wearer at the full rate; returns the records written
+static uint32_t capture(uint32_t cycles) {
+    ImuTrace trace(&logger);
+    TEST_ASSERT_TRUE(trace.start(*sd, TRACE, ImuRatePolicy::HIGH_HZ));
+    uint32_t base = millis();
+    uint32_t n = 0;
+    for (float t = 0; t < cycles * CYCLE_MS; t += RECORD_MS, n++) trace.record(wrist((uint32_t)t), base + (uint32_t)t);
+    trace.stop();
+    TEST_ASSERT_EQUAL_UINT32(n, trace.getRecordCount());
+    TEST_ASSERT_EQUAL_UINT32(0, trace.getDroppedCount());
+    return n;
+}
+
+static void writeLabels(uint32_t cycles) {
+    String text;
+    for (uint32_t c = 0; c < cycles; c++) {
+        text += String("raise ") + String(c * CYCLE_MS + 2000 + MOVE_MS) + "\n";
+        text += String("lower ") + String(c * CYCLE_MS + 8000 + MOVE_MS) + "\n";
+    }
+    TEST_ASSERT_TRUE(sd->writeFile((String(TRACE) + ".labels").c_str(), text));
+}
+
+void setUp() {
+    SD.format();
+    sd = new SDCard(&logger);
+    TEST_ASSERT_TRUE(sd->begin());
+}
+
+void tearDown() {
+    delete sd;
+}
+
+void test_needs_a_card() {
+    SDCard none(&logger);
+    ImuTrace trace(&logger);
+    TEST_ASSERT_FALSE(trace.start(none, TRACE, ImuRatePolicy::HIGH_HZ));
+    TEST_ASSERT_FALSE(trace.isRecording());
+    trace.record(wrist(0), millis());
+    TEST_ASSERT_EQUAL_UINT32(0, trace.getRecordCount());
+}
+
+void test_file_layout() {
+    ImuTrace trace(&logger);
+    TEST_ASSERT_TRUE(trace.start(*sd, TRACE, ImuRatePolicy::HIGH_HZ));
+    TEST_ASSERT_TRUE(trace.isRecording());
+    uint32_t base = millis();
+    for (uint32_t i = 0; i < 100; i++) trace.record(wrist(2000 + i * 9), base + i * 9);
+    trace.stop();
+    TEST_ASSERT_FALSE(trace.isRecording());
+
+    // Header, then every record — the partial last block is flushed on stop
+    File in = sd->open(TRACE);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(ImuTrace::Header) + 100 * sizeof(ImuTrace::Record), in.size());
+    ImuTrace::Header header;
+    in.read((uint8_t*)&header, sizeof(header));
+    TEST_ASSERT_EQUAL_HEX32(ImuTrace::MAGIC, header.magic);
+    TEST_ASSERT_EQUAL_UINT16(ImuTrace::VERSION, header.version);
+    TEST_ASSERT_EQUAL_UINT16(sizeof(ImuTrace::Record), header.record_size);
+    TEST_ASSERT_EQUAL_UINT16(ImuSample::ACCEL_FS_G, header.accel_fs_g);
+    TEST_ASSERT_EQUAL_UINT16(ImuSample::GYRO_FS_DPS, header.gyro_fs_dps);
+    TEST_ASSERT_EQUAL_FLOAT(ImuRatePolicy::HIGH_HZ, header.odr_hz);
+
+    ImuTrace::Record record;
+    for (uint32_t i = 0; i < 100; i++) {
+        in.read((uint8_t*)&record, sizeof(record));
+        TEST_ASSERT_UINT_WITHIN(1, i * 9, record.t_ms);
+        TEST_ASSERT_EQUAL_INT16(wrist(2000 + i * 9).ax, record.sample.ax);
+        TEST_ASSERT_EQUAL_INT16(wrist(2000 + i * 9).gx, record.sample.gx);
+    }
+    in.close();
+}
+
+void test_replay_rejects_other_files() {
+    ImuTrace trace(&logger);
+    ImuTrace::ReplayReport report;
+    TEST_ASSERT_FALSE(trace.replay(*sd, TRACE, report));
+
+    TEST_ASSERT_TRUE(sd->writeFile(TRACE, "not a trace, but longer than a header"));
+    TEST_ASSERT_FALSE(trace.replay(*sd, TRACE, report));
+    TEST_ASSERT_EQUAL_UINT32(0, report.records);
+}
+
+void test_replay_scores_labelled_gestures() {
+    static constexpr uint32_t CYCLES = 4;
+    uint32_t records = capture(CYCLES);
+    writeLabels(CYCLES);
+
+    ImuTrace trace(&logger);
+    ImuTrace::ReplayReport report;
+    TEST_ASSERT_TRUE(trace.replay(*sd, TRACE, report));
+    TEST_ASSERT_EQUAL_UINT32(records, report.records);
+    TEST_ASSERT_EQUAL_UINT32(2 * CYCLES, report.labels);
+    // Decimated to the live 50ms poll: the first record at least 50ms after the last
+    TEST_ASSERT_GREATER_OR_EQUAL((uint32_t)(report.duration_ms / (50 + RECORD_MS)), report.polled);
+    TEST_ASSERT_LESS_OR_EQUAL(report.duration_ms / 50 + 1, report.polled);
+
+    // Every raise and lower found once, nothing else
+    TEST_ASSERT_EQUAL_UINT32(CYCLES, report.fixed.raises);
+    TEST_ASSERT_EQUAL_UINT32(CYCLES, report.fixed.lowers);
+    TEST_ASSERT_EQUAL_UINT32(2 * CYCLES, report.fixed.matched);
+    TEST_ASSERT_EQUAL_UINT32(0, report.fixed.missed + report.fixed.false_positives);
+    TEST_ASSERT_LESS_OR_EQUAL(MOVE_MS, report.fixed.latency_max_ms);
+
+    // Still for over 5s between moves: the adaptive lane spends time at 21Hz and
+    // still catches each move once the accel wakes it and the gyro settles
+    TEST_ASSERT_GREATER_OR_EQUAL(2 * 2 * CYCLES - 1, report.rate_switches);
+    TEST_ASSERT_GREATER_THAN(0, report.low_ms);
+    TEST_ASSERT_EQUAL_UINT32(report.duration_ms, report.low_ms + report.high_ms);
+    TEST_ASSERT_LESS_THAN(ImuRatePolicy::HIGH_HZ, report.adaptive_avg_hz);
+    TEST_ASSERT_GREATER_THAN(ImuRatePolicy::LOW_HZ, report.adaptive_avg_hz);
+    TEST_ASSERT_EQUAL_UINT32(2 * CYCLES, report.adaptive.matched);
+    TEST_ASSERT_TRUE(report.latency_ok);
+
+    // The shipped model misses at most one move of the run and never fires on its own
+    TEST_ASSERT_GREATER_OR_EQUAL(2 * CYCLES - 1, report.model.matched);
+    TEST_ASSERT_EQUAL_UINT32(0, report.model.false_positives);
+}
+
+void test_replay_without_labels() {
+    capture(1);
+
+    ImuTrace trace(&logger);
+    ImuTrace::ReplayReport report;
+    TEST_ASSERT_TRUE(trace.replay(*sd, TRACE, report));
+    TEST_ASSERT_EQUAL_UINT32(0, report.labels);
+    // Detections still counted, but nothing to call a false positive
+    TEST_ASSERT_EQUAL_UINT32(1, report.fixed.raises);
+    TEST_ASSERT_EQUAL_UINT32(1, report.fixed.lowers);
+    TEST_ASSERT_EQUAL_UINT32(0, report.fixed.matched + report.fixed.missed + report.fixed.false_positives);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_needs_a_card);
+    RUN_TEST(test_file_layout);
+    RUN_TEST(test_replay_rejects_other_files);
+    RUN_TEST(test_replay_scores_labelled_gestures);
+    RUN_TEST(test_replay_without_labels);
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+#include <unity.h>
+#include <atomic>
+
+#include "system/boot/init_graph.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+// The firmware's bring-up shape with its model times (ms total / ms holding the I2C bus)
+struct Boot {
+    InitGraph graph{&logger};
+    int8_t bus, pmu, display, touch, rtc, imu, sd;
+
+    Boot() {
+        bus = graph.add("I2C", nullptr, nullptr);
+        graph.setModel(bus, 15, 15);
+        pmu = graph.add("PMU", nullptr, nullptr, {bus});
+        graph.setModel(pmu, 40, 40);
+        display = graph.add("Display", nullptr, nullptr, {pmu});
+        graph.setModel(display, 180);
+        touch = graph.add("Touch", nullptr, nullptr, {pmu});
+        graph.setModel(touch, 150, 3);
+        rtc = graph.add("RTC", nullptr, nullptr, {pmu});
+        graph.setModel(rtc, 5, 3);
+        imu = graph.add("IMU", nullptr, nullptr, {pmu});
+        graph.setModel(imu, 60, 10);
+        sd = graph.add("SD card", nullptr, nullptr, {pmu}, InitGraph::RES_NONE, false);
+        graph.setModel(sd, 250);
+    }
+};
+
+static constexpr uint32_t MODEL_SERIAL_MS = 15 + 40 + 180 + 150 + 5 + 60 + 250;
+
+static bool ok(void*) { return true; }
+static bool fail(void*) { return false; }
+
+// Counts how many holders of the same resource overlap
+struct Overlap {
+    std::atomic<int> inside{0};
+    std::atomic<int> most{0};
+
+    static bool hold(void* ctx) {
+        Overlap* o = static_cast<Overlap*>(ctx);
+        int now = ++o->inside;
+        if (now > o->most) o->most = now;
+        delay(30);
+        o->inside--;
+        return true;
+    }
+};
+
+void setUp() {}
+void tearDown() {}
+
+void test_one_worker_runs_in_declaration_order() {
+    Boot boot;
+    TEST_ASSERT_TRUE(boot.graph.run(InitGraph::SIMULATE, 1));
+
+    for (uint8_t i = 1; i < boot.graph.getCount(); i++) {
+        TEST_ASSERT_GREATER_OR_EQUAL(boot.graph.getNode(i - 1).end_us, boot.graph.getNode(i).start_us);
+        TEST_ASSERT_EQUAL_UINT8(1, boot.graph.getNode(i).core);
+    }
+    uint32_t wall_ms = boot.graph.getWallUs() / 1000;
+    TEST_ASSERT_GREATER_OR_EQUAL(MODEL_SERIAL_MS, wall_ms);
+    TEST_ASSERT_LESS_THAN(MODEL_SERIAL_MS + 100, wall_ms);
+}
+
+void test_two_workers_overlap() {
+    Boot boot;
+    TEST_ASSERT_TRUE(boot.graph.run(InitGraph::SIMULATE, 2));
+
+    bool cores[2] = {false, false};
+    for (uint8_t i = 0; i < boot.graph.getCount(); i++) {
+        const InitGraph::Node& node = boot.graph.getNode(i);
+        TEST_ASSERT_EQUAL(InitGraph::DONE, node.state);
+        cores[node.core] = true;
+        // Never before the nodes it needs
+        for (uint8_t d = 0; d < i; d++) {
+            if (node.deps & (1UL << d)) TEST_ASSERT_GREATER_OR_EQUAL(boot.graph.getNode(d).end_us, node.start_us);
+        }
+    }
+    TEST_ASSERT_TRUE(cores[0] && cores[1]);
+
+    // Longest remaining path first: SD and display start together once the PMU is up, touch waits
+    const InitGraph::Node& sd = boot.graph.getNode(boot.sd);
+    const InitGraph::Node& display = boot.graph.getNode(boot.display);
+    TEST_ASSERT_UINT_WITHIN(5000, sd.start_us, display.start_us);
+    TEST_ASSERT_GREATER_OR_EQUAL(display.end_us, boot.graph.getNode(boot.touch).start_us);
+
+    // I2C 15 + PMU 40, then SD 250 alongside display 180 + touch 150: about 385ms of 700
+    uint32_t wall_ms = boot.graph.getWallUs() / 1000;
+    TEST_ASSERT_GREATER_OR_EQUAL(385, wall_ms);
+    TEST_ASSERT_LESS_THAN(MODEL_SERIAL_MS * 65 / 100, wall_ms);
+    TEST_ASSERT_GREATER_OR_EQUAL(MODEL_SERIAL_MS * 1000, boot.graph.getSerialUs());
+
+    uint8_t path[InitGraph::MAX_NODES];
+    uint8_t length = 0;
+    boot.graph.criticalPath(path, length);
+    TEST_ASSERT_EQUAL_UINT8(3, length);
+    TEST_ASSERT_EQUAL_INT8(boot.sd, path[0]);
+    TEST_ASSERT_EQUAL_INT8(boot.pmu, path[1]);
+    TEST_ASSERT_EQUAL_INT8(boot.bus, path[2]);
+}
+
+void test_failed_node_skips_dependents() {
+    InitGraph graph(&logger);
+    int8_t bus = graph.add("I2C", ok, nullptr);
+    int8_t pmu = graph.add("PMU", fail, nullptr, {bus});
+    int8_t display = graph.add("Display", ok, nullptr, {pmu});
+    int8_t touch = graph.add("Touch", ok, nullptr, {display});
+    int8_t other = graph.add("Speaker", ok, nullptr, {bus});
+
+    TEST_ASSERT_FALSE(graph.run());
+    TEST_ASSERT_EQUAL(InitGraph::DONE, graph.getNode(bus).state);
+    TEST_ASSERT_EQUAL(InitGraph::FAILED, graph.getNode(pmu).state);
+    TEST_ASSERT_EQUAL(InitGraph::SKIPPED, graph.getNode(display).state);
+    TEST_ASSERT_EQUAL(InitGraph::SKIPPED, graph.getNode(touch).state);
+    TEST_ASSERT_EQUAL(InitGraph::DONE, graph.getNode(other).state);
+}
+
+void test_optional_failure_is_not_fatal() {
+    InitGraph graph(&logger);
+    int8_t bus = graph.add("I2C", ok, nullptr);
+    int8_t sd = graph.add("SD card", fail, nullptr, {bus}, InitGraph::RES_NONE, false);
+    int8_t trace = graph.add("IMU trace", ok, nullptr, {sd}, InitGraph::RES_NONE, false);
+
+    TEST_ASSERT_TRUE(graph.run());
+    TEST_ASSERT_EQUAL(InitGraph::FAILED, graph.getNode(sd).state);
+    TEST_ASSERT_EQUAL(InitGraph::SKIPPED, graph.getNode(trace).state);
+
+    // A second run starts from scratch
+    TEST_ASSERT_TRUE(graph.run());
+    TEST_ASSERT_EQUAL(InitGraph::DONE, graph.getNode(bus).state);
+}
+
+void test_shared_resource_is_exclusive() {
+    Overlap i2s, free;
+    InitGraph graph(&logger);
+    graph.add("Display", Overlap::hold, &free);
+    graph.add("Touch", Overlap::hold, &free);
+    graph.add("Speaker", Overlap::hold, &i2s, {}, InitGraph::RES_I2S);
+    graph.add("Mic", Overlap::hold, &i2s, {}, InitGraph::RES_I2S);
+
+    TEST_ASSERT_TRUE(graph.run());
+    TEST_ASSERT_EQUAL_INT(1, i2s.most);
+    TEST_ASSERT_EQUAL_INT(2, free.most);
+}
+
+void test_dependencies_must_come_first() {
+    InitGraph graph(&logger);
+    int8_t a = graph.add("A", ok, nullptr, {3});    // Not declared yet: ignored
+    TEST_ASSERT_EQUAL_UINT32(0, graph.getNode(a).deps);
+
+    for (uint8_t i = graph.getCount(); i < InitGraph::MAX_NODES; i++) graph.add("filler", ok, nullptr);
+    TEST_ASSERT_EQUAL_INT8(-1, graph.add("one too many", ok, nullptr));
+    TEST_ASSERT_TRUE(graph.run());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_one_worker_runs_in_declaration_order);
+    RUN_TEST(test_two_workers_overlap);
+    RUN_TEST(test_failed_node_skips_dependents);
+    RUN_TEST(test_optional_failure_is_not_fatal);
+    RUN_TEST(test_shared_resource_is_exclusive);
+    RUN_TEST(test_dependencies_must_come_first);
+    return UNITY_END();
+}
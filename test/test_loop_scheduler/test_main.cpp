@@ -0,0 +1,193 @@
+#include <unity.h>
+#include <thread>
+
+#include "system/scheduler/loop_scheduler.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+static uint32_t clock_ms = 0;
+
+struct Counter {
+    uint32_t runs = 0;
+    uint32_t last_ms = 0;
+
+    static void tick(void* ctx) {
+        Counter* c = static_cast<Counter*>(ctx);
+        c->runs++;
+        c->last_ms = clock_ms;
+    }
+};
+
+// Virtual clock: jump from deadline to deadline until nothing is armed or limit is reached
+static uint32_t runUntil(LoopScheduler& sched, uint32_t limit_ms) {
+    uint32_t wakes = 0;
+    while (true) {
+        uint32_t wait = sched.msUntilNext(clock_ms);
+        if (wait == LoopScheduler::NO_DEADLINE || clock_ms + wait > limit_ms) break;
+        clock_ms += wait;
+        sched.runDue(clock_ms);
+        wakes++;
+    }
+    return wakes;
+}
+
+void setUp() {
+    clock_ms = 0;
+}
+
+void tearDown() {}
+
+void test_periodic_wakes_only_at_deadlines() {
+    LoopScheduler sched(&logger);
+    Counter fast, slow;
+    sched.every("fast", 100, Counter::tick, &fast);
+    sched.every("slow", 250, Counter::tick, &slow);
+
+    // 100ms and 250ms jobs over one second; 500 and 1000 are shared
+    uint32_t wakes = runUntil(sched, 1000);
+    TEST_ASSERT_EQUAL_UINT32(10, fast.runs);
+    TEST_ASSERT_EQUAL_UINT32(4, slow.runs);
+    TEST_ASSERT_EQUAL_UINT32(12, wakes);
+}
+
+void test_one_shot_rearm() {
+    LoopScheduler sched(&logger);
+    Counter once;
+    int8_t job = sched.after("once", 300, Counter::tick, &once);
+    clock_ms = 200;
+    sched.runDue(clock_ms);
+    sched.rearm(job, 300);
+
+    runUntil(sched, 2000);
+    TEST_ASSERT_EQUAL_UINT32(1, once.runs);
+    TEST_ASSERT_EQUAL_UINT32(500, once.last_ms);
+    TEST_ASSERT_FALSE(sched.isArmed(job));
+    TEST_ASSERT_EQUAL_UINT32(LoopScheduler::NO_DEADLINE, sched.msUntilNext(clock_ms));
+}
+
+void test_event_runs_only_bound_job() {
+    LoopScheduler sched(&logger);
+    Counter touch, timer;
+    uint32_t source = sched.addSource("touch");
+    sched.on("touch", source, Counter::tick, &touch);
+    sched.every("timer", 1000, Counter::tick, &timer);
+
+    clock_ms = 10;
+    TEST_ASSERT_EQUAL_UINT32(990, sched.msUntilNext(clock_ms));
+    LoopScheduler::signalFromISR(sched.hookContext(source));
+    TEST_ASSERT_EQUAL_UINT32(0, sched.msUntilNext(clock_ms));
+    sched.runDue(clock_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, touch.runs);
+    TEST_ASSERT_EQUAL_UINT32(0, timer.runs);
+    TEST_ASSERT_EQUAL_UINT32(990, sched.msUntilNext(clock_ms));
+}
+
+void test_late_wake_restarts_period() {
+    // 5s of light sleep: one run, then the period restarts from now
+    LoopScheduler sched(&logger);
+    Counter job;
+    int8_t index = sched.every("poll", 100, Counter::tick, &job);
+    clock_ms = 5000;
+    sched.runDue(clock_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, job.runs);
+    TEST_ASSERT_EQUAL_UINT32(100, sched.msUntilNext(clock_ms));
+    TEST_ASSERT_EQUAL_UINT32(4900, sched.getStats(index).max_late_ms);
+}
+
+void test_free_timers() {
+    LoopScheduler sched(&logger);
+    Counter bound, callback;
+    uint32_t source = sched.addSource("timeout");
+    sched.on("timeout", source, Counter::tick, &bound);
+    LoopScheduler::Timer by_event, by_fn;
+    by_event.events = source;
+    by_fn.fn = Counter::tick;
+    by_fn.ctx = &callback;
+    sched.arm(by_event, 200);
+    sched.arm(by_fn, 5000);
+
+    uint32_t wakes = runUntil(sched, 0xFFFFFFF0);
+    TEST_ASSERT_EQUAL_UINT32(1, bound.runs);
+    TEST_ASSERT_EQUAL_UINT32(200, bound.last_ms);
+    TEST_ASSERT_EQUAL_UINT32(1, callback.runs);
+    TEST_ASSERT_EQUAL_UINT32(5000, callback.last_ms);
+    TEST_ASSERT_EQUAL_UINT32(2, wakes);
+}
+
+void test_cancel_stops_timer_and_events() {
+    LoopScheduler sched(&logger);
+    Counter job;
+    uint32_t source = sched.addSource("button");
+    int8_t index = sched.every("job", 100, Counter::tick, &job, source);
+    sched.cancel(index);
+    sched.post(source);
+    sched.runDue(clock_ms);
+    runUntil(sched, 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, job.runs);
+    TEST_ASSERT_FALSE(sched.isArmed(index));
+}
+
+static void postLater(LoopScheduler* sched, uint32_t source) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    sched->post(source);
+}
+
+void test_post_wakes_blocked_loop() {
+    // Real task: runOnce() blocks on its notification with nothing armed until another task posts
+    LoopScheduler sched(&logger);
+    sched.begin();
+    Counter job;
+    uint32_t source = sched.addSource("wifi");
+    sched.on("wifi", source, Counter::tick, &job);
+
+    std::thread poster(postLater, &sched, source);
+    uint32_t start = millis();
+    sched.runOnce();
+    poster.join();
+    TEST_ASSERT_GREATER_OR_EQUAL(15, millis() - start);
+    TEST_ASSERT_EQUAL_UINT32(0, job.runs);
+    TEST_ASSERT_EQUAL_UINT32(0, sched.msUntilNext(millis()));
+    sched.runDue(millis());
+    TEST_ASSERT_EQUAL_UINT32(1, job.runs);
+}
+
+struct IdleProbe {
+    uint32_t calls = 0;
+    uint32_t wait_ms = 0;
+};
+
+static bool idle(uint32_t wait_ms, void* ctx) {
+    IdleProbe* probe = static_cast<IdleProbe*>(ctx);
+    probe->calls++;
+    probe->wait_ms = wait_ms;
+    sim::advanceMs(wait_ms);    // As light sleep: the clock jumps, nothing blocks
+    return true;
+}
+
+void test_idle_hook_gets_the_deadline() {
+    LoopScheduler sched(&logger);
+    sched.begin();
+    IdleProbe probe;
+    sched.setIdle(idle, &probe);
+    Counter job;
+    sched.every("job", 2000, Counter::tick, &job);
+
+    sched.runOnce();
+    TEST_ASSERT_EQUAL_UINT32(1, probe.calls);
+    TEST_ASSERT_UINT_WITHIN(2, 2000, probe.wait_ms);
+    sched.runOnce();
+    TEST_ASSERT_EQUAL_UINT32(1, job.runs);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_periodic_wakes_only_at_deadlines);
+    RUN_TEST(test_one_shot_rearm);
+    RUN_TEST(test_event_runs_only_bound_job);
+    RUN_TEST(test_late_wake_restarts_period);
+    RUN_TEST(test_free_timers);
+    RUN_TEST(test_cancel_stops_timer_and_events);
+    RUN_TEST(test_post_wakes_blocked_loop);
+    RUN_TEST(test_idle_hook_gets_the_deadline);
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+#include <unity.h>
+
+#include "system/speaker/mic.hpp"
+#include "sim/es7210.hpp"
+
+using sim::Es7210;
+
+Logger logger;    // Defined by main.cpp in the firmware
+static I2CBus* bus = nullptr;
+static Mic* mic = nullptr;
+
+static constexpr uint32_t MCLK_HZ = 16000 * 256;    // Shared with the speaker's I2S port
+static constexpr uint32_t INIT_WRITES = 34;         // INIT_SEQUENCE without its waits
+
+void setUp() {
+    Wire.detachAll();
+    Wire.clearFaults();
+    bus = new I2CBus(&logger, Wire);
+    bus->begin(I2C_SDA, I2C_SCL, I2C_FAST_HZ);
+    mic = new Mic(&logger);
+}
+
+void tearDown() {
+    delete mic;
+    delete bus;
+    Wire.detachAll();
+}
+
+void test_bring_up() {
+    Es7210 chip;
+    Wire.attach(chip);
+    TEST_ASSERT_TRUE(mic->begin(*bus));
+    TEST_ASSERT_TRUE(mic->isInitialized());
+    TEST_ASSERT_EQUAL_UINT32(1, chip.getResets());
+    TEST_ASSERT_TRUE(chip.isRunning());
+
+    // 16kHz from the dividers, as the speaker side runs
+    TEST_ASSERT_EQUAL_UINT32(16000, chip.adcRateHz(MCLK_HZ));
+    TEST_ASSERT_EQUAL_UINT32(16000, chip.lrckHz(MCLK_HZ));
+    TEST_ASSERT_EQUAL_HEX8(0x60, chip.peek(Es7210::SDP_INTERFACE1));    // I2S, 16-bit
+
+    // MIC1/2 at 30dB, MIC3/4 (speaker reference) powered down
+    TEST_ASSERT_EQUAL_HEX8(0x1A, chip.peek(Es7210::MIC1_GAIN));
+    TEST_ASSERT_EQUAL_HEX8(0x1A, chip.peek(Es7210::MIC2_GAIN));
+    TEST_ASSERT_EQUAL_HEX8(0x0F, chip.peek(Es7210::MIC12_POWER));
+    TEST_ASSERT_EQUAL_HEX8(0xFF, chip.peek(Es7210::MIC34_POWER));
+    TEST_ASSERT_EQUAL_HEX8(0x00, chip.peek(Es7210::MIC34_BIAS));
+}
+
+void test_single_register_writes() {
+    // No auto-increment on this part: a burst would land every byte on one register
+    Es7210 chip;
+    Wire.attach(chip);
+    uint32_t before = Wire.getTransactions();
+    TEST_ASSERT_TRUE(mic->begin(*bus));
+    TEST_ASSERT_EQUAL_UINT32(1 + INIT_WRITES, Wire.getTransactions() - before);    // Probe, then one write each
+    for (uint8_t reg = Es7210::ADC1_MAX_GAIN; reg <= Es7210::ADC4_MAX_GAIN; reg++) TEST_ASSERT_EQUAL_HEX8(0xBF, chip.peek(reg));
+}
+
+void test_finds_strapped_address() {
+    Es7210 chip(0x42);
+    Wire.attach(chip);
+    TEST_ASSERT_TRUE(mic->begin(*bus));
+    TEST_ASSERT_TRUE(chip.isRunning());
+}
+
+void test_missing_chip_fails() {
+    TEST_ASSERT_FALSE(mic->begin(*bus));
+    TEST_ASSERT_FALSE(mic->isInitialized());
+}
+
+void test_failed_write_stops_bring_up() {
+    Es7210 chip;
+    chip.failOn(Es7210::MIC12_POWER);
+    Wire.attach(chip);
+    TEST_ASSERT_FALSE(mic->begin(*bus));
+    TEST_ASSERT_FALSE(mic->isInitialized());
+    // Nothing after the failing step: the chip is never enabled
+    TEST_ASSERT_FALSE(chip.isRunning());
+    TEST_ASSERT_FALSE(chip.peek(Es7210::ADC1_MAX_GAIN) == 0xBF);
+}
+
+void test_read_needs_init() {
+    int16_t samples[16];
+    TEST_ASSERT_EQUAL_UINT32(0, mic->read(samples, 16));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_bring_up);
+    RUN_TEST(test_single_register_writes);
+    RUN_TEST(test_finds_strapped_address);
+    RUN_TEST(test_missing_chip_fails);
+    RUN_TEST(test_failed_write_stops_bring_up);
+    RUN_TEST(test_read_needs_init);
+    return UNITY_END();
+}
@@ -0,0 +1,133 @@
+#include <unity.h>
+
+#include "system/rtc/rtc.hpp"
+#include "sim/pcf85063.hpp"
+
+using sim::Pcf85063;
+
+Logger logger;    // Defined by main.cpp in the firmware
+static I2CBus* bus = nullptr;
+static Pcf85063* chip = nullptr;
+static RTC* rtc = nullptr;
+
+void setUp() {
+    Wire.detachAll();
+    Wire.clearFaults();
+    chip = new Pcf85063(RTC_INT);
+    Wire.attach(*chip);
+    bus = new I2CBus(&logger, Wire);
+    bus->begin(I2C_SDA, I2C_SCL, I2C_FAST_HZ);
+    rtc = new RTC(&logger);
+}
+
+void tearDown() {
+    detachInterrupt(RTC_INT);
+    delete rtc;
+    delete bus;
+    delete chip;
+    Wire.detachAll();
+}
+
+static RTC::DateTime dateTime(uint16_t year, uint8_t month, uint8_t day, uint8_t hour, uint8_t minute, uint8_t second) {
+    RTC::DateTime dt = {};
+    dt.year = year;
+    dt.month = month;
+    dt.day = day;
+    dt.hour = hour;
+    dt.minute = minute;
+    dt.second = second;
+    return dt;
+}
+
+void test_oscillator_stop_invalidates_time() {
+    TEST_ASSERT_TRUE(rtc->setBus(*bus));
+    TEST_ASSERT_TRUE(chip->oscillatorStopped());
+
+    RTC::DateTime dt;
+    TEST_ASSERT_FALSE(rtc->getDateTime(dt));
+    TEST_ASSERT_FALSE(rtc->setTime(12, 0, 0));  // Needs a valid date to keep
+}
+
+void test_missing_chip_fails() {
+    Wire.detachAll();
+    TEST_ASSERT_FALSE(rtc->setBus(*bus));
+    RTC::DateTime dt = dateTime(2025, 1, 1, 0, 0, 0);
+    TEST_ASSERT_FALSE(rtc->setDateTime(dt));
+}
+
+void test_set_and_get() {
+    TEST_ASSERT_TRUE(rtc->setBus(*bus));
+    TEST_ASSERT_TRUE(rtc->setDateTime(dateTime(2025, 6, 14, 9, 41, 7)));
+    TEST_ASSERT_FALSE(chip->oscillatorStopped());
+    TEST_ASSERT_EQUAL_HEX8(0x41, chip->peek(Pcf85063::MINUTES));  // BCD on the chip
+
+    RTC::DateTime dt;
+    TEST_ASSERT_TRUE(rtc->getDateTime(dt));
+    TEST_ASSERT_EQUAL_UINT16(2025, dt.year);
+    TEST_ASSERT_EQUAL_UINT8(6, dt.month);
+    TEST_ASSERT_EQUAL_UINT8(14, dt.day);
+    TEST_ASSERT_EQUAL_UINT8(9, dt.hour);
+    TEST_ASSERT_EQUAL_UINT8(41, dt.minute);
+    TEST_ASSERT_EQUAL_UINT8(7, dt.second);
+
+    TEST_ASSERT_TRUE(rtc->setTime(23, 5, 0));
+    TEST_ASSERT_TRUE(rtc->getDateTime(dt));
+    TEST_ASSERT_EQUAL_UINT8(14, dt.day);
+    TEST_ASSERT_EQUAL_UINT8(23, dt.hour);
+    TEST_ASSERT_EQUAL_UINT8(5, dt.minute);
+}
+
+void test_rollover() {
+    TEST_ASSERT_TRUE(rtc->setBus(*bus));
+    TEST_ASSERT_TRUE(rtc->setDateTime(dateTime(2024, 12, 31, 23, 59, 58)));
+    chip->advance(3);
+
+    RTC::DateTime dt;
+    TEST_ASSERT_TRUE(rtc->getDateTime(dt));
+    TEST_ASSERT_EQUAL_UINT16(2025, dt.year);
+    TEST_ASSERT_EQUAL_UINT8(1, dt.month);
+    TEST_ASSERT_EQUAL_UINT8(1, dt.day);
+    TEST_ASSERT_EQUAL_UINT8(0, dt.hour);
+    TEST_ASSERT_EQUAL_UINT8(0, dt.minute);
+    TEST_ASSERT_EQUAL_UINT8(1, dt.second);
+    TEST_ASSERT_EQUAL_UINT8(3, dt.weekday);  // Wednesday
+}
+
+static volatile uint32_t hook_calls = 0;
+static void countHook(void*) { hook_calls++; }
+
+void test_alarm_interrupt() {
+    TEST_ASSERT_TRUE(rtc->setBus(*bus));
+    rtc->setIrqHook(countHook, nullptr);
+    hook_calls = 0;
+
+    TEST_ASSERT_TRUE(rtc->setDateTime(dateTime(2025, 3, 1, 6, 59, 50)));
+    TEST_ASSERT_TRUE(rtc->setAlarm(7, 0));
+    TEST_ASSERT_EQUAL_HEX8(0x80, chip->peek(Pcf85063::CONTROL_2) & 0x80);  // AIE
+
+    chip->advance(5);
+    TEST_ASSERT_EQUAL_UINT32(0, hook_calls);
+    TEST_ASSERT_FALSE(rtc->isAlarmTriggered());
+
+    // Minute and hour match at 07:00:00 — INT falls, the ISR runs
+    chip->advance(10);
+    TEST_ASSERT_EQUAL_UINT32(1, hook_calls);
+    TEST_ASSERT_EQUAL(0, digitalRead(RTC_INT));
+    TEST_ASSERT_TRUE(rtc->isAlarmTriggered());
+
+    // Clearing AF releases INT and disables the alarm
+    TEST_ASSERT_TRUE(rtc->clearAlarm());
+    TEST_ASSERT_EQUAL(1, digitalRead(RTC_INT));
+    TEST_ASSERT_EQUAL_HEX8(0x00, chip->peek(Pcf85063::CONTROL_2) & 0xC0);
+    TEST_ASSERT_FALSE(rtc->isAlarmTriggered());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_oscillator_stop_invalidates_time);
+    RUN_TEST(test_missing_chip_fails);
+    RUN_TEST(test_set_and_get);
+    RUN_TEST(test_rollover);
+    RUN_TEST(test_alarm_interrupt);
+    return UNITY_END();
+}
@@ -0,0 +1,99 @@
+#include <unity.h>
+
+#include "system/activity/sleep_tracker.hpp"
+#include "sim/qmi8658.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+static sim::Qmi8658* chip = nullptr;
+static I2CBus* bus = nullptr;
+static IMU* imu = nullptr;
+static FSManager* fs = nullptr;
+
+static const RTC::DateTime NIGHT = {0, 30, 23, 14, 6, 3, 2026};
+static constexpr size_t EPOCH = sizeof(Actigraphy::Epoch);
+
+// Minutes with the watch in use: one gap epoch each, scored LOOKAHEAD epochs later
+static void awakeFor(SleepTracker& tracker, uint32_t minutes) {
+    tracker.disarm();
+    sim::advanceMs(minutes * Actigraphy::EPOCH_S * 1000);
+    TEST_ASSERT_TRUE(tracker.arm());
+}
+
+static size_t logSize() {
+    File file = LittleFS.open(SLEEP_LOG_FILE);
+    return file.size();
+}
+
+void setUp() {
+    LittleFS.format();
+    LittleFS.setCapacity(UINT64_MAX);
+    Wire.detachAll();
+    chip = new sim::Qmi8658(IMU_INT1);
+    Wire.attach(*chip);
+    bus = new I2CBus(&logger, Wire);
+    bus->begin(I2C_SDA, I2C_SCL, I2C_FAST_HZ);
+    imu = new IMU(&logger);
+    TEST_ASSERT_TRUE(imu->setBus(*bus));
+    fs = new FSManager(&logger);
+}
+
+void tearDown() {
+    delete fs;
+    detachInterrupt(IMU_INT1);
+    delete imu;
+    delete bus;
+    delete chip;
+    Wire.detachAll();
+}
+
+void test_epochs_reach_the_log() {
+    SleepTracker tracker(&logger, *imu, *fs);
+    TEST_ASSERT_TRUE(tracker.start(NIGHT));
+    TEST_ASSERT_TRUE(tracker.arm());
+    awakeFor(tracker, 40);
+    tracker.stop();
+
+    // More than the pending buffer holds: flushed once on the way, the rest on stop
+    uint32_t scored = 40 - Actigraphy::LOOKAHEAD;
+    TEST_ASSERT_EQUAL_UINT32(sizeof(SleepTracker::FileHeader) + scored * EPOCH, logSize());
+    TEST_ASSERT_EQUAL_UINT32(logSize(), tracker.getBytesWritten());
+    TEST_ASSERT_EQUAL_UINT32(3, tracker.getFlashWrites());
+    TEST_ASSERT_EQUAL_UINT32(0, tracker.getLostEpochs());
+}
+
+void test_full_flash_drops_epochs() {
+    SleepTracker tracker(&logger, *imu, *fs);
+    TEST_ASSERT_TRUE(tracker.start(NIGHT));
+    TEST_ASSERT_TRUE(tracker.arm());
+
+    // Room for two and a half epochs: the first flush comes up short mid-epoch
+    LittleFS.setCapacity(LittleFS.usedBytes() + 2 * EPOCH + EPOCH / 2);
+    awakeFor(tracker, 60);
+    uint32_t scored = 60 - Actigraphy::LOOKAHEAD;
+    uint32_t kept = SleepTracker::PENDING_CAPACITY + 2;
+    TEST_ASSERT_EQUAL_UINT32(scored - kept, tracker.getLostEpochs());
+
+    // Space again: the retry resumes at the byte it stopped at
+    LittleFS.setCapacity(UINT64_MAX);
+    tracker.stop();
+    TEST_ASSERT_EQUAL_UINT32(sizeof(SleepTracker::FileHeader) + kept * EPOCH, logSize());
+    TEST_ASSERT_EQUAL_UINT32(logSize(), tracker.getBytesWritten());
+
+    File file = LittleFS.open(SLEEP_LOG_FILE);
+    SleepTracker::FileHeader header;
+    file.read((uint8_t*)&header, sizeof(header));
+    TEST_ASSERT_EQUAL_HEX32(SleepTracker::MAGIC, header.magic);
+    Actigraphy::Epoch epoch;
+    for (uint32_t i = 0; i < kept; i++) {
+        TEST_ASSERT_EQUAL_UINT32(EPOCH, file.read((uint8_t*)&epoch, EPOCH));
+        TEST_ASSERT_EQUAL_UINT16(Actigraphy::GAP_COUNTS, epoch.counts);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_epochs_reach_the_log);
+    RUN_TEST(test_full_flash_drops_epochs);
+    return UNITY_END();
+}
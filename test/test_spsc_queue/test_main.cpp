@@ -0,0 +1,113 @@
+#include <unity.h>
+#include <Arduino.h>
+
+#include "system/sensor/spsc_queue.hpp"
+#include "system/imu/imu_sample.hpp"
+
+// SensorMessage's shape without the drivers behind it. The sequence number goes in
+// three places, so a torn or reordered read shows up as a mismatch rather than a gap.
+struct Message {
+    uint8_t type;
+    uint8_t rate;
+    uint32_t time_us;
+    ImuSample sample;
+};
+
+static constexpr uint32_t DEPTH = 64;    // SensorTask::QUEUE_DEPTH
+typedef SpscQueue<Message, DEPTH> Queue;
+
+static Message make(uint32_t seq) {
+    Message m = {};
+    m.time_us = seq;
+    m.sample.ax = (int16_t)seq;
+    m.sample.gz = (int16_t)(seq >> 16);
+    return m;
+}
+
+static bool intact(const Message& m, uint32_t seq) {
+    return m.time_us == seq && m.sample.ax == (int16_t)seq && m.sample.gz == (int16_t)(seq >> 16);
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_fifo_until_full() {
+    Queue queue{};
+    Message m;
+    TEST_ASSERT_TRUE(queue.empty());
+    TEST_ASSERT_FALSE(queue.pop(m));
+
+    for (uint32_t i = 0; i < DEPTH; i++) TEST_ASSERT_TRUE(queue.push(make(i)));
+    // Full: refuses rather than overwrites
+    TEST_ASSERT_FALSE(queue.push(make(DEPTH)));
+    TEST_ASSERT_EQUAL_UINT32(DEPTH, queue.size());
+    TEST_ASSERT_EQUAL_UINT32(1, queue.getDrops());
+    TEST_ASSERT_EQUAL_UINT32(DEPTH, queue.getHighWater());
+
+    for (uint32_t i = 0; i < DEPTH; i++) {
+        TEST_ASSERT_TRUE(queue.pop(m));
+        TEST_ASSERT_TRUE(intact(m, i));
+    }
+    TEST_ASSERT_FALSE(queue.pop(m));
+    TEST_ASSERT_TRUE(queue.empty());
+
+    queue.resetStats();
+    TEST_ASSERT_EQUAL_UINT32(0, queue.getDrops());
+    TEST_ASSERT_EQUAL_UINT32(0, queue.getHighWater());
+}
+
+void test_every_slot_reused() {
+    // Many laps of the ring, never more than three deep
+    Queue queue{};
+    Message m;
+    uint32_t next = 0;
+    for (uint32_t i = 0; i < 10 * DEPTH; i++) {
+        TEST_ASSERT_TRUE(queue.push(make(i)));
+        if (i % 4 == 3) {
+            while (queue.pop(m)) TEST_ASSERT_TRUE(intact(m, next++));
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(10 * DEPTH, next);
+    TEST_ASSERT_EQUAL_UINT32(4, queue.getHighWater());
+}
+
+static void produce(Queue* queue, uint32_t messages, uint32_t* full) {
+    for (uint32_t i = 0; i < messages;) {
+        if (queue->push(make(i))) i++;
+        else if ((++*full & 1023) == 0) std::this_thread::yield();
+    }
+}
+
+void test_two_threads() {
+    // Producer and consumer on their own threads, as the sensor core and the loop
+    static constexpr uint32_t MESSAGES = 1000000;
+    Queue* queue = new Queue();
+    uint32_t full = 0;
+    std::thread producer(produce, queue, MESSAGES, &full);
+
+    uint32_t received = 0, errors = 0;
+    uint32_t last_progress = millis();
+    Message m;
+    while (received < MESSAGES && millis() - last_progress < 5000) {
+        if (!queue->pop(m)) continue;
+        if (!intact(m, received)) errors++;
+        received++;
+        last_progress = millis();
+    }
+    producer.join();
+
+    TEST_ASSERT_EQUAL_UINT32(MESSAGES, received);
+    TEST_ASSERT_EQUAL_UINT32(0, errors);
+    TEST_ASSERT_EQUAL_UINT32(full, queue->getDrops());    // Every refused push was retried
+    TEST_ASSERT_LESS_OR_EQUAL(DEPTH, queue->getHighWater());
+    TEST_ASSERT_TRUE(queue->empty());
+    delete queue;
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_fifo_until_full);
+    RUN_TEST(test_every_slot_reused);
+    RUN_TEST(test_two_threads);
+    return UNITY_END();
+}
@@ -0,0 +1,209 @@
+#include <unity.h>
+
+#include "system/scheduler/timer_wheel.hpp"
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+static uint32_t clock_ms = 0;
+static TimerWheel* wheel = nullptr;
+
+struct Probe {
+    TimerWheel::Timer timer;
+    uint32_t due = 0;             // Expected expiry
+    uint8_t fires = 0;
+    bool cancelled = false;
+    bool rearmed = false;
+    uint32_t early = 0;
+    uint32_t late = 0;
+
+    static void fire(void* ctx) {
+        Probe* p = static_cast<Probe*>(ctx);
+        p->fires++;
+        if (clock_ms < p->due) p->early++;
+        if (clock_ms > p->due) p->late++;
+        // Every eighth timer re-arms itself once from its own callback
+        if (!p->rearmed && (p->due & 7) == 0) {
+            p->rearmed = true;
+            p->fires--;
+            p->due = clock_ms + 1 + (p->due % 5000);
+            wheel->armAt(p->timer, p->due);
+        }
+    }
+};
+
+// Spread over all four levels: 1ms .. ~5h, roughly log-uniform
+static uint32_t randomDelay(uint32_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    uint8_t bits = 1 + seed % 24;
+    return 1 + (seed >> 8) % (1UL << bits);
+}
+
+// Drive the clock from deadline to deadline, as the idle path would
+static uint32_t runToEnd() {
+    uint32_t wakes = 0;
+    while (true) {
+        uint32_t wait = wheel->msUntilNext(clock_ms);
+        if (wait == TimerWheel::NO_DEADLINE) break;
+        clock_ms += wait;
+        wheel->advance(clock_ms);
+        wakes++;
+    }
+    return wakes;
+}
+
+void setUp() {
+    clock_ms = 0;
+    wheel = new TimerWheel();
+    wheel->begin(clock_ms);
+}
+
+void tearDown() {
+    delete wheel;
+}
+
+void test_random_timers_fire_once_on_time() {
+    static constexpr uint32_t TIMERS = 4096;
+    Probe* probes = new Probe[TIMERS];
+    uint32_t seed = 0x2545F491;
+    for (uint32_t i = 0; i < TIMERS; i++) {
+        Probe& p = probes[i];
+        p.timer.fn = Probe::fire;
+        p.timer.ctx = &p;
+        p.due = randomDelay(seed);
+        wheel->armAt(p.timer, p.due);
+    }
+    TEST_ASSERT_EQUAL_UINT32(TIMERS, wheel->getStats().armed);
+
+    // Cancel a quarter up front
+    for (uint32_t i = 0; i < TIMERS; i += 4) {
+        wheel->cancel(probes[i].timer);
+        probes[i].cancelled = true;
+    }
+
+    uint32_t wakes = runToEnd();
+
+    uint32_t fired = 0;
+    for (uint32_t i = 0; i < TIMERS; i++) {
+        const Probe& p = probes[i];
+        TEST_ASSERT_EQUAL_UINT8(p.cancelled ? 0 : 1, p.fires);
+        TEST_ASSERT_EQUAL_UINT32(0, p.early);
+        TEST_ASSERT_EQUAL_UINT32(0, p.late);
+        fired += p.fires;
+    }
+    TimerWheel::Stats stats = wheel->getStats();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.armed);
+    TEST_ASSERT_EQUAL_UINT32(TIMERS * 3 / 4, fired);
+    // Empty ticks are skipped: a few visits per timer over hours of virtual time, not one per ms
+    TEST_ASSERT_LESS_THAN(2 * TIMERS, stats.ticks);
+    TEST_ASSERT_LESS_OR_EQUAL(stats.ticks, wakes);
+    delete[] probes;
+}
+
+void test_deadline_is_exact_above_level_zero() {
+    Probe p;
+    p.timer.fn = Probe::fire;
+    p.timer.ctx = &p;
+    p.due = 5001;
+    wheel->armAt(p.timer, p.due);
+    TEST_ASSERT_EQUAL_UINT32(5001, wheel->msUntilNext(0));
+    TEST_ASSERT_EQUAL_UINT32(1, wheel->msUntilNext(5000));
+
+    TEST_ASSERT_EQUAL_UINT32(0, wheel->advance(5000));
+    TEST_ASSERT_EQUAL_UINT32(1, wheel->advance(5001));
+    TEST_ASSERT_EQUAL_UINT8(1, p.fires);
+    TEST_ASSERT_EQUAL_UINT32(TimerWheel::NO_DEADLINE, wheel->msUntilNext(5001));
+}
+
+void test_beyond_span_is_refiled() {
+    Probe p;
+    p.timer.fn = Probe::fire;
+    p.timer.ctx = &p;
+    p.due = TimerWheel::SPAN_MS + 12345;
+    wheel->armAt(p.timer, p.due);
+    runToEnd();
+    TEST_ASSERT_EQUAL_UINT8(1, p.fires);
+    TEST_ASSERT_EQUAL_UINT32(0, p.late);
+    TEST_ASSERT_EQUAL_UINT32(p.due, clock_ms);
+}
+
+void test_late_advance_fires_in_order() {
+    static uint32_t order[3];
+    static uint8_t count = 0;
+    count = 0;
+    struct Tag {
+        TimerWheel::Timer timer;
+        uint32_t id;
+        static void fire(void* ctx) { order[count++] = static_cast<Tag*>(ctx)->id; }
+    } tags[3];
+    const uint32_t expiry[3] = {900, 30, 70000};
+    for (uint32_t i = 0; i < 3; i++) {
+        tags[i].id = i;
+        tags[i].timer.fn = Tag::fire;
+        tags[i].timer.ctx = &tags[i];
+        wheel->armAt(tags[i].timer, expiry[i]);
+    }
+
+    // One call long after all of them, as after a light sleep
+    TEST_ASSERT_EQUAL_UINT32(3, wheel->advance(100000));
+    TEST_ASSERT_EQUAL_UINT32(1, order[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, order[1]);
+    TEST_ASSERT_EQUAL_UINT32(2, order[2]);
+}
+
+static uint32_t sunk_events = 0;
+static uint32_t sink_calls = 0;
+static void sink(uint32_t events, void*) {
+    sunk_events |= events;
+    sink_calls++;
+}
+
+void test_periodic_timer_posts_events() {
+    sunk_events = sink_calls = 0;
+    wheel->setEventSink(sink, nullptr);
+    TimerWheel::Timer tick;
+    tick.events = 0x04;
+    tick.period_ms = 100;
+    wheel->armAt(tick, 100);
+
+    for (clock_ms = 1; clock_ms <= 1000; clock_ms++) wheel->advance(clock_ms);
+    TEST_ASSERT_EQUAL_UINT32(10, sink_calls);
+    TEST_ASSERT_EQUAL_UINT32(0x04, sunk_events);
+    TEST_ASSERT_TRUE(tick.isArmed());
+    TEST_ASSERT_EQUAL_UINT32(1100, tick.getExpiry());
+
+    // Late by more than a period: fires once, then restarts from now
+    clock_ms = 1450;
+    wheel->advance(clock_ms);
+    TEST_ASSERT_EQUAL_UINT32(11, sink_calls);
+    TEST_ASSERT_EQUAL_UINT32(1550, tick.getExpiry());
+
+    wheel->cancel(tick);
+    TEST_ASSERT_FALSE(tick.isArmed());
+    TEST_ASSERT_EQUAL_UINT32(TimerWheel::NO_DEADLINE, wheel->msUntilNext(clock_ms));
+}
+
+void test_rearm_moves_timer() {
+    Probe p;
+    p.timer.fn = Probe::fire;
+    p.timer.ctx = &p;
+    p.due = 3;    // Odd: fire() leaves it alone
+    wheel->armAt(p.timer, 40000);
+    wheel->armAt(p.timer, p.due);
+    TEST_ASSERT_EQUAL_UINT32(1, wheel->getStats().armed);
+    runToEnd();
+    TEST_ASSERT_EQUAL_UINT8(1, p.fires);
+    TEST_ASSERT_EQUAL_UINT32(3, clock_ms);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_random_timers_fire_once_on_time);
+    RUN_TEST(test_deadline_is_exact_above_level_zero);
+    RUN_TEST(test_beyond_span_is_refiled);
+    RUN_TEST(test_late_advance_fires_in_order);
+    RUN_TEST(test_periodic_timer_posts_events);
+    RUN_TEST(test_rearm_moves_timer);
+    return UNITY_END();
+}
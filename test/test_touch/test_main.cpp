@@ -0,0 +1,133 @@
+#include <unity.h>
+
+#include "system/touch/touch_controller.hpp"
+#include "sim/ft3168.hpp"
+
+using sim::Ft3168;
+
+Logger logger;    // Defined by main.cpp in the firmware
+static I2CBus* bus = nullptr;
+static Ft3168* chip = nullptr;
+static TouchController* touch = nullptr;
+
+void setUp() {
+    Wire.detachAll();
+    Wire.clearFaults();
+    chip = new Ft3168(TOUCH_INT, TOUCH_RST);
+    Wire.attach(*chip);
+    bus = new I2CBus(&logger, Wire);
+    bus->begin(I2C_SDA, I2C_SCL, I2C_FAST_HZ);
+    touch = new TouchController(&logger);
+}
+
+void tearDown() {
+    detachInterrupt(TOUCH_INT);
+    delete touch;
+    delete bus;
+    delete chip;
+    Wire.detachAll();
+}
+
+void test_init_resets_and_configures() {
+    TEST_ASSERT_TRUE(touch->setBus(*bus));
+    TEST_ASSERT_EQUAL_UINT32(1, chip->getResets());
+    TEST_ASSERT_EQUAL_HEX8(0x01, chip->peek(Ft3168::POWER_MODE));
+    TEST_ASSERT_TRUE(sim::Pins::get().isAttached(TOUCH_INT));
+    TEST_ASSERT_EQUAL_UINT32(TouchController::NO_DEADLINE, touch->msUntilLongPress());
+}
+
+void test_wrong_chip_id_fails() {
+    chip->setChipId(0x64);
+    TEST_ASSERT_FALSE(touch->setBus(*bus));
+    TEST_ASSERT_FALSE(sim::Pins::get().isAttached(TOUCH_INT));
+}
+
+void test_coordinates() {
+    TEST_ASSERT_TRUE(touch->setBus(*bus));
+    chip->touch(300, 450);
+    uint16_t x = 0, y = 0;
+    TEST_ASSERT_TRUE(touch->readTouch(x, y));
+    // The event flag in the top bits of XH is not part of the coordinate
+    TEST_ASSERT_EQUAL_HEX8(Ft3168::EVENT_DOWN, chip->peek(Ft3168::P1_XH) & 0xC0);
+    TEST_ASSERT_EQUAL_UINT16(300, x);
+    TEST_ASSERT_EQUAL_UINT16(450, y);
+
+    chip->touch(301, 452);
+    TEST_ASSERT_EQUAL_HEX8(Ft3168::EVENT_CONTACT, chip->peek(Ft3168::P1_XH) & 0xC0);
+    TEST_ASSERT_TRUE(touch->readTouch(x, y));
+    TEST_ASSERT_EQUAL_UINT16(301, x);
+    TEST_ASSERT_EQUAL_UINT16(452, y);
+}
+
+void test_long_press() {
+    TEST_ASSERT_TRUE(touch->setBus(*bus));
+    chip->touch(200, 250);
+    touch->handleInterrupt();
+    TEST_ASSERT_UINT32_WITHIN(5, TouchController::LONG_PRESS_MS, touch->msUntilLongPress());
+
+    // Held still: fires once the deadline passes, without another report
+    sim::advanceMs(TouchController::LONG_PRESS_MS);
+    TEST_ASSERT_EQUAL_UINT32(0, touch->msUntilLongPress());
+    touch->checkLongPress();
+    TEST_ASSERT_EQUAL_UINT32(TouchController::NO_DEADLINE, touch->msUntilLongPress());
+
+    chip->release();
+    touch->handleInterrupt();
+    TEST_ASSERT_EQUAL_UINT32(TouchController::NO_DEADLINE, touch->msUntilLongPress());
+}
+
+void test_moving_finger_is_not_a_long_press() {
+    TEST_ASSERT_TRUE(touch->setBus(*bus));
+    chip->touch(200, 250);
+    touch->handleInterrupt();
+    sim::advanceMs(100);
+    chip->touch(260, 250);
+    touch->handleInterrupt();
+
+    sim::advanceMs(TouchController::LONG_PRESS_MS);
+    touch->checkLongPress();
+    // Still due, never fired
+    TEST_ASSERT_EQUAL_UINT32(0, touch->msUntilLongPress());
+
+    chip->release();
+    touch->handleInterrupt();
+    TEST_ASSERT_EQUAL_UINT32(TouchController::NO_DEADLINE, touch->msUntilLongPress());
+}
+
+void test_no_report_without_interrupt() {
+    TEST_ASSERT_TRUE(touch->setBus(*bus));
+    uint32_t transactions = Wire.getTransactions();
+    touch->handleInterrupt();
+    TEST_ASSERT_EQUAL_UINT32(transactions, Wire.getTransactions());
+}
+
+void test_sleep_and_wake() {
+    TEST_ASSERT_TRUE(touch->setBus(*bus));
+    TEST_ASSERT_TRUE(touch->sleep());
+    TEST_ASSERT_TRUE(chip->isAsleep());
+
+    // Deep sleep ignores the bus: reads fail after their retries
+    uint16_t x, y;
+    TEST_ASSERT_FALSE(touch->readTouch(x, y));
+
+    // Only a reset pulse brings it back
+    TEST_ASSERT_TRUE(touch->wake());
+    TEST_ASSERT_FALSE(chip->isAsleep());
+    TEST_ASSERT_EQUAL_UINT32(2, chip->getResets());
+    TEST_ASSERT_EQUAL_HEX8(0x01, chip->peek(Ft3168::POWER_MODE));
+    chip->touch(10, 20);
+    TEST_ASSERT_TRUE(touch->readTouch(x, y));
+    TEST_ASSERT_EQUAL_UINT16(10, x);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_init_resets_and_configures);
+    RUN_TEST(test_wrong_chip_id_fails);
+    RUN_TEST(test_coordinates);
+    RUN_TEST(test_long_press);
+    RUN_TEST(test_moving_finger_is_not_a_long_press);
+    RUN_TEST(test_no_report_without_interrupt);
+    RUN_TEST(test_sleep_and_wake);
+    return UNITY_END();
+}
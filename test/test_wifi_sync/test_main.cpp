@@ -0,0 +1,353 @@
+#include <unity.h>
+#include <sys/time.h>
+
+#include "system/wifi/wifi_sync.hpp"
+#include "sim/pcf85063.hpp"
+
+using sim::Pcf85063;
+
+Logger logger;    // Defined by main.cpp in the firmware
+
+static constexpr uint32_t NEVER = 0xFFFFFFFF;
+
+// Per attempt, relative to the request: when a scan-and-connect succeeds, when NTP
+// answers and when a directed connect to the cached AP succeeds (NEVER = AP moved)
+struct ScriptStep {
+    uint32_t connect_ms;
+    uint32_t ntp_ms;
+    uint32_t directed_ms;
+};
+
+class ScriptedNetwork : public WiFiSync::Network {
+private:
+    const ScriptStep* script;
+    uint8_t length;
+    ScriptStep current = {NEVER, NEVER, NEVER};
+    uint32_t connect_at = 0;
+    uint32_t connect_after = NEVER;
+    uint32_t ntp_at = 0;
+    bool ntp = false;
+    bool fallback = false;     // A scan now belongs to the directed connect's attempt
+
+public:
+    uint8_t attempts = 0;
+    uint8_t directed = 0;
+    uint32_t static_ip = 0;    // Of the last directed connect
+    bool radio = false;
+
+    template <size_t N>
+    ScriptedNetwork(const ScriptStep (&script)[N]) : script(script), length(N) {}
+
+    void connect(const char*, const char*, const WiFiSync::Link* link) override {
+        // A fallback scan stays within the same attempt's script step
+        if (link || !fallback) current = script[attempts < length ? attempts++ : length - 1];
+        fallback = link != nullptr;
+        if (link) {
+            directed++;
+            static_ip = link->ip;
+        }
+        connect_after = link ? current.directed_ms : current.connect_ms;
+        connect_at = millis();
+        radio = true;
+    }
+    bool isConnected() override {
+        return radio && connect_after != NEVER && millis() - connect_at >= connect_after;
+    }
+    void getLink(WiFiSync::Link& link) override {
+        static const uint8_t bssid[6] = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+        memcpy(link.bssid, bssid, sizeof(bssid));
+        link.channel = 6;
+        link.ip = 0x0A01A8C0;  // 192.168.1.10
+        link.gateway = 0x0101A8C0;
+        link.subnet = 0x00FFFFFF;
+        link.dns = 0x0101A8C0;
+    }
+    void startNtp() override {
+        fallback = false;
+        ntp_at = millis();
+        ntp = true;
+    }
+    bool getNtpTime(struct tm& timeinfo) override {
+        if (!ntp || current.ntp_ms == NEVER || millis() - ntp_at < current.ntp_ms) return false;
+        timeinfo = {};
+        timeinfo.tm_year = 126;
+        timeinfo.tm_mon = 2;
+        timeinfo.tm_mday = 14;
+        timeinfo.tm_hour = 15;
+        timeinfo.tm_min = 9;
+        timeinfo.tm_sec = 26;
+        timeinfo.tm_wday = 6;
+        return true;
+    }
+    void disconnect() override { radio = ntp = false; }
+};
+
+struct Recorder {
+    WiFiSync::Event events[12];
+    uint32_t at[12];
+    uint8_t count = 0;
+
+    static void record(const WiFiSync::Event& event, void* ctx) {
+        Recorder* r = static_cast<Recorder*>(ctx);
+        if (r->count >= 12) return;
+        r->at[r->count] = millis();
+        r->events[r->count++] = event;
+    }
+};
+
+static I2CBus* bus = nullptr;
+static Pcf85063* chip = nullptr;
+static RTC* rtc = nullptr;
+
+static void writeCredentials(const char* text) {
+    File f = LittleFS.open(WIFI_CREDENTIALS_FILE, "w");
+    f.print(text);
+    f.close();
+}
+
+void setUp() {
+    LittleFS.format();
+    writeCredentials("sim\nsecret\n");
+    Wire.detachAll();
+    chip = new Pcf85063(RTC_INT);
+    Wire.attach(*chip);
+    bus = new I2CBus(&logger, Wire);
+    bus->begin(I2C_SDA, I2C_SCL, I2C_FAST_HZ);
+    rtc = new RTC(&logger);
+    rtc->setBus(*bus);
+}
+
+void tearDown() {
+    detachInterrupt(RTC_INT);
+    delete rtc;
+    delete bus;
+    delete chip;
+    Wire.detachAll();
+}
+
+// 50ms loop passes on the simulated clock until the recorder has `events`, up to 4 hours
+static void play(WiFiSync& sync, Recorder& recorder, uint8_t events) {
+    uint32_t start = millis();
+    while (recorder.count < events && millis() - start < 4 * 3600000UL) {
+        sim::advanceMs(50);
+        sync.service();
+    }
+    TEST_ASSERT_EQUAL_UINT8(events, recorder.count);
+}
+
+static void assertEvent(const Recorder& recorder, uint8_t index, WiFiSync::Result result, uint8_t attempt, uint32_t next_ms) {
+    const WiFiSync::Event& event = recorder.events[index];
+    TEST_ASSERT_EQUAL_STRING(WiFiSync::resultName(result), WiFiSync::resultName(event.result));
+    TEST_ASSERT_EQUAL_UINT8(attempt, event.attempt);
+    TEST_ASSERT_EQUAL_UINT32(next_ms, event.next_ms);
+}
+
+void test_no_credentials_disables() {
+    LittleFS.remove(WIFI_CREDENTIALS_FILE);
+    const ScriptStep script[] = {{100, 100, 100}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+
+    TEST_ASSERT_FALSE(sync.begin(*rtc));
+    TEST_ASSERT_EQUAL(WiFiSync::DISABLED, sync.getState());
+    TEST_ASSERT_EQUAL_UINT8(1, recorder.count);
+    assertEvent(recorder, 0, WiFiSync::RESULT_NO_CREDENTIALS, 0, 0);
+    sim::advanceMs(3600000);
+    sync.service();
+    TEST_ASSERT_EQUAL_UINT8(0, network.attempts);
+}
+
+void test_unreachable_then_syncs() {
+    // AP unreachable twice, then a scan connects in 2s and NTP answers 1.5s later
+    const ScriptStep script[] = {{NEVER, NEVER, NEVER}, {NEVER, NEVER, NEVER}, {2000, 1500, NEVER}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+
+    // The RTC starts with its oscillator stopped: nothing to seed the clock from, but the sync still runs
+    uint32_t seeds = sim::wallClock().sets;
+    TEST_ASSERT_TRUE(sync.begin(*rtc));
+    TEST_ASSERT_EQUAL_UINT32(seeds, sim::wallClock().sets);
+    TEST_ASSERT_EQUAL(WiFiSync::CONNECTING, sync.getState());
+    play(sync, recorder, 3);
+
+    assertEvent(recorder, 0, WiFiSync::RESULT_CONNECT_TIMEOUT, 1, WIFI_RETRY_BASE_MS);
+    assertEvent(recorder, 1, WiFiSync::RESULT_CONNECT_TIMEOUT, 2, 2 * WIFI_RETRY_BASE_MS);
+    assertEvent(recorder, 2, WiFiSync::RESULT_SYNCED, 3, WIFI_RESYNC_MS);
+    TEST_ASSERT_EQUAL_UINT32(0, recorder.events[0].connect_ms);
+    TEST_ASSERT_UINT_WITHIN(100, 2000, recorder.events[2].connect_ms);
+    // Second timeout 30s after the first, success 60s after that
+    TEST_ASSERT_UINT_WITHIN(200, WIFI_RETRY_BASE_MS + WIFI_CONNECT_TIMEOUT_MS, recorder.at[1] - recorder.at[0]);
+    TEST_ASSERT_UINT_WITHIN(200, 2 * WIFI_RETRY_BASE_MS + 3500, recorder.at[2] - recorder.at[1]);
+
+    TEST_ASSERT_EQUAL(WiFiSync::SYNCED, sync.getState());
+    TEST_ASSERT_FALSE(network.radio);
+    TEST_ASSERT_EQUAL_UINT32(1, sync.getSyncCount());
+    TEST_ASSERT_EQUAL_UINT32(2, sync.getFailureCount());
+
+    // NTP time landed in the RTC
+    RTC::DateTime dt;
+    TEST_ASSERT_TRUE(rtc->getDateTime(dt));
+    TEST_ASSERT_EQUAL_UINT16(2026, dt.year);
+    TEST_ASSERT_EQUAL_UINT8(3, dt.month);
+    TEST_ASSERT_EQUAL_UINT8(14, dt.day);
+    TEST_ASSERT_EQUAL_UINT8(15, dt.hour);
+    TEST_ASSERT_EQUAL_UINT8(9, dt.minute);
+}
+
+void test_ntp_silent_then_syncs() {
+    const ScriptStep script[] = {{1000, NEVER, NEVER}, {1000, 500, NEVER}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+    sync.begin(*rtc);
+    play(sync, recorder, 2);
+
+    assertEvent(recorder, 0, WiFiSync::RESULT_NTP_TIMEOUT, 1, WIFI_RETRY_BASE_MS);
+    assertEvent(recorder, 1, WiFiSync::RESULT_SYNCED, 2, WIFI_RESYNC_MS);
+    // Associated both times, so both report a connect time
+    TEST_ASSERT_UINT_WITHIN(100, 1000, recorder.events[0].connect_ms);
+    TEST_ASSERT_GREATER_THAN(0, recorder.events[1].connect_ms);
+}
+
+void test_offline_backoff_caps() {
+    const ScriptStep script[] = {{NEVER, NEVER, NEVER}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+    sync.begin(*rtc);
+    play(sync, recorder, 8);
+
+    // 30s doubling each attempt, capped at 30 min; the radio is off in between
+    uint32_t backoff = WIFI_RETRY_BASE_MS;
+    for (uint8_t i = 0; i < 8; i++) {
+        assertEvent(recorder, i, WiFiSync::RESULT_CONNECT_TIMEOUT, i + 1, backoff);
+        backoff = std::min(backoff * 2, (uint32_t)WIFI_RETRY_MAX_MS);
+    }
+    TEST_ASSERT_EQUAL_UINT32(WIFI_RETRY_MAX_MS, recorder.events[7].next_ms);
+    TEST_ASSERT_EQUAL(WiFiSync::BACKOFF, sync.getState());
+    TEST_ASSERT_FALSE(network.radio);
+    TEST_ASSERT_EQUAL_UINT32(0, sync.getSyncCount());
+}
+
+// A first sync by scan, leaving the link cached in LittleFS
+static void syncOnce() {
+    const ScriptStep script[] = {{2500, 500, NEVER}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+    sync.begin(*rtc);
+    play(sync, recorder, 1);
+    assertEvent(recorder, 0, WiFiSync::RESULT_SYNCED, 1, WIFI_RESYNC_MS);
+    TEST_ASSERT_EQUAL_UINT8(0, network.directed);
+    TEST_ASSERT_TRUE(LittleFS.exists(WIFI_LINK_CACHE_FILE));
+}
+
+void test_cached_link_connects_directly() {
+    syncOnce();
+
+    // As after a reboot: a fresh instance picks up the cached AP and lease
+    const ScriptStep script[] = {{2500, 500, 300}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+    uint32_t seeds = sim::wallClock().sets;
+    sync.begin(*rtc);
+    TEST_ASSERT_TRUE(sync.hasCachedLink());
+    TEST_ASSERT_EQUAL_UINT32(seeds + 1, sim::wallClock().sets);  // The first sync left the RTC valid
+    play(sync, recorder, 1);
+
+    assertEvent(recorder, 0, WiFiSync::RESULT_SYNCED, 1, WIFI_RESYNC_MS);
+    TEST_ASSERT_UINT_WITHIN(100, 300, recorder.events[0].connect_ms);
+    TEST_ASSERT_EQUAL_UINT8(1, network.directed);
+    TEST_ASSERT_EQUAL_HEX32(0x0A01A8C0, network.static_ip);  // Lease still fresh: no DHCP
+    const WiFiSync::ConnectStats& stats = sync.getConnectStats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.fast);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.full);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.fallbacks);
+}
+
+void test_moved_ap_falls_back_to_scan() {
+    syncOnce();
+
+    const ScriptStep script[] = {{2500, 500, NEVER}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+    sync.begin(*rtc);
+    play(sync, recorder, 1);
+
+    // Same attempt: the directed connect gives up, a scan finds the AP
+    assertEvent(recorder, 0, WiFiSync::RESULT_SYNCED, 1, WIFI_RESYNC_MS);
+    TEST_ASSERT_UINT_WITHIN(100, WIFI_FAST_CONNECT_TIMEOUT_MS + 2500, recorder.events[0].connect_ms);
+    TEST_ASSERT_EQUAL_UINT8(1, network.attempts);
+    TEST_ASSERT_EQUAL_UINT32(1, sync.getConnectStats().fallbacks);
+    TEST_ASSERT_EQUAL_UINT32(1, sync.getConnectStats().full);
+    // A success always leaves the link it used cached
+    TEST_ASSERT_TRUE(sync.hasCachedLink());
+    TEST_ASSERT_TRUE(LittleFS.exists(WIFI_LINK_CACHE_FILE));
+}
+
+void test_cache_belongs_to_its_ssid() {
+    syncOnce();
+    writeCredentials("other\nsecret\n");
+
+    const ScriptStep script[] = {{2500, 500, 300}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+    sync.begin(*rtc);
+    TEST_ASSERT_FALSE(sync.hasCachedLink());
+    play(sync, recorder, 1);
+    TEST_ASSERT_EQUAL_UINT8(0, network.directed);
+}
+
+void test_power_lock_held_while_radio_up() {
+    PowerManager power(&logger);
+    int8_t lock = power.addLock("wifi");
+    const ScriptStep script[] = {{1000, 500, NEVER}};
+    ScriptedNetwork network(script);
+    Recorder recorder;
+    WiFiSync sync(&logger);
+    sync.setNetwork(network);
+    sync.setCallback(Recorder::record, &recorder);
+    sync.setPowerLock(power, lock);
+    sync.begin(*rtc);
+
+    // Light sleep would drop the link: the idle hook is refused until the attempt ends
+    TEST_ASSERT_TRUE(sync.isBusy());
+    TEST_ASSERT_FALSE(PowerManager::idle(1000, &power));
+    play(sync, recorder, 1);
+    TEST_ASSERT_FALSE(sync.isBusy());
+    TEST_ASSERT_TRUE(PowerManager::idle(1000, &power));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_no_credentials_disables);
+    RUN_TEST(test_unreachable_then_syncs);
+    RUN_TEST(test_ntp_silent_then_syncs);
+    RUN_TEST(test_offline_backoff_caps);
+    RUN_TEST(test_cached_link_connects_directly);
+    RUN_TEST(test_moved_ap_falls_back_to_scan);
+    RUN_TEST(test_cache_belongs_to_its_ssid);
+    RUN_TEST(test_power_lock_held_while_radio_up);
+    return UNITY_END();
+}
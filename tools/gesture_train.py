@@ -0,0 +1,407 @@
+#!/usr/bin/env python3
+"""
+Train the int8 wrist gesture decision tree and emit src/system/imu/gesture_model_data.hpp.
+
+Input: IMU traces captured with -DIMU_TRACE_CAPTURE (see src/system/imu/imu_trace.hpp)
+plus their "<trace>.labels" sidecars. Features are computed exactly as in
+GestureClassifier (integer maths on the 50ms-decimated stream), so the tree
+thresholds apply unchanged on the device.
+
+    python3 tools/gesture_train.py traces/*.bin
+    python3 tools/gesture_train.py --synthetic 60          # bootstrap model, 60 synthetic minutes
+    python3 tools/gesture_train.py --synthetic 60 --write-synthetic out/
+
+No third-party dependencies.
+"""
+import argparse
+import math
+import os
+import random
+import struct
+import sys
+
+MAGIC = 0x54554D49
+VERSION = 1
+HEADER = struct.Struct("<IHHHHfI")
+RECORD = struct.Struct("<Ihhhhhh")
+
+ACCEL_COUNTS_PER_G = 32768 // 8
+GYRO_COUNTS_PER_DPS = 32768 // 1024
+
+# Must match GestureClassifier
+POLL_INTERVAL_MS = 50
+WINDOW = 16
+FEATURES = 12
+FEATURE_NAMES = ["ax", "ay", "az", "ax0", "ay0", "az0", "gxmax", "gymax", "gzmax", "dax", "day", "daz"]
+CLASS_NONE, CLASS_RAISE, CLASS_LOWER = 0, 1, 2
+CLASS_NAMES = ["none", "raise", "lower"]
+
+# A poll belongs to a gesture class from the label time until this much later
+LABEL_BEFORE_MS = 0
+LABEL_AFTER_MS = 300
+
+DEFAULT_OUT = os.path.join(os.path.dirname(__file__), "..", "src", "system", "imu", "gesture_model_data.hpp")
+
+
+def clamp8(v):
+    return -127 if v < -127 else 127 if v > 127 else v
+
+
+def quant_accel(counts):
+    return clamp8(counts >> 6)           # 1/64 g per step, ±2 g
+
+
+def quant_gyro(counts):
+    return clamp8(abs(counts) >> 6)      # 2 dps per step, magnitude only
+
+
+# ---------------------------------------------------------------- traces
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    magic, version, record_size, accel_fs, gyro_fs, odr, start = HEADER.unpack_from(data, 0)
+    if magic != MAGIC or version != VERSION or record_size != RECORD.size:
+        raise ValueError(f"{path}: not an IMU trace")
+    if accel_fs != 8 or gyro_fs != 1024:
+        raise ValueError(f"{path}: unsupported full-scale range {accel_fs}g/{gyro_fs}dps")
+    records = [RECORD.unpack_from(data, off) for off in range(HEADER.size, len(data) - RECORD.size + 1, RECORD.size)]
+    return records
+
+
+def read_labels(path):
+    labels = []
+    try:
+        with open(path + ".labels") as f:
+            for line in f:
+                parts = line.split()
+                if len(parts) == 2 and parts[0] in ("raise", "lower"):
+                    labels.append((CLASS_RAISE if parts[0] == "raise" else CLASS_LOWER, int(parts[1])))
+    except FileNotFoundError:
+        pass
+    return labels
+
+
+def write_trace(path, records, labels):
+    with open(path, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, RECORD.size, 8, 1024, 112.1, 0))
+        for r in records:
+            f.write(RECORD.pack(*r))
+    with open(path + ".labels", "w") as f:
+        for cls, t in labels:
+            f.write(f"{CLASS_NAMES[cls]} {t}\n")
+
+
+# ---------------------------------------------------------------- features
+
+def poll_stream(records):
+    """Decimate to the live 50ms polling rate (same rule as ImuTrace::replay)."""
+    last = None
+    for r in records:
+        if last is not None and r[0] - last < POLL_INTERVAL_MS:
+            continue
+        last = r[0]
+        yield r
+
+
+def window_features(records):
+    """Yields (t_ms, features) for every poll once the window is full."""
+    window = []
+    for t, ax, ay, az, gx, gy, gz in poll_stream(records):
+        window.append((quant_accel(ax), quant_accel(ay), quant_accel(az), quant_gyro(gx), quant_gyro(gy), quant_gyro(gz)))
+        if len(window) > WINDOW:
+            window.pop(0)
+        if len(window) < WINDOW:
+            continue
+        cur, old = window[-1], window[0]
+        f = [cur[0], cur[1], cur[2], old[0], old[1], old[2],
+             max(s[3] for s in window), max(s[4] for s in window), max(s[5] for s in window),
+             clamp8(cur[0] - old[0]), clamp8(cur[1] - old[1]), clamp8(cur[2] - old[2])]
+        yield t, f
+
+
+def label_for(t, labels):
+    for cls, lt in labels:
+        if lt - LABEL_BEFORE_MS <= t <= lt + LABEL_AFTER_MS:
+            return cls
+    return CLASS_NONE
+
+
+def dataset(records, labels):
+    return [(f, label_for(t, labels)) for t, f in window_features(records)]
+
+
+# ---------------------------------------------------------------- synthetic traces
+
+POSES = {
+    "stand_down": (0.00, -0.95, -0.15),
+    "sit_lap":    (0.15, 0.25, -0.90),
+    "desk":       (0.05, 0.05, -0.98),
+    "watch_up":   (0.45, -0.25, -0.80),
+}
+
+
+def normalize(v):
+    n = math.sqrt(sum(c * c for c in v)) or 1.0
+    return tuple(c / n for c in v)
+
+
+def jitter(v, amount):
+    return normalize(tuple(c + random.uniform(-amount, amount) for c in v))
+
+
+def synthesize(minutes, seed=1):
+    """Random walk over poses with raise/lower gestures and look-alike fidgets."""
+    random.seed(seed)
+    dt = 1000.0 / 112.1
+    t = 0.0
+    records, labels = [], []
+    pose = jitter(POSES["stand_down"], 0.1)
+    state = "stand_down"
+
+    def emit(a, g):
+        records.append((int(t),
+                        int((a[0] + random.gauss(0, 0.02)) * ACCEL_COUNTS_PER_G),
+                        int((a[1] + random.gauss(0, 0.02)) * ACCEL_COUNTS_PER_G),
+                        int((a[2] + random.gauss(0, 0.02)) * ACCEL_COUNTS_PER_G),
+                        int((g[0] + random.gauss(0, 2.0)) * GYRO_COUNTS_PER_DPS),
+                        int((g[1] + random.gauss(0, 2.0)) * GYRO_COUNTS_PER_DPS),
+                        int((g[2] + random.gauss(0, 2.0)) * GYRO_COUNTS_PER_DPS)))
+
+    def hold(ms, swing=0.0):
+        nonlocal t
+        end = t + ms
+        while t < end:
+            g = (swing * math.sin(t / 1000.0 * 2 * math.pi * 0.9), 0.0, 0.0)
+            emit(pose, g)
+            t += dt
+
+    def move(target, ms):
+        nonlocal t, pose
+        start = pose
+        cos = max(-1.0, min(1.0, sum(a * b for a, b in zip(start, target))))
+        angle = math.degrees(math.acos(cos))
+        axis = normalize((start[1] * target[2] - start[2] * target[1],
+                          start[2] * target[0] - start[0] * target[2],
+                          start[0] * target[1] - start[1] * target[0]))
+        steps = max(1, int(ms / dt))
+        for i in range(steps):
+            k = (i + 1) / steps
+            shape = math.sin(k * math.pi)  # bell-shaped angular velocity
+            rate = angle / (ms / 1000.0) * shape * math.pi / 2
+            a = normalize(tuple(s + (e - s) * k for s, e in zip(start, target)))
+            emit(a, tuple(c * rate for c in axis))
+            t += dt
+        pose = target
+
+    end_ms = minutes * 60000
+    while t < end_ms:
+        if state == "watch_up":
+            hold(random.uniform(1000, 5000))
+            state = random.choice(["stand_down", "sit_lap", "desk"])
+            move(jitter(POSES[state], 0.1), random.uniform(300, 700))
+            labels.append((CLASS_LOWER, int(t)))
+            continue
+
+        r = random.random()
+        if r < 0.35:
+            hold(random.uniform(1000, 6000))
+            move(jitter(POSES["watch_up"], 0.1), random.uniform(300, 700))
+            labels.append((CLASS_RAISE, int(t)))
+            state = "watch_up"
+        elif r < 0.55:
+            # Sitting fidget: rotates hard but stays on the lap (the classic false wake)
+            hold(random.uniform(500, 3000))
+            saved = state
+            move(jitter((0.35, 0.15, -0.90), 0.05), random.uniform(200, 400))
+            hold(random.uniform(200, 800))
+            move(jitter(POSES[saved], 0.1), random.uniform(200, 400))
+        elif r < 0.75:
+            # Walking arm swing while standing
+            hold(random.uniform(2000, 6000), swing=random.uniform(40, 90))
+        else:
+            state = random.choice(["stand_down", "sit_lap", "desk"])
+            move(jitter(POSES[state], 0.1), random.uniform(400, 1000))
+    return records, labels
+
+
+# ---------------------------------------------------------------- CART
+
+def gini(counts):
+    n = sum(counts)
+    return 0.0 if n == 0 else 1.0 - sum((c / n) ** 2 for c in counts)
+
+
+def build_tree(rows, weights, depth, max_depth, min_leaf, nodes):
+    counts = [0.0, 0.0, 0.0]
+    for f, c in rows:
+        counts[c] += weights[c]
+    majority = max(range(3), key=lambda c: counts[c])
+    index = len(nodes)
+    nodes.append(None)
+
+    best = None
+    if depth < max_depth and len(rows) >= 2 * min_leaf and counts[majority] < sum(counts):
+        parent = gini(counts) * sum(counts)
+        for feature in range(FEATURES):
+            ordered = sorted(rows, key=lambda r: r[0][feature])
+            left = [0.0, 0.0, 0.0]
+            right = counts[:]
+            for i in range(len(ordered) - 1):
+                c = ordered[i][1]
+                left[c] += weights[c]
+                right[c] -= weights[c]
+                v, nxt = ordered[i][0][feature], ordered[i + 1][0][feature]
+                if v == nxt or i + 1 < min_leaf or len(ordered) - i - 1 < min_leaf:
+                    continue
+                score = gini(left) * sum(left) + gini(right) * sum(right)
+                if score < parent - 1e-9 and (best is None or score < best[0]):
+                    best = (score, feature, v)
+
+    if best is None:
+        nodes[index] = (-1, majority, 0, 0)
+        return index
+
+    _, feature, threshold = best
+    left_rows = [r for r in rows if r[0][feature] <= threshold]
+    right_rows = [r for r in rows if r[0][feature] > threshold]
+    left = build_tree(left_rows, weights, depth + 1, max_depth, min_leaf, nodes)
+    right = build_tree(right_rows, weights, depth + 1, max_depth, min_leaf, nodes)
+    nodes[index] = (feature, threshold, left, right)
+    return index
+
+
+def prune(nodes):
+    """Collapses splits whose two subtrees are identical, e.g. both the same leaf.
+
+    CART only stops on purity, so a split can separate rows that end up with the
+    same majority on both sides. Returns the tree renumbered in preorder.
+    """
+    def shape(i):
+        feature, threshold, left, right = nodes[i]
+        if feature < 0:
+            return (feature, threshold)
+        l, r = shape(left), shape(right)
+        return l if l == r else (feature, threshold, l, r)
+
+    out = []
+
+    def emit(s):
+        index = len(out)
+        out.append(None)
+        if len(s) == 2:
+            out[index] = (s[0], s[1], 0, 0)
+        else:
+            left = emit(s[2])
+            right = emit(s[3])
+            out[index] = (s[0], s[1], left, right)
+        return index
+
+    emit(shape(0))
+    return out
+
+
+def predict(nodes, f):
+    i = 0
+    while nodes[i][0] >= 0:
+        feature, threshold, left, right = nodes[i]
+        i = left if f[feature] <= threshold else right
+    return nodes[i][1]
+
+
+def report(name, nodes, rows):
+    confusion = [[0] * 3 for _ in range(3)]
+    for f, c in rows:
+        confusion[c][predict(nodes, f)] += 1
+    total = sum(map(sum, confusion))
+    correct = sum(confusion[i][i] for i in range(3))
+    print(f"{name}: {total} windows, accuracy {100.0 * correct / max(1, total):.1f}%")
+    print("  true\\pred " + " ".join(f"{n:>7}" for n in CLASS_NAMES))
+    for i, row in enumerate(confusion):
+        print(f"  {CLASS_NAMES[i]:>9} " + " ".join(f"{v:>7}" for v in row))
+
+
+# ---------------------------------------------------------------- output
+
+def emit_header(nodes, path, source):
+    if len(nodes) > 255:
+        raise ValueError("tree too large for uint8_t child indices - lower --max-depth")
+    lines = [
+        "#pragma once",
+        "// Generated by tools/gesture_train.py - do not edit by hand.",
+        f"// Source: {source}",
+        '#include "gesture_classifier.hpp"',
+        "",
+        f"static_assert(GestureClassifier::WINDOW == {WINDOW}, \"gesture model trained for a different window\");",
+        f"static_assert(GestureClassifier::FEATURES == {FEATURES}, \"gesture model trained for a different feature set\");",
+        "",
+        "// {feature, threshold, left, right} - feature < 0 marks a leaf whose threshold is the class",
+        "static const GestureClassifier::Node GESTURE_MODEL_NODES[] = {",
+    ]
+    for i, (feature, threshold, left, right) in enumerate(nodes):
+        comment = f"leaf: {CLASS_NAMES[threshold]}" if feature < 0 else f"{FEATURE_NAMES[feature]} <= {threshold}"
+        lines.append(f"    {{{feature:>3}, {threshold:>4}, {left:>3}, {right:>3}}},  // {i}: {comment}")
+    lines += [
+        "};",
+        "",
+        "static const GestureClassifier::Model GESTURE_MODEL = {",
+        "    GESTURE_MODEL_NODES,",
+        "    sizeof(GESTURE_MODEL_NODES) / sizeof(GESTURE_MODEL_NODES[0]),",
+        "};",
+        "",
+    ]
+    with open(path, "w") as f:
+        f.write("\n".join(lines))
+    print(f"Wrote {len(nodes)} nodes to {os.path.normpath(path)}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("traces", nargs="*", help="IMU trace files (.bin) with .labels sidecars")
+    parser.add_argument("--synthetic", type=float, default=0, help="add this many minutes of synthetic data")
+    parser.add_argument("--write-synthetic", metavar="DIR", help="also save the synthetic trace for replay")
+    parser.add_argument("--max-depth", type=int, default=6)
+    parser.add_argument("--min-leaf", type=int, default=8)
+    parser.add_argument("--holdout", type=float, default=0.25, help="fraction of each trace held out for evaluation")
+    parser.add_argument("--out", default=DEFAULT_OUT)
+    args = parser.parse_args()
+
+    sources = []
+    for path in args.traces:
+        sources.append((os.path.basename(path), read_trace(path), read_labels(path)))
+    if args.synthetic > 0:
+        records, labels = synthesize(args.synthetic)
+        sources.append((f"synthetic {args.synthetic:g} min", records, labels))
+        if args.write_synthetic:
+            os.makedirs(args.write_synthetic, exist_ok=True)
+            write_trace(os.path.join(args.write_synthetic, "synthetic.bin"), records, labels)
+    if not sources:
+        parser.error("no traces given (use --synthetic to bootstrap)")
+
+    # Hold out the tail of each trace so evaluation never sees training windows
+    train, test = [], []
+    for name, records, labels in sources:
+        rows = dataset(records, labels)
+        split = int(len(rows) * (1.0 - args.holdout))
+        train += rows[:split]
+        test += rows[split:]
+        print(f"{name}: {len(rows)} windows, {len(labels)} labels")
+
+    # Balance classes — gestures are rare compared to "none"
+    counts = [sum(1 for _, c in train if c == k) for k in range(3)]
+    weights = [len(train) / (3.0 * max(1, n)) for n in counts]
+
+    nodes = []
+    build_tree(train, weights, 0, args.max_depth, args.min_leaf, nodes)
+    grown = len(nodes)
+    nodes = prune(nodes)
+    if len(nodes) < grown:
+        print(f"Pruned {grown - len(nodes)} nodes with identical subtrees")
+    report("train", nodes, train)
+    if test:
+        report("holdout", nodes, test)
+    emit_header(nodes, args.out, ", ".join(name for name, _, _ in sources))
+
+
+if __name__ == "__main__":
+    sys.exit(main())